@@ -0,0 +1,198 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <RaspiAPA102/SIMD.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The minimum duration of a single measurement in nanoseconds.
+ */
+#define RASPI_APA102_BENCH_MIN_DURATION 100000000ull
+
+/**
+ * @brief   The name of the target architecture.
+ */
+#if defined(__x86_64__)
+#   define RASPI_APA102_BENCH_ARCH "x86_64"
+#elif defined(__i386__)
+#   define RASPI_APA102_BENCH_ARCH "x86"
+#elif defined(__aarch64__)
+#   define RASPI_APA102_BENCH_ARCH "aarch64"
+#elif defined(__arm__)
+#   define RASPI_APA102_BENCH_ARCH "arm"
+#else
+#   define RASPI_APA102_BENCH_ARCH "unknown"
+#endif
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchSuite` struct.
+ */
+typedef struct RaspiAPA102BenchSuite_
+{
+    /**
+     * @brief   The name of the suite.
+     */
+    const char* name;
+    /**
+     * @brief   The suite entry point.
+     */
+    void (*run)(void);
+} RaspiAPA102BenchSuite;
+
+/**
+ * @brief   All registered benchmark suites.
+ */
+static const RaspiAPA102BenchSuite RASPI_APA102_BENCH_SUITES[] =
+{
+    { "animation" , RaspiAPA102BenchAnimation  },
+    { "color"     , RaspiAPA102BenchColor      },
+    { "correction", RaspiAPA102BenchCorrection },
+    { "effect"    , RaspiAPA102BenchEffect     },
+    { "framing"   , RaspiAPA102BenchFraming    },
+    { "layer"     , RaspiAPA102BenchLayer      },
+    { "packing"   , RaspiAPA102BenchPacking    },
+    { "sequence"  , RaspiAPA102BenchSequence   },
+    { "strip"     , RaspiAPA102BenchStrip      },
+    { "transport" , RaspiAPA102BenchTransport  }
+};
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+static int RaspiAPA102BenchNullWrite(void* context, const uint8_t* buffer, size_t size)
+{
+    (void)context;
+    (void)size;
+
+    // Keep the compiler from dropping the framing of the data
+    __asm__ __volatile__("" : : "r"(buffer) : "memory");
+
+    return 0;
+}
+
+static int RaspiAPA102BenchNullFlush(void* context)
+{
+    (void)context;
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Harness                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+uint64_t RaspiAPA102BenchNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+void RaspiAPA102BenchRun(const char* suite, const char* name, size_t count, 
+    RaspiAPA102BenchFunction function, void* context)
+{
+    // Warm up caches and branch predictors
+    function(context, count);
+
+    uint64_t iterations = 1;
+    uint64_t elapsed;
+    for (;;)
+    {
+        const uint64_t start = RaspiAPA102BenchNow();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            function(context, count);
+        }
+        elapsed = RaspiAPA102BenchNow() - start;
+        if (elapsed >= RASPI_APA102_BENCH_MIN_DURATION)
+        {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    const double ns_per_call = (double)elapsed / (double)iterations;
+    printf("%s,%s,%zu,%" PRIu64 ",%.1f,%.3f,%.1f,%.0f\n", suite, name, count, iterations, 
+        ns_per_call, ns_per_call / (double)count, 1e9 / ns_per_call, 
+        (double)count * 1e9 / ns_per_call);
+    fflush(stdout);
+}
+
+void RaspiAPA102BenchGetNullTransport(RaspiAPA102Transport* transport)
+{
+    memset(transport, 0, sizeof(*transport));
+    transport->write = RaspiAPA102BenchNullWrite;
+    transport->flush = RaspiAPA102BenchNullFlush;
+}
+
+/* ============================================================================================== */
+/* Entry Point                                                                                    */
+/* ============================================================================================== */
+
+int main(int argc, char** argv)
+{
+    // The comment line allows to tell results of different machines and builds apart
+    printf("# RaspiAPA102Bench arch=%s simd=%s compiler=%s\n", RASPI_APA102_BENCH_ARCH, 
+        RaspiAPA102SIMDGetName(RaspiAPA102SIMDResolve(RASPI_APA102_SIMD_AUTO)), __VERSION__);
+    printf("suite,case,items,iterations,ns_per_call,ns_per_item,calls_per_second,"
+        "items_per_second\n");
+
+    const size_t count = sizeof(RASPI_APA102_BENCH_SUITES) / sizeof(RASPI_APA102_BENCH_SUITES[0]);
+    for (size_t i = 0; i < count; ++i)
+    {
+        bool selected = (argc < 2);
+        for (int j = 1; j < argc; ++j)
+        {
+            if (!strcmp(argv[j], RASPI_APA102_BENCH_SUITES[i].name))
+            {
+                selected = true;
+            }
+        }
+        if (selected)
+        {
+            RASPI_APA102_BENCH_SUITES[i].run();
+        }
+    }
+
+    return 0;
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,170 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Declares the benchmark harness and the individual benchmark suites.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <RaspiAPA102/Transport.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The strip sizes used by the suites that cover the output path.
+ */
+#define RASPI_APA102_BENCH_STRIP_SIZES { 1, 10, 100, 1000, 10000 }
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchFunction` function prototype.
+ *
+ * @param   context The benchmark context.
+ * @param   count   The number of items to process.
+ */
+typedef void (*RaspiAPA102BenchFunction)(void* context, size_t count);
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Harness                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the current value of the monotonic clock in nanoseconds.
+ *
+ * @return  The current time in nanoseconds.
+ */
+uint64_t RaspiAPA102BenchNow(void);
+
+/**
+ * @brief   Measures the given function and prints a result line.
+ *
+ * @param   suite       The name of the suite.
+ * @param   name        The name of the benchmark case.
+ * @param   count       The number of items processed by a single call.
+ * @param   function    The function to measure.
+ * @param   context     The context passed to the function.
+ *
+ * The number of iterations is doubled until a single measurement takes at least 100ms. One line
+ * of comma separated values is printed to `stdout`:
+ * `suite,case,items,iterations,ns_per_call,ns_per_item,calls_per_second,items_per_second`.
+ *
+ * For the suites that cover the output path, an item is a single LED and a call is a single 
+ * frame.
+ */
+void RaspiAPA102BenchRun(const char* suite, const char* name, size_t count, 
+    RaspiAPA102BenchFunction function, void* context);
+
+/**
+ * @brief   Returns a transport that discards all data.
+ *
+ * @param   transport   Receives the transport.
+ *
+ * The transport replaces the `SPI` driver, so that only the cost of the library itself is 
+ * measured.
+ */
+void RaspiAPA102BenchGetNullTransport(RaspiAPA102Transport* transport);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Suites                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Measures the rendering of keyframe animations (virtual clock, no output).
+ */
+void RaspiAPA102BenchAnimation(void);
+
+/**
+ * @brief   Measures the scalar and batched color conversion functions.
+ */
+void RaspiAPA102BenchColor(void);
+
+/**
+ * @brief   Measures the color correction stage for all combinations of flags.
+ */
+void RaspiAPA102BenchCorrection(void);
+
+/**
+ * @brief   Measures the effect kernels single-threaded and on the thread pool.
+ */
+void RaspiAPA102BenchEffect(void);
+
+/**
+ * @brief   Measures the `APA102` framing of the device functions (null transport).
+ */
+void RaspiAPA102BenchFraming(void);
+
+/**
+ * @brief   Measures the composition of a layer stack for all blend modes and implementations.
+ */
+void RaspiAPA102BenchLayer(void);
+
+/**
+ * @brief   Measures the bulk pixel packing for all pixel formats and implementations.
+ */
+void RaspiAPA102BenchPacking(void);
+
+/**
+ * @brief   Measures the decoding of sequence files compared to copying raw frames.
+ */
+void RaspiAPA102BenchSequence(void);
+
+/**
+ * @brief   Measures the pixel setters of the `C++` strip layer compared to the `C` functions.
+ */
+void RaspiAPA102BenchStrip(void);
+
+/**
+ * @brief   Measures the write path of the software transports (stubbed `GPIO` registers).
+ */
+void RaspiAPA102BenchTransport(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H */
@@ -0,0 +1,121 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <RaspiAPA102/Animation.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+#define RASPI_APA102_BENCH_ANIMATION_FPS 100
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchAnimationContext` struct.
+ */
+typedef struct RaspiAPA102BenchAnimationContext_
+{
+    /**
+     * @brief   The animation.
+     */
+    RaspiAPA102Animation animation;
+    /**
+     * @brief   The virtual time in nanoseconds.
+     */
+    uint64_t now;
+} RaspiAPA102BenchAnimationContext;
+
+static void RaspiAPA102BenchAnimationRun(void* context, size_t count)
+{
+    (void)count;
+
+    RaspiAPA102BenchAnimationContext* c = (RaspiAPA102BenchAnimationContext*)context;
+    c->now += 1000000000 / RASPI_APA102_BENCH_ANIMATION_FPS;
+    RaspiAPA102AnimationNextFrameAt(&c->animation, c->now, NULL);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchAnimation(void)
+{
+    static const size_t sizes[] = { 144, 4096 };
+    static const RaspiAPA102Keyframe keyframes[] =
+    {
+        { 0   , {     0, 255, 255 }, RASPI_APA102_ANIMATION_CURVE_LINEAR      },
+        { 1000, { 32768, 255, 128 }, RASPI_APA102_ANIMATION_CURVE_EASE_IN_OUT },
+        { 2000, {     0, 255, 255 }, RASPI_APA102_ANIMATION_CURVE_LINEAR      }
+    };
+    const size_t max_count = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    RaspiAPA102ColorQuad* quads = malloc(max_count * sizeof(RaspiAPA102ColorQuad));
+    RaspiAPA102AnimationTrack* tracks = malloc(max_count * sizeof(RaspiAPA102AnimationTrack));
+    if (!quads || !tracks)
+    {
+        free(quads);
+        free(tracks);
+        return;
+    }
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        // One looping HSV track per pixel, phase shifted along the string
+        for (size_t i = 0; i < sizes[s]; ++i)
+        {
+            tracks[i].first          = i;
+            tracks[i].length         = 1;
+            tracks[i].keyframes      = keyframes;
+            tracks[i].keyframe_count = sizeof(keyframes) / sizeof(keyframes[0]);
+            tracks[i].space          = RASPI_APA102_ANIMATION_SPACE_HSV;
+            tracks[i].start          = (uint32_t)(i % 2000);
+            tracks[i].loop           = true;
+        }
+
+        RaspiAPA102BenchAnimationContext context;
+        if (RaspiAPA102AnimationInit(&context.animation, quads, sizes[s], tracks, sizes[s], 
+            RASPI_APA102_BENCH_ANIMATION_FPS) < 0)
+        {
+            continue;
+        }
+        context.now = 0;
+        RaspiAPA102AnimationStartAt(&context.animation, context.now);
+        RaspiAPA102BenchRun("animation", "hsv/per-pixel", sizes[s], RaspiAPA102BenchAnimationRun, 
+            &context);
+        RaspiAPA102AnimationDestroy(&context.animation);
+    }
+
+    free(quads);
+    free(tracks);
+}
+
+/* ============================================================================================== */
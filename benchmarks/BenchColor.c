@@ -0,0 +1,213 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <RaspiAPA102/ColorConversion.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchColorContext` struct.
+ */
+typedef struct RaspiAPA102BenchColorContext_
+{
+    /**
+     * @brief   The color quads.
+     */
+    RaspiAPA102ColorQuad* quads;
+    /**
+     * @brief   The `RGB` color values.
+     */
+    RaspiAPA102RGB* rgb;
+    /**
+     * @brief   The `HSV` color values.
+     */
+    RaspiAPA102HSV* hsv;
+    /**
+     * @brief   The floating-point color channels (six planes of `count` values).
+     */
+    float* planes[6];
+    /**
+     * @brief   The fixed-point hues.
+     */
+    uint16_t* h;
+    /**
+     * @brief   The fixed-point saturations.
+     */
+    uint8_t* s;
+    /**
+     * @brief   The fixed-point values.
+     */
+    uint8_t* v;
+    /**
+     * @brief   The implementation used by the fixed-point conversion.
+     */
+    RaspiAPA102SIMDPath path;
+} RaspiAPA102BenchColorContext;
+
+static void RaspiAPA102BenchColorRunRGB2HSV(void* context, size_t count)
+{
+    RaspiAPA102BenchColorContext* c = (RaspiAPA102BenchColorContext*)context;
+    for (size_t i = 0; i < count; ++i)
+    {
+        c->hsv[i] = RaspiAPA102RGB2HSV(c->rgb[i]);
+    }
+}
+
+static void RaspiAPA102BenchColorRunHSV2RGB(void* context, size_t count)
+{
+    RaspiAPA102BenchColorContext* c = (RaspiAPA102BenchColorContext*)context;
+    for (size_t i = 0; i < count; ++i)
+    {
+        c->rgb[i] = RaspiAPA102HSV2RGB(c->hsv[i]);
+    }
+}
+
+static void RaspiAPA102BenchColorRunRGB2HSVBatch(void* context, size_t count)
+{
+    RaspiAPA102BenchColorContext* c = (RaspiAPA102BenchColorContext*)context;
+    RaspiAPA102RGB2HSVBatch(c->planes[0], c->planes[1], c->planes[2], c->planes[3], c->planes[4], 
+        c->planes[5], count);
+}
+
+static void RaspiAPA102BenchColorRunHSV2RGBBatch(void* context, size_t count)
+{
+    RaspiAPA102BenchColorContext* c = (RaspiAPA102BenchColorContext*)context;
+    RaspiAPA102HSV2RGBBatch(c->planes[3], c->planes[4], c->planes[5], c->planes[0], c->planes[1], 
+        c->planes[2], count);
+}
+
+static void RaspiAPA102BenchColorRunHSV2QuadBatch(void* context, size_t count)
+{
+    RaspiAPA102BenchColorContext* c = (RaspiAPA102BenchColorContext*)context;
+    RaspiAPA102HSV2ColorQuadBatch(c->quads, c->planes[3], c->planes[4], c->planes[5], count, 31);
+}
+
+static void RaspiAPA102BenchColorRunHSVFixed2QuadBatch(void* context, size_t count)
+{
+    RaspiAPA102BenchColorContext* c = (RaspiAPA102BenchColorContext*)context;
+    RaspiAPA102HSVFixed2ColorQuadBatchEx(c->quads, c->h, c->s, c->v, count, 31, c->path);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchColor(void)
+{
+    static const size_t sizes[] = RASPI_APA102_BENCH_STRIP_SIZES;
+    static const struct
+    {
+        RaspiAPA102BenchFunction function;
+        const char* name;
+    } cases[] =
+    {
+        { RaspiAPA102BenchColorRunRGB2HSV      , "rgb2hsv"        },
+        { RaspiAPA102BenchColorRunHSV2RGB      , "hsv2rgb"        },
+        { RaspiAPA102BenchColorRunRGB2HSVBatch , "rgb2hsv/batch"  },
+        { RaspiAPA102BenchColorRunHSV2RGBBatch , "hsv2rgb/batch"  },
+        { RaspiAPA102BenchColorRunHSV2QuadBatch, "hsv2quad/batch" }
+    };
+    const size_t max_count = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    RaspiAPA102BenchColorContext context;
+    context.quads = malloc(max_count * sizeof(RaspiAPA102ColorQuad));
+    context.rgb   = malloc(max_count * sizeof(RaspiAPA102RGB));
+    context.hsv   = malloc(max_count * sizeof(RaspiAPA102HSV));
+    context.h     = malloc(max_count * sizeof(uint16_t));
+    context.s     = malloc(max_count);
+    context.v     = malloc(max_count);
+    bool valid = context.quads && context.rgb && context.hsv && context.h && context.s && 
+        context.v;
+    for (size_t p = 0; p < 6; ++p)
+    {
+        context.planes[p] = malloc(max_count * sizeof(float));
+        valid = valid && context.planes[p];
+    }
+
+    if (valid)
+    {
+        for (size_t i = 0; i < max_count; ++i)
+        {
+            context.rgb[i].r = (double)((i * 7) & 0xFF) / 255.0;
+            context.rgb[i].g = (double)((i * 13) & 0xFF) / 255.0;
+            context.rgb[i].b = (double)((i * 29) & 0xFF) / 255.0;
+            context.hsv[i] = RaspiAPA102RGB2HSV(context.rgb[i]);
+            context.planes[0][i] = (float)context.rgb[i].r;
+            context.planes[1][i] = (float)context.rgb[i].g;
+            context.planes[2][i] = (float)context.rgb[i].b;
+            context.planes[3][i] = (float)context.hsv[i].h;
+            context.planes[4][i] = (float)context.hsv[i].s;
+            context.planes[5][i] = (float)context.hsv[i].v;
+            context.h[i] = (uint16_t)(i * 655);
+            context.s[i] = (uint8_t)(255 - (i & 0x3F));
+            context.v[i] = (uint8_t)(i * 3);
+        }
+
+        for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+        {
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+            {
+                RaspiAPA102BenchRun("color", cases[c].name, sizes[s], cases[c].function, 
+                    &context);
+            }
+        }
+
+        for (int path = RASPI_APA102_SIMD_SCALAR; path <= RASPI_APA102_SIMD_MAX_VALUE; ++path)
+        {
+            if (!RaspiAPA102SIMDIsSupported((RaspiAPA102SIMDPath)path))
+            {
+                continue;
+            }
+            context.path = (RaspiAPA102SIMDPath)path;
+            char name[64];
+            snprintf(name, sizeof(name), "hsvfixed2quad/%s", 
+                RaspiAPA102SIMDGetName(context.path));
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+            {
+                RaspiAPA102BenchRun("color", name, sizes[s], 
+                    RaspiAPA102BenchColorRunHSVFixed2QuadBatch, &context);
+            }
+        }
+    }
+
+    for (size_t p = 0; p < 6; ++p)
+    {
+        free(context.planes[p]);
+    }
+    free(context.quads);
+    free(context.rgb);
+    free(context.hsv);
+    free(context.h);
+    free(context.s);
+    free(context.v);
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,134 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <RaspiAPA102/Correction.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchCorrectionContext` struct.
+ */
+typedef struct RaspiAPA102BenchCorrectionContext_
+{
+    /**
+     * @brief   The correction stage.
+     */
+    RaspiAPA102Correction correction;
+    /**
+     * @brief   The color quads.
+     */
+    RaspiAPA102ColorQuad* quads;
+    /**
+     * @brief   The 16-bit linear source pixels.
+     */
+    uint16_t* pixels;
+} RaspiAPA102BenchCorrectionContext;
+
+static void RaspiAPA102BenchCorrectionRun(void* context, size_t count)
+{
+    RaspiAPA102BenchCorrectionContext* c = (RaspiAPA102BenchCorrectionContext*)context;
+    RaspiAPA102CorrectionApply(&c->correction, c->quads, count);
+}
+
+static void RaspiAPA102BenchCorrectionRun16(void* context, size_t count)
+{
+    RaspiAPA102BenchCorrectionContext* c = (RaspiAPA102BenchCorrectionContext*)context;
+    RaspiAPA102CorrectionApply16(&c->correction, c->quads, c->pixels, count, 31);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchCorrection(void)
+{
+    static const size_t sizes[] = { 144, 4096, 65536 };
+    static const struct
+    {
+        uint32_t flags;
+        const char* name;
+    } modes[] =
+    {
+        { 0, "lut" },
+        { RASPI_APA102_CORRECTION_DITHERING, "dither" },
+        { RASPI_APA102_CORRECTION_BRIGHTNESS, "brightness" },
+        {
+            RASPI_APA102_CORRECTION_BRIGHTNESS | RASPI_APA102_CORRECTION_DITHERING, 
+            "brightness+dither"
+        }
+    };
+    const size_t max_count = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    RaspiAPA102BenchCorrectionContext context;
+    context.quads  = malloc(max_count * sizeof(RaspiAPA102ColorQuad));
+    context.pixels = malloc(max_count * 3 * sizeof(uint16_t));
+    if (!context.quads || !context.pixels)
+    {
+        free(context.quads);
+        free(context.pixels);
+        return;
+    }
+    for (size_t i = 0; i < max_count; ++i)
+    {
+        RaspiAPA102ColorQuadInit(&context.quads[i], (uint8_t)i, (uint8_t)(i * 3), (uint8_t)(i * 7), 
+            31);
+        context.pixels[i * 3 + 0] = (uint16_t)(i * 11);
+        context.pixels[i * 3 + 1] = (uint16_t)(i * 13);
+        context.pixels[i * 3 + 2] = (uint16_t)(i * 17);
+    }
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m)
+    {
+        if (RaspiAPA102CorrectionInit(&context.correction, max_count, 2.2f, modes[m].flags) < 0)
+        {
+            continue;
+        }
+        char name[64];
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            snprintf(name, sizeof(name), "quad8/%s", modes[m].name);
+            RaspiAPA102BenchRun("correction", name, sizes[s], RaspiAPA102BenchCorrectionRun, 
+                &context);
+        }
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            snprintf(name, sizeof(name), "linear16/%s", modes[m].name);
+            RaspiAPA102BenchRun("correction", name, sizes[s], RaspiAPA102BenchCorrectionRun16, 
+                &context);
+        }
+        RaspiAPA102CorrectionDestroy(&context.correction);
+    }
+
+    free(context.quads);
+    free(context.pixels);
+}
+
+/* ============================================================================================== */
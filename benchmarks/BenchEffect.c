@@ -0,0 +1,117 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <RaspiAPA102/Effect.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchEffectContext` struct.
+ */
+typedef struct RaspiAPA102BenchEffectContext_
+{
+    /**
+     * @brief   The effect.
+     */
+    RaspiAPA102Effect effect;
+    /**
+     * @brief   The thread pool.
+     */
+    RaspiAPA102ThreadPool pool;
+    /**
+     * @brief   The canvas.
+     */
+    RaspiAPA102ColorQuad* canvas;
+    /**
+     * @brief   The time of the next frame in nanoseconds.
+     */
+    uint64_t time_ns;
+} RaspiAPA102BenchEffectContext;
+
+static void RaspiAPA102BenchEffectRunSingle(void* context, size_t count)
+{
+    RaspiAPA102BenchEffectContext* c = (RaspiAPA102BenchEffectContext*)context;
+    RaspiAPA102EffectRender(&c->effect, c->canvas, 0, count, c->time_ns);
+    c->time_ns += 16666667;
+}
+
+static void RaspiAPA102BenchEffectRunParallel(void* context, size_t count)
+{
+    RaspiAPA102BenchEffectContext* c = (RaspiAPA102BenchEffectContext*)context;
+    RaspiAPA102EffectRenderParallel(&c->effect, &c->pool, c->canvas, count, c->time_ns);
+    c->time_ns += 16666667;
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchEffect(void)
+{
+    static const char* const names[] = { "rainbow", "chase", "gradient", "noise", "fire" };
+    static const size_t sizes[] = { 1000, 20000 };
+    const size_t max_count = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    RaspiAPA102BenchEffectContext context = { 0 };
+    context.canvas = malloc(max_count * sizeof(RaspiAPA102ColorQuad));
+    if (!context.canvas)
+    {
+        return;
+    }
+    if (RaspiAPA102ThreadPoolInit(&context.pool, 0) < 0)
+    {
+        free(context.canvas);
+        return;
+    }
+    size_t threads;
+    RaspiAPA102ThreadPoolGetThreadCount(&context.pool, &threads);
+
+    for (size_t e = 0; e <= RASPI_APA102_EFFECT_MAX_VALUE; ++e)
+    {
+        RaspiAPA102EffectInit(&context.effect, (RaspiAPA102EffectType)e);
+        RaspiAPA102ColorQuadInit(&context.effect.colors[1], 0, 64, 255, 31);
+
+        char name[32];
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            RaspiAPA102BenchRun("effect", names[e], sizes[s], RaspiAPA102BenchEffectRunSingle, 
+                &context);
+            snprintf(name, sizeof(name), "%s/threads=%zu", names[e], threads);
+            RaspiAPA102BenchRun("effect", name, sizes[s], RaspiAPA102BenchEffectRunParallel, 
+                &context);
+        }
+    }
+
+    RaspiAPA102ThreadPoolDestroy(&context.pool);
+    free(context.canvas);
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,143 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Stats.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchFramingContext` struct.
+ */
+typedef struct RaspiAPA102BenchFramingContext_
+{
+    /**
+     * @brief   The device.
+     */
+    RaspiAPA102Device device;
+    /**
+     * @brief   The source color quads.
+     */
+    RaspiAPA102ColorQuad* quads;
+} RaspiAPA102BenchFramingContext;
+
+static void RaspiAPA102BenchFramingRunUpdate(void* context, size_t count)
+{
+    RaspiAPA102BenchFramingContext* c = (RaspiAPA102BenchFramingContext*)context;
+    RaspiAPA102DeviceUpdate(&c->device, c->quads, count);
+}
+
+static void RaspiAPA102BenchFramingRunCommit(void* context, size_t count)
+{
+    (void)count;
+
+    RaspiAPA102BenchFramingContext* c = (RaspiAPA102BenchFramingContext*)context;
+    RaspiAPA102DeviceCommit(&c->device);
+}
+
+static void RaspiAPA102BenchFramingRunCommitDirty(void* context, size_t count)
+{
+    RaspiAPA102BenchFramingContext* c = (RaspiAPA102BenchFramingContext*)context;
+
+    // Modify the first tenth of the strip, like a short animation at the start of the chain
+    RaspiAPA102DeviceMarkDirty(&c->device, 0, (count + 9) / 10);
+    RaspiAPA102DeviceCommit(&c->device);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchFraming(void)
+{
+    static const size_t sizes[] = RASPI_APA102_BENCH_STRIP_SIZES;
+    const size_t max_count = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    RaspiAPA102BenchFramingContext context;
+    context.quads = malloc(max_count * sizeof(RaspiAPA102ColorQuad));
+    if (!context.quads)
+    {
+        return;
+    }
+    for (size_t i = 0; i < max_count; ++i)
+    {
+        RaspiAPA102ColorQuadInit(&context.quads[i], (uint8_t)i, (uint8_t)(i * 3), 
+            (uint8_t)(i * 7), 31);
+    }
+
+    RaspiAPA102Transport transport;
+    RaspiAPA102BenchGetNullTransport(&transport);
+    if (RaspiAPA102DeviceInitTransport(&context.device, &transport) < 0)
+    {
+        free(context.quads);
+        return;
+    }
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        RaspiAPA102BenchRun("framing", "update", sizes[s], RaspiAPA102BenchFramingRunUpdate, 
+            &context);
+    }
+    if (RaspiAPA102DeviceEnableStats(&context.device, true) == 0)
+    {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            RaspiAPA102BenchRun("framing", "update/stats", sizes[s], 
+                RaspiAPA102BenchFramingRunUpdate, &context);
+        }
+        RaspiAPA102DeviceEnableStats(&context.device, false);
+    }
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        if (RaspiAPA102DeviceAllocateBuffer(&context.device, sizes[s]) < 0)
+        {
+            break;
+        }
+        RaspiAPA102ColorQuad* buffer;
+        RaspiAPA102DeviceGetBuffer(&context.device, &buffer, NULL);
+        for (size_t i = 0; i < sizes[s]; ++i)
+        {
+            buffer[i] = context.quads[i];
+        }
+
+        RaspiAPA102DeviceSetRefreshInterval(&context.device, 0);
+        RaspiAPA102BenchRun("framing", "commit", sizes[s], RaspiAPA102BenchFramingRunCommit, 
+            &context);
+        RaspiAPA102DeviceSetRefreshInterval(&context.device, UINT32_MAX);
+        RaspiAPA102BenchRun("framing", "commit/dirty", sizes[s], 
+            RaspiAPA102BenchFramingRunCommitDirty, &context);
+    }
+
+    RaspiAPA102DeviceDestroy(&context.device);
+    free(context.quads);
+}
+
+/* ============================================================================================== */
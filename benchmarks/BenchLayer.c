@@ -0,0 +1,132 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <RaspiAPA102/LayerStack.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+static void RaspiAPA102BenchLayerRunFull(void* context, size_t count)
+{
+    RaspiAPA102LayerStack* stack = (RaspiAPA102LayerStack*)context;
+    RaspiAPA102LayerStackMarkDirty(stack, 1, 0, count);
+    RaspiAPA102LayerStackCompose(stack, NULL, NULL);
+}
+
+static void RaspiAPA102BenchLayerRunPartial(void* context, size_t count)
+{
+    RaspiAPA102LayerStack* stack = (RaspiAPA102LayerStack*)context;
+
+    // Only the first tenth of the top layer changed, like a short highlight on a static background
+    RaspiAPA102LayerStackMarkDirty(stack, 1, 0, (count + 9) / 10);
+    RaspiAPA102LayerStackCompose(stack, NULL, NULL);
+}
+
+/**
+ * @brief   Initializes a stack with an opaque background and a partially covering top layer.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   count   The number of pixels.
+ * @param   mode    The blend mode of the top layer.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102BenchLayerInit(RaspiAPA102LayerStack* stack, size_t count, 
+    RaspiAPA102BlendMode mode)
+{
+    if (RaspiAPA102LayerStackInit(stack, count, 2, 31) < 0)
+    {
+        return -1;
+    }
+    if ((RaspiAPA102LayerStackAddLayer(stack, RASPI_APA102_BLEND_ALPHA, 255, NULL, NULL, 
+        NULL) < 0) || 
+        (RaspiAPA102LayerStackAddLayer(stack, mode, 200, NULL, NULL, NULL) < 0))
+    {
+        RaspiAPA102LayerStackDestroy(stack);
+        return -1;
+    }
+
+    RaspiAPA102ColorQuad* background;
+    RaspiAPA102ColorQuad* top;
+    RaspiAPA102LayerStackGetPixels(stack, 0, &background);
+    RaspiAPA102LayerStackGetPixels(stack, 1, &top);
+    for (size_t i = 0; i < count; ++i)
+    {
+        RaspiAPA102ColorQuadInit(&background[i], (uint8_t)i, (uint8_t)(i * 3), (uint8_t)(i * 7), 
+            31);
+        RaspiAPA102ColorQuadInit(&top[i], (uint8_t)(i * 5), (uint8_t)(i * 11), (uint8_t)(i * 13), 
+            (uint8_t)i);
+    }
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchLayer(void)
+{
+    static const size_t sizes[] = RASPI_APA102_BENCH_STRIP_SIZES;
+    static const char* const modes[] = { "alpha", "add", "multiply", "max" };
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        for (size_t m = 0; m <= RASPI_APA102_BLEND_MAX_VALUE; ++m)
+        {
+            RaspiAPA102LayerStack stack;
+            if (RaspiAPA102BenchLayerInit(&stack, sizes[s], (RaspiAPA102BlendMode)m) < 0)
+            {
+                return;
+            }
+
+            for (int path = RASPI_APA102_SIMD_SCALAR; path <= RASPI_APA102_SIMD_MAX_VALUE; ++path)
+            {
+                if (RaspiAPA102LayerStackSetPath(&stack, (RaspiAPA102SIMDPath)path) < 0)
+                {
+                    continue;
+                }
+                char name[64];
+                snprintf(name, sizeof(name), "%s/%s", modes[m], 
+                    RaspiAPA102SIMDGetName((RaspiAPA102SIMDPath)path));
+                RaspiAPA102BenchRun("layer", name, sizes[s], RaspiAPA102BenchLayerRunFull, 
+                    &stack);
+            }
+
+            RaspiAPA102LayerStackSetPath(&stack, RASPI_APA102_SIMD_AUTO);
+            char name[64];
+            snprintf(name, sizeof(name), "%s/partial", modes[m]);
+            RaspiAPA102BenchRun("layer", name, sizes[s], RaspiAPA102BenchLayerRunPartial, &stack);
+
+            RaspiAPA102LayerStackDestroy(&stack);
+        }
+    }
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,119 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <RaspiAPA102/Packing.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchPackingContext` struct.
+ */
+typedef struct RaspiAPA102BenchPackingContext_
+{
+    /**
+     * @brief   The packer.
+     */
+    RaspiAPA102Packer packer;
+    /**
+     * @brief   The destination quads.
+     */
+    RaspiAPA102ColorQuad* quads;
+    /**
+     * @brief   The source pixels.
+     */
+    uint8_t* pixels;
+} RaspiAPA102BenchPackingContext;
+
+static void RaspiAPA102BenchPackingRun(void* context, size_t count)
+{
+    RaspiAPA102BenchPackingContext* c = (RaspiAPA102BenchPackingContext*)context;
+    RaspiAPA102PackerPack(&c->packer, c->quads, c->pixels, count);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchPacking(void)
+{
+    static const size_t sizes[] = RASPI_APA102_BENCH_STRIP_SIZES;
+    static const struct
+    {
+        RaspiAPA102PixelFormat format;
+        const char* name;
+    } formats[] =
+    {
+        { RASPI_APA102_PIXEL_FORMAT_RGB , "rgb"  },
+        { RASPI_APA102_PIXEL_FORMAT_GRB , "grb"  },
+        { RASPI_APA102_PIXEL_FORMAT_RGBA, "rgba" }
+    };
+    const size_t max_count = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    RaspiAPA102BenchPackingContext context;
+    context.quads  = malloc(max_count * sizeof(RaspiAPA102ColorQuad));
+    context.pixels = malloc(max_count * 4);
+    if (!context.quads || !context.pixels)
+    {
+        free(context.quads);
+        free(context.pixels);
+        return;
+    }
+    for (size_t i = 0; i < max_count * 4; ++i)
+    {
+        context.pixels[i] = (uint8_t)(i * 7);
+    }
+
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+    {
+        RaspiAPA102PackerInit(&context.packer, formats[f].format, RASPI_APA102_CHANNEL_ORDER_BGR, 
+            31);
+        for (int path = RASPI_APA102_SIMD_SCALAR; path <= RASPI_APA102_SIMD_MAX_VALUE; ++path)
+        {
+            if (RaspiAPA102PackerSetPath(&context.packer, (RaspiAPA102SIMDPath)path) < 0)
+            {
+                continue;
+            }
+            char name[64];
+            snprintf(name, sizeof(name), "%s/%s", formats[f].name, 
+                RaspiAPA102SIMDGetName((RaspiAPA102SIMDPath)path));
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+            {
+                RaspiAPA102BenchRun("packing", name, sizes[s], RaspiAPA102BenchPackingRun, 
+                    &context);
+            }
+        }
+    }
+
+    free(context.quads);
+    free(context.pixels);
+}
+
+/* ============================================================================================== */
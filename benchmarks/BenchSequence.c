@@ -0,0 +1,214 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <RaspiAPA102/Sequence.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+#define RASPI_APA102_BENCH_SEQUENCE_FRAMES 120
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchSequenceContext` struct.
+ */
+typedef struct RaspiAPA102BenchSequenceContext_
+{
+    /**
+     * @brief   The player.
+     */
+    RaspiAPA102SequencePlayer player;
+    /**
+     * @brief   The raw frames.
+     */
+    RaspiAPA102ColorQuad* frames;
+    /**
+     * @brief   The destination buffer.
+     */
+    RaspiAPA102ColorQuad* quads;
+    /**
+     * @brief   The index of the next frame.
+     */
+    uint64_t frame;
+} RaspiAPA102BenchSequenceContext;
+
+static void RaspiAPA102BenchSequenceRunDecode(void* context, size_t count)
+{
+    (void)count;
+
+    RaspiAPA102BenchSequenceContext* c = (RaspiAPA102BenchSequenceContext*)context;
+    RaspiAPA102SequencePlayerDecode(&c->player, c->frame, c->quads);
+    c->frame = (c->frame + 1) % RASPI_APA102_BENCH_SEQUENCE_FRAMES;
+}
+
+static void RaspiAPA102BenchSequenceRunRaw(void* context, size_t count)
+{
+    RaspiAPA102BenchSequenceContext* c = (RaspiAPA102BenchSequenceContext*)context;
+    memcpy(c->quads, &c->frames[c->frame * count], count * sizeof(RaspiAPA102ColorQuad));
+    c->frame = (c->frame + 1) % RASPI_APA102_BENCH_SEQUENCE_FRAMES;
+}
+
+/**
+ * @brief   Renders a frame of the given scene.
+ */
+static void RaspiAPA102BenchSequenceRender(RaspiAPA102ColorQuad* quads, size_t count, 
+    unsigned scene, unsigned frame)
+{
+    switch (scene)
+    {
+    case 0:
+        // Moving rainbow, every LED changes in every frame
+        for (size_t i = 0; i < count; ++i)
+        {
+            const unsigned position = (unsigned)((frame * 6 + i * 768 / count) % 768);
+            const uint8_t value = (uint8_t)(position % 256);
+            switch (position / 256)
+            {
+            case 0:
+                RaspiAPA102ColorQuadInit(&quads[i], 255 - value, value, 0, 31);
+                break;
+            case 1:
+                RaspiAPA102ColorQuadInit(&quads[i], 0, 255 - value, value, 31);
+                break;
+            default:
+                RaspiAPA102ColorQuadInit(&quads[i], value, 0, 255 - value, 31);
+                break;
+            }
+        }
+        break;
+    case 1:
+        // Comet with a short tail chasing over a dim static background
+        for (size_t i = 0; i < count; ++i)
+        {
+            RaspiAPA102ColorQuadInit(&quads[i], 0, 0, 16, 31);
+        }
+        for (size_t i = 0; i < 16; ++i)
+        {
+            const size_t position = (frame * 4 + i) % count;
+            RaspiAPA102ColorQuadInit(&quads[position], (uint8_t)(i * 16), (uint8_t)(i * 16), 255, 
+                31);
+        }
+        break;
+    default:
+        // Uniform fade
+        for (size_t i = 0; i < count; ++i)
+        {
+            RaspiAPA102ColorQuadInit(&quads[i], (uint8_t)(frame * 2), 0, 
+                (uint8_t)(255 - frame * 2), 31);
+        }
+        break;
+    }
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchSequence(void)
+{
+    static const size_t sizes[] = { 144, 4096, 16384 };
+    static const char* scenes[] = { "rainbow", "chase", "fade" };
+
+    char path[] = "/tmp/RaspiAPA102BenchSequenceXXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        return;
+    }
+    close(fd);
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        const size_t count = sizes[s];
+        RaspiAPA102BenchSequenceContext context;
+        context.frames = malloc(RASPI_APA102_BENCH_SEQUENCE_FRAMES * count * 
+            sizeof(RaspiAPA102ColorQuad));
+        context.quads  = malloc(count * sizeof(RaspiAPA102ColorQuad));
+        if (!context.frames || !context.quads)
+        {
+            free(context.frames);
+            free(context.quads);
+            break;
+        }
+
+        for (unsigned scene = 0; scene < sizeof(scenes) / sizeof(scenes[0]); ++scene)
+        {
+            RaspiAPA102SequenceWriter writer;
+            if (RaspiAPA102SequenceWriterOpen(&writer, path, count, 
+                RASPI_APA102_BENCH_SEQUENCE_FRAMES, 
+                RASPI_APA102_SEQUENCE_DEFAULT_KEYFRAME_INTERVAL) < 0)
+            {
+                continue;
+            }
+            for (unsigned frame = 0; frame < RASPI_APA102_BENCH_SEQUENCE_FRAMES; ++frame)
+            {
+                RaspiAPA102ColorQuad* quads = &context.frames[frame * count];
+                RaspiAPA102BenchSequenceRender(quads, count, scene, frame);
+                RaspiAPA102SequenceWriterAppend(&writer, quads);
+            }
+            const uint64_t encoded = writer.offset;
+            if ((RaspiAPA102SequenceWriterClose(&writer) < 0) || 
+                (RaspiAPA102SequencePlayerOpen(&context.player, path) < 0))
+            {
+                continue;
+            }
+
+            // The size comparison goes to `stderr` to keep `stdout` machine readable
+            const uint64_t raw = 
+                (uint64_t)RASPI_APA102_BENCH_SEQUENCE_FRAMES * count * sizeof(RaspiAPA102ColorQuad);
+            fprintf(stderr, "sequence: %s/%zu: %llu bytes raw, %llu bytes encoded (%.1f%%)\n", 
+                scenes[scene], count, (unsigned long long)raw, (unsigned long long)encoded, 
+                100.0 * encoded / raw);
+
+            char name[64];
+            snprintf(name, sizeof(name), "decode/%s", scenes[scene]);
+            context.frame = 0;
+            RaspiAPA102BenchRun("sequence", name, count, RaspiAPA102BenchSequenceRunDecode, 
+                &context);
+            snprintf(name, sizeof(name), "raw/%s", scenes[scene]);
+            context.frame = 0;
+            RaspiAPA102BenchRun("sequence", name, count, RaspiAPA102BenchSequenceRunRaw, 
+                &context);
+            RaspiAPA102SequencePlayerClose(&context.player);
+        }
+
+        free(context.frames);
+        free(context.quads);
+    }
+
+    unlink(path);
+}
+
+/* ============================================================================================== */
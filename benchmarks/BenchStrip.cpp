@@ -0,0 +1,164 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Strip.hpp>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+namespace
+{
+
+/**
+ * @brief   The strip sizes (compile-time copy of `RASPI_APA102_BENCH_STRIP_SIZES`).
+ */
+constexpr std::size_t RASPI_APA102_BENCH_STRIP_SIZE_TABLE[] = RASPI_APA102_BENCH_STRIP_SIZES;
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchStripContext` struct.
+ */
+template <std::size_t N>
+struct RaspiAPA102BenchStripContext
+{
+    /**
+     * @brief   The device.
+     */
+    RaspiAPA102Device device;
+    /**
+     * @brief   The strip.
+     */
+    RaspiAPA102::Strip<N> strip;
+    /**
+     * @brief   The frame counter, so that every call writes different colors.
+     */
+    std::uint8_t frame;
+};
+
+template <std::size_t N>
+void RaspiAPA102BenchStripRunSetColor(void* context, std::size_t count)
+{
+    auto* c = static_cast<RaspiAPA102BenchStripContext<N>*>(context);
+    const std::uint8_t frame = c->frame++;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        RaspiAPA102ColorQuad color;
+        RaspiAPA102ColorQuadInit(&color, static_cast<std::uint8_t>(i + frame), 
+            static_cast<std::uint8_t>(i * 3), static_cast<std::uint8_t>(i * 7), 31);
+        RaspiAPA102DeviceSetColor(&c->device, i, color);
+    }
+    RaspiAPA102DeviceCommit(&c->device);
+}
+
+template <std::size_t N>
+void RaspiAPA102BenchStripRunInPlace(void* context, std::size_t count)
+{
+    auto* c = static_cast<RaspiAPA102BenchStripContext<N>*>(context);
+    const std::uint8_t frame = c->frame++;
+
+    RaspiAPA102ColorQuad* colors;
+    RaspiAPA102DeviceGetBuffer(&c->device, &colors, nullptr);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        RaspiAPA102ColorQuadInit(&colors[i], static_cast<std::uint8_t>(i + frame), 
+            static_cast<std::uint8_t>(i * 3), static_cast<std::uint8_t>(i * 7), 31);
+    }
+    RaspiAPA102DeviceCommit(&c->device);
+}
+
+template <std::size_t N>
+void RaspiAPA102BenchStripRunStrip(void* context, std::size_t count)
+{
+    (void)count;
+
+    auto* c = static_cast<RaspiAPA102BenchStripContext<N>*>(context);
+    const std::uint8_t frame = c->frame++;
+
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        c->strip.Set(i, static_cast<std::uint8_t>(i + frame), static_cast<std::uint8_t>(i * 3), 
+            static_cast<std::uint8_t>(i * 7));
+    }
+    c->strip.Commit();
+}
+
+template <std::size_t N>
+void RaspiAPA102BenchStripRunSize(const RaspiAPA102Transport& transport)
+{
+    // The strip embeds the framed buffer, which is too large for the stack
+    auto context = std::make_unique<RaspiAPA102BenchStripContext<N>>();
+    if (RaspiAPA102DeviceInitTransport(&context->device, &transport) < 0)
+    {
+        return;
+    }
+
+    if (RaspiAPA102DeviceAllocateBuffer(&context->device, N) == 0)
+    {
+        RaspiAPA102BenchRun("strip", "c/setcolor", N, RaspiAPA102BenchStripRunSetColor<N>, 
+            context.get());
+        RaspiAPA102BenchRun("strip", "c/inplace", N, RaspiAPA102BenchStripRunInPlace<N>, 
+            context.get());
+    }
+    if (context->strip.Attach(context->device) == 0)
+    {
+        RaspiAPA102BenchRun("strip", "cpp/set", N, RaspiAPA102BenchStripRunStrip<N>, 
+            context.get());
+        context->strip.Detach();
+    }
+
+    RaspiAPA102DeviceDestroy(&context->device);
+}
+
+template <std::size_t... I>
+void RaspiAPA102BenchStripRunSizes(const RaspiAPA102Transport& transport, 
+    std::index_sequence<I...>)
+{
+    (RaspiAPA102BenchStripRunSize<RASPI_APA102_BENCH_STRIP_SIZE_TABLE[I]>(transport), ...);
+}
+
+} // namespace
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchStrip(void)
+{
+    RaspiAPA102Transport transport;
+    RaspiAPA102BenchGetNullTransport(&transport);
+
+    constexpr std::size_t count = 
+        sizeof(RASPI_APA102_BENCH_STRIP_SIZE_TABLE) / sizeof(RASPI_APA102_BENCH_STRIP_SIZE_TABLE[0]);
+    RaspiAPA102BenchStripRunSizes(transport, std::make_index_sequence<count>());
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,177 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/SoftSPI.h>
+#include "Bench.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The requested clock frequency of the software transports.
+ *
+ * The registers are plain memory, so the clock is only limited by the register writes.
+ */
+#define RASPI_APA102_BENCH_TRANSPORT_CLOCK UINT32_MAX
+
+/**
+ * @brief   The number of lanes of the multi-lane transport.
+ */
+#define RASPI_APA102_BENCH_TRANSPORT_LANES 4
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BenchTransportContext` struct.
+ */
+typedef struct RaspiAPA102BenchTransportContext_
+{
+    /**
+     * @brief   The device.
+     */
+    RaspiAPA102Device device;
+    /**
+     * @brief   The multi-lane transport.
+     */
+    RaspiAPA102MultiLaneSPI multi_lane;
+    /**
+     * @brief   The source color quads.
+     */
+    RaspiAPA102ColorQuad* quads;
+} RaspiAPA102BenchTransportContext;
+
+static void RaspiAPA102BenchTransportRunDevice(void* context, size_t count)
+{
+    RaspiAPA102BenchTransportContext* c = (RaspiAPA102BenchTransportContext*)context;
+    RaspiAPA102DeviceUpdate(&c->device, c->quads, count);
+}
+
+static void RaspiAPA102BenchTransportRunMultiLane(void* context, size_t count)
+{
+    RaspiAPA102BenchTransportContext* c = (RaspiAPA102BenchTransportContext*)context;
+
+    const RaspiAPA102ColorQuad* colors[RASPI_APA102_BENCH_TRANSPORT_LANES];
+    size_t counts[RASPI_APA102_BENCH_TRANSPORT_LANES];
+    for (size_t i = 0; i < RASPI_APA102_BENCH_TRANSPORT_LANES; ++i)
+    {
+        colors[i] = c->quads;
+        counts[i] = count;
+    }
+    RaspiAPA102MultiLaneSPIUpdate(&c->multi_lane, colors, counts);
+}
+
+/**
+ * @brief   Measures `RaspiAPA102DeviceUpdate` with the given transport for all strip sizes.
+ *
+ * @param   context     A pointer to the `RaspiAPA102BenchTransportContext` struct.
+ * @param   name        The name of the benchmark case.
+ * @param   transport   A pointer to the `RaspiAPA102Transport` struct.
+ */
+static void RaspiAPA102BenchTransportRun(RaspiAPA102BenchTransportContext* context, 
+    const char* name, const RaspiAPA102Transport* transport)
+{
+    static const size_t sizes[] = RASPI_APA102_BENCH_STRIP_SIZES;
+
+    if (RaspiAPA102DeviceInitTransport(&context->device, transport) < 0)
+    {
+        return;
+    }
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        RaspiAPA102BenchRun("transport", name, sizes[s], RaspiAPA102BenchTransportRunDevice, 
+            context);
+    }
+    RaspiAPA102DeviceDestroy(&context->device);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102BenchTransport(void)
+{
+    static const size_t sizes[] = RASPI_APA102_BENCH_STRIP_SIZES;
+    const size_t max_count = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    RaspiAPA102BenchTransportContext context;
+    context.quads = malloc(max_count * sizeof(RaspiAPA102ColorQuad));
+    if (!context.quads)
+    {
+        return;
+    }
+    for (size_t i = 0; i < max_count; ++i)
+    {
+        RaspiAPA102ColorQuadInit(&context.quads[i], (uint8_t)i, (uint8_t)(i * 3), 
+            (uint8_t)(i * 7), 31);
+    }
+
+    // The `GPIO` registers are replaced by plain memory, so the software transports run without
+    // `wiringPi` or hardware access
+    static uint32_t registers[RASPI_APA102_GPIO_REGISTER_COUNT];
+    RaspiAPA102Transport transport;
+
+    RaspiAPA102BenchGetNullTransport(&transport);
+    RaspiAPA102BenchTransportRun(&context, "null", &transport);
+
+    RaspiAPA102Capture capture;
+    if (RaspiAPA102CaptureInit(&capture, false) == 0)
+    {
+        RaspiAPA102CaptureGetTransport(&capture, &transport);
+        RaspiAPA102BenchTransportRun(&context, "capture", &transport);
+        RaspiAPA102CaptureDestroy(&capture);
+    }
+
+    RaspiAPA102SoftSPI spi;
+    if (RaspiAPA102SoftSPIInit(&spi, registers, 11, 10, -1, 
+        RASPI_APA102_BENCH_TRANSPORT_CLOCK) == 0)
+    {
+        RaspiAPA102SoftSPIGetTransport(&spi, &transport);
+        RaspiAPA102BenchTransportRun(&context, "softspi", &transport);
+        RaspiAPA102SoftSPIDestroy(&spi);
+    }
+
+    // Every lane receives `count` LEDs
+    static const int pins_mosi[RASPI_APA102_BENCH_TRANSPORT_LANES] = { 10, 12, 13, 16 };
+    if (RaspiAPA102MultiLaneSPIInit(&context.multi_lane, registers, 11, pins_mosi, 
+        RASPI_APA102_BENCH_TRANSPORT_LANES, RASPI_APA102_BENCH_TRANSPORT_CLOCK) == 0)
+    {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            RaspiAPA102BenchRun("transport", "multilane/4", sizes[s], 
+                RaspiAPA102BenchTransportRunMultiLane, &context);
+        }
+        RaspiAPA102MultiLaneSPIDestroy(&context.multi_lane);
+    }
+
+    free(context.quads);
+}
+
+/* ============================================================================================== */
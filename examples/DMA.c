@@ -0,0 +1,122 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/DMA.h>
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The default `SPI` clock frequency in Hz.
+ */
+#define RASPI_APA102_DMA_SPEED 8000000
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+static uint64_t Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void Render(RaspiAPA102ColorQuad* quads, size_t count, unsigned frame)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const unsigned position = (unsigned)(i * 256 / count + frame * 8) & 0xFF;
+        RaspiAPA102ColorQuadInit(&quads[i], (uint8_t)position, (uint8_t)(255 - position),
+            (uint8_t)(position * 3), 31);
+    }
+}
+
+/**
+ * @brief   Streams a rainbow to real hardware and reports the CPU time per frame.
+ */
+static int Stream(size_t count, uint32_t speed_hz)
+{
+    RaspiAPA102Device device;
+    if (RaspiAPA102DeviceInitDMA(&device, speed_hz, count) < 0)
+    {
+        fprintf(stderr, "Could not initialize the DMA engine (root required)\n");
+        return 1;
+    }
+    RaspiAPA102ColorQuad* quads = malloc(count * sizeof(RaspiAPA102ColorQuad));
+    if (!quads)
+    {
+        return 1;
+    }
+
+    const unsigned frames = 1000;
+    const uint64_t start = Now();
+    const clock_t cpu = clock();
+    for (unsigned frame = 0; frame < frames; ++frame)
+    {
+        Render(quads, count, frame);
+        if (RaspiAPA102DeviceUpdate(&device, quads, count) < 0)
+        {
+            fprintf(stderr, "Update failed\n");
+            break;
+        }
+    }
+    RaspiAPA102DeviceDestroy(&device);
+    const double elapsed = (double)(Now() - start) / 1e9;
+    const double cpu_time = (double)(clock() - cpu) / CLOCKS_PER_SEC;
+
+    printf("%u frames in %.2f s (%.1f fps), %.1f us CPU time per frame\n", frames, elapsed,
+        frames / elapsed, cpu_time * 1e6 / frames);
+    free(quads);
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Entry Point                                                                                    */
+/* ============================================================================================== */
+
+int main(int argc, char** argv)
+{
+    const size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000;
+    const uint32_t speed_hz = 
+        (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : RASPI_APA102_DMA_SPEED;
+    if (!count || !speed_hz)
+    {
+        fprintf(stderr, "Usage: %s [count] [speed in Hz]\n", argv[0]);
+        return 1;
+    }
+
+    return Stream(count, speed_hz);
+}
+
+/* ============================================================================================== */
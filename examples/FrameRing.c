@@ -0,0 +1,233 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/ColorConversion.h>
+#include <RaspiAPA102/FrameRing.h>
+#include <RaspiAPA102/Transport.h>
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+#define RASPI_APA102_FRAME_RING_SLOTS 4
+#define RASPI_APA102_POLL_INTERVAL_NS 100000
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+static uint64_t Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void SleepUntil(uint64_t deadline)
+{
+    const struct timespec abstime =
+    {
+        .tv_sec  = (time_t)(deadline / 1000000000ULL),
+        .tv_nsec = (long)(deadline % 1000000000ULL)
+    };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &abstime, NULL);
+}
+
+static int CompareLatency(const void* a, const void* b)
+{
+    const uint64_t x = *(const uint64_t*)a;
+    const uint64_t y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief   Publishes a moving rainbow to an existing frame ring.
+ */
+static int Produce(const char* name, unsigned fps, unsigned frames)
+{
+    RaspiAPA102FrameRing ring;
+    if (RaspiAPA102FrameRingOpen(&ring, name) < 0)
+    {
+        fprintf(stderr, "Could not open frame ring '%s'\n", name);
+        return 1;
+    }
+
+    size_t count;
+    RaspiAPA102ColorQuad* quads;
+    RaspiAPA102FrameRingBeginWrite(&ring, &quads, &count);
+    uint16_t* hue = malloc(count * sizeof(uint16_t));
+    uint8_t* saturation = malloc(count);
+    uint8_t* value = malloc(count);
+    if (!hue || !saturation || !value)
+    {
+        return 1;
+    }
+    memset(saturation, 255, count);
+    memset(value, 255, count);
+
+    unsigned dropped = 0;
+    const uint64_t interval = 1000000000ULL / fps;
+    const uint64_t start = Now();
+    for (unsigned frame = 0; frame < frames; ++frame)
+    {
+        SleepUntil(start + frame * interval);
+
+        RaspiAPA102FrameRingBeginWrite(&ring, &quads, NULL);
+        if (!quads)
+        {
+            // The consumer is behind
+            ++dropped;
+            continue;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            hue[i] = (uint16_t)(frame * 512 + i * 65536 / count);
+        }
+        RaspiAPA102HSVFixed2ColorQuadBatch(quads, hue, saturation, value, count, 31);
+        RaspiAPA102FrameRingPublish(&ring);
+    }
+    printf("Published %u frames (%u dropped)\n", frames - dropped, dropped);
+
+    free(hue);
+    free(saturation);
+    free(value);
+    RaspiAPA102FrameRingDestroy(&ring);
+
+    return 0;
+}
+
+/**
+ * @brief   Creates a frame ring, sends every new frame to the device and prints the latency from
+ *          publishing a frame until it was on the wire.
+ */
+static int Consume(const char* name, size_t count, unsigned frames, const char* spidev)
+{
+    RaspiAPA102Device device;
+    RaspiAPA102Capture capture;
+    if (spidev)
+    {
+        if (RaspiAPA102DeviceInitSPIDev(&device, spidev, RASPI_APA102_SPI_DEFAULT_SPEED) < 0)
+        {
+            fprintf(stderr, "Could not open '%s'\n", spidev);
+            return 1;
+        }
+    }
+    else
+    {
+        // Headless: capture the byte stream instead of sending it
+        RaspiAPA102Transport transport;
+        RaspiAPA102CaptureInit(&capture, false);
+        RaspiAPA102CaptureGetTransport(&capture, &transport);
+        RaspiAPA102DeviceInitTransport(&device, &transport);
+    }
+
+    RaspiAPA102FrameRing ring;
+    if (RaspiAPA102FrameRingCreate(&ring, name, count, RASPI_APA102_FRAME_RING_SLOTS) < 0)
+    {
+        fprintf(stderr, "Could not create frame ring '%s'\n", name);
+        return 1;
+    }
+    printf("Waiting for %u frames on '%s'\n", frames, name);
+
+    uint64_t* latency = malloc(frames * sizeof(uint64_t));
+    if (!latency)
+    {
+        return 1;
+    }
+    unsigned received = 0;
+    while (received < frames)
+    {
+        bool updated;
+        if (RaspiAPA102FrameRingUpdateDevice(&ring, &device, &updated, &latency[received]) < 0)
+        {
+            break;
+        }
+        if (updated)
+        {
+            ++received;
+        }
+        else
+        {
+            SleepUntil(Now() + RASPI_APA102_POLL_INTERVAL_NS);
+        }
+    }
+
+    if (received)
+    {
+        qsort(latency, received, sizeof(uint64_t), CompareLatency);
+        uint64_t sum = 0;
+        for (unsigned i = 0; i < received; ++i)
+        {
+            sum += latency[i];
+        }
+        printf("Publish to wire latency over %u frames (us): min %.1f, avg %.1f, p50 %.1f, "
+            "p99 %.1f, max %.1f\n", received, latency[0] / 1e3, (double)sum / received / 1e3, 
+            latency[received / 2] / 1e3, latency[received * 99 / 100] / 1e3, 
+            latency[received - 1] / 1e3);
+    }
+
+    free(latency);
+    RaspiAPA102FrameRingDestroy(&ring);
+    RaspiAPA102DeviceDestroy(&device);
+    if (!spidev)
+    {
+        RaspiAPA102CaptureDestroy(&capture);
+    }
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Entry Point                                                                                    */
+/* ============================================================================================== */
+
+int main(int argc, char** argv)
+{
+    if ((argc >= 5) && !strcmp(argv[1], "produce"))
+    {
+        return Produce(argv[2], (unsigned)atoi(argv[3]), (unsigned)atoi(argv[4]));
+    }
+    if ((argc >= 5) && !strcmp(argv[1], "consume"))
+    {
+        return Consume(argv[2], (size_t)atol(argv[3]), (unsigned)atoi(argv[4]), 
+            (argc >= 6) ? argv[5] : NULL);
+    }
+
+    fprintf(stderr, 
+        "Usage: %s consume <name> <count> <frames> [spidev]\n"
+        "       %s produce <name> <fps> <frames>\n", argv[0], argv[0]);
+
+    return 1;
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,177 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/AsyncOutput.h>
+#include <RaspiAPA102/Stats.h>
+#include <RaspiAPA102/Transport.h>
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+#define RASPI_APA102_REALTIME_FPS 200
+#define RASPI_APA102_REALTIME_PRIORITY 80
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+static void Sleep(uint64_t duration)
+{
+    const struct timespec time =
+    {
+        .tv_sec  = (time_t)(duration / 1000000000ULL),
+        .tv_nsec = (long)(duration % 1000000000ULL)
+    };
+    nanosleep(&time, NULL);
+}
+
+static void PrintHistogram(const char* name, const RaspiAPA102StatsHistogram* histogram)
+{
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    double deviation = 0.0;
+    RaspiAPA102StatsGetPercentile(histogram, 50.0, &p50);
+    RaspiAPA102StatsGetPercentile(histogram, 99.0, &p99);
+    RaspiAPA102StatsGetPercentile(histogram, 99.9, &p999);
+    RaspiAPA102StatsGetDeviation(histogram, &deviation);
+    printf("  %-9s (us): p50 %.1f, p99 %.1f, p99.9 %.1f, max %.1f, stddev %.1f\n", name, 
+        p50 / 1e3, p99 / 1e3, p999 / 1e3, histogram->count ? histogram->max / 1e3 : 0.0, 
+        deviation / 1e3);
+}
+
+/**
+ * @brief   Streams frames through an asynchronous output for the given duration and prints the 
+ *          jitter statistics.
+ */
+static int Run(RaspiAPA102Device* device, size_t count, unsigned seconds, 
+    const RaspiAPA102AsyncOutputRealtime* realtime)
+{
+    RaspiAPA102AsyncOutput output;
+    if (RaspiAPA102AsyncOutputInitEx(&output, device, count, RASPI_APA102_REALTIME_FPS, 
+        realtime) < 0)
+    {
+        fprintf(stderr, "Could not start the output thread\n");
+        return 1;
+    }
+
+    uint32_t flags = 0;
+    RaspiAPA102AsyncOutputGetRealtime(&output, &flags);
+    printf("%s mode (SCHED_FIFO %s, affinity %s, mlock %s):\n", 
+        realtime ? "Real-time" : "Default", 
+        (flags & RASPI_APA102_REALTIME_SCHEDULING) ? "yes" : "no", 
+        (flags & RASPI_APA102_REALTIME_AFFINITY) ? "yes" : "no", 
+        (flags & RASPI_APA102_REALTIME_LOCKED) ? "yes" : "no");
+
+    const unsigned frames = seconds * RASPI_APA102_REALTIME_FPS;
+    for (unsigned frame = 0; frame < frames; ++frame)
+    {
+        RaspiAPA102ColorQuad* quads;
+        RaspiAPA102AsyncOutputGetBackBuffer(&output, &quads, NULL);
+        for (size_t i = 0; i < count; ++i)
+        {
+            RaspiAPA102ColorQuadInit(&quads[i], (uint8_t)(frame + i), (uint8_t)(frame * 3), 
+                (uint8_t)i, 31);
+        }
+        RaspiAPA102AsyncOutputSwap(&output, NULL);
+        Sleep(1000000000ULL / RASPI_APA102_REALTIME_FPS);
+    }
+
+    RaspiAPA102AsyncOutputJitter jitter;
+    RaspiAPA102AsyncOutputGetJitter(&output, &jitter, false);
+    PrintHistogram("wake-up", &jitter.wakeup);
+    PrintHistogram("transfer", &jitter.transfer);
+    printf("  missed deadlines: %llu\n", (unsigned long long)jitter.deadlines_missed);
+
+    RaspiAPA102AsyncOutputDestroy(&output);
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Entry Point                                                                                    */
+/* ============================================================================================== */
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <count> [seconds] [cpu] [spidev]\n", argv[0]);
+        return 1;
+    }
+    const size_t count = strtoul(argv[1], NULL, 10);
+    const unsigned seconds = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 5;
+    const int cpu = (argc > 3) ? atoi(argv[3]) : -1;
+    const char* spidev = (argc > 4) ? argv[4] : NULL;
+
+    RaspiAPA102Device device;
+    RaspiAPA102Capture capture;
+    if (spidev)
+    {
+        if (RaspiAPA102DeviceInitSPIDev(&device, spidev, RASPI_APA102_SPI_DEFAULT_SPEED) < 0)
+        {
+            fprintf(stderr, "Could not open '%s'\n", spidev);
+            return 1;
+        }
+    }
+    else
+    {
+        // Headless: capture the byte stream instead of sending it
+        RaspiAPA102Transport transport;
+        RaspiAPA102CaptureInit(&capture, false);
+        RaspiAPA102CaptureGetTransport(&capture, &transport);
+        RaspiAPA102DeviceInitTransport(&device, &transport);
+    }
+
+    // Run the same load twice to compare the jitter
+    const RaspiAPA102AsyncOutputRealtime realtime = 
+    {
+        .priority    = RASPI_APA102_REALTIME_PRIORITY,
+        .cpu         = cpu,
+        .lock_memory = true
+    };
+    int status = Run(&device, count, seconds, NULL);
+    if (status == 0)
+    {
+        status = Run(&device, count, seconds, &realtime);
+    }
+
+    RaspiAPA102DeviceDestroy(&device);
+    if (!spidev)
+    {
+        RaspiAPA102CaptureDestroy(&capture);
+    }
+
+    return status;
+}
+
+/* ============================================================================================== */
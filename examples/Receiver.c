@@ -0,0 +1,419 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Receiver.h>
+#include <RaspiAPA102/Transport.h>
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+#define RASPI_APA102_PIXELS_PER_UNIVERSE RASPI_APA102_RECEIVER_DEFAULT_PIXELS_PER_UNIVERSE
+#define RASPI_APA102_MAX_PACKETS 1024
+#define RASPI_APA102_PACKET_SIZE 640
+#define RASPI_APA102_IDLE_TIMEOUT_MS 5000
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+static uint64_t Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void SleepUntil(uint64_t deadline)
+{
+    const struct timespec abstime =
+    {
+        .tv_sec  = (time_t)(deadline / 1000000000ULL),
+        .tv_nsec = (long)(deadline % 1000000000ULL)
+    };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &abstime, NULL);
+}
+
+static void Write16(uint8_t* data, uint16_t value)
+{
+    data[0] = (uint8_t)(value >> 8);
+    data[1] = (uint8_t)value;
+}
+
+static void Write32(uint8_t* data, uint32_t value)
+{
+    Write16(&data[0], (uint16_t)(value >> 16));
+    Write16(&data[2], (uint16_t)value);
+}
+
+/**
+ * @brief   Writes the `E1.31` root layer and returns the offset of the framing layer.
+ */
+static size_t WriteE131Root(uint8_t* packet, size_t size, uint32_t vector)
+{
+    static const uint8_t id[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+    static const uint8_t cid[16] = { 'R', 'a', 's', 'p', 'i', 'A', 'P', 'A', '1', '0', '2' };
+
+    memset(packet, 0, size);
+    Write16(&packet[0], 0x0010);
+    memcpy(&packet[4], id, sizeof(id));
+    Write16(&packet[16], (uint16_t)(0x7000 | (size - 16)));
+    Write32(&packet[18], vector);
+    memcpy(&packet[22], cid, sizeof(cid));
+    Write16(&packet[38], (uint16_t)(0x7000 | (size - 38)));
+
+    return 38;
+}
+
+/**
+ * @brief   Builds a data packet and returns its size.
+ */
+static size_t BuildData(uint8_t* packet, bool e131, uint16_t universe, uint8_t sequence, 
+    const uint8_t* data, size_t size, bool sync)
+{
+    if (!e131)
+    {
+        static const uint8_t id[8] = { 'A', 'r', 't', '-', 'N', 'e', 't', 0 };
+        memcpy(packet, id, sizeof(id));
+        packet[8]  = 0x00;
+        packet[9]  = 0x50;
+        packet[10] = 0;
+        packet[11] = 14;
+        packet[12] = sequence;
+        packet[13] = 0;
+        packet[14] = (uint8_t)universe;
+        packet[15] = (uint8_t)((universe >> 8) & 0x7F);
+        Write16(&packet[16], (uint16_t)size);
+        memcpy(&packet[18], data, size);
+
+        return 18 + size;
+    }
+
+    const size_t total = 126 + size;
+    WriteE131Root(packet, total, 0x00000004);
+    Write32(&packet[40], 0x00000002);
+    strcpy((char*)&packet[44], "RaspiAPA102 sender");
+    packet[108] = 100;
+    Write16(&packet[109], sync ? 1 : 0);
+    packet[111] = sequence;
+    packet[112] = 0;
+    Write16(&packet[113], universe);
+    Write16(&packet[115], (uint16_t)(0x7000 | (total - 115)));
+    packet[117] = 0x02;
+    packet[118] = 0xA1;
+    Write16(&packet[119], 0);
+    Write16(&packet[121], 1);
+    Write16(&packet[123], (uint16_t)(size + 1));
+    packet[125] = 0;
+    memcpy(&packet[126], data, size);
+
+    return total;
+}
+
+/**
+ * @brief   Builds a synchronization packet and returns its size.
+ */
+static size_t BuildSync(uint8_t* packet, bool e131, uint8_t sequence)
+{
+    if (!e131)
+    {
+        static const uint8_t header[14] = 
+            { 'A', 'r', 't', '-', 'N', 'e', 't', 0, 0x00, 0x52, 0, 14, 0, 0 };
+        memcpy(packet, header, sizeof(header));
+
+        return sizeof(header);
+    }
+
+    WriteE131Root(packet, 49, 0x00000008);
+    Write32(&packet[40], 0x00000001);
+    packet[44] = sequence;
+    Write16(&packet[45], 1);
+
+    return 49;
+}
+
+/**
+ * @brief   Opens a socket connected to the given target (`udp:<port>` or `unix:<path>`).
+ */
+static int Connect(const char* target)
+{
+    if (!strncmp(target, "udp:", 4))
+    {
+        struct sockaddr_in remote = { 0 };
+        remote.sin_family = AF_INET;
+        remote.sin_port = htons((uint16_t)atoi(&target[4]));
+        remote.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if ((fd >= 0) && (connect(fd, (const struct sockaddr*)&remote, sizeof(remote)) < 0))
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    if (!strncmp(target, "unix:", 5))
+    {
+        struct sockaddr_un remote = { 0 };
+        remote.sun_family = AF_UNIX;
+        strncpy(remote.sun_path, &target[5], sizeof(remote.sun_path) - 1);
+        const int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if ((fd >= 0) && (connect(fd, (const struct sockaddr*)&remote, sizeof(remote)) < 0))
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief   Sends a moving rainbow as packetised universes.
+ */
+static int Send(const char* protocol, const char* target, size_t count, unsigned fps, 
+    unsigned frames, bool sync)
+{
+    const bool e131 = !strcmp(protocol, "e131");
+    const size_t universes = 
+        (count + RASPI_APA102_PIXELS_PER_UNIVERSE - 1) / RASPI_APA102_PIXELS_PER_UNIVERSE;
+    if (universes + 1 > RASPI_APA102_MAX_PACKETS)
+    {
+        fprintf(stderr, "Too many universes\n");
+        return 1;
+    }
+    const int fd = Connect(target);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Could not connect to '%s'\n", target);
+        return 1;
+    }
+
+    uint8_t* packets = malloc(RASPI_APA102_MAX_PACKETS * RASPI_APA102_PACKET_SIZE);
+    uint8_t* pixels = malloc(count * 3);
+    struct mmsghdr* messages = calloc(RASPI_APA102_MAX_PACKETS, sizeof(struct mmsghdr));
+    struct iovec* vectors = calloc(RASPI_APA102_MAX_PACKETS, sizeof(struct iovec));
+    if (!packets || !pixels || !messages || !vectors)
+    {
+        return 1;
+    }
+
+    uint64_t sent = 0;
+    const uint64_t interval = 1000000000ULL / fps;
+    const uint64_t start = Now();
+    for (unsigned frame = 0; frame < frames; ++frame)
+    {
+        SleepUntil(start + frame * interval);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const unsigned position = (unsigned)((frame * 4 + i * 768 / count) % 768);
+            const uint8_t value = (uint8_t)(position % 256);
+            const uint8_t rgb[3][3] = 
+                { { 255 - value, value, 0 }, { 0, 255 - value, value }, { value, 0, 255 - value } };
+            memcpy(&pixels[i * 3], rgb[position / 256], 3);
+        }
+
+        // All universes of a frame (and the synchronization packet) go out in a single call
+        size_t packet_count = 0;
+        for (size_t u = 0; u < universes; ++u, ++packet_count)
+        {
+            const size_t first = u * RASPI_APA102_PIXELS_PER_UNIVERSE;
+            const size_t length = (count - first < RASPI_APA102_PIXELS_PER_UNIVERSE) ? 
+                count - first : RASPI_APA102_PIXELS_PER_UNIVERSE;
+            vectors[u].iov_base = &packets[u * RASPI_APA102_PACKET_SIZE];
+            vectors[u].iov_len = BuildData(vectors[u].iov_base, e131, (uint16_t)(1 + u), 
+                (uint8_t)(frame + 1), &pixels[first * 3], length * 3, sync);
+        }
+        if (sync)
+        {
+            vectors[packet_count].iov_base = &packets[packet_count * RASPI_APA102_PACKET_SIZE];
+            vectors[packet_count].iov_len = 
+                BuildSync(vectors[packet_count].iov_base, e131, (uint8_t)(frame + 1));
+            ++packet_count;
+        }
+        for (size_t i = 0; i < packet_count; ++i)
+        {
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        size_t offset = 0;
+        while (offset < packet_count)
+        {
+            const int result = sendmmsg(fd, &messages[offset], (unsigned)(packet_count - offset), 
+                0);
+            if (result < 0)
+            {
+                fprintf(stderr, "Could not send frame %u\n", frame);
+                return 1;
+            }
+            offset += (size_t)result;
+        }
+        sent += packet_count;
+    }
+    const double seconds = (Now() - start) / 1e9;
+    printf("Sent %u frames, %llu packets (%.0f packets/s)\n", frames, (unsigned long long)sent, 
+        sent / seconds);
+
+    free(packets);
+    free(pixels);
+    free(messages);
+    free(vectors);
+    close(fd);
+
+    return 0;
+}
+
+/**
+ * @brief   Receives packetised universes and prints the throughput and latency.
+ */
+static int Receive(const char* source, size_t count, unsigned frames, const char* spidev)
+{
+    RaspiAPA102Device device;
+    RaspiAPA102Capture capture;
+    if (spidev)
+    {
+        if (RaspiAPA102DeviceInitSPIDev(&device, spidev, RASPI_APA102_SPI_DEFAULT_SPEED) < 0)
+        {
+            fprintf(stderr, "Could not open '%s'\n", spidev);
+            return 1;
+        }
+    }
+    else
+    {
+        // Headless: capture the byte stream instead of sending it
+        RaspiAPA102Transport transport;
+        RaspiAPA102CaptureInit(&capture, false);
+        RaspiAPA102CaptureGetTransport(&capture, &transport);
+        RaspiAPA102DeviceInitTransport(&device, &transport);
+    }
+    if (RaspiAPA102DeviceAllocateBuffer(&device, count) < 0)
+    {
+        return 1;
+    }
+
+    RaspiAPA102Receiver receiver;
+    int status = -1;
+    if (!strncmp(source, "udp:", 4))
+    {
+        status = RaspiAPA102ReceiverInitUDP(&receiver, &device, NULL, 
+            (uint16_t)atoi(&source[4]));
+    }
+    else if (!strncmp(source, "unix:", 5))
+    {
+        status = RaspiAPA102ReceiverInitUnix(&receiver, &device, &source[5]);
+    }
+    if (status < 0)
+    {
+        fprintf(stderr, "Could not listen on '%s'\n", source);
+        return 1;
+    }
+    printf("Waiting for %u frames on '%s'\n", frames, source);
+
+    RaspiAPA102ReceiverStats stats = { 0 };
+    uint64_t first = 0;
+    uint64_t last = 0;
+    while (stats.frames < frames)
+    {
+        size_t received;
+        if (RaspiAPA102ReceiverPoll(&receiver, first ? RASPI_APA102_IDLE_TIMEOUT_MS : -1, 
+            &received) < 0)
+        {
+            break;
+        }
+        const uint64_t packets = stats.packets;
+        RaspiAPA102ReceiverGetStats(&receiver, &stats);
+        if (stats.packets == packets)
+        {
+            // The sender stopped
+            break;
+        }
+        last = Now();
+        first = first ? first : last;
+    }
+
+    const double seconds = (last - first) / 1e9;
+    printf("Received %llu packets in %llu batches (%.0f packets/s), %llu frames, %llu syncs, "
+        "%llu invalid, %llu ignored, %llu sequence errors\n", 
+        (unsigned long long)stats.packets, (unsigned long long)stats.batches, 
+        (seconds > 0) ? stats.packets / seconds : 0.0, (unsigned long long)stats.frames, 
+        (unsigned long long)stats.syncs, (unsigned long long)stats.invalid, 
+        (unsigned long long)stats.ignored, (unsigned long long)stats.sequence_errors);
+    if (stats.frames)
+    {
+        printf("Receive to wire latency (us): min %.1f, avg %.1f, max %.1f\n", 
+            stats.latency_min / 1e3, (double)stats.latency_sum / stats.frames / 1e3, 
+            stats.latency_max / 1e3);
+    }
+
+    RaspiAPA102ReceiverDestroy(&receiver);
+    RaspiAPA102DeviceDestroy(&device);
+    if (!spidev)
+    {
+        RaspiAPA102CaptureDestroy(&capture);
+    }
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Entry Point                                                                                    */
+/* ============================================================================================== */
+
+int main(int argc, char** argv)
+{
+    if ((argc >= 5) && !strcmp(argv[1], "receive"))
+    {
+        return Receive(argv[2], (size_t)atol(argv[3]), (unsigned)atoi(argv[4]), 
+            (argc >= 6) ? argv[5] : NULL);
+    }
+    if ((argc >= 7) && !strcmp(argv[1], "send"))
+    {
+        return Send(argv[2], argv[3], (size_t)atol(argv[4]), (unsigned)atoi(argv[5]), 
+            (unsigned)atoi(argv[6]), (argc >= 8) && !strcmp(argv[7], "sync"));
+    }
+
+    fprintf(stderr, 
+        "Usage: %s receive <udp:port|unix:path> <count> <frames> [spidev]\n"
+        "       %s send <artnet|e131> <udp:port|unix:path> <count> <fps> <frames> [sync]\n", 
+        argv[0], argv[0]);
+
+    return 1;
+}
+
+/* ============================================================================================== */
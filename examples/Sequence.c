@@ -0,0 +1,218 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Sequence.h>
+#include <RaspiAPA102/Transport.h>
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+#define RASPI_APA102_REFRESH_INTERVAL 60
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+static uint64_t Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void SleepUntil(uint64_t deadline)
+{
+    const struct timespec abstime =
+    {
+        .tv_sec  = (time_t)(deadline / 1000000000ULL),
+        .tv_nsec = (long)(deadline % 1000000000ULL)
+    };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &abstime, NULL);
+}
+
+/**
+ * @brief   Converts a file of raw color quad frames (`count * 4` bytes each) to a sequence file.
+ */
+static int Encode(const char* input, size_t count, unsigned fps, const char* output, 
+    unsigned keyframe_interval)
+{
+    FILE* file = strcmp(input, "-") ? fopen(input, "rb") : stdin;
+    if (!file)
+    {
+        fprintf(stderr, "Could not open '%s'\n", input);
+        return 1;
+    }
+
+    RaspiAPA102SequenceWriter writer;
+    if (RaspiAPA102SequenceWriterOpen(&writer, output, count, fps, keyframe_interval) < 0)
+    {
+        fprintf(stderr, "Could not create '%s'\n", output);
+        return 1;
+    }
+
+    RaspiAPA102ColorQuad* quads = malloc(count * sizeof(RaspiAPA102ColorQuad));
+    if (!quads)
+    {
+        return 1;
+    }
+    uint64_t frames = 0;
+    while (fread(quads, sizeof(RaspiAPA102ColorQuad), count, file) == count)
+    {
+        if (RaspiAPA102SequenceWriterAppend(&writer, quads) < 0)
+        {
+            fprintf(stderr, "Could not write frame %llu\n", (unsigned long long)frames);
+            return 1;
+        }
+        ++frames;
+    }
+    free(quads);
+    if (file != stdin)
+    {
+        fclose(file);
+    }
+
+    const uint64_t raw = frames * count * sizeof(RaspiAPA102ColorQuad);
+    const uint64_t encoded = writer.offset;
+    if (RaspiAPA102SequenceWriterClose(&writer) < 0)
+    {
+        fprintf(stderr, "Could not complete '%s'\n", output);
+        return 1;
+    }
+    printf("Encoded %llu frames: %llu bytes raw, %llu bytes encoded (%.1f%%)\n", 
+        (unsigned long long)frames, (unsigned long long)raw, (unsigned long long)encoded, 
+        raw ? 100.0 * encoded / raw : 0.0);
+
+    return 0;
+}
+
+/**
+ * @brief   Plays a sequence file at its frame rate.
+ */
+static int Play(const char* path, unsigned loops, const char* spidev)
+{
+    RaspiAPA102SequencePlayer player;
+    if (RaspiAPA102SequencePlayerOpen(&player, path) < 0)
+    {
+        fprintf(stderr, "Could not open '%s'\n", path);
+        return 1;
+    }
+    size_t count;
+    uint32_t fps;
+    uint64_t frames;
+    RaspiAPA102SequencePlayerGetInfo(&player, &count, &fps, &frames);
+
+    RaspiAPA102Device device;
+    RaspiAPA102Capture capture;
+    if (spidev)
+    {
+        if (RaspiAPA102DeviceInitSPIDev(&device, spidev, RASPI_APA102_SPI_DEFAULT_SPEED) < 0)
+        {
+            fprintf(stderr, "Could not open '%s'\n", spidev);
+            return 1;
+        }
+    }
+    else
+    {
+        // Headless: capture the byte stream instead of sending it
+        RaspiAPA102Transport transport;
+        RaspiAPA102CaptureInit(&capture, false);
+        RaspiAPA102CaptureGetTransport(&capture, &transport);
+        RaspiAPA102DeviceInitTransport(&device, &transport);
+    }
+    if ((RaspiAPA102DeviceAllocateBuffer(&device, count) < 0) || 
+        (RaspiAPA102DeviceSetRefreshInterval(&device, RASPI_APA102_REFRESH_INTERVAL) < 0))
+    {
+        return 1;
+    }
+
+    uint64_t late = 0;
+    uint64_t played = 0;
+    const uint64_t interval = 1000000000ULL / fps;
+    const uint64_t start = Now();
+    for (unsigned loop = 0; loop < loops; ++loop)
+    {
+        for (uint64_t frame = 0; frame < frames; ++frame, ++played)
+        {
+            const uint64_t deadline = start + played * interval;
+            if (Now() > deadline + interval)
+            {
+                ++late;
+            }
+            SleepUntil(deadline);
+            if (RaspiAPA102SequencePlayerUpdateDevice(&player, &device, frame) < 0)
+            {
+                fprintf(stderr, "Could not play frame %llu\n", (unsigned long long)frame);
+                return 1;
+            }
+        }
+    }
+    printf("Played %llu frames of %zu LEDs at %u fps (%llu late)\n", (unsigned long long)played, 
+        count, fps, (unsigned long long)late);
+
+    RaspiAPA102SequencePlayerClose(&player);
+    RaspiAPA102DeviceDestroy(&device);
+    if (!spidev)
+    {
+        RaspiAPA102CaptureDestroy(&capture);
+    }
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Entry Point                                                                                    */
+/* ============================================================================================== */
+
+int main(int argc, char** argv)
+{
+    if ((argc >= 6) && !strcmp(argv[1], "encode"))
+    {
+        const unsigned keyframe_interval = (argc >= 7) ? (unsigned)atoi(argv[6]) : 
+            RASPI_APA102_SEQUENCE_DEFAULT_KEYFRAME_INTERVAL;
+        return Encode(argv[2], (size_t)atol(argv[3]), (unsigned)atoi(argv[4]), argv[5], 
+            keyframe_interval);
+    }
+    if ((argc >= 3) && !strcmp(argv[1], "play"))
+    {
+        return Play(argv[2], (argc >= 4) ? (unsigned)atoi(argv[3]) : 1, 
+            (argc >= 5) ? argv[4] : NULL);
+    }
+
+    fprintf(stderr, 
+        "Usage: %s encode <raw input|-> <count> <fps> <output> [keyframe interval]\n"
+        "       %s play <file> [loops] [spidev]\n", argv[0], argv[0]);
+
+    return 1;
+}
+
+/* ============================================================================================== */
@@ -33,14 +33,44 @@
 #define APA102_H
 
 #include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/Transport.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* ============================================================================================== */
 /* Enums and types                                                                                */
 /* ============================================================================================== */
 
+/**
+ * @brief   Defines the `RaspiAPA102ChainMode` enum.
+ */
+typedef enum RaspiAPA102ChainMode_
+{
+    /**
+     * @brief   The end frame consists of `(n/2)` bits of `1`, where n is the number of LEDs that 
+     *          were sent.
+     */
+    RASPI_APA102_CHAIN_MODE_DEFAULT,
+    /**
+     * @brief   The end frame consists of a 32 bit reset frame followed by `(n/2)` bits of `0`.
+     *
+     * Every LED delays the clock by half a period, so the last of `n` LEDs needs `(n/2)` additional
+     * clock edges after its data. Unlike ones, zero bits are never latched as an LED frame, which
+     * keeps the LEDs behind a partially transmitted chain unchanged, and the reset frame latches
+     * `SK9822` compatible LEDs immediately.
+     */
+    RASPI_APA102_CHAIN_MODE_LARGE,
+    /**
+     * @brief   Maximum value of this enum.
+     */
+    RASPI_APA102_CHAIN_MODE_MAX_VALUE = RASPI_APA102_CHAIN_MODE_LARGE
+} RaspiAPA102ChainMode;
+
 /**
  * @brief   Defines the `RaspiAPA102Device` struct.
  *
@@ -50,25 +80,59 @@
 typedef struct RaspiAPA102Device_
 {
     /**
-     * @brief   Signals, if configured to use hardware `SPI`.
+     * @brief   The transport used to put the frames on the wire.
+     */
+    RaspiAPA102Transport transport;
+    /**
+     * @brief   The framed transmit buffer (start frame, LED frames and end frame), or `NULL`.
+     */
+    uint8_t* frame;
+    /**
+     * @brief   The size of the transmit buffer in bytes.
+     */
+    size_t frame_size;
+    /**
+     * @brief   The size of the memory block that holds the transmit buffer in bytes.
+     */
+    size_t frame_capacity;
+    /**
+     * @brief   Signals, if the transmit buffer is owned by the device. Attached buffers are owned 
+     *          by the caller.
+     */
+    bool frame_owned;
+    /**
+     * @brief   The number of LED frames in the transmit buffer.
+     */
+    size_t count;
+    /**
+     * @brief   The number of LEDs in the modified prefix of the transmit buffer.
      */
-    bool native_spi;
+    size_t dirty_count;
     /**
-     * @brief   The native hardware `SPI` channel (0..1). 
+     * @brief   The number of commits between full refreshes, or `0` if dirty tracking is 
+     *          disabled.
      */
-    uint8_t channel;
+    uint32_t refresh_interval;
     /**
-     * @brief   The GPIO `SCLK` pin for software `SPI`.
+     * @brief   The number of commits since the last full refresh.
      */
-    uint8_t pin_sclk;
+    uint32_t refresh_counter;
     /**
-     * @brief   The GPIO `MOSI` pin for software `SPI`.
+     * @brief   The layout of the end frame.
      */
-    uint8_t pin_mosi;
+    RaspiAPA102ChainMode chain_mode;
     /**
-     * @brief   The chip select pin for software `SPI`.
+     * @brief   The number of bytes sent by the last commit.
      */
-    uint8_t pin_cs;
+    size_t bytes_sent;
+    /**
+     * @brief   The total number of bytes sent by all commits.
+     */
+    uint64_t bytes_sent_total;
+    /**
+     * @brief   The instrumentation state, or `NULL` if the instrumentation is disabled.
+     */
+    struct RaspiAPA102Stats_* stats;
 } RaspiAPA102Device;
 
 #pragma pack(push, 1)
@@ -105,6 +169,22 @@ typedef struct RaspiAPA102ColorQuad_
 /* Macros                                                                                         */
 /* ============================================================================================== */
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Constants                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   The default `SPI` clock frequency in Hz used by `RaspiAPA102DeviceInitHardware`.
+ */
+#define RASPI_APA102_SPI_DEFAULT_SPEED 500000
+
+/**
+ * @brief   The maximum number of LEDs in a single string.
+ *
+ * The limit guarantees that the size of a framed buffer can not overflow.
+ */
+#define RASPI_APA102_MAX_COUNT (SIZE_MAX / 16)
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Initializer                                                                                    */
 /* ---------------------------------------------------------------------------------------------- */
@@ -120,6 +200,44 @@ typedef struct RaspiAPA102ColorQuad_
         /* r          */ ar, \
     }
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Framing                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   The size of the start frame in bytes.
+ */
+#define RASPI_APA102_START_FRAME_SIZE 4
+
+/**
+ * @brief   Returns the size of the end frame in bytes for the given number of LEDs.
+ *
+ * An end frame consists of at least (n/2) bits of 1, where n is the number of LEDs in the string.
+ */
+#define RASPI_APA102_END_FRAME_SIZE(count) (((count) + 15) / 16)
+
+/**
+ * @brief   Returns the size of a complete frame (start frame, LED frames and end frame) in bytes 
+ *          for the given number of LEDs.
+ */
+#define RASPI_APA102_FRAME_SIZE(count) \
+    (RASPI_APA102_START_FRAME_SIZE + (count) * 4 + RASPI_APA102_END_FRAME_SIZE(count))
+
+/**
+ * @brief   The size of the reset frame in bytes that precedes the end frame in 
+ *          `RASPI_APA102_CHAIN_MODE_LARGE`.
+ */
+#define RASPI_APA102_RESET_FRAME_SIZE 4
+
+/**
+ * @brief   Returns the size of a complete frame in `RASPI_APA102_CHAIN_MODE_LARGE` in bytes for 
+ *          the given number of LEDs.
+ *
+ * Buffers of this size fit the frame of either chain mode.
+ */
+#define RASPI_APA102_FRAME_SIZE_LARGE(count) \
+    (RASPI_APA102_FRAME_SIZE(count) + RASPI_APA102_RESET_FRAME_SIZE)
+
 /* ---------------------------------------------------------------------------------------------- */
 /* Helper                                                                                         */
 /* ---------------------------------------------------------------------------------------------- */
@@ -146,12 +264,30 @@ typedef struct RaspiAPA102ColorQuad_
  * @param   device  A pointer to the `RaspiAPA102Device` struct.
  * @param   channel The number of the `SPI` channel/chip to use (either `0` or `1`).
  * 
- * This function initializes the given `SPI` channel with a frequency of `500000`.
+ * This function opens `/dev/spidev0.<channel>` with a frequency of 
+ * `RASPI_APA102_SPI_DEFAULT_SPEED`.
  * 
  * @return  A status code.
  */
 RASPI_APA102_EXPORT int RaspiAPA102DeviceInitHardware(RaspiAPA102Device* device, uint8_t channel);
 
+/**
+ * @brief   Initializes a new `APA102` device and configures it to use the given `spidev` device 
+ *          node.
+ * 
+ * @param   device      A pointer to the `RaspiAPA102Device` struct.
+ * @param   path        The path of the `spidev` device node (e.g. `/dev/spidev0.0`).
+ * @param   speed_hz    The `SPI` clock frequency in Hz.
+ * 
+ * Start frame, LED frames and end frame of an update are submitted as a single `SPI_IOC_MESSAGE`
+ * transfer. Updates that exceed the `bufsiz` limit of the `spidev` driver are split into 
+ * consecutive messages.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceInitSPIDev(RaspiAPA102Device* device, const char* path,
+    uint32_t speed_hz);
+
 /**
  * @brief   Initializes a new `APA102` device and configures it to use software emulated `SPI` on 
  *          the given `GPIO` pins.
@@ -166,13 +302,72 @@ RASPI_APA102_EXPORT int RaspiAPA102DeviceInitHardware(RaspiAPA102Device* device,
  * @param   pin_cs      The number of the `GPIO` pin (broadcom numbering scheme) to use as channel 
  *                      select output, or `-1` if not needed.
  * 
- * This function sets the given `GPIO` pins to `OUTPUT` mode.
+ * This function sets the given `GPIO` pins to `OUTPUT` mode and uses a clock frequency of 
+ * `RASPI_APA102_SOFT_SPI_DEFAULT_SPEED`. The pins are driven through the memory mapped `GPIO` 
+ * registers (`/dev/gpiomem`), or through `wiringPi` if the registers can not be mapped.
  * 
  * @return  A status code.
  */
 RASPI_APA102_EXPORT int RaspiAPA102DeviceInitSoftware(RaspiAPA102Device* device, int pin_sclk, 
     int pin_mosi, int pin_cs);
 
+/**
+ * @brief   Initializes a new `APA102` device and configures it to use software emulated `SPI` on 
+ *          the given `GPIO` pins with the given clock frequency.
+ * 
+ * @param   device      A pointer to the `RaspiAPA102Device` struct.
+ * @param   pin_sclk    The number of the `GPIO` pin (broadcom numbering scheme) to use as `SCLK` 
+ *                      output.
+ * @param   pin_mosi    The number of the `GPIO` pin (broadcom numbering scheme) to use as `MOSI` 
+ *                      output.
+ * @param   pin_cs      The number of the `GPIO` pin (broadcom numbering scheme) to use as channel 
+ *                      select output, or `-1` if not needed.
+ * @param   clock_hz    The requested clock frequency in Hz.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceInitSoftwareEx(RaspiAPA102Device* device, int pin_sclk, 
+    int pin_mosi, int pin_cs, uint32_t clock_hz);
+
+/**
+ * @brief   Initializes a new `APA102` device and configures it to stream the frames to the 
+ *          hardware `SPI` controller through `DMA`.
+ * 
+ * @param   device      A pointer to the `RaspiAPA102Device` struct.
+ * @param   speed_hz    The `SPI` clock frequency in Hz.
+ * @param   count       The maximum number of LEDs in the string.
+ * 
+ * Frames are copied to uncached memory and put on the wire by the `DMA` controller without any 
+ * CPU involvement, so updates return as soon as the frame is queued. The `SPI0` pins have to be 
+ * in `ALT0` mode (e.g. `dtparam=spi=on`) and `spidev` must not be used at the same time. See 
+ * `RaspiAPA102DMA` for details.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceInitDMA(RaspiAPA102Device* device, uint32_t speed_hz, 
+    size_t count);
+
+/**
+ * @brief   Initializes a new `APA102` device and configures it to use the given transport.
+ * 
+ * @param   device      A pointer to the `RaspiAPA102Device` struct.
+ * @param   transport   A pointer to the `RaspiAPA102Transport` struct. The struct is copied and 
+ *                      its `open` callback is invoked, if present.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceInitTransport(RaspiAPA102Device* device, 
+    const RaspiAPA102Transport* transport);
+
+/**
+ * @brief   Releases all resources held by the given `APA102` device.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceDestroy(RaspiAPA102Device* device);
+
 /**
  * @brief   Updates the LEDs of the given `APA102` device.
  * 
@@ -180,11 +375,168 @@ RASPI_APA102_EXPORT int RaspiAPA102DeviceInitSoftware(RaspiAPA102Device* device,
  * @param   colors  A pointer to an array of `RaspiAPA102ColorQuad` structs.
  * @param   count   The number of structs in the passed array.
  * 
+ * This function does not use the transmit buffer of the device. Use `RaspiAPA102DeviceGetBuffer`
+ * and `RaspiAPA102DeviceCommit` to avoid passing the start and end frame separately.
+ * 
  * @return  A status code.
  */
 RASPI_APA102_EXPORT int RaspiAPA102DeviceUpdate(const RaspiAPA102Device* device, 
     const RaspiAPA102ColorQuad* colors, size_t count);
 
+/**
+ * @brief   Allocates the framed transmit buffer of the given `APA102` device.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   count   The number of LEDs in the string.
+ * 
+ * The buffer holds the start frame, `count` LED frames and the end frame in a single contiguous 
+ * block. All LEDs are initialized to black. A previously allocated buffer is released.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceAllocateBuffer(RaspiAPA102Device* device, size_t count);
+
+/**
+ * @brief   Uses a caller-owned memory block as the framed transmit buffer of the given `APA102` 
+ *          device.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   buffer  A pointer to the memory block. The LED frames start at 
+ *                  `buffer + RASPI_APA102_START_FRAME_SIZE`.
+ * @param   size    The size of the memory block in bytes. At least 
+ *                  `RASPI_APA102_FRAME_SIZE(count)` bytes are required, 
+ *                  `RASPI_APA102_FRAME_SIZE_LARGE(count)` bytes for 
+ *                  `RASPI_APA102_CHAIN_MODE_LARGE`.
+ * @param   count   The number of LEDs in the string.
+ * 
+ * The memory block needs head room for the start frame and tail room for the end frame around the
+ * LED frames; both are written by this function. The LED frames are left untouched, so a renderer
+ * can keep drawing into its own buffer and `RaspiAPA102DeviceCommit` passes the block to the 
+ * transport without copying. The block stays owned by the caller and has to stay valid until it 
+ * is detached or the device is destroyed. A previously allocated buffer is released.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceAttachBuffer(RaspiAPA102Device* device, uint8_t* buffer, 
+    size_t size, size_t count);
+
+/**
+ * @brief   Removes the transmit buffer from the given `APA102` device.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   buffer  Receives the attached memory block, or `NULL` if the buffer was allocated by 
+ *                  `RaspiAPA102DeviceAllocateBuffer` (which is released). This parameter is 
+ *                  optional.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceDetachBuffer(RaspiAPA102Device* device, 
+    uint8_t** buffer);
+
+/**
+ * @brief   Returns the LED frames inside the transmit buffer of the given `APA102` device.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   colors  Receives a pointer to the `RaspiAPA102ColorQuad` structs.
+ * @param   count   Receives the number of LEDs. This parameter is optional.
+ * 
+ * The LED frames can be modified in place and are sent by the next call to 
+ * `RaspiAPA102DeviceCommit`.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceGetBuffer(const RaspiAPA102Device* device, 
+    RaspiAPA102ColorQuad** colors, size_t* count);
+
+/**
+ * @brief   Sets the color of a single LED in the transmit buffer and marks it as modified.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   index   The index of the LED.
+ * @param   color   The new color.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceSetColor(RaspiAPA102Device* device, size_t index, 
+    RaspiAPA102ColorQuad color);
+
+/**
+ * @brief   Marks a range of LEDs in the transmit buffer as modified.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   index   The index of the first modified LED.
+ * @param   count   The number of modified LEDs.
+ * 
+ * This function has to be called after modifying the buffer in place, if dirty tracking is 
+ * enabled.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceMarkDirty(RaspiAPA102Device* device, size_t index, 
+    size_t count);
+
+/**
+ * @brief   Enables or disables dirty tracking for the transmit buffer of the given `APA102` 
+ *          device.
+ * 
+ * @param   device      A pointer to the `RaspiAPA102Device` struct.
+ * @param   interval    The number of commits between two full refreshes, or `0` to disable dirty 
+ *                      tracking (default).
+ * 
+ * `APA102` strings shift the data through the LEDs, so LEDs behind the last transmitted LED frame
+ * keep their state. With dirty tracking enabled, `RaspiAPA102DeviceCommit` only sends the prefix 
+ * up to the highest modified LED, followed by an end frame of zero bits that is sized for that 
+ * prefix (an end frame of ones would be latched as a white LED frame by the next LED). Every 
+ * `interval` commits, the whole buffer is sent to recover from transmission errors.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceSetRefreshInterval(RaspiAPA102Device* device, 
+    uint32_t interval);
+
+/**
+ * @brief   Sets the end frame layout of the given `APA102` device.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   mode    The chain mode (`RASPI_APA102_CHAIN_MODE_DEFAULT` by default).
+ * 
+ * `RASPI_APA102_CHAIN_MODE_LARGE` is recommended for long strings. The transmit buffer is updated
+ * in place; this fails, if an attached buffer has no room for the larger end frame. Outputs that 
+ * keep their own framed buffers (e.g. `RaspiAPA102AsyncOutput`) use the mode that was set when 
+ * they were initialized.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceSetChainMode(RaspiAPA102Device* device, 
+    RaspiAPA102ChainMode mode);
+
+/**
+ * @brief   Sends the transmit buffer of the given `APA102` device.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * 
+ * The whole buffer is passed to the transport as a single contiguous write. If dirty tracking is 
+ * enabled and only the modified prefix is sent, the prefix is written first, followed by one or 
+ * more writes of a zero end frame.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceCommit(RaspiAPA102Device* device);
+
+/**
+ * @brief   Returns the number of bytes sent by `RaspiAPA102DeviceCommit`.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   last    Receives the number of bytes sent by the last commit. This parameter is 
+ *                  optional.
+ * @param   total   Receives the total number of bytes sent by all commits. This parameter is 
+ *                  optional.
+ * 
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceGetBytesSent(const RaspiAPA102Device* device, 
+    size_t* last, uint64_t* total);
+
 /* ---------------------------------------------------------------------------------------------- */
 /* APA102 Color Quad                                                                              */
 /* ---------------------------------------------------------------------------------------------- */
@@ -208,4 +560,8 @@ RASPI_APA102_EXPORT int RaspiAPA102ColorQuadInit(RaspiAPA102ColorQuad* value, ui
 
 /* ============================================================================================== */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* APA102_H */
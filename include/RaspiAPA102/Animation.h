@@ -0,0 +1,384 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a keyframe based animation engine with a fixed frame rate.
+ */
+
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102AnimationCurve` enum.
+ *
+ * Describes the transition from a keyframe to the next one.
+ */
+typedef enum RaspiAPA102AnimationCurve_
+{
+    /**
+     * @brief   Holds the color until the next keyframe is reached.
+     */
+    RASPI_APA102_ANIMATION_CURVE_STEP,
+    /**
+     * @brief   Linear interpolation.
+     */
+    RASPI_APA102_ANIMATION_CURVE_LINEAR,
+    /**
+     * @brief   Quadratic interpolation that starts slow.
+     */
+    RASPI_APA102_ANIMATION_CURVE_EASE_IN,
+    /**
+     * @brief   Quadratic interpolation that ends slow.
+     */
+    RASPI_APA102_ANIMATION_CURVE_EASE_OUT,
+    /**
+     * @brief   Cubic (smoothstep) interpolation that starts and ends slow.
+     */
+    RASPI_APA102_ANIMATION_CURVE_EASE_IN_OUT,
+
+    /**
+     * @brief   Maximum value of this enum.
+     */
+    RASPI_APA102_ANIMATION_CURVE_MAX_VALUE = RASPI_APA102_ANIMATION_CURVE_EASE_IN_OUT
+} RaspiAPA102AnimationCurve;
+
+/**
+ * @brief   Defines the `RaspiAPA102AnimationSpace` enum.
+ *
+ * Describes the color space in which the keyframes of a track are interpolated.
+ */
+typedef enum RaspiAPA102AnimationSpace_
+{
+    /**
+     * @brief   The keyframe colors are red, green and blue (`0` to `255`).
+     */
+    RASPI_APA102_ANIMATION_SPACE_RGB,
+    /**
+     * @brief   The keyframe colors are hue (`0` to `65535`, `65536` = 360°), saturation and value
+     *          (`0` to `255`). The hue takes the shorter way around the color circle.
+     */
+    RASPI_APA102_ANIMATION_SPACE_HSV,
+
+    /**
+     * @brief   Maximum value of this enum.
+     */
+    RASPI_APA102_ANIMATION_SPACE_MAX_VALUE = RASPI_APA102_ANIMATION_SPACE_HSV
+} RaspiAPA102AnimationSpace;
+
+/**
+ * @brief   Defines the `RaspiAPA102Keyframe` struct.
+ */
+typedef struct RaspiAPA102Keyframe_
+{
+    /**
+     * @brief   The time of the keyframe in milliseconds, relative to the start of the track.
+     */
+    uint32_t time;
+    /**
+     * @brief   The color components (see `RaspiAPA102AnimationSpace`).
+     */
+    uint16_t color[3];
+    /**
+     * @brief   The transition to the next keyframe.
+     */
+    RaspiAPA102AnimationCurve curve;
+} RaspiAPA102Keyframe;
+
+/**
+ * @brief   Defines the `RaspiAPA102AnimationTrack` struct.
+ *
+ * A track renders a single color to a range of pixels (use a length of `1` for per-pixel tracks).
+ * Before its start time a track does not touch its pixels; after its last keyframe it holds the 
+ * last color, unless it loops.
+ */
+typedef struct RaspiAPA102AnimationTrack_
+{
+    /**
+     * @brief   The index of the first pixel.
+     */
+    size_t first;
+    /**
+     * @brief   The number of pixels.
+     */
+    size_t length;
+    /**
+     * @brief   The keyframes, sorted by time. The array has to stay valid for the lifetime of the
+     *          animation.
+     */
+    const RaspiAPA102Keyframe* keyframes;
+    /**
+     * @brief   The number of keyframes.
+     */
+    size_t keyframe_count;
+    /**
+     * @brief   The color space of the keyframes.
+     */
+    RaspiAPA102AnimationSpace space;
+    /**
+     * @brief   The start time of the track in milliseconds, relative to the start of the 
+     *          animation.
+     */
+    uint32_t start;
+    /**
+     * @brief   Signals, if the track restarts after its last keyframe.
+     */
+    bool loop;
+} RaspiAPA102AnimationTrack;
+
+/**
+ * @brief   Defines the `RaspiAPA102AnimationTrackState` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102AnimationTrackState_
+{
+    /**
+     * @brief   The track.
+     */
+    RaspiAPA102AnimationTrack track;
+    /**
+     * @brief   The index of the keyframe found by the last lookup.
+     */
+    size_t cursor;
+    /**
+     * @brief   The last rendered color.
+     */
+    RaspiAPA102ColorQuad color;
+    /**
+     * @brief   Signals, if `color` is valid.
+     */
+    bool rendered;
+} RaspiAPA102AnimationTrackState;
+
+/**
+ * @brief   Defines the `RaspiAPA102Animation` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102Animation_
+{
+    /**
+     * @brief   The destination color quads.
+     */
+    RaspiAPA102ColorQuad* quads;
+    /**
+     * @brief   The number of destination color quads.
+     */
+    size_t count;
+    /**
+     * @brief   The tracks.
+     */
+    RaspiAPA102AnimationTrackState* tracks;
+    /**
+     * @brief   The number of tracks.
+     */
+    size_t track_count;
+    /**
+     * @brief   The LED brightness (0..31).
+     */
+    uint8_t brightness;
+    /**
+     * @brief   The frame interval in nanoseconds.
+     */
+    uint64_t interval_ns;
+    /**
+     * @brief   The start time of the animation (`CLOCK_MONOTONIC`) in nanoseconds.
+     */
+    uint64_t start_ns;
+    /**
+     * @brief   The index of the next frame.
+     */
+    uint64_t frame;
+    /**
+     * @brief   The index of the first pixel changed by the last frame.
+     */
+    size_t dirty_first;
+    /**
+     * @brief   The number of pixels (starting at `dirty_first`) changed by the last frame.
+     */
+    size_t dirty_count;
+    /**
+     * @brief   The number of rendered frames.
+     */
+    uint64_t frames_rendered;
+    /**
+     * @brief   The number of frames skipped, because their deadline had already passed.
+     */
+    uint64_t frames_skipped;
+    /**
+     * @brief   The accumulated CPU time spent rendering in nanoseconds.
+     */
+    uint64_t render_ns;
+} RaspiAPA102Animation;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Animation                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102Animation` struct.
+ *
+ * @param   animation   A pointer to the `RaspiAPA102Animation` struct.
+ * @param   quads       A pointer to the destination color quads (e.g. the transmit buffer of a
+ *                      device or the back buffer of an asynchronous output).
+ * @param   count       The number of destination color quads.
+ * @param   tracks      A pointer to an array of `RaspiAPA102AnimationTrack` structs. The array 
+ *                      is copied; the keyframes are not.
+ * @param   track_count The number of tracks. Later tracks are drawn on top of earlier ones.
+ * @param   fps         The frame rate.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AnimationInit(RaspiAPA102Animation* animation, 
+    RaspiAPA102ColorQuad* quads, size_t count, const RaspiAPA102AnimationTrack* tracks, 
+    size_t track_count, uint32_t fps);
+
+/**
+ * @brief   Sets the LED brightness.
+ *
+ * @param   animation   A pointer to the `RaspiAPA102Animation` struct.
+ * @param   brightness  The LED brightness (0..31).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AnimationSetBrightness(RaspiAPA102Animation* animation, 
+    uint8_t brightness);
+
+/**
+ * @brief   Starts the animation at the current time of the monotonic clock.
+ *
+ * @param   animation   A pointer to the `RaspiAPA102Animation` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AnimationStart(RaspiAPA102Animation* animation);
+
+/**
+ * @brief   Starts the animation at the given time.
+ *
+ * @param   animation   A pointer to the `RaspiAPA102Animation` struct.
+ * @param   now_ns      The current time in nanoseconds.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AnimationStartAt(RaspiAPA102Animation* animation, 
+    uint64_t now_ns);
+
+/**
+ * @brief   Waits for the deadline of the next frame and renders it.
+ *
+ * @param   animation   A pointer to the `RaspiAPA102Animation` struct.
+ * @param   frame       Receives the index of the rendered frame. This parameter is optional.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AnimationNextFrame(RaspiAPA102Animation* animation, 
+    uint64_t* frame);
+
+/**
+ * @brief   Renders the newest frame whose deadline is not after the given time.
+ *
+ * @param   animation   A pointer to the `RaspiAPA102Animation` struct.
+ * @param   now_ns      The current time in nanoseconds.
+ * @param   frame       Receives the index of the rendered frame. This parameter is optional.
+ *
+ * Frames are only ever rendered for their scheduled time (`start + index * interval`), so the 
+ * output does not depend on the actual time. Frames whose deadline has already been passed by the 
+ * deadline of a newer frame are skipped. If the deadline of the next frame has not been reached 
+ * yet, the next frame is rendered anyway.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AnimationNextFrameAt(RaspiAPA102Animation* animation, 
+    uint64_t now_ns, uint64_t* frame);
+
+/**
+ * @brief   Returns the range of pixels changed by the last frame.
+ *
+ * @param   animation   A pointer to the `RaspiAPA102Animation` struct.
+ * @param   first       Receives the index of the first changed pixel.
+ * @param   count       Receives the number of changed pixels (`0`, if nothing changed).
+ *
+ * The range can be passed to `RaspiAPA102DeviceMarkDirty`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AnimationGetDirty(const RaspiAPA102Animation* animation, 
+    size_t* first, size_t* count);
+
+/**
+ * @brief   Returns the statistics of the given animation.
+ *
+ * @param   animation       A pointer to the `RaspiAPA102Animation` struct.
+ * @param   frames_rendered Receives the number of rendered frames. This parameter is optional.
+ * @param   frames_skipped  Receives the number of skipped frames. This parameter is optional.
+ * @param   render_ns       Receives the accumulated CPU time spent rendering in nanoseconds. This
+ *                          parameter is optional.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AnimationGetStats(const RaspiAPA102Animation* animation, 
+    uint64_t* frames_rendered, uint64_t* frames_skipped, uint64_t* render_ns);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102Animation` struct.
+ *
+ * @param   animation   A pointer to the `RaspiAPA102Animation` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AnimationDestroy(RaspiAPA102Animation* animation);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANIMATION_H */
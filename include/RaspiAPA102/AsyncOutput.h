@@ -0,0 +1,368 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a double-buffered asynchronous output thread for `APA102` devices.
+ */
+
+#ifndef ASYNC_OUTPUT_H
+#define ASYNC_OUTPUT_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Stats.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102RealtimeFlags` enum.
+ */
+typedef enum RaspiAPA102RealtimeFlags_
+{
+    /**
+     * @brief   The output thread runs with the `SCHED_FIFO` policy.
+     */
+    RASPI_APA102_REALTIME_SCHEDULING = 1 << 0,
+    /**
+     * @brief   The output thread is pinned to a single CPU.
+     */
+    RASPI_APA102_REALTIME_AFFINITY   = 1 << 1,
+    /**
+     * @brief   The buffers and the stack of the output thread are locked in memory (`mlock`).
+     */
+    RASPI_APA102_REALTIME_LOCKED     = 1 << 2
+} RaspiAPA102RealtimeFlags;
+
+/**
+ * @brief   Defines the `RaspiAPA102AsyncOutputRealtime` struct.
+ */
+typedef struct RaspiAPA102AsyncOutputRealtime_
+{
+    /**
+     * @brief   The `SCHED_FIFO` priority of the output thread (`1` to `99`), or `0` to keep the 
+     *          default scheduling policy.
+     */
+    int priority;
+    /**
+     * @brief   The CPU the output thread is pinned to, or `-1` to allow all CPUs.
+     */
+    int cpu;
+    /**
+     * @brief   Signals, if the buffers and the stack of the output thread should be locked in 
+     *          memory.
+     */
+    bool lock_memory;
+} RaspiAPA102AsyncOutputRealtime;
+
+/**
+ * @brief   Defines the `RaspiAPA102AsyncOutputJitter` struct.
+ *
+ * The statistics are recorded for outputs with a target frame rate.
+ */
+typedef struct RaspiAPA102AsyncOutputJitter_
+{
+    /**
+     * @brief   The delay between a frame deadline and the wake-up of the output thread.
+     */
+    RaspiAPA102StatsHistogram wakeup;
+    /**
+     * @brief   The duration of the transfers.
+     */
+    RaspiAPA102StatsHistogram transfer;
+    /**
+     * @brief   The number of deadlines that were skipped, because the previous transfer or the 
+     *          wake-up took too long.
+     */
+    uint64_t deadlines_missed;
+} RaspiAPA102AsyncOutputJitter;
+
+/**
+ * @brief   Defines the `RaspiAPA102AsyncOutput` struct.
+ *
+ * The output thread owns the transport of the device. The application renders into the back 
+ * buffer and publishes it with `RaspiAPA102AsyncOutputSwap`. The thread always sends the newest 
+ * published frame; frames that are superseded before the thread picks them up are dropped.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102AsyncOutput_
+{
+    /**
+     * @brief   A pointer to the `RaspiAPA102Device` struct.
+     */
+    const RaspiAPA102Device* device;
+    /**
+     * @brief   The number of LEDs in the string.
+     */
+    size_t count;
+    /**
+     * @brief   The size of a framed buffer in bytes.
+     */
+    size_t frame_size;
+    /**
+     * @brief   The allocation that holds all three framed buffers.
+     */
+    uint8_t* buffers;
+    /**
+     * @brief   The size of the `buffers` allocation in bytes (a multiple of the page size).
+     */
+    size_t buffers_size;
+    /**
+     * @brief   The stack of the output thread, or `NULL` if the thread uses the default stack.
+     */
+    void* stack;
+    /**
+     * @brief   The framed buffer the application renders into.
+     */
+    uint8_t* back;
+    /**
+     * @brief   The newest published framed buffer that was not picked up by the thread yet.
+     */
+    uint8_t* pending;
+    /**
+     * @brief   The framed buffer that is currently sent by the thread.
+     */
+    uint8_t* front;
+    /**
+     * @brief   Signals, if the `pending` buffer contains a frame.
+     */
+    bool pending_valid;
+    /**
+     * @brief   The frame interval in nanoseconds, or `0` to send frames as soon as they are 
+     *          published.
+     */
+    uint64_t interval_ns;
+    /**
+     * @brief   The sequence number of the last published frame.
+     */
+    uint64_t sequence_published;
+    /**
+     * @brief   The sequence number of the last sent (or dropped) frame.
+     */
+    uint64_t sequence_sent;
+    /**
+     * @brief   The sequence number of the frame in the `pending` buffer.
+     */
+    uint64_t sequence_pending;
+    /**
+     * @brief   The number of frames that were superseded before being sent.
+     */
+    uint64_t frames_dropped;
+    /**
+     * @brief   Signals, if the thread is paced by `clock_nanosleep` instead of the condition 
+     *          variable.
+     */
+    bool realtime;
+    /**
+     * @brief   The `RaspiAPA102RealtimeFlags` that were applied.
+     */
+    uint32_t realtime_flags;
+    /**
+     * @brief   The jitter statistics.
+     */
+    RaspiAPA102AsyncOutputJitter jitter;
+    /**
+     * @brief   The status code of the last transfer.
+     */
+    int status;
+    /**
+     * @brief   Signals, if the thread should terminate.
+     */
+    bool stop;
+    /**
+     * @brief   The output thread.
+     */
+    pthread_t thread;
+    /**
+     * @brief   The mutex that protects the buffer state.
+     */
+    pthread_mutex_t mutex;
+    /**
+     * @brief   Signaled when a frame is published or the thread should terminate.
+     */
+    pthread_cond_t published;
+    /**
+     * @brief   Signaled when a frame was sent.
+     */
+    pthread_cond_t sent;
+} RaspiAPA102AsyncOutput;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Async Output                                                                                   */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102AsyncOutput` struct and starts the output thread.
+ *
+ * @param   output  A pointer to the `RaspiAPA102AsyncOutput` struct.
+ * @param   device  A pointer to an initialized `RaspiAPA102Device` struct. The device must not be
+ *                  used by the application until the output is destroyed.
+ * @param   count   The number of LEDs in the string.
+ * @param   fps     The target frame rate, or `0` to send frames as soon as they are published.
+ *
+ * With a target frame rate, the thread wakes up on a fixed schedule of absolute deadlines and 
+ * sends the newest published frame, independent of the time a single transfer takes. Deadlines 
+ * that are missed because of long transfers are skipped.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AsyncOutputInit(RaspiAPA102AsyncOutput* output, 
+    const RaspiAPA102Device* device, size_t count, uint32_t fps);
+
+/**
+ * @brief   Initializes the given `RaspiAPA102AsyncOutput` struct and starts the output thread in 
+ *          real-time mode.
+ *
+ * @param   output      A pointer to the `RaspiAPA102AsyncOutput` struct.
+ * @param   device      A pointer to an initialized `RaspiAPA102Device` struct. The device must not
+ *                      be used by the application until the output is destroyed.
+ * @param   count       The number of LEDs in the string.
+ * @param   fps         The target frame rate, or `0` to send frames as soon as they are published.
+ * @param   realtime    A pointer to the `RaspiAPA102AsyncOutputRealtime` struct, or `NULL` to 
+ *                      behave like `RaspiAPA102AsyncOutputInit`.
+ *
+ * In real-time mode, the buffers and the stack of the thread are pre-faulted and the thread sleeps
+ * with `clock_nanosleep` until the absolute frame deadlines, so publishing a frame never wakes it 
+ * early. This keeps transfers (in particular software `SPI`) from being preempted mid-frame. 
+ * `RaspiAPA102AsyncOutputDestroy` may block for up to one frame interval.
+ *
+ * The scheduling policy, the CPU affinity and the memory lock require privileges (e.g. 
+ * `CAP_SYS_NICE`, `CAP_IPC_LOCK` or suitable `RLIMIT_RTPRIO` and `RLIMIT_MEMLOCK` limits). Each of
+ * them is applied on a best effort basis; use `RaspiAPA102AsyncOutputGetRealtime` to query which 
+ * ones took effect. The scheduling policy and the CPU affinity are set before the thread starts, 
+ * so they already apply to the first frame. The memory lock only covers the buffers and the stack 
+ * of the output thread and is released by `RaspiAPA102AsyncOutputDestroy`. Memory the transport 
+ * touches from the thread (e.g. the buffers of the device) is not locked; lock it separately 
+ * (e.g. with `mlockall`), if needed.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AsyncOutputInitEx(RaspiAPA102AsyncOutput* output, 
+    const RaspiAPA102Device* device, size_t count, uint32_t fps, 
+    const RaspiAPA102AsyncOutputRealtime* realtime);
+
+/**
+ * @brief   Returns the LED frames of the back buffer.
+ *
+ * @param   output  A pointer to the `RaspiAPA102AsyncOutput` struct.
+ * @param   colors  Receives a pointer to the `RaspiAPA102ColorQuad` structs.
+ * @param   count   Receives the number of LEDs. This parameter is optional.
+ *
+ * The returned pointer changes with every call to `RaspiAPA102AsyncOutputSwap`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AsyncOutputGetBackBuffer(RaspiAPA102AsyncOutput* output, 
+    RaspiAPA102ColorQuad** colors, size_t* count);
+
+/**
+ * @brief   Publishes the back buffer to the output thread without blocking.
+ *
+ * @param   output      A pointer to the `RaspiAPA102AsyncOutput` struct.
+ * @param   sequence    Receives the sequence number of the published frame. This parameter is 
+ *                      optional.
+ *
+ * The new back buffer is initialized with the content of the published frame, so incremental 
+ * rendering continues to work.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AsyncOutputSwap(RaspiAPA102AsyncOutput* output, 
+    uint64_t* sequence);
+
+/**
+ * @brief   Waits until the frame with the given sequence number was sent or superseded by a newer
+ *          frame that was sent.
+ *
+ * @param   output      A pointer to the `RaspiAPA102AsyncOutput` struct.
+ * @param   sequence    The sequence number returned by `RaspiAPA102AsyncOutputSwap`.
+ *
+ * @return  The status code of the last transfer.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AsyncOutputWait(RaspiAPA102AsyncOutput* output, 
+    uint64_t sequence);
+
+/**
+ * @brief   Returns the real-time settings that took effect for the given output.
+ *
+ * @param   output  A pointer to the `RaspiAPA102AsyncOutput` struct.
+ * @param   flags   Receives a combination of `RaspiAPA102RealtimeFlags`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AsyncOutputGetRealtime(const RaspiAPA102AsyncOutput* output, 
+    uint32_t* flags);
+
+/**
+ * @brief   Returns the jitter statistics of the given output.
+ *
+ * @param   output  A pointer to the `RaspiAPA102AsyncOutput` struct.
+ * @param   jitter  Receives the jitter statistics. Use `RaspiAPA102StatsGetPercentile` and 
+ *                  `RaspiAPA102StatsGetDeviation` to evaluate the histograms.
+ * @param   reset   Pass `true` to reset the statistics.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AsyncOutputGetJitter(RaspiAPA102AsyncOutput* output, 
+    RaspiAPA102AsyncOutputJitter* jitter, bool reset);
+
+/**
+ * @brief   Stops the output thread and releases all resources held by the given 
+ *          `RaspiAPA102AsyncOutput` struct.
+ *
+ * @param   output  A pointer to the `RaspiAPA102AsyncOutput` struct.
+ *
+ * A frame that was published but not sent yet is discarded.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102AsyncOutputDestroy(RaspiAPA102AsyncOutput* output);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASYNC_OUTPUT_H */
@@ -0,0 +1,211 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a pool of framed buffers in page aligned slots for 
+ *          `RaspiAPA102DeviceAttachBuffer`.
+ *
+ * All buffers of a pool live in a single anonymous memory mapping. Every buffer occupies its own 
+ * page aligned slot and starts at a small offset into it, so that its LED frames are aligned to 
+ * 64 bytes (a cache line). The mapping can
+ * be backed by huge pages and locked into memory, which avoids TLB misses and page faults while a 
+ * frame is rendered or transferred.
+ */
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BufferPoolFlags` enum.
+ */
+typedef enum RaspiAPA102BufferPoolFlags_
+{
+    /**
+     * @brief   Backs the pool with huge pages. Falls back to transparent huge pages and then to 
+     *          regular pages, if no huge pages are reserved.
+     */
+    RASPI_APA102_BUFFER_POOL_HUGE_PAGES = 1 << 0,
+    /**
+     * @brief   Locks the pool into memory (`mlock`). Initialization fails, if the pages can not be
+     *          locked (see `RLIMIT_MEMLOCK`).
+     */
+    RASPI_APA102_BUFFER_POOL_LOCKED     = 1 << 1
+} RaspiAPA102BufferPoolFlags;
+
+/**
+ * @brief   Defines the `RaspiAPA102BufferPool` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102BufferPool_
+{
+    /**
+     * @brief   The memory mapping that holds all buffers.
+     */
+    uint8_t* memory;
+    /**
+     * @brief   The size of the memory mapping in bytes.
+     */
+    size_t memory_size;
+    /**
+     * @brief   The distance between two buffers in bytes (a multiple of the page size).
+     */
+    size_t stride;
+    /**
+     * @brief   The usable size of a single buffer in bytes.
+     */
+    size_t buffer_size;
+    /**
+     * @brief   The number of LEDs per buffer.
+     */
+    size_t count;
+    /**
+     * @brief   The number of buffers.
+     */
+    size_t buffer_count;
+    /**
+     * @brief   The stack of available buffers.
+     */
+    uint8_t** available;
+    /**
+     * @brief   The number of available buffers.
+     */
+    size_t available_count;
+    /**
+     * @brief   Signals for every buffer (indexed by its slot), if it is currently acquired.
+     */
+    bool* in_use;
+    /**
+     * @brief   The mutex that protects the stack of available buffers.
+     */
+    pthread_mutex_t mutex;
+    /**
+     * @brief   Signals, if the mapping is backed by explicitly reserved huge pages.
+     */
+    bool huge_pages;
+    /**
+     * @brief   Signals, if the mapping is locked into memory.
+     */
+    bool locked;
+} RaspiAPA102BufferPool;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102BufferPool` struct.
+ *
+ * @param   pool            A pointer to the `RaspiAPA102BufferPool` struct.
+ * @param   count           The number of LEDs per buffer.
+ * @param   buffer_count    The number of buffers.
+ * @param   flags           A combination of `RaspiAPA102BufferPoolFlags`.
+ *
+ * Every buffer holds `RASPI_APA102_FRAME_SIZE_LARGE(count)` bytes (so it fits either chain mode)
+ * and is initialized to black LED frames.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102BufferPoolInit(RaspiAPA102BufferPool* pool, size_t count, 
+    size_t buffer_count, uint32_t flags);
+
+/**
+ * @brief   Takes a buffer from the given pool.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102BufferPool` struct.
+ * @param   buffer  Receives a pointer to the buffer. The LED frames start at 
+ *                  `buffer + RASPI_APA102_START_FRAME_SIZE`.
+ * @param   size    Receives the size of the buffer in bytes. This parameter is optional.
+ *
+ * This function is thread-safe. It fails, if all buffers are in use.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102BufferPoolAcquire(RaspiAPA102BufferPool* pool, 
+    uint8_t** buffer, size_t* size);
+
+/**
+ * @brief   Returns a buffer to the given pool.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102BufferPool` struct.
+ * @param   buffer  A pointer to a buffer returned by `RaspiAPA102BufferPoolAcquire`.
+ *
+ * This function is thread-safe. The buffer must no longer be attached to a device. Releasing a 
+ * buffer that is not acquired (e.g. releasing it twice) fails.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102BufferPoolRelease(RaspiAPA102BufferPool* pool, 
+    uint8_t* buffer);
+
+/**
+ * @brief   Returns how the memory of the given pool is backed.
+ *
+ * @param   pool        A pointer to the `RaspiAPA102BufferPool` struct.
+ * @param   huge_pages  Receives `true`, if the pool is backed by reserved huge pages. This 
+ *                      parameter is optional.
+ * @param   locked      Receives `true`, if the pool is locked into memory. This parameter is 
+ *                      optional.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102BufferPoolGetInfo(const RaspiAPA102BufferPool* pool, 
+    bool* huge_pages, bool* locked);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102BufferPool` struct.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102BufferPool` struct.
+ *
+ * All buffers have to be detached from their devices before.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102BufferPoolDestroy(RaspiAPA102BufferPool* pool);
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_POOL_H */
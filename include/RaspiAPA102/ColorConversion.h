@@ -33,8 +33,15 @@
 #define COLOR_CONVERSION_H
 
 #include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/SIMD.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* ============================================================================================== */
 /* Enums and types                                                                                */
 /* ============================================================================================== */
@@ -116,8 +123,105 @@ RASPI_APA102_EXPORT RaspiAPA102HSV RaspiAPA102RGB2HSV(RaspiAPA102RGB in);
  */
 RASPI_APA102_EXPORT RaspiAPA102RGB RaspiAPA102HSV2RGB(RaspiAPA102HSV in);
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Batch                                                                                          */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Converts the given `RGB` color values to `HSV` color values.
+ *
+ * @param   r       The red color components (`0.0` to `1.0`).
+ * @param   g       The green color components (`0.0` to `1.0`).
+ * @param   b       The blue color components (`0.0` to `1.0`).
+ * @param   h       Receives the hues in degrees (`0.0` to `360.0`).
+ * @param   s       Receives the saturations (`0.0` to `1.0`).
+ * @param   v       Receives the values (`0.0` to `1.0`).
+ * @param   count   The number of color values.
+ *
+ * The input and output arrays must not overlap. Achromatic colors receive a hue of `0.0`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102RGB2HSVBatch(const float* r, const float* g, const float* b, 
+    float* h, float* s, float* v, size_t count);
+
+/**
+ * @brief   Converts the given `HSV` color values to `RGB` color values.
+ *
+ * @param   h       The hues in degrees. Values outside of `0.0` to `360.0` wrap around.
+ * @param   s       The saturations (`0.0` to `1.0`).
+ * @param   v       The values (`0.0` to `1.0`).
+ * @param   r       Receives the red color components (`0.0` to `1.0`).
+ * @param   g       Receives the green color components (`0.0` to `1.0`).
+ * @param   b       Receives the blue color components (`0.0` to `1.0`).
+ * @param   count   The number of color values.
+ *
+ * The input and output arrays must not overlap.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102HSV2RGBBatch(const float* h, const float* s, const float* v, 
+    float* r, float* g, float* b, size_t count);
+
+/**
+ * @brief   Converts the given `HSV` color values to color quads.
+ *
+ * @param   quads       Receives the color quads.
+ * @param   h           The hues in degrees. Values outside of `0.0` to `360.0` wrap around.
+ * @param   s           The saturations (`0.0` to `1.0`).
+ * @param   v           The values (`0.0` to `1.0`).
+ * @param   count       The number of color values.
+ * @param   brightness  The global LED brightness (0..31).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102HSV2ColorQuadBatch(RaspiAPA102ColorQuad* quads, const float* h, 
+    const float* s, const float* v, size_t count, uint8_t brightness);
+
+/**
+ * @brief   Converts the given fixed-point `HSV` color values to color quads.
+ *
+ * @param   quads       Receives the color quads.
+ * @param   h           The hues. The full circle is mapped to `0` to `65535` (`65536` = 360°).
+ * @param   s           The saturations (`0` to `255`).
+ * @param   v           The values (`0` to `255`).
+ * @param   count       The number of color values.
+ * @param   brightness  The global LED brightness (0..31).
+ *
+ * The conversion uses integer arithmetic only and is accurate to +-2 compared to 
+ * `RaspiAPA102HSV2RGB`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102HSVFixed2ColorQuadBatch(RaspiAPA102ColorQuad* quads, 
+    const uint16_t* h, const uint8_t* s, const uint8_t* v, size_t count, uint8_t brightness);
+
+/**
+ * @brief   Converts the given fixed-point `HSV` color values to color quads using the given 
+ *          implementation.
+ *
+ * @param   quads       Receives the color quads.
+ * @param   h           The hues. The full circle is mapped to `0` to `65535` (`65536` = 360°).
+ * @param   s           The saturations (`0` to `255`).
+ * @param   v           The values (`0` to `255`).
+ * @param   count       The number of color values.
+ * @param   brightness  The global LED brightness (0..31).
+ * @param   path        The implementation.
+ *
+ * This function fails, if the implementation is not supported by the current CPU.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102HSVFixed2ColorQuadBatchEx(RaspiAPA102ColorQuad* quads, 
+    const uint16_t* h, const uint8_t* s, const uint8_t* v, size_t count, uint8_t brightness, 
+    RaspiAPA102SIMDPath path);
+
 /* ---------------------------------------------------------------------------------------------- */
 
 /* ============================================================================================== */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* COLOR_CONVERSION_H */
\ No newline at end of file
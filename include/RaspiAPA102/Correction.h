@@ -0,0 +1,211 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a color correction stage (gamma, white balance and temporal dithering).
+ */
+
+#ifndef CORRECTION_H
+#define CORRECTION_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102CorrectionFlags` enum.
+ */
+typedef enum RaspiAPA102CorrectionFlags_
+{
+    /**
+     * @brief   Selects the 5-bit brightness of every LED together with its 8-bit color values, so
+     *          that dark colors keep the full 8-bit resolution.
+     */
+    RASPI_APA102_CORRECTION_BRIGHTNESS = 1 << 0,
+    /**
+     * @brief   Carries the quantization error of every LED over to the next frame (temporal
+     *          dithering), which adds about 8 bits of effective depth at high frame rates.
+     */
+    RASPI_APA102_CORRECTION_DITHERING  = 1 << 1
+} RaspiAPA102CorrectionFlags;
+
+/**
+ * @brief   Defines the `RaspiAPA102Correction` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102Correction_
+{
+    /**
+     * @brief   The red, green and blue lookup tables. Every entry maps an 8-bit input value to a
+     *          linear 8.8 fixed-point value (`0` to `255 * 256`).
+     */
+    uint16_t lut[3][256];
+    /**
+     * @brief   The red, green and blue white balance factors for 16-bit linear input (16.16
+     *          fixed-point, already including the conversion to the 8.8 fixed-point range).
+     */
+    uint32_t white[3];
+    /**
+     * @brief   The gamma exponent.
+     */
+    float gamma;
+    /**
+     * @brief   The red, green and blue white balance factors.
+     */
+    float white_balance[3];
+    /**
+     * @brief   The `RaspiAPA102CorrectionFlags`.
+     */
+    uint32_t flags;
+    /**
+     * @brief   The quantization error of the last frame (3 bytes per LED), or `NULL`, if temporal
+     *          dithering is disabled.
+     */
+    uint8_t* error;
+    /**
+     * @brief   The maximum number of LEDs.
+     */
+    size_t count;
+} RaspiAPA102Correction;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Correction                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102Correction` struct.
+ *
+ * @param   correction  A pointer to the `RaspiAPA102Correction` struct.
+ * @param   count       The maximum number of LEDs processed per frame.
+ * @param   gamma       The gamma exponent (e.g. `2.2`, or `1.0` to disable gamma correction).
+ * @param   flags       A combination of `RaspiAPA102CorrectionFlags`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CorrectionInit(RaspiAPA102Correction* correction, size_t count,
+    float gamma, uint32_t flags);
+
+/**
+ * @brief   Sets the gamma exponent and rebuilds the lookup tables.
+ *
+ * @param   correction  A pointer to the `RaspiAPA102Correction` struct.
+ * @param   gamma       The gamma exponent.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CorrectionSetGamma(RaspiAPA102Correction* correction,
+    float gamma);
+
+/**
+ * @brief   Sets the white balance and rebuilds the lookup tables.
+ *
+ * @param   correction  A pointer to the `RaspiAPA102Correction` struct.
+ * @param   r           The red scale factor (`0.0` to `1.0`).
+ * @param   g           The green scale factor (`0.0` to `1.0`).
+ * @param   b           The blue scale factor (`0.0` to `1.0`).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CorrectionSetWhiteBalance(RaspiAPA102Correction* correction,
+    float r, float g, float b);
+
+/**
+ * @brief   Corrects the given color quads in place.
+ *
+ * @param   correction  A pointer to the `RaspiAPA102Correction` struct.
+ * @param   quads       A pointer to the color quads.
+ * @param   count       The number of color quads.
+ *
+ * The color values of every quad are passed through the lookup tables. The brightness field acts
+ * as the global brightness: it is kept as is or, with `RASPI_APA102_CORRECTION_BRIGHTNESS`,
+ * scales the linear color before the brightness of the LED is selected.
+ *
+ * With temporal dithering enabled, the quads must always be passed in the same order.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CorrectionApply(RaspiAPA102Correction* correction,
+    RaspiAPA102ColorQuad* quads, size_t count);
+
+/**
+ * @brief   Converts the given 16-bit linear pixels to color quads.
+ *
+ * @param   correction  A pointer to the `RaspiAPA102Correction` struct.
+ * @param   quads       Receives the color quads.
+ * @param   pixels      A pointer to the source pixels (red, green and blue; `0` to `65535`).
+ * @param   count       The number of pixels.
+ * @param   brightness  The global LED brightness (0..31).
+ *
+ * The pixels are expected to be linear already, so only the white balance is applied.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CorrectionApply16(RaspiAPA102Correction* correction,
+    RaspiAPA102ColorQuad* quads, const uint16_t* pixels, size_t count, uint8_t brightness);
+
+/**
+ * @brief   Resets the temporal dithering state.
+ *
+ * @param   correction  A pointer to the `RaspiAPA102Correction` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CorrectionReset(RaspiAPA102Correction* correction);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102Correction` struct.
+ *
+ * @param   correction  A pointer to the `RaspiAPA102Correction` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CorrectionDestroy(RaspiAPA102Correction* correction);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CORRECTION_H */
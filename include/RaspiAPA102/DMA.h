@@ -0,0 +1,475 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a `DMA` driven output engine for the hardware `SPI` controller.
+ *
+ * The engine streams framed buffers from uncached memory to the `SPI0` controller of the 
+ * `BCM283x` without any CPU involvement. Two `DMA` channels are used: the `TX` channel fills the 
+ * `SPI` FIFO and the `RX` channel drains it. The `RX` channel also acts as the sequencer: after 
+ * every chunk it restarts the `TX` channel with the next chunk by writing the `TX` channel 
+ * registers, and after every frame it stores the sequence number of the frame in a status word. 
+ * Frames that are submitted while the engine is busy are linked to the end of the running chain, 
+ * so consecutive frames are put on the wire back to back.
+ *
+ * The peripheral registers and the `DMA` memory can be replaced by an in-memory region, which 
+ * allows to run the control block builder and the frame chaining against a simulated controller.
+ */
+
+#ifndef DMA_H
+#define DMA_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/Transport.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Macros                                                                                         */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Constants                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   The default `DMA` channel that fills the `SPI` FIFO.
+ */
+#define RASPI_APA102_DMA_DEFAULT_TX_CHANNEL 10
+
+/**
+ * @brief   The default `DMA` channel that drains the `SPI` FIFO.
+ */
+#define RASPI_APA102_DMA_DEFAULT_RX_CHANNEL 9
+
+/**
+ * @brief   The highest supported `DMA` channel.
+ *
+ * Channels `11` to `14` are `DMA4` engines with a different control block layout on the 
+ * `BCM2711`.
+ */
+#define RASPI_APA102_DMA_MAX_CHANNEL 10
+
+/**
+ * @brief   The number of frame slots. A slot can be reused once its frame is on the wire.
+ */
+#define RASPI_APA102_DMA_SLOT_COUNT 3
+
+/**
+ * @brief   The maximum number of bytes sent by a single `SPI` transfer (`DLEN` is 16 bits wide).
+ */
+#define RASPI_APA102_DMA_MAX_CHUNK 65532
+
+/**
+ * @brief   The number of control blocks per chunk (two `TX` and three `RX` control blocks).
+ */
+#define RASPI_APA102_DMA_BLOCKS_PER_CHUNK 5
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Registers                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   The bus address of the peripheral block as seen by the `DMA` controller.
+ */
+#define RASPI_APA102_DMA_BUS_PERIPHERALS 0x7E000000u
+
+/**
+ * @brief   The offset of the `DMA` controller registers inside the peripheral block.
+ */
+#define RASPI_APA102_DMA_OFFSET 0x7000u
+
+/**
+ * @brief   The distance between the register blocks of two `DMA` channels in bytes.
+ */
+#define RASPI_APA102_DMA_CHANNEL_SIZE 0x100u
+
+/**
+ * @brief   The offset of the `SPI0` controller registers inside the peripheral block.
+ */
+#define RASPI_APA102_DMA_SPI_OFFSET 0x204000u
+
+/**
+ * @brief   The size of a fake peripheral region in bytes. The region has to cover the `DMA` and 
+ *          the `SPI0` registers.
+ */
+#define RASPI_APA102_DMA_PERIPHERAL_SIZE (RASPI_APA102_DMA_SPI_OFFSET + 0x1000u)
+
+/**
+ * @brief   The index of the `CS` register of a `DMA` channel.
+ */
+#define RASPI_APA102_DMA_CS (0x00 / 4)
+
+/**
+ * @brief   The index of the `CONBLK_AD` register of a `DMA` channel.
+ */
+#define RASPI_APA102_DMA_CONBLK_AD (0x04 / 4)
+
+/**
+ * @brief   The index of the `NEXTCONBK` register of a `DMA` channel.
+ */
+#define RASPI_APA102_DMA_NEXTCONBK (0x1C / 4)
+
+/**
+ * @brief   The index of the `DEBUG` register of a `DMA` channel.
+ */
+#define RASPI_APA102_DMA_DEBUG (0x20 / 4)
+
+/**
+ * @brief   The index of the global `ENABLE` register of the `DMA` controller.
+ */
+#define RASPI_APA102_DMA_ENABLE (0xFF0 / 4)
+
+#define RASPI_APA102_DMA_CS_ACTIVE                      (1u << 0)
+#define RASPI_APA102_DMA_CS_END                         (1u << 1)
+#define RASPI_APA102_DMA_CS_ERROR                       (1u << 8)
+#define RASPI_APA102_DMA_CS_PRIORITY(x)                 ((uint32_t)(x) << 16)
+#define RASPI_APA102_DMA_CS_PANIC_PRIORITY(x)           ((uint32_t)(x) << 20)
+#define RASPI_APA102_DMA_CS_WAIT_FOR_OUTSTANDING_WRITES (1u << 28)
+#define RASPI_APA102_DMA_CS_ABORT                       (1u << 30)
+#define RASPI_APA102_DMA_CS_RESET                       (1u << 31)
+
+#define RASPI_APA102_DMA_TI_WAIT_RESP                   (1u << 3)
+#define RASPI_APA102_DMA_TI_DEST_INC                    (1u << 4)
+#define RASPI_APA102_DMA_TI_DEST_DREQ                   (1u << 6)
+#define RASPI_APA102_DMA_TI_SRC_INC                     (1u << 8)
+#define RASPI_APA102_DMA_TI_SRC_DREQ                    (1u << 10)
+#define RASPI_APA102_DMA_TI_PERMAP(x)                   ((uint32_t)(x) << 16)
+
+/**
+ * @brief   The peripheral number of the `SPI` transmit data request.
+ */
+#define RASPI_APA102_DMA_DREQ_SPI_TX 6
+
+/**
+ * @brief   The peripheral number of the `SPI` receive data request.
+ */
+#define RASPI_APA102_DMA_DREQ_SPI_RX 7
+
+/**
+ * @brief   The index of the `CS` register of the `SPI` controller.
+ */
+#define RASPI_APA102_SPI_CS (0x00 / 4)
+
+/**
+ * @brief   The index of the `FIFO` register of the `SPI` controller.
+ */
+#define RASPI_APA102_SPI_FIFO (0x04 / 4)
+
+/**
+ * @brief   The index of the `CLK` register of the `SPI` controller.
+ */
+#define RASPI_APA102_SPI_CLK (0x08 / 4)
+
+#define RASPI_APA102_SPI_CS_CLEAR_TX                    (1u << 4)
+#define RASPI_APA102_SPI_CS_CLEAR_RX                    (1u << 5)
+#define RASPI_APA102_SPI_CS_TA                          (1u << 7)
+#define RASPI_APA102_SPI_CS_DMAEN                       (1u << 8)
+#define RASPI_APA102_SPI_CS_ADCS                        (1u << 11)
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102DMAControlBlock` struct.
+ *
+ * Control blocks have to be aligned to 32 bytes. All addresses are bus addresses.
+ */
+typedef struct RaspiAPA102DMAControlBlock_
+{
+    /**
+     * @brief   The transfer information (`TI`).
+     */
+    uint32_t transfer_info;
+    /**
+     * @brief   The source address.
+     */
+    uint32_t source;
+    /**
+     * @brief   The destination address.
+     */
+    uint32_t destination;
+    /**
+     * @brief   The transfer length in bytes.
+     */
+    uint32_t length;
+    /**
+     * @brief   The `2D` stride (unused).
+     */
+    uint32_t stride;
+    /**
+     * @brief   The address of the next control block, or `0` to stop the channel.
+     */
+    uint32_t next;
+    /**
+     * @brief   Reserved.
+     */
+    uint32_t reserved[2];
+} RaspiAPA102DMAControlBlock;
+
+/**
+ * @brief   Defines the `RaspiAPA102DMARegion` struct.
+ *
+ * Describes an in-memory replacement for the peripheral registers and the uncached `DMA` memory.
+ */
+typedef struct RaspiAPA102DMARegion_
+{
+    /**
+     * @brief   The peripheral block (at least `RASPI_APA102_DMA_PERIPHERAL_SIZE` bytes).
+     */
+    volatile uint32_t* peripherals;
+    /**
+     * @brief   The `DMA` memory (32 byte aligned).
+     */
+    uint8_t* memory;
+    /**
+     * @brief   The bus address of the `DMA` memory (32 byte aligned).
+     */
+    uint32_t memory_bus;
+    /**
+     * @brief   The size of the `DMA` memory in bytes (see `RaspiAPA102DMAGetMemorySize`).
+     */
+    size_t memory_size;
+} RaspiAPA102DMARegion;
+
+/**
+ * @brief   Defines the `RaspiAPA102DMA` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102DMA_
+{
+    /**
+     * @brief   The register block of the `TX` channel.
+     */
+    volatile uint32_t* tx;
+    /**
+     * @brief   The register block of the `RX` channel.
+     */
+    volatile uint32_t* rx;
+    /**
+     * @brief   The register block of the `SPI` controller.
+     */
+    volatile uint32_t* spi;
+    /**
+     * @brief   The mapping of the `DMA` registers, or `NULL` if the region was provided by the 
+     *          caller.
+     */
+    void* dma_mapping;
+    /**
+     * @brief   The mapping of the `SPI` registers, or `NULL` if the region was provided by the 
+     *          caller.
+     */
+    void* spi_mapping;
+    /**
+     * @brief   The `DMA` memory.
+     */
+    uint8_t* memory;
+    /**
+     * @brief   The bus address of the `DMA` memory.
+     */
+    uint32_t memory_bus;
+    /**
+     * @brief   The size of the `DMA` memory in bytes.
+     */
+    size_t memory_size;
+    /**
+     * @brief   The file descriptor of the mailbox, or `-1` if the memory was provided by the 
+     *          caller.
+     */
+    int mailbox;
+    /**
+     * @brief   The mailbox handle of the `DMA` memory.
+     */
+    uint32_t memory_handle;
+    /**
+     * @brief   The `TX` channel.
+     */
+    int tx_channel;
+    /**
+     * @brief   The `RX` channel.
+     */
+    int rx_channel;
+    /**
+     * @brief   The maximum size of a framed buffer in bytes.
+     */
+    size_t capacity;
+    /**
+     * @brief   The size of a frame slot in bytes.
+     */
+    size_t slot_size;
+    /**
+     * @brief   The offset of the control blocks inside a frame slot.
+     */
+    size_t blocks_offset;
+    /**
+     * @brief   The offset of the framed buffer inside a frame slot.
+     */
+    size_t data_offset;
+    /**
+     * @brief   The sequence number of the last submitted frame.
+     */
+    uint32_t sequence;
+    /**
+     * @brief   The last control block of the last submitted frame, or `NULL`.
+     */
+    RaspiAPA102DMAControlBlock* last;
+    /**
+     * @brief   The number of bytes written through the transport since the last flush.
+     */
+    size_t pending;
+} RaspiAPA102DMA;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* DMA                                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the size of the `DMA` memory required for the given frame capacity.
+ *
+ * @param   capacity    The maximum size of a framed buffer in bytes.
+ * @param   size        Receives the size of the `DMA` memory in bytes.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DMAGetMemorySize(size_t capacity, size_t* size);
+
+/**
+ * @brief   Initializes the given `RaspiAPA102DMA` struct.
+ *
+ * @param   dma         A pointer to the `RaspiAPA102DMA` struct.
+ * @param   region      A pointer to a `RaspiAPA102DMARegion` struct, or `NULL` to map the 
+ *                      peripheral registers (`/dev/mem`) and to allocate uncached memory through
+ *                      the `VideoCore` mailbox (`/dev/vcio`).
+ * @param   tx_channel  The `DMA` channel that fills the `SPI` FIFO.
+ * @param   rx_channel  The `DMA` channel that drains the `SPI` FIFO.
+ * @param   capacity    The maximum size of a framed buffer in bytes.
+ * @param   speed_hz    The `SPI` clock frequency in Hz.
+ *
+ * The `SPI0` pins have to be in `ALT0` mode (e.g. `dtparam=spi=on`) and the `spidev` driver must 
+ * not be used at the same time. Access to the hardware requires root privileges.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DMAInit(RaspiAPA102DMA* dma, const RaspiAPA102DMARegion* region, 
+    int tx_channel, int rx_channel, size_t capacity, uint32_t speed_hz);
+
+/**
+ * @brief   Returns the framed buffer of the next free frame slot.
+ *
+ * @param   dma     A pointer to the `RaspiAPA102DMA` struct.
+ * @param   frame   Receives a pointer to the framed buffer inside the `DMA` memory.
+ *
+ * Waits until the frame that previously occupied the slot is on the wire. The buffer holds 
+ * `capacity` bytes and keeps its contents from the last use of the slot.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DMAGetFrame(RaspiAPA102DMA* dma, uint8_t** frame);
+
+/**
+ * @brief   Queues the framed buffer returned by `RaspiAPA102DMAGetFrame`.
+ *
+ * @param   dma     A pointer to the `RaspiAPA102DMA` struct.
+ * @param   size    The size of the frame in bytes. The frame is padded to a multiple of 4 bytes
+ *                  by repeating its last byte.
+ *
+ * Builds the control block chain of the frame and links it to the end of the running chain, or 
+ * starts the engine if it is idle. This function does not wait for the transfer.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DMASubmit(RaspiAPA102DMA* dma, size_t size);
+
+/**
+ * @brief   Waits until all submitted frames are on the wire.
+ *
+ * @param   dma A pointer to the `RaspiAPA102DMA` struct.
+ *
+ * @return  A status code. Fails, if a `DMA` channel signals an error.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DMAWait(RaspiAPA102DMA* dma);
+
+/**
+ * @brief   Returns the sequence number of the last frame that is on the wire.
+ *
+ * @param   dma         A pointer to the `RaspiAPA102DMA` struct.
+ * @param   sequence    Receives the sequence number. The first submitted frame has the sequence 
+ *                      number `1`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DMAGetCompleted(const RaspiAPA102DMA* dma, uint32_t* sequence);
+
+/**
+ * @brief   Returns a transport that writes to the given `RaspiAPA102DMA` struct.
+ *
+ * @param   dma         A pointer to the `RaspiAPA102DMA` struct.
+ * @param   transport   Receives the transport.
+ *
+ * The transport copies all writes of a frame into the next free frame slot and submits it on 
+ * `flush`. Unlike other transports, `flush` returns as soon as the frame is queued.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DMAGetTransport(RaspiAPA102DMA* dma, 
+    RaspiAPA102Transport* transport);
+
+/**
+ * @brief   Stops the engine and releases all resources held by the given `RaspiAPA102DMA` 
+ *          struct.
+ *
+ * @param   dma A pointer to the `RaspiAPA102DMA` struct.
+ *
+ * Frames that are not on the wire yet are discarded.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DMADestroy(RaspiAPA102DMA* dma);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DMA_H */
@@ -0,0 +1,190 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides effect kernels that render time-parameterized patterns into color quads.
+ */
+
+#ifndef EFFECT_H
+#define EFFECT_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/ThreadPool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102EffectType` enum.
+ */
+typedef enum RaspiAPA102EffectType_
+{
+    /**
+     * @brief   A fully saturated hue wheel that repeats every `scale` pixels and moves along the 
+     *          string.
+     */
+    RASPI_APA102_EFFECT_RAINBOW,
+    /**
+     * @brief   Heads of the first color followed by a fading tail on a background of the second 
+     *          color, one every `scale` pixels.
+     */
+    RASPI_APA102_EFFECT_CHASE,
+    /**
+     * @brief   A gradient from the first to the second color and back, `scale` pixels long.
+     */
+    RASPI_APA102_EFFECT_GRADIENT,
+    /**
+     * @brief   Smooth value noise between the first and the second color with a feature size of
+     *          `scale` pixels that evolves over time.
+     */
+    RASPI_APA102_EFFECT_NOISE,
+    /**
+     * @brief   Flickering flames that rise from the start of every `scale` pixels long section.
+     */
+    RASPI_APA102_EFFECT_FIRE,
+    /**
+     * @brief   Maximum value of this enum.
+     */
+    RASPI_APA102_EFFECT_MAX_VALUE = RASPI_APA102_EFFECT_FIRE
+} RaspiAPA102EffectType;
+
+/**
+ * @brief   Defines the `RaspiAPA102Effect` struct.
+ *
+ * Every pixel of an effect only depends on its position and the time, so any range of a canvas 
+ * can be rendered independently of the others.
+ */
+typedef struct RaspiAPA102Effect_
+{
+    /**
+     * @brief   The effect type.
+     */
+    RaspiAPA102EffectType type;
+    /**
+     * @brief   The first and the second color. The brightness of the colors is ignored.
+     */
+    RaspiAPA102ColorQuad colors[2];
+    /**
+     * @brief   The size of the pattern in pixels (e.g. the length of a full hue wheel).
+     */
+    float scale;
+    /**
+     * @brief   The speed of the pattern in patterns per second. Negative values reverse the 
+     *          direction.
+     */
+    float speed;
+    /**
+     * @brief   The seed of the noise based effects.
+     */
+    uint32_t seed;
+    /**
+     * @brief   The global LED brightness (0..31).
+     */
+    uint8_t brightness;
+} RaspiAPA102Effect;
+
+/* ============================================================================================== */
+/* Macros                                                                                         */
+/* ============================================================================================== */
+
+/**
+ * @brief   The number of pixels per tile of `RaspiAPA102EffectRenderParallel`.
+ */
+#define RASPI_APA102_EFFECT_TILE_SIZE 512
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Effect                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102Effect` struct with the defaults of the given type.
+ *
+ * @param   effect  A pointer to the `RaspiAPA102Effect` struct.
+ * @param   type    The effect type.
+ *
+ * The defaults are a pattern size of 60 pixels, a speed of one pattern per second, full 
+ * brightness and white on black.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102EffectInit(RaspiAPA102Effect* effect, 
+    RaspiAPA102EffectType type);
+
+/**
+ * @brief   Renders a range of pixels of the given effect.
+ *
+ * @param   effect  A pointer to the `RaspiAPA102Effect` struct.
+ * @param   quads   Receives the color quads of the range.
+ * @param   offset  The position of the first pixel of the range on the canvas.
+ * @param   count   The number of pixels in the range.
+ * @param   time_ns The time in nanoseconds.
+ *
+ * The rendered pixels do not depend on how the canvas is split into ranges.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102EffectRender(const RaspiAPA102Effect* effect, 
+    RaspiAPA102ColorQuad* quads, size_t offset, size_t count, uint64_t time_ns);
+
+/**
+ * @brief   Renders the given effect into a canvas using all threads of the given pool.
+ *
+ * @param   effect  A pointer to the `RaspiAPA102Effect` struct.
+ * @param   pool    A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   quads   Receives the color quads of the canvas.
+ * @param   count   The number of pixels on the canvas.
+ * @param   time_ns The time in nanoseconds.
+ *
+ * The canvas is split into tiles of `RASPI_APA102_EFFECT_TILE_SIZE` pixels. The result is the same
+ * as rendering the whole canvas with `RaspiAPA102EffectRender`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102EffectRenderParallel(const RaspiAPA102Effect* effect, 
+    RaspiAPA102ThreadPool* pool, RaspiAPA102ColorQuad* quads, size_t count, uint64_t time_ns);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EFFECT_H */
@@ -0,0 +1,378 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a shared memory ring buffer to receive frames from other processes.
+ *
+ * The ring lives in a POSIX shared memory object or a memory mapped file and has the following 
+ * layout (all values in native byte order):
+ *
+ * | Offset                      | Size          | Content                                       |
+ * |-----------------------------|---------------|-----------------------------------------------|
+ * | `0`                         | `192`         | `RaspiAPA102FrameRingHeader`                  |
+ * | `header_size + n*slot_size` | `64`          | `RaspiAPA102FrameRingSlot` of slot `n`        |
+ * | `... + 64`                  | `count * 4`   | `RaspiAPA102ColorQuad` array of slot `n`      |
+ *
+ * Protocol (single producer, single consumer):
+ * - The producer may write frame `w` (`w = write_sequence`) into slot `w & (slot_count - 1)` as
+ *   long as `w - read_sequence < slot_count`. It fills the slot, stores `sequence` and 
+ *   `publish_ns` and then increments `write_sequence` with release semantics.
+ * - The consumer loads `write_sequence` with acquire semantics. If it differs from the last seen 
+ *   value, it stores `write_sequence - 1` (the newest frame) to `read_sequence` and reads that 
+ *   slot. The slot stays valid until the consumer stores a new `read_sequence`. Older frames are 
+ *   dropped.
+ *
+ * Sequence counters are 32-bit and wrap around; all comparisons use unsigned differences.
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   The value of `RaspiAPA102FrameRingHeader.magic` (`"A102"`).
+ */
+#define RASPI_APA102_FRAME_RING_MAGIC 0x32303141
+
+/**
+ * @brief   The value of `RaspiAPA102FrameRingHeader.version`.
+ */
+#define RASPI_APA102_FRAME_RING_VERSION 1
+
+/**
+ * @brief   The access mode of frame rings created by `RaspiAPA102FrameRingCreate` and 
+ *          `RaspiAPA102FrameRingCreateFile` (owner only).
+ */
+#define RASPI_APA102_FRAME_RING_DEFAULT_MODE 0600
+
+/**
+ * @brief   Defines the `RaspiAPA102FrameRingFlags` enum.
+ */
+typedef enum RaspiAPA102FrameRingFlags_
+{
+    /**
+     * @brief   Replaces an existing frame ring with the same name (e.g. left behind by a crashed 
+     *          process). A consumer that still maps the old ring keeps reading from it.
+     */
+    RASPI_APA102_FRAME_RING_REPLACE = 1 << 0
+} RaspiAPA102FrameRingFlags;
+
+/**
+ * @brief   Defines the `RaspiAPA102FrameRingHeader` struct.
+ *
+ * The sequence counters are placed in separate cache lines.
+ */
+typedef struct RaspiAPA102FrameRingHeader_
+{
+    /**
+     * @brief   The magic value `RASPI_APA102_FRAME_RING_MAGIC`.
+     */
+    uint32_t magic;
+    /**
+     * @brief   The layout version `RASPI_APA102_FRAME_RING_VERSION`.
+     */
+    uint32_t version;
+    /**
+     * @brief   The size of the header in bytes (offset of the first slot).
+     */
+    uint32_t header_size;
+    /**
+     * @brief   The number of slots (a power of two).
+     */
+    uint32_t slot_count;
+    /**
+     * @brief   The size of a single slot in bytes (a multiple of `64`).
+     */
+    uint64_t slot_size;
+    /**
+     * @brief   The number of LEDs per frame.
+     */
+    uint64_t pixel_count;
+    /**
+     * @brief   Reserved.
+     */
+    uint8_t reserved0[32];
+    /**
+     * @brief   The number of published frames. Only written by the producer.
+     */
+    uint32_t write_sequence;
+    /**
+     * @brief   Reserved.
+     */
+    uint8_t reserved1[60];
+    /**
+     * @brief   The sequence of the frame currently used by the consumer. Only written by the 
+     *          consumer.
+     */
+    uint32_t read_sequence;
+    /**
+     * @brief   Reserved.
+     */
+    uint8_t reserved2[60];
+} RaspiAPA102FrameRingHeader;
+
+/**
+ * @brief   Defines the `RaspiAPA102FrameRingSlot` struct.
+ */
+typedef struct RaspiAPA102FrameRingSlot_
+{
+    /**
+     * @brief   The sequence of the frame stored in this slot.
+     */
+    uint32_t sequence;
+    /**
+     * @brief   Reserved.
+     */
+    uint32_t reserved0;
+    /**
+     * @brief   The time the frame was published (`CLOCK_MONOTONIC`) in nanoseconds.
+     */
+    uint64_t publish_ns;
+    /**
+     * @brief   Reserved.
+     */
+    uint8_t reserved1[48];
+} RaspiAPA102FrameRingSlot;
+
+/**
+ * @brief   Defines the `RaspiAPA102FrameRing` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102FrameRing_
+{
+    /**
+     * @brief   The mapped ring.
+     */
+    RaspiAPA102FrameRingHeader* header;
+    /**
+     * @brief   The size of the mapping in bytes.
+     */
+    size_t size;
+    /**
+     * @brief   The name of the shared memory object, if it was created by this process (it is 
+     *          removed on destruction), or `NULL`.
+     */
+    char* name;
+    /**
+     * @brief   The last `write_sequence` seen by the consumer.
+     */
+    uint32_t consumed;
+} RaspiAPA102FrameRing;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Lifecycle                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Creates a new frame ring in a POSIX shared memory object.
+ *
+ * @param   ring        A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   name        The name of the shared memory object (e.g. `/apa102`).
+ * @param   count       The number of LEDs per frame.
+ * @param   slot_count  The number of slots (a power of two, at least `2`).
+ *
+ * The object is only accessible by the owner (`RASPI_APA102_FRAME_RING_DEFAULT_MODE`). Fails, if
+ * an object with the same name already exists.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingCreate(RaspiAPA102FrameRing* ring, const char* name, 
+    size_t count, uint32_t slot_count);
+
+/**
+ * @brief   Creates a new frame ring in a POSIX shared memory object with the given access mode.
+ *
+ * @param   ring        A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   name        The name of the shared memory object (e.g. `/apa102`).
+ * @param   count       The number of LEDs per frame.
+ * @param   slot_count  The number of slots (a power of two, at least `2`).
+ * @param   mode        The access mode of the object (e.g. `0660` to let a producer of the same 
+ *                      group write frames). The mode is subject to the `umask`.
+ * @param   flags       A combination of `RaspiAPA102FrameRingFlags`.
+ *
+ * Fails, if an object with the same name already exists, unless `RASPI_APA102_FRAME_RING_REPLACE`
+ * is passed.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingCreateEx(RaspiAPA102FrameRing* ring, 
+    const char* name, size_t count, uint32_t slot_count, mode_t mode, uint32_t flags);
+
+/**
+ * @brief   Opens an existing frame ring in a POSIX shared memory object.
+ *
+ * @param   ring    A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   name    The name of the shared memory object.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingOpen(RaspiAPA102FrameRing* ring, const char* name);
+
+/**
+ * @brief   Creates a new frame ring in a memory mapped file.
+ *
+ * @param   ring        A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   path        The path of the file.
+ * @param   count       The number of LEDs per frame.
+ * @param   slot_count  The number of slots (a power of two, at least `2`).
+ *
+ * The file is only accessible by the owner (`RASPI_APA102_FRAME_RING_DEFAULT_MODE`). Fails, if 
+ * the file already exists.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingCreateFile(RaspiAPA102FrameRing* ring, 
+    const char* path, size_t count, uint32_t slot_count);
+
+/**
+ * @brief   Creates a new frame ring in a memory mapped file with the given access mode.
+ *
+ * @param   ring        A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   path        The path of the file.
+ * @param   count       The number of LEDs per frame.
+ * @param   slot_count  The number of slots (a power of two, at least `2`).
+ * @param   mode        The access mode of the file. The mode is subject to the `umask`.
+ * @param   flags       A combination of `RaspiAPA102FrameRingFlags`.
+ *
+ * Fails, if the file already exists, unless `RASPI_APA102_FRAME_RING_REPLACE` is passed. An 
+ * existing file is unlinked and never truncated, so a consumer that still maps it does not fault.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingCreateFileEx(RaspiAPA102FrameRing* ring, 
+    const char* path, size_t count, uint32_t slot_count, mode_t mode, uint32_t flags);
+
+/**
+ * @brief   Opens an existing frame ring in a memory mapped file.
+ *
+ * @param   ring    A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   path    The path of the file.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingOpenFile(RaspiAPA102FrameRing* ring, 
+    const char* path);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102FrameRing` struct.
+ *
+ * @param   ring    A pointer to the `RaspiAPA102FrameRing` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingDestroy(RaspiAPA102FrameRing* ring);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Producer                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the slot for the next frame.
+ *
+ * @param   ring    A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   quads   Receives a pointer to the color quads of the slot, or `NULL`, if all slots 
+ *                  are in use (the consumer is behind).
+ * @param   count   Receives the number of LEDs. This parameter is optional.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingBeginWrite(RaspiAPA102FrameRing* ring, 
+    RaspiAPA102ColorQuad** quads, size_t* count);
+
+/**
+ * @brief   Publishes the frame written to the slot returned by `RaspiAPA102FrameRingBeginWrite`.
+ *
+ * @param   ring    A pointer to the `RaspiAPA102FrameRing` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingPublish(RaspiAPA102FrameRing* ring);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Consumer                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the newest published frame.
+ *
+ * @param   ring        A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   quads       Receives a pointer to the color quads of the frame, or `NULL`, if no new 
+ *                      frame was published since the last call.
+ * @param   count       Receives the number of LEDs. This parameter is optional.
+ * @param   sequence    Receives the sequence of the frame. This parameter is optional.
+ * @param   publish_ns  Receives the time the frame was published. This parameter is optional.
+ *
+ * The returned frame stays valid until the next call to this function.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingAcquire(RaspiAPA102FrameRing* ring, 
+    const RaspiAPA102ColorQuad** quads, size_t* count, uint32_t* sequence, uint64_t* publish_ns);
+
+/**
+ * @brief   Sends the newest published frame to the given device without copying it.
+ *
+ * @param   ring        A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   device      A pointer to the `RaspiAPA102Device` struct.
+ * @param   updated     Receives `true`, if a new frame was sent or `false`, if not.
+ * @param   latency_ns  Receives the time from publishing the frame until it was on the wire in 
+ *                      nanoseconds. This parameter is optional.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102FrameRingUpdateDevice(RaspiAPA102FrameRing* ring, 
+    const RaspiAPA102Device* device, bool* updated, uint64_t* latency_ns);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_RING_H */
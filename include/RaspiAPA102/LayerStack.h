@@ -0,0 +1,391 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a stack of blended layers that only re-renders and recomposes modified pixels.
+ */
+
+#ifndef LAYER_STACK_H
+#define LAYER_STACK_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/SIMD.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102BlendMode` enum.
+ *
+ * The blended color of every mode is mixed into the layers below with the opacity of the layer
+ * times the coverage of the pixel.
+ */
+typedef enum RaspiAPA102BlendMode_
+{
+    /**
+     * @brief   The layer covers the layers below.
+     */
+    RASPI_APA102_BLEND_ALPHA,
+    /**
+     * @brief   The layer is added to the layers below (saturating).
+     */
+    RASPI_APA102_BLEND_ADD,
+    /**
+     * @brief   The layers below are multiplied by the layer.
+     */
+    RASPI_APA102_BLEND_MULTIPLY,
+    /**
+     * @brief   The brighter of the layer and the layers below is kept per component.
+     */
+    RASPI_APA102_BLEND_MAX,
+
+    /**
+     * @brief   Maximum value of this enum.
+     */
+    RASPI_APA102_BLEND_MAX_VALUE = RASPI_APA102_BLEND_MAX
+} RaspiAPA102BlendMode;
+
+/**
+ * @brief   Defines the `RaspiAPA102LayerRender` function prototype.
+ *
+ * @param   context The context passed to `RaspiAPA102LayerStackAddLayer`.
+ * @param   quads   Receives the pixels of the range.
+ * @param   offset  The position of the first pixel of the range.
+ * @param   count   The number of pixels in the range.
+ *
+ * The signature matches `RaspiAPA102EffectRender` apart from the time, so an effect can be 
+ * rendered into a layer by a thin wrapper.
+ *
+ * @return  A status code.
+ */
+typedef int (*RaspiAPA102LayerRender)(void* context, RaspiAPA102ColorQuad* quads, size_t offset,
+    size_t count);
+
+/**
+ * @brief   Defines the `RaspiAPA102Layer` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102Layer_
+{
+    /**
+     * @brief   The cached pixels of the layer. The brightness field of every pixel is its 
+     *          coverage (`0` = transparent, `31` = opaque).
+     */
+    RaspiAPA102ColorQuad* pixels;
+    /**
+     * @brief   The render callback, or `NULL` if the application writes the pixels directly.
+     */
+    RaspiAPA102LayerRender render;
+    /**
+     * @brief   The context passed to the render callback.
+     */
+    void* context;
+    /**
+     * @brief   The blend mode.
+     */
+    RaspiAPA102BlendMode mode;
+    /**
+     * @brief   The opacity (`0` to `255`).
+     */
+    uint8_t opacity;
+    /**
+     * @brief   Signals, if the layer is visible.
+     */
+    bool visible;
+    /**
+     * @brief   The first modified pixel.
+     */
+    size_t dirty_begin;
+    /**
+     * @brief   The position behind the last modified pixel (`0` if nothing was modified).
+     */
+    size_t dirty_end;
+} RaspiAPA102Layer;
+
+/**
+ * @brief   Defines the `RaspiAPA102LayerStackStats` struct.
+ */
+typedef struct RaspiAPA102LayerStackStats_
+{
+    /**
+     * @brief   The number of composed frames.
+     */
+    uint64_t frames;
+    /**
+     * @brief   The number of pixels recomposed by the last frame.
+     */
+    uint64_t recomposed;
+    /**
+     * @brief   The total number of recomposed pixels.
+     */
+    uint64_t recomposed_total;
+    /**
+     * @brief   The number of layer pixels re-rendered by the last frame.
+     */
+    uint64_t rendered;
+    /**
+     * @brief   The total number of re-rendered layer pixels.
+     */
+    uint64_t rendered_total;
+} RaspiAPA102LayerStackStats;
+
+/**
+ * @brief   Defines the `RaspiAPA102LayerStack` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102LayerStack_
+{
+    /**
+     * @brief   The layers, from bottom to top.
+     */
+    RaspiAPA102Layer* layers;
+    /**
+     * @brief   The number of layers.
+     */
+    size_t layer_count;
+    /**
+     * @brief   The maximum number of layers.
+     */
+    size_t layer_capacity;
+    /**
+     * @brief   The number of pixels of every layer.
+     */
+    size_t count;
+    /**
+     * @brief   The composed pixels.
+     */
+    RaspiAPA102ColorQuad* output;
+    /**
+     * @brief   The brightness byte of the composed pixels.
+     */
+    uint8_t header;
+    /**
+     * @brief   The first pixel that has to be recomposed regardless of the layers.
+     */
+    size_t dirty_begin;
+    /**
+     * @brief   The position behind the last pixel that has to be recomposed regardless of the 
+     *          layers.
+     */
+    size_t dirty_end;
+    /**
+     * @brief   The selected blend implementation.
+     */
+    RaspiAPA102SIMDPath path;
+    /**
+     * @brief   The statistics.
+     */
+    RaspiAPA102LayerStackStats stats;
+} RaspiAPA102LayerStack;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Layer Stack                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102LayerStack` struct.
+ *
+ * @param   stack           A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   count           The number of pixels.
+ * @param   layer_capacity  The maximum number of layers.
+ * @param   brightness      The global LED brightness of the composed pixels (0..31).
+ *
+ * The fastest blend implementation supported by the current CPU is selected.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackInit(RaspiAPA102LayerStack* stack, size_t count, 
+    size_t layer_capacity, uint8_t brightness);
+
+/**
+ * @brief   Adds a layer on top of the given `RaspiAPA102LayerStack` struct.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   mode    The blend mode.
+ * @param   opacity The opacity (`0` to `255`).
+ * @param   render  The render callback, or `NULL` if the pixels are written with 
+ *                  `RaspiAPA102LayerStackGetPixels`.
+ * @param   context The context passed to the render callback.
+ * @param   index   Receives the index of the layer. This parameter is optional.
+ *
+ * The layer starts fully transparent and marked as modified.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackAddLayer(RaspiAPA102LayerStack* stack, 
+    RaspiAPA102BlendMode mode, uint8_t opacity, RaspiAPA102LayerRender render, void* context, 
+    size_t* index);
+
+/**
+ * @brief   Changes the blend mode and the opacity of the given layer.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   index   The index of the layer.
+ * @param   mode    The blend mode.
+ * @param   opacity The opacity (`0` to `255`).
+ *
+ * All pixels covered by the layer are recomposed by the next frame, without re-rendering it.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackSetBlend(RaspiAPA102LayerStack* stack, 
+    size_t index, RaspiAPA102BlendMode mode, uint8_t opacity);
+
+/**
+ * @brief   Shows or hides the given layer.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   index   The index of the layer.
+ * @param   visible Pass `true` to show the layer or `false` to hide it.
+ *
+ * Hidden layers are neither rendered nor blended. Modifications of a hidden layer are kept and 
+ * rendered as soon as it is shown again.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackSetVisible(RaspiAPA102LayerStack* stack, 
+    size_t index, bool visible);
+
+/**
+ * @brief   Returns the cached pixels of the given layer.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   index   The index of the layer.
+ * @param   pixels  Receives a pointer to the `RaspiAPA102ColorQuad` structs of the layer.
+ *
+ * The brightness field of every pixel is its coverage (`0` = transparent, `31` = opaque). 
+ * Modified pixels have to be passed to `RaspiAPA102LayerStackMarkDirty`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackGetPixels(RaspiAPA102LayerStack* stack, 
+    size_t index, RaspiAPA102ColorQuad** pixels);
+
+/**
+ * @brief   Marks a range of pixels of the given layer as modified.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   index   The index of the layer.
+ * @param   offset  The index of the first modified pixel.
+ * @param   count   The number of modified pixels.
+ *
+ * The next frame re-renders the range of the layer (if it has a render callback) and recomposes 
+ * it together with all other layers.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackMarkDirty(RaspiAPA102LayerStack* stack, 
+    size_t index, size_t offset, size_t count);
+
+/**
+ * @brief   Selects the blend implementation used by the given `RaspiAPA102LayerStack` struct.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   path    The implementation.
+ *
+ * This function fails, if the implementation is not supported by the current CPU.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackSetPath(RaspiAPA102LayerStack* stack, 
+    RaspiAPA102SIMDPath path);
+
+/**
+ * @brief   Re-renders the modified layers and recomposes the affected pixels.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   offset  Receives the index of the first recomposed pixel. This parameter is optional.
+ * @param   count   Receives the number of recomposed pixels (`0`, if nothing changed). This 
+ *                  parameter is optional.
+ *
+ * The recomposed range is the union of the modified ranges of all layers. Pixels outside of it
+ * keep their previous value, so only that range has to be copied to the transmit buffer (and 
+ * passed to `RaspiAPA102DeviceMarkDirty`).
+ *
+ * @return  A status code (`-1`, if any render callback failed).
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackCompose(RaspiAPA102LayerStack* stack, 
+    size_t* offset, size_t* count);
+
+/**
+ * @brief   Returns the composed pixels of the given `RaspiAPA102LayerStack` struct.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   output  Receives a pointer to the composed `RaspiAPA102ColorQuad` structs.
+ * @param   count   Receives the number of pixels. This parameter is optional.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackGetOutput(const RaspiAPA102LayerStack* stack, 
+    const RaspiAPA102ColorQuad** output, size_t* count);
+
+/**
+ * @brief   Returns the statistics of the given `RaspiAPA102LayerStack` struct.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   stats   Receives the statistics.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackGetStats(const RaspiAPA102LayerStack* stack, 
+    RaspiAPA102LayerStackStats* stats);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102LayerStack` struct.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102LayerStackDestroy(RaspiAPA102LayerStack* stack);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAYER_STACK_H */
@@ -0,0 +1,254 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides functions to convert packed pixel arrays into `APA102` color quads in bulk.
+ */
+
+#ifndef PACKING_H
+#define PACKING_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/SIMD.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102PixelFormat` enum.
+ *
+ * Describes the byte layout of a single pixel in the source array.
+ */
+typedef enum RaspiAPA102PixelFormat_
+{
+    /**
+     * @brief   3 bytes per pixel: red, green, blue.
+     */
+    RASPI_APA102_PIXEL_FORMAT_RGB,
+    /**
+     * @brief   3 bytes per pixel: blue, green, red.
+     */
+    RASPI_APA102_PIXEL_FORMAT_BGR,
+    /**
+     * @brief   3 bytes per pixel: green, red, blue.
+     */
+    RASPI_APA102_PIXEL_FORMAT_GRB,
+    /**
+     * @brief   4 bytes per pixel: red, green, blue, alpha. The alpha channel is ignored.
+     */
+    RASPI_APA102_PIXEL_FORMAT_RGBA,
+    /**
+     * @brief   4 bytes per pixel: blue, green, red, alpha. The alpha channel is ignored.
+     */
+    RASPI_APA102_PIXEL_FORMAT_BGRA,
+    /**
+     * @brief   4 bytes per pixel: alpha, red, green, blue. The alpha channel is ignored.
+     */
+    RASPI_APA102_PIXEL_FORMAT_ARGB,
+
+    /**
+     * @brief   Maximum value of this enum.
+     */
+    RASPI_APA102_PIXEL_FORMAT_MAX_VALUE = RASPI_APA102_PIXEL_FORMAT_ARGB
+} RaspiAPA102PixelFormat;
+
+/**
+ * @brief   Defines the `RaspiAPA102ChannelOrder` enum.
+ *
+ * Describes the order in which the LEDs expect the color components on the wire. Genuine `APA102`
+ * LEDs use `BGR`, which matches the field layout of `RaspiAPA102ColorQuad`. For any other order
+ * the `r`, `g` and `b` fields of the packed quads no longer match their names.
+ */
+typedef enum RaspiAPA102ChannelOrder_
+{
+    /**
+     * @brief   Blue, green, red (native `APA102` order).
+     */
+    RASPI_APA102_CHANNEL_ORDER_BGR,
+    /**
+     * @brief   Blue, red, green.
+     */
+    RASPI_APA102_CHANNEL_ORDER_BRG,
+    /**
+     * @brief   Green, blue, red.
+     */
+    RASPI_APA102_CHANNEL_ORDER_GBR,
+    /**
+     * @brief   Green, red, blue.
+     */
+    RASPI_APA102_CHANNEL_ORDER_GRB,
+    /**
+     * @brief   Red, blue, green.
+     */
+    RASPI_APA102_CHANNEL_ORDER_RBG,
+    /**
+     * @brief   Red, green, blue.
+     */
+    RASPI_APA102_CHANNEL_ORDER_RGB,
+
+    /**
+     * @brief   Maximum value of this enum.
+     */
+    RASPI_APA102_CHANNEL_ORDER_MAX_VALUE = RASPI_APA102_CHANNEL_ORDER_RGB
+} RaspiAPA102ChannelOrder;
+
+/**
+ * @brief   Defines the `RaspiAPA102Packer` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102Packer_
+{
+    /**
+     * @brief   The source pixel format.
+     */
+    RaspiAPA102PixelFormat format;
+    /**
+     * @brief   The channel order on the wire.
+     */
+    RaspiAPA102ChannelOrder order;
+    /**
+     * @brief   The size of a single source pixel in bytes.
+     */
+    size_t stride;
+    /**
+     * @brief   The source byte offsets of the three color bytes following the brightness byte.
+     */
+    uint8_t offsets[3];
+    /**
+     * @brief   The brightness byte written to every quad.
+     */
+    uint8_t header;
+    /**
+     * @brief   The byte shuffle that packs 4 source pixels into 4 quads (the brightness bytes are
+     *          cleared).
+     */
+    uint8_t shuffle[16];
+    /**
+     * @brief   The selected implementation.
+     */
+    RaspiAPA102SIMDPath path;
+} RaspiAPA102Packer;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Packer                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102Packer` struct.
+ *
+ * @param   packer      A pointer to the `RaspiAPA102Packer` struct.
+ * @param   format      The source pixel format.
+ * @param   order       The channel order on the wire.
+ * @param   brightness  The global LED brightness (0..31).
+ *
+ * The fastest implementation supported by the current CPU is selected.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102PackerInit(RaspiAPA102Packer* packer,
+    RaspiAPA102PixelFormat format, RaspiAPA102ChannelOrder order, uint8_t brightness);
+
+/**
+ * @brief   Sets the global LED brightness.
+ *
+ * @param   packer      A pointer to the `RaspiAPA102Packer` struct.
+ * @param   brightness  The global LED brightness (0..31).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102PackerSetBrightness(RaspiAPA102Packer* packer,
+    uint8_t brightness);
+
+/**
+ * @brief   Selects the implementation used by the given `RaspiAPA102Packer` struct.
+ *
+ * @param   packer  A pointer to the `RaspiAPA102Packer` struct.
+ * @param   path    The implementation.
+ *
+ * This function fails, if the implementation is not supported by the current CPU.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102PackerSetPath(RaspiAPA102Packer* packer,
+    RaspiAPA102SIMDPath path);
+
+/**
+ * @brief   Converts the given pixels to color quads.
+ *
+ * @param   packer  A pointer to the `RaspiAPA102Packer` struct.
+ * @param   quads   A pointer to the destination quads.
+ * @param   pixels  A pointer to the source pixels.
+ * @param   count   The number of pixels.
+ *
+ * The source and destination arrays must not overlap. No alignment is required.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102PackerPack(const RaspiAPA102Packer* packer,
+    RaspiAPA102ColorQuad* quads, const uint8_t* pixels, size_t count);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Convenience                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Converts the given pixels to color quads in the native `APA102` channel order.
+ *
+ * @param   quads       A pointer to the destination quads.
+ * @param   pixels      A pointer to the source pixels.
+ * @param   count       The number of pixels.
+ * @param   format      The source pixel format.
+ * @param   brightness  The global LED brightness (0..31).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102PackPixels(RaspiAPA102ColorQuad* quads, const uint8_t* pixels,
+    size_t count, RaspiAPA102PixelFormat format, uint8_t brightness);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PACKING_H */
@@ -0,0 +1,338 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a receiver for `E1.31` (sACN) and `Art-Net` pixel streams on a local `UDP` or 
+ *          Unix datagram socket.
+ *
+ * Every universe carries the channels of `pixels_per_universe` consecutive LEDs, starting at 
+ * `first_universe`. Received universes are packed straight into the transmit buffer of the 
+ * device. A frame is sent as soon as all universes were received, or when a universe is received 
+ * a second time before that. After a synchronization packet (`ArtSync` or an `E1.31` 
+ * synchronization packet), frames are only sent on synchronization packets until no 
+ * synchronization packet was received for `RASPI_APA102_RECEIVER_SYNC_TIMEOUT` nanoseconds.
+ */
+
+#ifndef RECEIVER_H
+#define RECEIVER_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Packing.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   The default `UDP` port of `Art-Net`.
+ */
+#define RASPI_APA102_RECEIVER_ARTNET_PORT 6454
+
+/**
+ * @brief   The default `UDP` port of `E1.31`.
+ */
+#define RASPI_APA102_RECEIVER_E131_PORT 5568
+
+/**
+ * @brief   The default number of LEDs per universe (`510` of `512` channels for `RGB` data).
+ */
+#define RASPI_APA102_RECEIVER_DEFAULT_PIXELS_PER_UNIVERSE 170
+
+/**
+ * @brief   The time in nanoseconds after the last synchronization packet until frames are sent on 
+ *          completion again.
+ */
+#define RASPI_APA102_RECEIVER_SYNC_TIMEOUT 4000000000ULL
+
+/**
+ * @brief   The maximum number of datagrams received by a single system call.
+ */
+#define RASPI_APA102_RECEIVER_BATCH_SIZE 32
+
+/**
+ * @brief   Defines the `RaspiAPA102ReceiverStats` struct.
+ */
+typedef struct RaspiAPA102ReceiverStats_
+{
+    /**
+     * @brief   The number of received datagrams.
+     */
+    uint64_t packets;
+    /**
+     * @brief   The number of receive system calls that returned at least one datagram.
+     */
+    uint64_t batches;
+    /**
+     * @brief   The number of sent frames.
+     */
+    uint64_t frames;
+    /**
+     * @brief   The number of received synchronization packets.
+     */
+    uint64_t syncs;
+    /**
+     * @brief   The number of datagrams that are neither `E1.31` nor `Art-Net` packets.
+     */
+    uint64_t invalid;
+    /**
+     * @brief   The number of valid packets that were ignored (e.g. universes outside the 
+     *          configured range, preview data or unsupported opcodes).
+     */
+    uint64_t ignored;
+    /**
+     * @brief   The number of data packets with an unexpected sequence number.
+     */
+    uint64_t sequence_errors;
+    /**
+     * @brief   The minimum latency in nanoseconds.
+     */
+    uint64_t latency_min;
+    /**
+     * @brief   The maximum latency in nanoseconds.
+     */
+    uint64_t latency_max;
+    /**
+     * @brief   The sum of all latencies in nanoseconds.
+     */
+    uint64_t latency_sum;
+} RaspiAPA102ReceiverStats;
+
+/**
+ * @brief   Defines the `RaspiAPA102Receiver` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102Receiver_
+{
+    /**
+     * @brief   The socket, or `-1`.
+     */
+    int fd;
+    /**
+     * @brief   The path of the Unix socket, or `NULL`.
+     */
+    char* path;
+    /**
+     * @brief   The target device.
+     */
+    RaspiAPA102Device* device;
+    /**
+     * @brief   The transmit buffer of the device (queried for every packet).
+     */
+    RaspiAPA102ColorQuad* quads;
+    /**
+     * @brief   The number of LEDs.
+     */
+    size_t count;
+    /**
+     * @brief   The packer used to convert the channel data.
+     */
+    RaspiAPA102Packer packer;
+    /**
+     * @brief   The universe of the first LED.
+     */
+    uint16_t first_universe;
+    /**
+     * @brief   The number of LEDs per universe.
+     */
+    size_t pixels_per_universe;
+    /**
+     * @brief   The number of universes.
+     */
+    size_t universe_count;
+    /**
+     * @brief   A bitmap of the universes received for the current frame.
+     */
+    uint64_t* received;
+    /**
+     * @brief   The number of universes received for the current frame.
+     */
+    size_t received_count;
+    /**
+     * @brief   A bitmap of the universes with a known sequence number.
+     */
+    uint64_t* sequenced;
+    /**
+     * @brief   The last sequence number of every universe.
+     */
+    uint8_t* sequence;
+    /**
+     * @brief   The receive buffers and message headers of a batch.
+     */
+    void* batch;
+    /**
+     * @brief   The synchronization address of `E1.31` data packets, or `0`.
+     */
+    uint16_t sync_address;
+    /**
+     * @brief   The monotonic time in nanoseconds until which frames are only sent on 
+     *          synchronization packets.
+     */
+    uint64_t sync_until;
+    /**
+     * @brief   The receive time (`CLOCK_REALTIME`) of the first packet of the current frame.
+     */
+    uint64_t frame_start;
+    /**
+     * @brief   The index of the first LED changed in the current frame.
+     */
+    size_t dirty_first;
+    /**
+     * @brief   The index after the last LED changed in the current frame.
+     */
+    size_t dirty_last;
+    /**
+     * @brief   The statistics.
+     */
+    RaspiAPA102ReceiverStats stats;
+} RaspiAPA102Receiver;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Initializes a receiver on a `UDP` socket.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   device      A pointer to the `RaspiAPA102Device` struct. The transmit buffer of the 
+ *                      device has to be allocated. It is queried for every packet, so it may be 
+ *                      replaced between calls to `RaspiAPA102ReceiverPoll` (call 
+ *                      `RaspiAPA102ReceiverSetUniverses` to map the LEDs of a larger buffer).
+ * @param   address     The local `IPv4` address to bind to, or `NULL` for the loopback address.
+ * @param   port        The port (e.g. `RASPI_APA102_RECEIVER_E131_PORT`).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ReceiverInitUDP(RaspiAPA102Receiver* receiver, 
+    RaspiAPA102Device* device, const char* address, uint16_t port);
+
+/**
+ * @brief   Initializes a receiver on a Unix datagram socket.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   device      A pointer to the `RaspiAPA102Device` struct. The transmit buffer of the 
+ *                      device has to be allocated. It is queried for every packet, so it may be 
+ *                      replaced between calls to `RaspiAPA102ReceiverPoll` (call 
+ *                      `RaspiAPA102ReceiverSetUniverses` to map the LEDs of a larger buffer).
+ * @param   path        The path of the socket. An existing socket file is replaced.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ReceiverInitUnix(RaspiAPA102Receiver* receiver, 
+    RaspiAPA102Device* device, const char* path);
+
+/**
+ * @brief   Sets the mapping of universes to LEDs.
+ *
+ * @param   receiver            A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   first_universe      The universe of the first LED (default `1`).
+ * @param   pixels_per_universe The number of LEDs per universe (default 
+ *                              `RASPI_APA102_RECEIVER_DEFAULT_PIXELS_PER_UNIVERSE`).
+ * @param   format              The layout of the channel data (default 
+ *                              `RASPI_APA102_PIXEL_FORMAT_RGB`).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ReceiverSetUniverses(RaspiAPA102Receiver* receiver, 
+    uint16_t first_universe, size_t pixels_per_universe, RaspiAPA102PixelFormat format);
+
+/**
+ * @brief   Sets the global brightness of all received LEDs.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   brightness  The brightness (0..31, default 31).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ReceiverSetBrightness(RaspiAPA102Receiver* receiver, 
+    uint8_t brightness);
+
+/**
+ * @brief   Returns the socket of the given receiver.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   fd          Receives the file descriptor, which can be used to wait for packets in an 
+ *                      existing event loop.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ReceiverGetFD(const RaspiAPA102Receiver* receiver, int* fd);
+
+/**
+ * @brief   Waits for packets, processes all pending packets and sends completed frames.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   timeout     The maximum time to wait for the first packet in milliseconds, `0` to 
+ *                      return immediately or `-1` to wait indefinitely.
+ * @param   frames      Receives the number of sent frames. This parameter is optional.
+ *
+ * Pending packets are received in batches of up to `RASPI_APA102_RECEIVER_BATCH_SIZE` datagrams 
+ * per system call.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ReceiverPoll(RaspiAPA102Receiver* receiver, int timeout, 
+    size_t* frames);
+
+/**
+ * @brief   Returns the statistics of the given receiver.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   stats       Receives the statistics. The latency is measured from the kernel receive 
+ *                      time of the first packet of a frame until the frame was sent.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ReceiverGetStats(const RaspiAPA102Receiver* receiver, 
+    RaspiAPA102ReceiverStats* stats);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102Receiver` struct.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ReceiverDestroy(RaspiAPA102Receiver* receiver);
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RECEIVER_H */
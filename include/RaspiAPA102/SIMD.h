@@ -0,0 +1,121 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides functions to query and select the SIMD implementations of the library.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102SIMDPath` enum.
+ */
+typedef enum RaspiAPA102SIMDPath_
+{
+    /**
+     * @brief   Selects the fastest implementation supported by the current CPU.
+     */
+    RASPI_APA102_SIMD_AUTO,
+    /**
+     * @brief   The portable scalar implementation.
+     */
+    RASPI_APA102_SIMD_SCALAR,
+    /**
+     * @brief   The `SSSE3` implementation (x86).
+     */
+    RASPI_APA102_SIMD_SSSE3,
+    /**
+     * @brief   The `AVX2` implementation (x86).
+     */
+    RASPI_APA102_SIMD_AVX2,
+    /**
+     * @brief   The `NEON` implementation (ARM).
+     */
+    RASPI_APA102_SIMD_NEON,
+
+    /**
+     * @brief   Maximum value of this enum.
+     */
+    RASPI_APA102_SIMD_MAX_VALUE = RASPI_APA102_SIMD_NEON
+} RaspiAPA102SIMDPath;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* SIMD                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Checks, if the given implementation is compiled in and supported by the current CPU.
+ *
+ * @param   path    The implementation.
+ *
+ * @return  `true`, if the implementation is supported or `false`, if not.
+ */
+RASPI_APA102_EXPORT bool RaspiAPA102SIMDIsSupported(RaspiAPA102SIMDPath path);
+
+/**
+ * @brief   Resolves the given implementation.
+ *
+ * @param   path    The implementation.
+ *
+ * @return  The fastest supported implementation for `RASPI_APA102_SIMD_AUTO`, or `path` itself.
+ */
+RASPI_APA102_EXPORT RaspiAPA102SIMDPath RaspiAPA102SIMDResolve(RaspiAPA102SIMDPath path);
+
+/**
+ * @brief   Returns a human readable name for the given implementation.
+ *
+ * @param   path    The implementation.
+ *
+ * @return  The name of the implementation.
+ */
+RASPI_APA102_EXPORT const char* RaspiAPA102SIMDGetName(RaspiAPA102SIMDPath path);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIMD_H */
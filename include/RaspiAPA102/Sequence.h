@@ -0,0 +1,361 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a compact file format for pre-rendered animations and a memory mapped player.
+ *
+ * A sequence file has the following layout (all values little-endian):
+ *
+ * | Offset          | Size                  | Content                                          |
+ * |-----------------|-----------------------|--------------------------------------------------|
+ * | `0`             | `64`                  | `RaspiAPA102SequenceHeader`                      |
+ * | `header_size`   | variable              | One frame record for every frame                 |
+ * | `index_offset`  | `frame_count * 8`     | The file offset of every frame record            |
+ *
+ * Every frame record starts at a 4-byte aligned offset with a `RaspiAPA102SequenceRecord` 
+ * followed by `size` bytes of payload. The payload describes the frame as the XOR difference to a reference frame in the 
+ * `RaspiAPA102ColorQuad` layout. The reference is the previous frame for delta frames and an 
+ * all-zero frame for keyframes. The payload is a list of tokens. Every token starts with an 
+ * unsigned LEB128 value `(length << 2) | type`:
+ *
+ * - `0` (skip):    The next `length` quads are unchanged.
+ * - `1` (literal): Followed by `length * 4` bytes that are XOR-ed into the next `length` quads.
+ * - `2` (repeat):  Followed by `4` bytes that are XOR-ed into each of the next `length` quads.
+ *
+ * The first frame is always a keyframe.
+ */
+
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   The value of `RaspiAPA102SequenceHeader.magic` (`"A1SQ"`).
+ */
+#define RASPI_APA102_SEQUENCE_MAGIC 0x51533141
+
+/**
+ * @brief   The value of `RaspiAPA102SequenceHeader.version`.
+ */
+#define RASPI_APA102_SEQUENCE_VERSION 1
+
+/**
+ * @brief   The default number of frames between two keyframes.
+ */
+#define RASPI_APA102_SEQUENCE_DEFAULT_KEYFRAME_INTERVAL 300
+
+/**
+ * @brief   Defines the `RaspiAPA102SequenceHeader` struct.
+ */
+typedef struct RaspiAPA102SequenceHeader_
+{
+    /**
+     * @brief   The magic value `RASPI_APA102_SEQUENCE_MAGIC`.
+     */
+    uint32_t magic;
+    /**
+     * @brief   The format version `RASPI_APA102_SEQUENCE_VERSION`.
+     */
+    uint32_t version;
+    /**
+     * @brief   The size of the header in bytes (offset of the first frame record).
+     */
+    uint32_t header_size;
+    /**
+     * @brief   The frame rate.
+     */
+    uint32_t fps;
+    /**
+     * @brief   The number of LEDs per frame.
+     */
+    uint64_t pixel_count;
+    /**
+     * @brief   The number of frames.
+     */
+    uint64_t frame_count;
+    /**
+     * @brief   The file offset of the frame index.
+     */
+    uint64_t index_offset;
+    /**
+     * @brief   Reserved.
+     */
+    uint8_t reserved[24];
+} RaspiAPA102SequenceHeader;
+
+/**
+ * @brief   Defines the `RaspiAPA102SequenceRecordType` enum.
+ */
+typedef enum RaspiAPA102SequenceRecordType_
+{
+    /**
+     * @brief   The frame is encoded relative to an all-zero frame.
+     */
+    RASPI_APA102_SEQUENCE_RECORD_KEYFRAME,
+    /**
+     * @brief   The frame is encoded relative to the previous frame.
+     */
+    RASPI_APA102_SEQUENCE_RECORD_DELTA
+} RaspiAPA102SequenceRecordType;
+
+/**
+ * @brief   Defines the `RaspiAPA102SequenceRecord` struct.
+ */
+typedef struct RaspiAPA102SequenceRecord_
+{
+    /**
+     * @brief   The `RaspiAPA102SequenceRecordType`.
+     */
+    uint8_t type;
+    /**
+     * @brief   Reserved.
+     */
+    uint8_t reserved[3];
+    /**
+     * @brief   The size of the payload in bytes.
+     */
+    uint32_t size;
+} RaspiAPA102SequenceRecord;
+
+/**
+ * @brief   Defines the `RaspiAPA102SequenceWriter` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102SequenceWriter_
+{
+    /**
+     * @brief   The output file.
+     */
+    FILE* file;
+    /**
+     * @brief   The header.
+     */
+    RaspiAPA102SequenceHeader header;
+    /**
+     * @brief   The file offset of every frame record written so far.
+     */
+    uint64_t* index;
+    /**
+     * @brief   The capacity of the `index` array.
+     */
+    size_t index_capacity;
+    /**
+     * @brief   The current file offset.
+     */
+    uint64_t offset;
+    /**
+     * @brief   The number of frames between two keyframes.
+     */
+    uint32_t keyframe_interval;
+    /**
+     * @brief   The previous frame.
+     */
+    RaspiAPA102ColorQuad* previous;
+    /**
+     * @brief   The encoding buffer.
+     */
+    uint8_t* buffer;
+} RaspiAPA102SequenceWriter;
+
+/**
+ * @brief   Defines the `RaspiAPA102SequencePlayer` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102SequencePlayer_
+{
+    /**
+     * @brief   The mapped file.
+     */
+    const uint8_t* data;
+    /**
+     * @brief   The size of the mapped file in bytes.
+     */
+    size_t size;
+    /**
+     * @brief   The header.
+     */
+    const RaspiAPA102SequenceHeader* header;
+    /**
+     * @brief   The frame index.
+     */
+    const uint64_t* index;
+    /**
+     * @brief   The index of the frame currently held by the destination buffer plus one, or `0`.
+     */
+    uint64_t decoded;
+    /**
+     * @brief   The index of the first quad changed by the last decode.
+     */
+    size_t dirty_first;
+    /**
+     * @brief   The number of quads (starting at `dirty_first`) changed by the last decode.
+     */
+    size_t dirty_count;
+} RaspiAPA102SequencePlayer;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Writer                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Creates a new sequence file.
+ *
+ * @param   writer              A pointer to the `RaspiAPA102SequenceWriter` struct.
+ * @param   path                The path of the file.
+ * @param   count               The number of LEDs per frame.
+ * @param   fps                 The frame rate.
+ * @param   keyframe_interval   The maximum number of frames between two keyframes (e.g. 
+ *                              `RASPI_APA102_SEQUENCE_DEFAULT_KEYFRAME_INTERVAL`). Keyframes allow
+ *                              seeking.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SequenceWriterOpen(RaspiAPA102SequenceWriter* writer, 
+    const char* path, size_t count, uint32_t fps, uint32_t keyframe_interval);
+
+/**
+ * @brief   Appends a frame.
+ *
+ * @param   writer  A pointer to the `RaspiAPA102SequenceWriter` struct.
+ * @param   quads   A pointer to the color quads of the frame (`count` quads).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SequenceWriterAppend(RaspiAPA102SequenceWriter* writer, 
+    const RaspiAPA102ColorQuad* quads);
+
+/**
+ * @brief   Writes the frame index, completes the file and releases all resources held by the 
+ *          given `RaspiAPA102SequenceWriter` struct.
+ *
+ * @param   writer  A pointer to the `RaspiAPA102SequenceWriter` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SequenceWriterClose(RaspiAPA102SequenceWriter* writer);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Player                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Opens the given sequence file.
+ *
+ * @param   player  A pointer to the `RaspiAPA102SequencePlayer` struct.
+ * @param   path    The path of the file.
+ *
+ * The file is mapped into memory and validated.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SequencePlayerOpen(RaspiAPA102SequencePlayer* player, 
+    const char* path);
+
+/**
+ * @brief   Returns information about the opened sequence.
+ *
+ * @param   player      A pointer to the `RaspiAPA102SequencePlayer` struct.
+ * @param   count       Receives the number of LEDs per frame. This parameter is optional.
+ * @param   fps         Receives the frame rate. This parameter is optional.
+ * @param   frame_count Receives the number of frames. This parameter is optional.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SequencePlayerGetInfo(const RaspiAPA102SequencePlayer* player, 
+    size_t* count, uint32_t* fps, uint64_t* frame_count);
+
+/**
+ * @brief   Decodes the given frame into the given buffer.
+ *
+ * @param   player  A pointer to the `RaspiAPA102SequencePlayer` struct.
+ * @param   frame   The index of the frame.
+ * @param   quads   A pointer to the destination buffer (`count` quads).
+ *
+ * Delta frames are applied in place, so the buffer must not be modified between two calls. 
+ * Decoding the frame following the previously decoded one only touches the changed quads; any 
+ * other frame is decoded starting at the preceding keyframe.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SequencePlayerDecode(RaspiAPA102SequencePlayer* player, 
+    uint64_t frame, RaspiAPA102ColorQuad* quads);
+
+/**
+ * @brief   Decodes the given frame into the transmit buffer of the given device and sends it.
+ *
+ * @param   player  A pointer to the `RaspiAPA102SequencePlayer` struct.
+ * @param   device  A pointer to the `RaspiAPA102Device` struct. The transmit buffer must be 
+ *                  allocated for at least `count` LEDs.
+ * @param   frame   The index of the frame.
+ *
+ * The changed quads are marked dirty, so only the changed prefix of the string is sent, if the 
+ * device tracks dirty LEDs.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SequencePlayerUpdateDevice(RaspiAPA102SequencePlayer* player, 
+    RaspiAPA102Device* device, uint64_t frame);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102SequencePlayer` struct.
+ *
+ * @param   player  A pointer to the `RaspiAPA102SequencePlayer` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SequencePlayerClose(RaspiAPA102SequencePlayer* player);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEQUENCE_H */
@@ -0,0 +1,405 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a software emulated `SPI` engine with a calibrated clock.
+ */
+
+#ifndef SOFT_SPI_H
+#define SOFT_SPI_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Transport.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Macros                                                                                         */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Constants                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   The default clock frequency of the software `SPI` engine in Hz.
+ */
+#define RASPI_APA102_SOFT_SPI_DEFAULT_SPEED 1000000
+
+/**
+ * @brief   The number of 32-bit registers of the `GPIO` register block that are accessed by the 
+ *          software `SPI` engine.
+ *
+ * A fake register block passed to `RaspiAPA102SoftSPIInit` has to contain at least this many 
+ * registers.
+ */
+#define RASPI_APA102_GPIO_REGISTER_COUNT 16
+
+/**
+ * @brief   The maximum number of data lanes of the multi-lane software `SPI` engine.
+ */
+#define RASPI_APA102_MULTI_LANE_MAX 8
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102SoftSPI` struct.
+ *
+ * The engine toggles the pins by writing the `GPSET0`/`GPCLR0` registers of a memory mapped 
+ * `GPIO` register block and times the clock edges with a calibrated busy-wait loop. If the 
+ * register block can not be mapped, the pins are driven through `wiringPi` instead (if available).
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102SoftSPI_
+{
+    /**
+     * @brief   The `GPIO` register block, or `NULL` if the pins are driven through `wiringPi`.
+     */
+    volatile uint32_t* registers;
+    /**
+     * @brief   The size of the mapping owned by the engine, or `0` if the register block was 
+     *          provided by the caller.
+     */
+    size_t mapping_size;
+    /**
+     * @brief   The `SCLK` pin.
+     */
+    int pin_sclk;
+    /**
+     * @brief   The `MOSI` pin.
+     */
+    int pin_mosi;
+    /**
+     * @brief   The chip select pin, or `-1`.
+     */
+    int pin_cs;
+    /**
+     * @brief   Signals, if the chip select pin is currently asserted.
+     */
+    bool selected;
+    /**
+     * @brief   The requested clock frequency in Hz.
+     */
+    uint32_t clock_hz;
+    /**
+     * @brief   The number of busy-wait iterations per half clock period.
+     */
+    double half_period_loops;
+    /**
+     * @brief   The total number of bits written.
+     */
+    uint64_t bits_written;
+    /**
+     * @brief   The total time spent writing in nanoseconds.
+     */
+    uint64_t time_ns;
+} RaspiAPA102SoftSPI;
+
+/**
+ * @brief   Defines the `RaspiAPA102MultiLaneSPI` struct.
+ *
+ * The multi-lane engine drives up to `RASPI_APA102_MULTI_LANE_MAX` strings that share a single 
+ * `SCLK` pin. Each string has its own `MOSI` pin and all data lines are updated with the same 
+ * `GPSET0`/`GPCLR0` writes, so the aggregate throughput scales with the number of lanes.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102MultiLaneSPI_
+{
+    /**
+     * @brief   The `GPIO` register block.
+     */
+    volatile uint32_t* registers;
+    /**
+     * @brief   The size of the mapping owned by the engine, or `0` if the register block was 
+     *          provided by the caller.
+     */
+    size_t mapping_size;
+    /**
+     * @brief   The shared `SCLK` pin.
+     */
+    int pin_sclk;
+    /**
+     * @brief   The `MOSI` pins of the lanes.
+     */
+    int pins_mosi[RASPI_APA102_MULTI_LANE_MAX];
+    /**
+     * @brief   The number of lanes.
+     */
+    size_t lane_count;
+    /**
+     * @brief   The combined `GPIO` mask of all `MOSI` pins.
+     */
+    uint32_t mask_mosi;
+    /**
+     * @brief   Maps every combination of lane bits (bit `n` = lane `n`) to the corresponding 
+     *          `GPIO` mask.
+     */
+    uint32_t lane_masks[256];
+    /**
+     * @brief   The requested clock frequency in Hz.
+     */
+    uint32_t clock_hz;
+    /**
+     * @brief   The number of busy-wait iterations per half clock period.
+     */
+    double half_period_loops;
+    /**
+     * @brief   The total number of clock periods.
+     */
+    uint64_t bits_written;
+    /**
+     * @brief   The total time spent writing in nanoseconds.
+     */
+    uint64_t time_ns;
+} RaspiAPA102MultiLaneSPI;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Soft SPI                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Calibrates the busy-wait loop used to time the clock edges.
+ *
+ * @param   loops_per_us    Receives the number of busy-wait iterations per microsecond. This 
+ *                          parameter is optional.
+ *
+ * The calibration runs once per process; subsequent calls return the cached result. It is 
+ * invoked implicitly by `RaspiAPA102SoftSPIInit`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SoftSPICalibrate(double* loops_per_us);
+
+/**
+ * @brief   Initializes the given `RaspiAPA102SoftSPI` struct.
+ *
+ * @param   spi         A pointer to the `RaspiAPA102SoftSPI` struct.
+ * @param   registers   A pointer to the `GPIO` register block, or `NULL` to map `/dev/gpiomem`.
+ *                      Passing an in-memory block of `RASPI_APA102_GPIO_REGISTER_COUNT` registers
+ *                      allows to run the engine without hardware.
+ * @param   pin_sclk    The number of the `GPIO` pin (broadcom numbering scheme) to use as `SCLK` 
+ *                      output.
+ * @param   pin_mosi    The number of the `GPIO` pin (broadcom numbering scheme) to use as `MOSI` 
+ *                      output.
+ * @param   pin_cs      The number of the `GPIO` pin (broadcom numbering scheme) to use as channel 
+ *                      select output, or `-1` if not needed.
+ * @param   clock_hz    The requested clock frequency in Hz.
+ *
+ * This function sets the given `GPIO` pins to `OUTPUT` mode. The pins must be distinct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SoftSPIInit(RaspiAPA102SoftSPI* spi, 
+    volatile uint32_t* registers, int pin_sclk, int pin_mosi, int pin_cs, uint32_t clock_hz);
+
+/**
+ * @brief   Writes the given buffer.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102SoftSPI` struct.
+ * @param   buffer  A pointer to the data buffer.
+ * @param   size    The number of bytes to write.
+ *
+ * The clock period is continuously adjusted towards the requested clock frequency based on the 
+ * measured duration of each write.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SoftSPIWrite(RaspiAPA102SoftSPI* spi, const uint8_t* buffer, 
+    size_t size);
+
+/**
+ * @brief   Returns the achieved bit rate.
+ *
+ * @param   spi                 A pointer to the `RaspiAPA102SoftSPI` struct.
+ * @param   bits_per_second     Receives the average number of bits written per second.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SoftSPIGetBitRate(const RaspiAPA102SoftSPI* spi, 
+    double* bits_per_second);
+
+/**
+ * @brief   Returns a transport that writes to the given `RaspiAPA102SoftSPI` struct.
+ *
+ * @param   spi         A pointer to the `RaspiAPA102SoftSPI` struct.
+ * @param   transport   Receives the transport.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SoftSPIGetTransport(RaspiAPA102SoftSPI* spi,
+    RaspiAPA102Transport* transport);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102SoftSPI` struct.
+ *
+ * @param   spi A pointer to the `RaspiAPA102SoftSPI` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SoftSPIDestroy(RaspiAPA102SoftSPI* spi);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Multi-lane Soft SPI                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102MultiLaneSPI` struct.
+ *
+ * @param   spi         A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   registers   A pointer to the `GPIO` register block, or `NULL` to map `/dev/gpiomem`.
+ * @param   pin_sclk    The number of the `GPIO` pin (broadcom numbering scheme) to use as shared
+ *                      `SCLK` output.
+ * @param   pins_mosi   A pointer to an array with the numbers of the `GPIO` pins (broadcom 
+ *                      numbering scheme) to use as `MOSI` outputs.
+ * @param   lane_count  The number of lanes (`1..RASPI_APA102_MULTI_LANE_MAX`).
+ * @param   clock_hz    The requested clock frequency in Hz.
+ *
+ * This function sets the given `GPIO` pins to `OUTPUT` mode. The pins must be distinct. Unlike the
+ * single-lane engine, there is no `wiringPi` fallback.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102MultiLaneSPIInit(RaspiAPA102MultiLaneSPI* spi, 
+    volatile uint32_t* registers, int pin_sclk, const int* pins_mosi, size_t lane_count, 
+    uint32_t clock_hz);
+
+/**
+ * @brief   Transposes the given lane buffers into one `GPIO` set mask per clock period.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   lanes   A pointer to an array of `lane_count` data buffers.
+ * @param   sizes   A pointer to an array of `lane_count` buffer sizes in bytes.
+ * @param   size    The number of bytes to encode per lane. Lanes with less data are padded with 
+ *                  `0xFF`.
+ * @param   masks   Receives `size * 8` `GPIO` masks. Bit `pins_mosi[n]` of mask `i` is the 
+ *                  value of lane `n` during clock period `i`.
+ *
+ * This function is used by `RaspiAPA102MultiLaneSPIWrite` and allows to verify the encoded 
+ * stream without hardware.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102MultiLaneSPIEncode(const RaspiAPA102MultiLaneSPI* spi, 
+    const uint8_t* const* lanes, const size_t* sizes, size_t size, uint32_t* masks);
+
+/**
+ * @brief   Writes the given lane buffers.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   lanes   A pointer to an array of `lane_count` data buffers.
+ * @param   sizes   A pointer to an array of `lane_count` buffer sizes in bytes. Lanes with less 
+ *                  data are padded with `0xFF`.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102MultiLaneSPIWrite(RaspiAPA102MultiLaneSPI* spi, 
+    const uint8_t* const* lanes, const size_t* sizes);
+
+/**
+ * @brief   Updates the LEDs of all lanes.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   colors  A pointer to an array of `lane_count` pointers to `RaspiAPA102ColorQuad` 
+ *                  arrays.
+ * @param   counts  A pointer to an array of `lane_count` LED counts.
+ *
+ * All lanes receive their start frame at the same time. Lanes with less LEDs are padded with LED
+ * frames that turn the LEDs off (`0xE0 0x00 0x00 0x00`) up to the longest lane, followed by the 
+ * end frame of the longest lane.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102MultiLaneSPIUpdate(RaspiAPA102MultiLaneSPI* spi, 
+    const RaspiAPA102ColorQuad* const* colors, const size_t* counts);
+
+/**
+ * @brief   Encodes the `GPIO` set masks of an update of all lanes.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   colors  A pointer to an array of `lane_count` pointers to `RaspiAPA102ColorQuad` 
+ *                  arrays.
+ * @param   counts  A pointer to an array of `lane_count` LED counts.
+ * @param   masks   Receives the `GPIO` masks, or `NULL` to query the number of masks.
+ * @param   count   Passes the capacity of the `masks` array and receives the number of masks.
+ *
+ * The masks are the ones clocked out by `RaspiAPA102MultiLaneSPIUpdate`, which allows to verify 
+ * the `APA102` stream of each lane without hardware.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102MultiLaneSPIEncodeUpdate(const RaspiAPA102MultiLaneSPI* spi, 
+    const RaspiAPA102ColorQuad* const* colors, const size_t* counts, uint32_t* masks, 
+    size_t* count);
+
+/**
+ * @brief   Returns the achieved aggregate bit rate of all lanes.
+ *
+ * @param   spi                 A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   bits_per_second     Receives the average number of bits written per second, summed 
+ *                              over all lanes.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102MultiLaneSPIGetBitRate(const RaspiAPA102MultiLaneSPI* spi, 
+    double* bits_per_second);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102MultiLaneSPI` struct.
+ *
+ * @param   spi A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102MultiLaneSPIDestroy(RaspiAPA102MultiLaneSPI* spi);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOFT_SPI_H */
@@ -0,0 +1,293 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides per-frame instrumentation of `APA102` devices.
+ *
+ * The instrumentation is compiled in with the `RASPI_APA102_ENABLE_STATS` build option and has to
+ * be enabled per device at runtime. Without the build option, all hooks compile to nothing and
+ * `RaspiAPA102DeviceEnableStats` fails.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   The number of sub-buckets per power of two (relative bucket width of `1/16`).
+ */
+#define RASPI_APA102_STATS_SUB_BUCKETS 16
+
+/**
+ * @brief   The number of histogram buckets. Values of `2^40` ns and above are counted in the last 
+ *          bucket.
+ */
+#define RASPI_APA102_STATS_BUCKETS ((40 - 3) * RASPI_APA102_STATS_SUB_BUCKETS)
+
+/**
+ * @brief   Defines the `RaspiAPA102StatsStage` enum.
+ */
+typedef enum RaspiAPA102StatsStage_
+{
+    /**
+     * @brief   Converting pixel data into the transmit buffer (recorded by library components that 
+     *          fill the buffer and by `RaspiAPA102DeviceRecordStage`).
+     */
+    RASPI_APA102_STATS_STAGE_PACK,
+    /**
+     * @brief   Writing the start frame and the LED frames to the transport.
+     */
+    RASPI_APA102_STATS_STAGE_TRANSFER,
+    /**
+     * @brief   Writing a separate end frame to the transport.
+     */
+    RASPI_APA102_STATS_STAGE_END_FRAME,
+    /**
+     * @brief   Flushing the transport.
+     */
+    RASPI_APA102_STATS_STAGE_FLUSH,
+    /**
+     * @brief   The complete output of a frame (transfer, end frame and flush).
+     */
+    RASPI_APA102_STATS_STAGE_FRAME,
+    /**
+     * @brief   The time between the start of two consecutive frames.
+     */
+    RASPI_APA102_STATS_STAGE_INTERVAL,
+
+    RASPI_APA102_STATS_STAGE_MAX_VALUE = RASPI_APA102_STATS_STAGE_INTERVAL
+} RaspiAPA102StatsStage;
+
+/**
+ * @brief   Defines the `RaspiAPA102StatsHistogram` struct.
+ *
+ * A log-linear histogram of durations in nanoseconds with a maximum relative error of `1/16`.
+ */
+typedef struct RaspiAPA102StatsHistogram_
+{
+    /**
+     * @brief   The number of recorded values.
+     */
+    uint64_t count;
+    /**
+     * @brief   The sum of all recorded values.
+     */
+    uint64_t sum;
+    /**
+     * @brief   The sum of all squared recorded values in microseconds squared.
+     */
+    uint64_t sum_squares;
+    /**
+     * @brief   The minimum recorded value.
+     */
+    uint64_t min;
+    /**
+     * @brief   The maximum recorded value.
+     */
+    uint64_t max;
+    /**
+     * @brief   The number of recorded values per bucket.
+     */
+    uint32_t buckets[RASPI_APA102_STATS_BUCKETS];
+} RaspiAPA102StatsHistogram;
+
+/**
+ * @brief   Defines the `RaspiAPA102Stats` struct.
+ */
+typedef struct RaspiAPA102Stats_
+{
+    /**
+     * @brief   The histogram of every stage.
+     */
+    RaspiAPA102StatsHistogram stages[RASPI_APA102_STATS_STAGE_MAX_VALUE + 1];
+    /**
+     * @brief   The number of sent frames.
+     */
+    uint64_t frames;
+    /**
+     * @brief   The number of frames that failed.
+     */
+    uint64_t errors;
+    /**
+     * @brief   The number of bytes sent.
+     */
+    uint64_t bytes;
+    /**
+     * @brief   The start time of the last frame (`CLOCK_MONOTONIC`, ns).
+     */
+    uint64_t last_frame;
+    /**
+     * @brief   The file the statistics are periodically written to, or `NULL`.
+     */
+    FILE* dump_file;
+    /**
+     * @brief   The interval between two dumps in nanoseconds.
+     */
+    uint64_t dump_interval;
+    /**
+     * @brief   The time of the next dump (`CLOCK_MONOTONIC`, ns).
+     */
+    uint64_t dump_next;
+} RaspiAPA102Stats;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Device                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Enables or disables the instrumentation of the given `APA102` device.
+ *
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   enable  Pass `true` to enable and reset the instrumentation or `false` to disable it.
+ *
+ * Must not be called while another thread drives the device, i.e. while an 
+ * `RaspiAPA102AsyncOutput` or a `RaspiAPA102StripGroup` uses it, not even between two frames: 
+ * disabling frees the statistics the thread updates. Enable the instrumentation before the output
+ * is initialized and disable it after the output was destroyed.
+ *
+ * @return  A status code. Fails, if the library was built without `RASPI_APA102_ENABLE_STATS`.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceEnableStats(RaspiAPA102Device* device, bool enable);
+
+/**
+ * @brief   Returns a snapshot of the statistics of the given `APA102` device.
+ *
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   stats   Receives the snapshot.
+ *
+ * The snapshot can be taken at any time without blocking the output. Counters updated 
+ * concurrently may be off by the frame in flight.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceGetStats(const RaspiAPA102Device* device, 
+    RaspiAPA102Stats* stats);
+
+/**
+ * @brief   Records a duration for the given stage of the given `APA102` device.
+ *
+ * @param   device      A pointer to the `RaspiAPA102Device` struct.
+ * @param   stage       The stage (e.g. `RASPI_APA102_STATS_STAGE_PACK` for application code that 
+ *                      fills the transmit buffer).
+ * @param   duration    The duration in nanoseconds.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceRecordStage(const RaspiAPA102Device* device, 
+    RaspiAPA102StatsStage stage, uint64_t duration);
+
+/**
+ * @brief   Periodically writes the statistics of the given `APA102` device to a file.
+ *
+ * @param   device      A pointer to the `RaspiAPA102Device` struct.
+ * @param   file        The file, or `NULL` to disable the periodic output.
+ * @param   interval    The interval in milliseconds.
+ *
+ * The statistics are written by the thread that sends the frame, after the frame was sent.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102DeviceSetStatsDump(RaspiAPA102Device* device, FILE* file, 
+    uint32_t interval);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Evaluation                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the given percentile of the given histogram.
+ *
+ * @param   histogram   A pointer to the `RaspiAPA102StatsHistogram` struct.
+ * @param   percentile  The percentile (0..100).
+ * @param   value       Receives the value in nanoseconds.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102StatsGetPercentile(const RaspiAPA102StatsHistogram* histogram, 
+    double percentile, uint64_t* value);
+
+/**
+ * @brief   Returns the standard deviation of the given histogram.
+ *
+ * @param   histogram   A pointer to the `RaspiAPA102StatsHistogram` struct.
+ * @param   deviation   Receives the standard deviation in nanoseconds (with microsecond 
+ *                      resolution).
+ *
+ * Applied to `RASPI_APA102_STATS_STAGE_INTERVAL`, this is the frame interval jitter.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102StatsGetDeviation(const RaspiAPA102StatsHistogram* histogram, 
+    double* deviation);
+
+/**
+ * @brief   Returns the achieved bit rate while sending frames.
+ *
+ * @param   stats   A pointer to the `RaspiAPA102Stats` struct.
+ * @param   rate    Receives the number of bits per second spent in the `FRAME` stage.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102StatsGetBitRate(const RaspiAPA102Stats* stats, double* rate);
+
+/**
+ * @brief   Writes a human readable summary of the given statistics.
+ *
+ * @param   stats   A pointer to the `RaspiAPA102Stats` struct.
+ * @param   file    The file.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102StatsDump(const RaspiAPA102Stats* stats, FILE* file);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATS_H */
@@ -0,0 +1,489 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a header-only `C++17` layer with compile-time specialized `APA102` strips.
+ */
+
+#ifndef STRIP_HPP
+#define STRIP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <RaspiAPA102/APA102.h>
+
+#if !defined(__cplusplus) || (__cplusplus < 201703L)
+#   error "RaspiAPA102/Strip.hpp requires C++17"
+#endif
+
+namespace RaspiAPA102
+{
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Channel order                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `ChannelOrder` enum.
+ *
+ * Names the order of the three color bytes that follow the brightness byte of an LED frame on the
+ * wire. Genuine `APA102` LEDs expect `BGR`; some clones and pre-wired strips swap the channels.
+ */
+enum class ChannelOrder
+{
+    BGR,
+    BRG,
+    GBR,
+    GRB,
+    RBG,
+    RGB
+};
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Brightness mode                                                                                */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `BrightnessMode` enum.
+ */
+enum class BrightnessMode
+{
+    /**
+     * @brief   All LEDs share the brightness set by `Strip::SetBrightness`.
+     */
+    Global,
+    /**
+     * @brief   Every LED frame carries its own brightness.
+     */
+    PerPixel
+};
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Strip                                                                                          */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `Strip` class template.
+ *
+ * @tparam  N       The number of LEDs in the string.
+ * @tparam  Order   The channel order of the LEDs.
+ * @tparam  Mode    The brightness mode.
+ * @tparam  Chain   The chain mode that determines the end frame layout.
+ *
+ * The strip owns a complete framed buffer of `FrameSize` bytes. The start frame, the black LED 
+ * frames and the end frame are computed at compile time, so constructing a strip is a single 
+ * copy. The buffer is attached to a `RaspiAPA102Device` with `Attach` and sent without copying by 
+ * `Commit`. Pixel setters compile to a single 32 bit store into the buffer.
+ *
+ * The LED frames are exposed as a contiguous range of `RaspiAPA102ColorQuad` structs, so standard
+ * algorithms, range-based `for` loops and spans work directly on the strip. For orders other than
+ * `ChannelOrder::BGR`, the `b`, `g` and `r` fields hold the wire bytes in the selected order.
+ *
+ * Large strips should not be placed on the stack.
+ */
+template <std::size_t N, ChannelOrder Order = ChannelOrder::BGR, 
+    BrightnessMode Mode = BrightnessMode::PerPixel, 
+    RaspiAPA102ChainMode Chain = RASPI_APA102_CHAIN_MODE_DEFAULT>
+class Strip
+{
+    static_assert(N > 0, "The strip needs at least one LED");
+    static_assert(N <= RASPI_APA102_MAX_COUNT, "Too many LEDs");
+    static_assert(sizeof(RaspiAPA102ColorQuad) == 4, "Invalid color quad size");
+
+public:
+    /**
+     * @brief   The number of LEDs in the string.
+     */
+    static constexpr std::size_t Count = N;
+    /**
+     * @brief   The size of the end frame in bytes.
+     */
+    static constexpr std::size_t EndFrameSize = RASPI_APA102_END_FRAME_SIZE(N) + 
+        ((Chain == RASPI_APA102_CHAIN_MODE_LARGE) ? RASPI_APA102_RESET_FRAME_SIZE : 0);
+    /**
+     * @brief   The size of the framed buffer in bytes.
+     */
+    static constexpr std::size_t FrameSize = 
+        RASPI_APA102_START_FRAME_SIZE + N * sizeof(RaspiAPA102ColorQuad) + EndFrameSize;
+
+    using value_type = RaspiAPA102ColorQuad;
+    using size_type = std::size_t;
+    using iterator = RaspiAPA102ColorQuad*;
+    using const_iterator = const RaspiAPA102ColorQuad*;
+
+public:
+    /**
+     * @brief   Constructs a strip with all LEDs turned off.
+     */
+    Strip() noexcept
+        : frame_(InitialFrame)
+    {
+    }
+
+    Strip(const Strip&) = delete;
+    Strip& operator=(const Strip&) = delete;
+
+    /**
+     * @brief   Detaches the strip from its device.
+     */
+    ~Strip()
+    {
+        Detach();
+    }
+
+public:
+    /**
+     * @brief   Attaches the framed buffer of the strip to the given `APA102` device.
+     *
+     * @param   device  The device.
+     *
+     * A previous buffer of the device is removed and the chain mode of the device is set to 
+     * `Chain`. The strip has to outlive the attachment.
+     *
+     * @return  A status code.
+     */
+    int Attach(RaspiAPA102Device& device) noexcept
+    {
+        Detach();
+        // The previous buffer of the device might have no room for the end frame of `Chain`
+        if ((RaspiAPA102DeviceDetachBuffer(&device, nullptr) < 0) || 
+            (RaspiAPA102DeviceSetChainMode(&device, Chain) < 0) || 
+            (RaspiAPA102DeviceAttachBuffer(&device, frame_.data(), FrameSize, N) < 0))
+        {
+            return -1;
+        }
+        device_ = &device;
+
+        return 0;
+    }
+
+    /**
+     * @brief   Removes the framed buffer of the strip from its device.
+     *
+     * @return  A status code.
+     */
+    int Detach() noexcept
+    {
+        RaspiAPA102Device* const device = device_;
+        device_ = nullptr;
+        if (!device || (device->frame != frame_.data()))
+        {
+            // Not attached, or the device has already moved on to a different buffer
+            return 0;
+        }
+
+        return RaspiAPA102DeviceDetachBuffer(device, nullptr);
+    }
+
+    /**
+     * @brief   Checks, if the framed buffer of the strip is attached to a device.
+     *
+     * @return  `true`, if the buffer is attached or `false`, if not.
+     */
+    bool IsAttached() const noexcept
+    {
+        return device_ && (device_->frame == frame_.data());
+    }
+
+    /**
+     * @brief   Sends the framed buffer of the strip.
+     *
+     * The LEDs modified since the last commit have to be passed to `MarkDirty`, if dirty tracking
+     * is enabled for the device.
+     *
+     * @return  A status code.
+     */
+    int Commit() noexcept
+    {
+        return IsAttached() ? RaspiAPA102DeviceCommit(device_) : -1;
+    }
+
+    /**
+     * @brief   Marks a range of LEDs as modified.
+     *
+     * @param   index   The index of the first modified LED.
+     * @param   count   The number of modified LEDs.
+     *
+     * @return  A status code.
+     */
+    int MarkDirty(std::size_t index, std::size_t count) noexcept
+    {
+        return IsAttached() ? RaspiAPA102DeviceMarkDirty(device_, index, count) : -1;
+    }
+
+public:
+    /**
+     * @brief   Sets the color of a single LED.
+     *
+     * @param   index   The index of the LED (`0..N-1`, unchecked).
+     * @param   r       The red color component.
+     * @param   g       The green color component.
+     * @param   b       The blue color component.
+     *
+     * The LED uses the global brightness, or full brightness in `BrightnessMode::PerPixel`.
+     */
+    void Set(std::size_t index, std::uint8_t r, std::uint8_t g, std::uint8_t b) noexcept
+    {
+        Store(index, header_, r, g, b);
+    }
+
+    /**
+     * @brief   Sets the color and brightness of a single LED.
+     *
+     * @param   index       The index of the LED (`0..N-1`, unchecked).
+     * @param   r           The red color component.
+     * @param   g           The green color component.
+     * @param   b           The blue color component.
+     * @param   brightness  The LED brightness (0..31).
+     */
+    void Set(std::size_t index, std::uint8_t r, std::uint8_t g, std::uint8_t b, 
+        std::uint8_t brightness) noexcept
+    {
+        static_assert(Mode == BrightnessMode::PerPixel, 
+            "Per LED brightness requires BrightnessMode::PerPixel");
+
+        Store(index, static_cast<std::uint8_t>(0b11100000 | (brightness & 0b00011111)), r, g, b);
+    }
+
+    /**
+     * @brief   Sets a single LED from the given `RaspiAPA102ColorQuad` struct.
+     *
+     * @param   index   The index of the LED (`0..N-1`, unchecked).
+     * @param   color   The color. The brightness is ignored in `BrightnessMode::Global`.
+     */
+    void Set(std::size_t index, const RaspiAPA102ColorQuad& color) noexcept
+    {
+        if constexpr (Mode == BrightnessMode::PerPixel)
+        {
+            Store(index, static_cast<std::uint8_t>(0b11100000 | color.brightness), color.r, 
+                color.g, color.b);
+        }
+        else
+        {
+            Store(index, header_, color.r, color.g, color.b);
+        }
+    }
+
+    /**
+     * @brief   Sets all LEDs to the same color.
+     *
+     * @param   r   The red color component.
+     * @param   g   The green color component.
+     * @param   b   The blue color component.
+     */
+    void Fill(std::uint8_t r, std::uint8_t g, std::uint8_t b) noexcept
+    {
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            Store(i, header_, r, g, b);
+        }
+    }
+
+    /**
+     * @brief   Turns off all LEDs.
+     */
+    void Clear() noexcept
+    {
+        Fill(0, 0, 0);
+    }
+
+    /**
+     * @brief   Sets the brightness of all LEDs.
+     *
+     * @param   brightness  The brightness (0..31).
+     *
+     * The brightness byte of every LED frame is rewritten. In `BrightnessMode::PerPixel`, this only
+     * changes the brightness used by subsequent calls to `Set` without a brightness argument.
+     */
+    void SetBrightness(std::uint8_t brightness) noexcept
+    {
+        header_ = static_cast<std::uint8_t>(0b11100000 | (brightness & 0b00011111));
+        if constexpr (Mode == BrightnessMode::Global)
+        {
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                frame_[RASPI_APA102_START_FRAME_SIZE + i * sizeof(RaspiAPA102ColorQuad)] = 
+                    header_;
+            }
+        }
+    }
+
+    /**
+     * @brief   Returns the brightness of subsequently set LEDs.
+     *
+     * @return  The brightness (0..31).
+     */
+    std::uint8_t GetBrightness() const noexcept
+    {
+        return header_ & 0b00011111;
+    }
+
+public:
+    RaspiAPA102ColorQuad* data() noexcept
+    {
+        return reinterpret_cast<RaspiAPA102ColorQuad*>(
+            frame_.data() + RASPI_APA102_START_FRAME_SIZE);
+    }
+
+    const RaspiAPA102ColorQuad* data() const noexcept
+    {
+        return reinterpret_cast<const RaspiAPA102ColorQuad*>(
+            frame_.data() + RASPI_APA102_START_FRAME_SIZE);
+    }
+
+    static constexpr std::size_t size() noexcept
+    {
+        return N;
+    }
+
+    iterator begin() noexcept
+    {
+        return data();
+    }
+
+    iterator end() noexcept
+    {
+        return data() + N;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return data() + N;
+    }
+
+    RaspiAPA102ColorQuad& operator[](std::size_t index) noexcept
+    {
+        return data()[index];
+    }
+
+    const RaspiAPA102ColorQuad& operator[](std::size_t index) const noexcept
+    {
+        return data()[index];
+    }
+
+    /**
+     * @brief   Returns the complete framed buffer, including the start and end frame.
+     *
+     * @return  The framed buffer.
+     */
+    const std::array<std::uint8_t, FrameSize>& GetFrame() const noexcept
+    {
+        return frame_;
+    }
+
+private:
+    /**
+     * @brief   Returns the position of the given channel (`0` = red, `1` = green, `2` = blue) 
+     *          inside the color bytes of an LED frame.
+     */
+    static constexpr std::size_t GetChannelOffset(std::size_t channel) noexcept
+    {
+        constexpr std::size_t offsets[][3] =
+        {
+            { 2, 1, 0 }, // BGR
+            { 1, 2, 0 }, // BRG
+            { 2, 0, 1 }, // GBR
+            { 1, 0, 2 }, // GRB
+            { 0, 2, 1 }, // RBG
+            { 0, 1, 2 }  // RGB
+        };
+
+        return 1 + offsets[static_cast<std::size_t>(Order)][channel];
+    }
+
+    /**
+     * @brief   Returns the initial framed buffer.
+     */
+    static constexpr std::array<std::uint8_t, FrameSize> MakeFrame() noexcept
+    {
+        std::array<std::uint8_t, FrameSize> frame { };
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            frame[RASPI_APA102_START_FRAME_SIZE + i * sizeof(RaspiAPA102ColorQuad)] = 0b11100000;
+        }
+        const std::uint8_t end = (Chain == RASPI_APA102_CHAIN_MODE_LARGE) ? 0x00 : 0xFF;
+        for (std::size_t i = FrameSize - EndFrameSize; i < FrameSize; ++i)
+        {
+            frame[i] = end;
+        }
+
+        return frame;
+    }
+
+    /**
+     * @brief   The initial framed buffer, evaluated at compile time.
+     */
+    static constexpr std::array<std::uint8_t, FrameSize> InitialFrame = MakeFrame();
+
+    /**
+     * @brief   Writes a single LED frame.
+     */
+    void Store(std::size_t index, std::uint8_t header, std::uint8_t r, std::uint8_t g, 
+        std::uint8_t b) noexcept
+    {
+        std::uint8_t bytes[sizeof(RaspiAPA102ColorQuad)];
+        bytes[0] = header;
+        bytes[GetChannelOffset(0)] = r;
+        bytes[GetChannelOffset(1)] = g;
+        bytes[GetChannelOffset(2)] = b;
+        std::memcpy(&frame_[RASPI_APA102_START_FRAME_SIZE + index * sizeof(bytes)], bytes, 
+            sizeof(bytes));
+    }
+
+private:
+    /**
+     * @brief   The framed buffer. The buffer starts on a cache line boundary.
+     */
+    alignas(64) std::array<std::uint8_t, FrameSize> frame_;
+    /**
+     * @brief   The device the buffer is attached to, or `nullptr`.
+     */
+    RaspiAPA102Device* device_ = nullptr;
+    /**
+     * @brief   The brightness byte of subsequently set LEDs.
+     */
+    std::uint8_t header_ = 0xFF;
+};
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+} // namespace RaspiAPA102
+
+#endif /* STRIP_HPP */
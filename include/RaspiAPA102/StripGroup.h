@@ -0,0 +1,244 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides functions to drive multiple `APA102` devices from a single pixel canvas.
+ */
+
+#ifndef STRIP_GROUP_H
+#define STRIP_GROUP_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/APA102.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102StripSegment` struct.
+ *
+ * A segment maps a range of the canvas onto a range of LEDs of a device.
+ */
+typedef struct RaspiAPA102StripSegment_
+{
+    /**
+     * @brief   A pointer to the `RaspiAPA102Device` struct. The transmit buffer of the device has
+     *          to be allocated.
+     */
+    RaspiAPA102Device* device;
+    /**
+     * @brief   The index of the first pixel on the canvas.
+     */
+    size_t canvas_offset;
+    /**
+     * @brief   The index of the first LED on the device.
+     */
+    size_t device_offset;
+    /**
+     * @brief   The number of LEDs.
+     */
+    size_t length;
+    /**
+     * @brief   Signals, if the segment is mounted in reverse direction.
+     */
+    bool reversed;
+} RaspiAPA102StripSegment;
+
+/**
+ * @brief   Defines the `RaspiAPA102StripWorker` struct.
+ */
+typedef struct RaspiAPA102StripWorker_
+{
+    /**
+     * @brief   A pointer to the `RaspiAPA102StripGroup` struct.
+     */
+    struct RaspiAPA102StripGroup_* group;
+    /**
+     * @brief   The device driven by this worker.
+     */
+    RaspiAPA102Device* device;
+    /**
+     * @brief   The worker thread.
+     */
+    pthread_t thread;
+} RaspiAPA102StripWorker;
+
+/**
+ * @brief   Defines the `RaspiAPA102StripGroup` struct.
+ *
+ * Every device of the group is flushed by a dedicated worker thread, so the transfers to all 
+ * devices run concurrently.
+ *
+ * The worker threads keep a pointer to this struct. It must not be moved or copied between
+ * `RaspiAPA102StripGroupInit` and `RaspiAPA102StripGroupDestroy`.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102StripGroup_
+{
+    /**
+     * @brief   The canvas.
+     */
+    RaspiAPA102ColorQuad* canvas;
+    /**
+     * @brief   The number of pixels on the canvas.
+     */
+    size_t canvas_size;
+    /**
+     * @brief   The segments.
+     */
+    RaspiAPA102StripSegment* segments;
+    /**
+     * @brief   The number of segments.
+     */
+    size_t segment_count;
+    /**
+     * @brief   The workers (one for each distinct device).
+     */
+    RaspiAPA102StripWorker* workers;
+    /**
+     * @brief   The number of workers.
+     */
+    size_t worker_count;
+    /**
+     * @brief   The number of the current frame. Workers start a transfer whenever it changes.
+     */
+    uint64_t generation;
+    /**
+     * @brief   The number of workers that did not finish the current frame.
+     */
+    size_t pending;
+    /**
+     * @brief   The status code of the current frame.
+     */
+    int status;
+    /**
+     * @brief   Signals, if the workers should terminate.
+     */
+    bool stop;
+    /**
+     * @brief   The mutex that protects the frame state.
+     */
+    pthread_mutex_t mutex;
+    /**
+     * @brief   Signaled when a new frame was committed or the workers should terminate.
+     */
+    pthread_cond_t committed;
+    /**
+     * @brief   Signaled when all workers finished the current frame.
+     */
+    pthread_cond_t completed;
+} RaspiAPA102StripGroup;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Strip Group                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102StripGroup` struct and starts the worker threads.
+ *
+ * @param   group           A pointer to the `RaspiAPA102StripGroup` struct.
+ * @param   canvas_size     The number of pixels on the canvas.
+ * @param   segments        A pointer to an array of `RaspiAPA102StripSegment` structs. The array
+ *                          is copied.
+ * @param   segment_count   The number of structs in the passed array.
+ *
+ * The devices must not be used by the application until the group is destroyed. The struct must
+ * stay at the same address until the group is destroyed, since the worker threads refer to it.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102StripGroupInit(RaspiAPA102StripGroup* group, 
+    size_t canvas_size, const RaspiAPA102StripSegment* segments, size_t segment_count);
+
+/**
+ * @brief   Returns the canvas of the given `RaspiAPA102StripGroup` struct.
+ *
+ * @param   group   A pointer to the `RaspiAPA102StripGroup` struct.
+ * @param   canvas  Receives a pointer to the `RaspiAPA102ColorQuad` structs of the canvas.
+ * @param   size    Receives the number of pixels on the canvas. This parameter is optional.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102StripGroupGetCanvas(RaspiAPA102StripGroup* group, 
+    RaspiAPA102ColorQuad** canvas, size_t* size);
+
+/**
+ * @brief   Maps the canvas onto the devices and starts the transfers.
+ *
+ * @param   group   A pointer to the `RaspiAPA102StripGroup` struct.
+ *
+ * This function waits for the transfers of the previous frame to complete before it copies the 
+ * canvas into the transmit buffers of the devices. It returns as soon as the transfers were 
+ * started, so the canvas can be reused to render the next frame.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102StripGroupCommit(RaspiAPA102StripGroup* group);
+
+/**
+ * @brief   Waits until the transfers of the last committed frame completed on all devices.
+ *
+ * @param   group   A pointer to the `RaspiAPA102StripGroup` struct.
+ *
+ * @return  The status code of the last frame (`-1`, if the transfer to any device failed).
+ */
+RASPI_APA102_EXPORT int RaspiAPA102StripGroupWait(RaspiAPA102StripGroup* group);
+
+/**
+ * @brief   Stops the worker threads and releases all resources held by the given 
+ *          `RaspiAPA102StripGroup` struct.
+ *
+ * @param   group   A pointer to the `RaspiAPA102StripGroup` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102StripGroupDestroy(RaspiAPA102StripGroup* group);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STRIP_GROUP_H */
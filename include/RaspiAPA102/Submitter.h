@@ -0,0 +1,466 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a batched, non-blocking submission engine for frames to multiple `spidev` 
+ *          device nodes.
+ *
+ * A single thread queues the frames of all targets and submits them in one batch. The writes are 
+ * issued through `io_uring` if the kernel supports it, or through non-blocking `write` calls and
+ * `poll` otherwise. Each target has at most one write in flight, so the frames of a target are put
+ * on the wire in order; writes larger than the chunk size of a target (the `bufsiz` of the 
+ * `spidev` driver) are split. Any writable file descriptor (pipes, regular files) can stand in for
+ * a `spidev` node.
+ *
+ * The `spidev` write path uses the clock frequency configured on the device node, which is set 
+ * when a target is opened by `RaspiAPA102SubmitterOpenTarget`.
+ */
+
+#ifndef SUBMITTER_H
+#define SUBMITTER_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <RaspiAPA102/Transport.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102SubmitterBackend` enum.
+ */
+typedef enum RaspiAPA102SubmitterBackend_
+{
+    /**
+     * @brief   Uses `io_uring` if available and falls back to 
+     *          `RASPI_APA102_SUBMITTER_BACKEND_POLL`.
+     */
+    RASPI_APA102_SUBMITTER_BACKEND_AUTO,
+    /**
+     * @brief   Issues the writes through an `io_uring` instance.
+     */
+    RASPI_APA102_SUBMITTER_BACKEND_IO_URING,
+    /**
+     * @brief   Issues non-blocking `write` calls and waits with `poll`.
+     */
+    RASPI_APA102_SUBMITTER_BACKEND_POLL,
+    /**
+     * @brief   Maximum value of this enum.
+     */
+    RASPI_APA102_SUBMITTER_BACKEND_MAX_VALUE = RASPI_APA102_SUBMITTER_BACKEND_POLL
+} RaspiAPA102SubmitterBackend;
+
+/**
+ * @brief   Defines the `RaspiAPA102SubmitterStats` struct.
+ *
+ * All times are values of the monotonic clock in nanoseconds. The latency of a frame is measured 
+ * from the call to `RaspiAPA102SubmitterSubmit` that issued its first write to the completion of 
+ * its last write.
+ */
+typedef struct RaspiAPA102SubmitterStats_
+{
+    /**
+     * @brief   The number of completed frames.
+     */
+    uint64_t frames;
+    /**
+     * @brief   The number of frames that were dropped due to a write error.
+     */
+    uint64_t errors;
+    /**
+     * @brief   The total number of bytes written.
+     */
+    uint64_t bytes;
+    /**
+     * @brief   The completion time of the last frame.
+     */
+    uint64_t last_completion_ns;
+    /**
+     * @brief   The latency of the last frame.
+     */
+    uint64_t last_latency_ns;
+    /**
+     * @brief   The highest latency of all frames.
+     */
+    uint64_t max_latency_ns;
+    /**
+     * @brief   The sum of the latencies of all frames.
+     */
+    uint64_t total_latency_ns;
+} RaspiAPA102SubmitterStats;
+
+/**
+ * @brief   Defines the `RaspiAPA102SubmitterWrite` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102SubmitterWrite_
+{
+    /**
+     * @brief   A pointer to the data.
+     */
+    const uint8_t* data;
+    /**
+     * @brief   The size of the data in bytes.
+     */
+    size_t size;
+    /**
+     * @brief   The time of the submission of the frame this write belongs to, or `0`.
+     */
+    uint64_t submit_ns;
+    /**
+     * @brief   Signals, if this write completes a frame.
+     */
+    bool frame_end;
+} RaspiAPA102SubmitterWrite;
+
+/**
+ * @brief   Defines the `RaspiAPA102SubmitterTarget` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102SubmitterTarget_
+{
+    /**
+     * @brief   A pointer to the `RaspiAPA102Submitter` struct that owns this target.
+     */
+    struct RaspiAPA102Submitter_* submitter;
+    /**
+     * @brief   The file descriptor.
+     */
+    int fd;
+    /**
+     * @brief   Signals, if the file descriptor is closed by the submitter.
+     */
+    bool owned;
+    /**
+     * @brief   Signals, if a write of this target is in flight.
+     */
+    bool busy;
+    /**
+     * @brief   The maximum number of bytes per write.
+     */
+    size_t chunk_size;
+    /**
+     * @brief   The ring of queued writes (`depth` entries).
+     */
+    RaspiAPA102SubmitterWrite* writes;
+    /**
+     * @brief   The index of the oldest queued write.
+     */
+    size_t head;
+    /**
+     * @brief   The number of queued writes.
+     */
+    size_t length;
+    /**
+     * @brief   The number of queued writes that were already submitted.
+     */
+    size_t submitted;
+    /**
+     * @brief   The number of bytes of the oldest write that are already written.
+     */
+    size_t offset;
+    /**
+     * @brief   The statistics of this target.
+     */
+    RaspiAPA102SubmitterStats stats;
+} RaspiAPA102SubmitterTarget;
+
+/**
+ * @brief   Defines the `RaspiAPA102Submitter` struct.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102Submitter_
+{
+    /**
+     * @brief   The backend in use.
+     */
+    RaspiAPA102SubmitterBackend backend;
+    /**
+     * @brief   The targets.
+     */
+    RaspiAPA102SubmitterTarget* targets;
+    /**
+     * @brief   The number of targets.
+     */
+    size_t target_count;
+    /**
+     * @brief   The maximum number of targets.
+     */
+    size_t capacity;
+    /**
+     * @brief   The maximum number of queued writes per target.
+     */
+    size_t depth;
+    /**
+     * @brief   The number of writes in flight.
+     */
+    size_t in_flight;
+    /**
+     * @brief   The number of frames completed by `RaspiAPA102SubmitterSubmit` that were not yet 
+     *          reported by `RaspiAPA102SubmitterReap`.
+     */
+    size_t completed;
+    /**
+     * @brief   The `pollfd` array of the `poll` backend (`capacity` entries).
+     */
+    void* poll_fds;
+    /**
+     * @brief   The file descriptor of the `io_uring` instance, or `-1`.
+     */
+    int ring_fd;
+    /**
+     * @brief   The mapping of the submission queue ring.
+     */
+    void* sq_ring;
+    /**
+     * @brief   The size of the submission queue ring mapping in bytes.
+     */
+    size_t sq_ring_size;
+    /**
+     * @brief   The mapping of the completion queue ring, or `NULL` if it shares the submission 
+     *          queue ring mapping.
+     */
+    void* cq_ring;
+    /**
+     * @brief   The size of the completion queue ring mapping in bytes.
+     */
+    size_t cq_ring_size;
+    /**
+     * @brief   The mapping of the submission queue entries.
+     */
+    void* sqes;
+    /**
+     * @brief   The size of the submission queue entries mapping in bytes.
+     */
+    size_t sqes_size;
+    /**
+     * @brief   The tail of the submission queue.
+     */
+    volatile uint32_t* sq_tail;
+    /**
+     * @brief   The index mask of the submission queue.
+     */
+    uint32_t sq_mask;
+    /**
+     * @brief   The index array of the submission queue.
+     */
+    uint32_t* sq_array;
+    /**
+     * @brief   The head of the completion queue.
+     */
+    volatile uint32_t* cq_head;
+    /**
+     * @brief   The tail of the completion queue.
+     */
+    volatile uint32_t* cq_tail;
+    /**
+     * @brief   The index mask of the completion queue.
+     */
+    uint32_t cq_mask;
+    /**
+     * @brief   The completion queue entries.
+     */
+    void* cqes;
+    /**
+     * @brief   The number of prepared submission queue entries that are not yet submitted.
+     */
+    uint32_t sq_pending;
+} RaspiAPA102Submitter;
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102Submitter` struct.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   backend     The backend.
+ * @param   capacity    The maximum number of targets.
+ * @param   depth       The maximum number of queued writes per target. An update through a device
+ *                      transport takes at least three writes (start frame, LED frames and end 
+ *                      frame blocks); a framed buffer takes one.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterInit(RaspiAPA102Submitter* submitter, 
+    RaspiAPA102SubmitterBackend backend, size_t capacity, size_t depth);
+
+/**
+ * @brief   Returns the backend of the given submitter.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   backend     Receives the backend in use (never `RASPI_APA102_SUBMITTER_BACKEND_AUTO`).
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterGetBackend(const RaspiAPA102Submitter* submitter, 
+    RaspiAPA102SubmitterBackend* backend);
+
+/**
+ * @brief   Opens a `spidev` device node and adds it as a target.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   path        The path of the device node.
+ * @param   speed_hz    The `SPI` clock frequency in Hz.
+ * @param   target      Receives the index of the target.
+ *
+ * The chunk size is the `bufsiz` of the `spidev` driver. The configuration of the `SPI` mode and 
+ * clock frequency is skipped for files that are not `spidev` nodes.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterOpenTarget(RaspiAPA102Submitter* submitter, 
+    const char* path, uint32_t speed_hz, size_t* target);
+
+/**
+ * @brief   Adds the given file descriptor as a target.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   fd          The file descriptor. It stays owned by the caller. The `poll` backend 
+ *                      switches it to non-blocking mode.
+ * @param   chunk_size  The maximum number of bytes per write, or `0` for no limit.
+ * @param   target      Receives the index of the target.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterAddTarget(RaspiAPA102Submitter* submitter, int fd, 
+    size_t chunk_size, size_t* target);
+
+/**
+ * @brief   Returns a transport that queues all writes for the given target.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   target      The index of the target.
+ * @param   transport   Receives the transport.
+ *
+ * The `flush` callback completes the frame, but does not wait for it: the frame is issued by the 
+ * next call to `RaspiAPA102SubmitterSubmit`. The written buffers (e.g. the transmit buffer of the
+ * device) have to stay unchanged until the frame is completed. The transport does not own the 
+ * target.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterGetTransport(RaspiAPA102Submitter* submitter, 
+    size_t target, RaspiAPA102Transport* transport);
+
+/**
+ * @brief   Queues a complete framed buffer for the given target.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   target      The index of the target.
+ * @param   frame       A pointer to the framed buffer. It has to stay unchanged until the frame is
+ *                      completed.
+ * @param   size        The size of the framed buffer in bytes.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterQueueFrame(RaspiAPA102Submitter* submitter, 
+    size_t target, const uint8_t* frame, size_t size);
+
+/**
+ * @brief   Issues the queued writes of all idle targets.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ *
+ * With `io_uring`, the writes of all targets are submitted by a single system call. This function
+ * does not block.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterSubmit(RaspiAPA102Submitter* submitter);
+
+/**
+ * @brief   Processes the completed writes and issues the following writes of their targets.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   wait        Pass `true` to block until at least one write completes, if any write is 
+ *                      in flight.
+ * @param   frames      Receives the number of frames completed since the last call (including 
+ *                      frames the `poll` backend completed within `RaspiAPA102SubmitterSubmit`). 
+ *                      This parameter is optional.
+ *
+ * Write errors are not reported here; they drop the affected frame and are counted in the 
+ * statistics of the target.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterReap(RaspiAPA102Submitter* submitter, bool wait, 
+    size_t* frames);
+
+/**
+ * @brief   Blocks until all submitted frames are completed.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterWait(RaspiAPA102Submitter* submitter);
+
+/**
+ * @brief   Returns the statistics of the given target.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   target      The index of the target.
+ * @param   stats       Receives the statistics.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterGetStats(const RaspiAPA102Submitter* submitter, 
+    size_t target, RaspiAPA102SubmitterStats* stats);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102Submitter` struct.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ *
+ * Pending writes are discarded. Targets opened by `RaspiAPA102SubmitterOpenTarget` are closed.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102SubmitterDestroy(RaspiAPA102Submitter* submitter);
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SUBMITTER_H */
@@ -0,0 +1,240 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides a small work-stealing thread pool that splits pixel ranges across cores.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102ThreadPoolFunction` function prototype.
+ *
+ * @param   context The context passed to `RaspiAPA102ThreadPoolRun`.
+ * @param   begin   The index of the first item of the tile.
+ * @param   end     The index behind the last item of the tile.
+ */
+typedef void (*RaspiAPA102ThreadPoolFunction)(void* context, size_t begin, size_t end);
+
+/**
+ * @brief   Defines the `RaspiAPA102ThreadPoolWorker` struct.
+ */
+typedef struct RaspiAPA102ThreadPoolWorker_
+{
+    /**
+     * @brief   A pointer to the `RaspiAPA102ThreadPool` struct.
+     */
+    struct RaspiAPA102ThreadPool_* pool;
+    /**
+     * @brief   The index of the tile queue owned by this worker.
+     */
+    size_t index;
+    /**
+     * @brief   The worker thread.
+     */
+    pthread_t thread;
+} RaspiAPA102ThreadPoolWorker;
+
+/**
+ * @brief   Defines the `RaspiAPA102ThreadPool` struct.
+ *
+ * The calling thread and every worker own a queue of tiles. Each queue is a single word that 
+ * holds a contiguous range of tile indices: the owner takes tiles from the front, idle threads 
+ * steal the back half of another queue. Both operations are a single compare-and-swap.
+ *
+ * All fields in this struct should be considered as "private". Any changes may lead to unexpected
+ * behavior.
+ */
+typedef struct RaspiAPA102ThreadPool_
+{
+    /**
+     * @brief   The workers.
+     */
+    RaspiAPA102ThreadPoolWorker* workers;
+    /**
+     * @brief   The number of workers (not including the calling thread).
+     */
+    size_t worker_count;
+    /**
+     * @brief   The tile queues (one cache line for each thread).
+     */
+    uint32_t* queues;
+    /**
+     * @brief   The function of the current run.
+     */
+    RaspiAPA102ThreadPoolFunction function;
+    /**
+     * @brief   The context of the current run.
+     */
+    void* context;
+    /**
+     * @brief   The number of items of the current run.
+     */
+    size_t count;
+    /**
+     * @brief   The number of items per tile of the current run.
+     */
+    size_t tile_size;
+    /**
+     * @brief   The number of the current run. Workers start working whenever it changes.
+     */
+    uint64_t generation;
+    /**
+     * @brief   The number of workers that did not finish the current run.
+     */
+    size_t pending;
+    /**
+     * @brief   Signals, if the workers should terminate.
+     */
+    bool stop;
+    /**
+     * @brief   The number of completed runs.
+     */
+    uint64_t runs;
+    /**
+     * @brief   The number of successful steals.
+     */
+    uint64_t steals;
+    /**
+     * @brief   The mutex that protects the run state.
+     */
+    pthread_mutex_t mutex;
+    /**
+     * @brief   Signaled when a new run was started or the workers should terminate.
+     */
+    pthread_cond_t started;
+    /**
+     * @brief   Signaled when all workers finished the current run.
+     */
+    pthread_cond_t completed;
+} RaspiAPA102ThreadPool;
+
+/* ============================================================================================== */
+/* Macros                                                                                         */
+/* ============================================================================================== */
+
+/**
+ * @brief   The maximum number of tiles of a single run. Larger ranges use larger tiles.
+ */
+#define RASPI_APA102_THREAD_POOL_MAX_TILES 65535
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread Pool                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102ThreadPool` struct and starts the worker threads.
+ *
+ * @param   pool            A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   thread_count    The number of threads that work on a run, including the calling 
+ *                          thread, or `0` to use one thread for each online CPU.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ThreadPoolInit(RaspiAPA102ThreadPool* pool, 
+    size_t thread_count);
+
+/**
+ * @brief   Returns the number of threads that work on a run, including the calling thread.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   count   Receives the number of threads.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ThreadPoolGetThreadCount(const RaspiAPA102ThreadPool* pool, 
+    size_t* count);
+
+/**
+ * @brief   Splits the given range of items into tiles and processes them on all threads.
+ *
+ * @param   pool        A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   count       The number of items.
+ * @param   tile_size   The number of items per tile.
+ * @param   function    The function that processes a single tile.
+ * @param   context     The context passed to the function.
+ *
+ * The tiles are distributed evenly across the threads up front; threads that run out of tiles 
+ * steal from the others, so uneven tiles and preempted cores do not stall the run. The calling 
+ * thread takes part and this function returns when all tiles were processed. A pool runs one 
+ * range at a time.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ThreadPoolRun(RaspiAPA102ThreadPool* pool, size_t count, 
+    size_t tile_size, RaspiAPA102ThreadPoolFunction function, void* context);
+
+/**
+ * @brief   Returns the statistics of the given `RaspiAPA102ThreadPool` struct.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   runs    Receives the number of completed runs. This parameter is optional.
+ * @param   steals  Receives the number of successful steals. This parameter is optional.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ThreadPoolGetStats(RaspiAPA102ThreadPool* pool, 
+    uint64_t* runs, uint64_t* steals);
+
+/**
+ * @brief   Stops the worker threads and releases all resources held by the given 
+ *          `RaspiAPA102ThreadPool` struct.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102ThreadPool` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102ThreadPoolDestroy(RaspiAPA102ThreadPool* pool);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THREAD_POOL_H */
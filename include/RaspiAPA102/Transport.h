@@ -0,0 +1,224 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Provides the transport interface used to put `APA102` frames on the wire.
+ */
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <RaspiAPA102ExportConfig.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Enums and types                                                                                */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transport                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `RaspiAPA102TransportOpen` function prototype.
+ *
+ * @param   context The transport context.
+ *
+ * @return  A status code.
+ */
+typedef int (*RaspiAPA102TransportOpen)(void* context);
+
+/**
+ * @brief   Defines the `RaspiAPA102TransportWrite` function prototype.
+ *
+ * @param   context The transport context.
+ * @param   buffer  A pointer to the data buffer.
+ * @param   size    The number of bytes to write.
+ *
+ * The transport may defer the actual output until the next call to `flush`. The passed buffer has
+ * to stay valid until then.
+ *
+ * @return  A status code.
+ */
+typedef int (*RaspiAPA102TransportWrite)(void* context, const uint8_t* buffer, size_t size);
+
+/**
+ * @brief   Defines the `RaspiAPA102TransportFlush` function prototype.
+ *
+ * @param   context The transport context.
+ *
+ * Completes the current frame. All data passed to `write` since the last call is on the wire
+ * when this function returns.
+ *
+ * @return  A status code.
+ */
+typedef int (*RaspiAPA102TransportFlush)(void* context);
+
+/**
+ * @brief   Defines the `RaspiAPA102TransportClose` function prototype.
+ *
+ * @param   context The transport context.
+ */
+typedef void (*RaspiAPA102TransportClose)(void* context);
+
+/**
+ * @brief   Defines the `RaspiAPA102Transport` struct.
+ *
+ * A transport puts the byte stream of the `APA102` framing on the wire. The `open` and `close`
+ * callbacks are optional.
+ */
+typedef struct RaspiAPA102Transport_
+{
+    /**
+     * @brief   The opaque transport context passed to all callbacks.
+     */
+    void* context;
+    /**
+     * @brief   The `open` callback.
+     */
+    RaspiAPA102TransportOpen open;
+    /**
+     * @brief   The `write` callback.
+     */
+    RaspiAPA102TransportWrite write;
+    /**
+     * @brief   The `flush` callback.
+     */
+    RaspiAPA102TransportFlush flush;
+    /**
+     * @brief   The `close` callback.
+     */
+    RaspiAPA102TransportClose close;
+} RaspiAPA102Transport;
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Capture                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Defines the `RaspiAPA102Capture` struct.
+ *
+ * The capture transport records the exact byte stream that would be put on the wire. Bits are
+ * transmitted MSB first.
+ */
+typedef struct RaspiAPA102Capture_
+{
+    /**
+     * @brief   The captured data.
+     */
+    uint8_t* data;
+    /**
+     * @brief   The number of captured bytes.
+     */
+    size_t size;
+    /**
+     * @brief   The capacity of the `data` buffer.
+     */
+    size_t capacity;
+    /**
+     * @brief   Signals, if all frames are accumulated. Otherwise only the last frame is kept.
+     */
+    bool accumulate;
+    /**
+     * @brief   Signals, if the next write starts a new frame.
+     */
+    bool frame_complete;
+    /**
+     * @brief   The number of completed frames.
+     */
+    uint64_t frame_count;
+    /**
+     * @brief   The total number of bytes written.
+     */
+    uint64_t bytes_total;
+} RaspiAPA102Capture;
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Capture                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given `RaspiAPA102Capture` struct.
+ *
+ * @param   capture     A pointer to the `RaspiAPA102Capture` struct.
+ * @param   accumulate  Pass `true` to keep the data of all frames or `false` to only keep the
+ *                      data of the last frame.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CaptureInit(RaspiAPA102Capture* capture, bool accumulate);
+
+/**
+ * @brief   Returns a transport that writes to the given `RaspiAPA102Capture` struct.
+ *
+ * @param   capture     A pointer to the `RaspiAPA102Capture` struct.
+ * @param   transport   Receives the transport.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CaptureGetTransport(RaspiAPA102Capture* capture,
+    RaspiAPA102Transport* transport);
+
+/**
+ * @brief   Discards all captured data.
+ *
+ * @param   capture A pointer to the `RaspiAPA102Capture` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CaptureReset(RaspiAPA102Capture* capture);
+
+/**
+ * @brief   Releases all resources held by the given `RaspiAPA102Capture` struct.
+ *
+ * @param   capture A pointer to the `RaspiAPA102Capture` struct.
+ *
+ * @return  A status code.
+ */
+RASPI_APA102_EXPORT int RaspiAPA102CaptureDestroy(RaspiAPA102Capture* capture);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRANSPORT_H */
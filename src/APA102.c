@@ -25,80 +25,172 @@
 ***************************************************************************************************/
 
 #include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/SoftSPI.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
-#include <wiringPi.h>
+#include <APA102Internal.h>
+#include <StatsInternal.h>
+#include <TransportInternal.h>
 
 /* ============================================================================================== */
 /* Internal constants                                                                             */
 /* ============================================================================================== */
 
-#define RASPI_APA102_CLCK_STRETCH 5
+/**
+ * @brief   A start frame of 32 zero bits (<0x00> <0x00> <0x00> <0x00>).
+ */
+static const uint8_t RASPI_APA102_START_FRAME[RASPI_APA102_START_FRAME_SIZE] = { 0 };
+
+/**
+ * @brief   A block of end frame bytes for `RASPI_APA102_CHAIN_MODE_DEFAULT`.
+ */
+static const uint8_t RASPI_APA102_END_FRAME[64] = 
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/**
+ * @brief   A block of end frame bytes for `RASPI_APA102_CHAIN_MODE_LARGE` and for the end frames 
+ *          behind a dirty prefix.
+ *
+ * A single block covers the reset frame and the end frame of 16320 LEDs, which keeps the number of
+ * transport writes per update small for long strings.
+ */
+static const uint8_t RASPI_APA102_END_FRAME_LARGE[1024] = { 0 };
 
 /* ============================================================================================== */
 /* Internal functions                                                                             */
 /* ============================================================================================== */
 
 /* ---------------------------------------------------------------------------------------------- */
-/* SPI                                                                                            */
+/* Device                                                                                         */
 /* ---------------------------------------------------------------------------------------------- */
 
 /**
- * @brief   Writes the specified amount of bits from the given buffer to the `SPI` device.
+ * @brief   Initializes the given `APA102` device struct.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ */
+static void RaspiAPA102DeviceInitStruct(RaspiAPA102Device* device)
+{
+    memset(device, 0, sizeof(*device));
+}
+
+/**
+ * @brief   Removes the transmit buffer from the given `APA102` device and releases it, if it is 
+ *          owned by the device.
  * 
- * @param   device          A pointer to the `RaspiAPA102Device` struct.
- * @param   buffer          A pointer to the data buffer.
- * @param   number_of_bits  The number of bits to write.
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
  */
-static void RaspiAPA102SPIWriteBuffer(const RaspiAPA102Device* device, const uint8_t* buffer, 
-    size_t number_of_bits)
+static void RaspiAPA102DeviceReleaseBuffer(RaspiAPA102Device* device)
 {
-    if (device->native_spi)
+    if (device->frame_owned)
     {
-        // TODO:
-        return;
+        free(device->frame);
     }
+    device->frame          = NULL;
+    device->frame_size     = 0;
+    device->frame_capacity = 0;
+    device->frame_owned    = false;
+    device->count          = 0;
+    device->dirty_count    = 0;
+}
 
-    const uint8_t pin_sclk = device->pin_sclk;
-    const uint8_t pin_mosi = device->pin_mosi;
-    const uint8_t pin_cs = device->pin_cs;
+/**
+ * @brief   Writes an end frame for the given number of LEDs to the transport of the given `APA102`
+ *          device.
+ * 
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   count   The number of LEDs that were sent.
+ * @param   prefix  Signals, if only a prefix of the string was sent.
+ * 
+ * The end frame behind a prefix always consists of zero bits, as the first LED behind the prefix 
+ * would otherwise latch four bytes of ones as a white LED frame.
+ * 
+ * @return  A status code.
+ */
+static int RaspiAPA102DeviceWriteEndFrame(const RaspiAPA102Device* device, size_t count, 
+    bool prefix)
+{
+    const RaspiAPA102Transport* const transport = &device->transport;
 
-    if (pin_cs >= 0)
+    const bool zero = prefix || (device->chain_mode == RASPI_APA102_CHAIN_MODE_LARGE);
+    const uint8_t* const block = zero ? RASPI_APA102_END_FRAME_LARGE : RASPI_APA102_END_FRAME;
+    const size_t block_size = zero ? 
+        sizeof(RASPI_APA102_END_FRAME_LARGE) : sizeof(RASPI_APA102_END_FRAME);
+
+    size_t remaining = RaspiAPA102FrameGetEndSize(count, device->chain_mode);
+    while (remaining > 0)
     {
-        digitalWrite(pin_sclk, LOW);
+        const size_t size = (remaining < block_size) ? remaining : block_size;
+        const int status = transport->write(transport->context, block, size);
+        if (status < 0)
+        {
+            return status;
+        }
+        remaining -= size;
     }
 
-    size_t number_of_bytes = number_of_bits / 8;
-    size_t remaining_bits = number_of_bits % 8;
-    if (remaining_bits > 0)
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Library functions                                                                              */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Framing                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+void RaspiAPA102FrameInit(uint8_t* frame, size_t count, RaspiAPA102ChainMode mode)
+{
+    memset(frame, 0x00, RASPI_APA102_START_FRAME_SIZE);
+
+    RaspiAPA102ColorQuad* const colors = RaspiAPA102FrameGetColors(frame);
+    for (size_t i = 0; i < count; ++i)
     {
-        ++number_of_bytes;
+        RaspiAPA102ColorQuadInit(&colors[i], 0, 0, 0, 0);
     }
 
-    for (int i = 0; i < number_of_bytes; ++i)
-    {
-        const uint8_t byte = buffer[i];
-        uint8_t bits = 8;
-        if (i == number_of_bytes - 1)
-        {
-            bits = remaining_bits;
-        }
+    RaspiAPA102FrameInitEnd(frame, count, mode);
+}
 
-        for (int j = 0; j < 8; ++j)
-        {
-            digitalWrite(pin_mosi, (byte & (1 << (7 - j))) > 0);
-            digitalWrite(pin_sclk, HIGH);
-            usleep(RASPI_APA102_CLCK_STRETCH);
-            digitalWrite(pin_sclk, LOW);
-            usleep(RASPI_APA102_CLCK_STRETCH);
-        }
-    }
+void RaspiAPA102FrameInitEnd(uint8_t* frame, size_t count, RaspiAPA102ChainMode mode)
+{
+    memset(&RaspiAPA102FrameGetColors(frame)[count], 
+        (mode == RASPI_APA102_CHAIN_MODE_LARGE) ? 0x00 : 0xFF, 
+        RaspiAPA102FrameGetEndSize(count, mode));
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Device                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102DeviceWriteFrame(const RaspiAPA102Device* device, const uint8_t* frame, 
+    size_t size)
+{
+    const RaspiAPA102Transport* const transport = &device->transport;
+
+    RaspiAPA102StatsTimer timer = { 0 };
+    RaspiAPA102StatsTimerStart(device, &timer);
 
-    if (pin_cs >= 0)
+    int status = transport->write(transport->context, frame, size);
+    RaspiAPA102StatsTimerLap(device, &timer, RASPI_APA102_STATS_STAGE_TRANSFER);
+    if (status == 0)
     {
-        digitalWrite(pin_sclk, HIGH);
+        status = transport->flush(transport->context);
+        RaspiAPA102StatsTimerLap(device, &timer, RASPI_APA102_STATS_STAGE_FLUSH);
     }
+
+    RaspiAPA102StatsTimerFrame(device, &timer, size, status);
+
+    return status;
 }
 
 /* ---------------------------------------------------------------------------------------------- */
@@ -118,15 +210,32 @@ int RaspiAPA102DeviceInitHardware(RaspiAPA102Device* device, uint8_t channel)
         return -1;
     }
 
-    device->native_spi = true;
-    device->channel    = channel;
+    char path[32];
+    snprintf(path, sizeof(path), "/dev/spidev0.%u", channel);
 
-    //wiringPiSPISetup(channel, 500000);
+    return RaspiAPA102DeviceInitSPIDev(device, path, RASPI_APA102_SPI_DEFAULT_SPEED);
+}
 
-    return 0;
+int RaspiAPA102DeviceInitSPIDev(RaspiAPA102Device* device, const char* path, uint32_t speed_hz)
+{
+    if (!device || !path || !speed_hz)
+    {
+        return -1;
+    }
+
+    RaspiAPA102DeviceInitStruct(device);
+
+    return RaspiAPA102SPIDevTransportCreate(&device->transport, path, speed_hz);
 }
 
 int RaspiAPA102DeviceInitSoftware(RaspiAPA102Device* device, int pin_sclk, int pin_mosi, int pin_cs)
+{
+    return RaspiAPA102DeviceInitSoftwareEx(device, pin_sclk, pin_mosi, pin_cs, 
+        RASPI_APA102_SOFT_SPI_DEFAULT_SPEED);
+}
+
+int RaspiAPA102DeviceInitSoftwareEx(RaspiAPA102Device* device, int pin_sclk, int pin_mosi, 
+    int pin_cs, uint32_t clock_hz)
 {
     if (!device || 
         (pin_sclk < 0) || (pin_sclk > 29) || 
@@ -136,19 +245,58 @@ int RaspiAPA102DeviceInitSoftware(RaspiAPA102Device* device, int pin_sclk, int p
         return -1;
     }
 
-    device->native_spi = false;
-    device->pin_sclk   = pin_sclk;
-    device->pin_mosi   = pin_mosi;
-    device->pin_cs     = pin_cs;
+    RaspiAPA102DeviceInitStruct(device);
+
+    return RaspiAPA102SoftSPITransportCreate(&device->transport, pin_sclk, pin_mosi, pin_cs, 
+        clock_hz);
+}
+
+int RaspiAPA102DeviceInitDMA(RaspiAPA102Device* device, uint32_t speed_hz, size_t count)
+{
+    if (!device || !speed_hz || !count || (count > RASPI_APA102_MAX_COUNT))
+    {
+        return -1;
+    }
+
+    RaspiAPA102DeviceInitStruct(device);
+
+    // Leave room for the larger end frame, so that the chain mode can be changed later on
+    return RaspiAPA102DMATransportCreate(&device->transport, speed_hz, 
+        RaspiAPA102FrameGetSize(count, RASPI_APA102_CHAIN_MODE_LARGE));
+}
+
+int RaspiAPA102DeviceInitTransport(RaspiAPA102Device* device, const RaspiAPA102Transport* transport)
+{
+    if (!device || !transport || !transport->write || !transport->flush)
+    {
+        return -1;
+    }
+
+    if (transport->open && (transport->open(transport->context) < 0))
+    {
+        return -1;
+    }
+
+    RaspiAPA102DeviceInitStruct(device);
+    device->transport = *transport;
+
+    return 0;
+}
+
+int RaspiAPA102DeviceDestroy(RaspiAPA102Device* device)
+{
+    if (!device)
+    {
+        return -1;
+    }
 
-    wiringPiSetupGpio();
-    pinMode(pin_sclk, OUTPUT);
-    pinMode(pin_mosi, OUTPUT);
-    if (pin_cs >= 0)
+    if (device->transport.close)
     {
-        pinMode(pin_cs, OUTPUT);
-        digitalWrite(pin_cs, HIGH);
+        device->transport.close(device->transport.context);
     }
+    RaspiAPA102DeviceReleaseBuffer(device);
+    free(device->stats);
+    RaspiAPA102DeviceInitStruct(device);
 
     return 0;
 }
@@ -156,37 +304,282 @@ int RaspiAPA102DeviceInitSoftware(RaspiAPA102Device* device, int pin_sclk, int p
 int RaspiAPA102DeviceUpdate(const RaspiAPA102Device* device, const RaspiAPA102ColorQuad* colors, 
     size_t count)
 {
-    if (!device || !colors || !count)
+    if (!device || !device->transport.write || !colors || !count || 
+        (count > RASPI_APA102_MAX_COUNT))
     {
         return -1;
     }
 
-    size_t bits = count / 2;
-    if (count % 2 > 0)
+    const RaspiAPA102Transport* const transport = &device->transport;
+
+    RaspiAPA102StatsTimer timer = { 0 };
+    RaspiAPA102StatsTimerStart(device, &timer);
+
+    int status = transport->write(transport->context, RASPI_APA102_START_FRAME, 
+        RASPI_APA102_START_FRAME_SIZE);
+
+    // A 32 bit LED frame for each LED in the string (<0xE0+brightness> <blue> <green> <red>) 
+    if (status == 0)
     {
-        ++bits;
+        status = transport->write(transport->context, (const uint8_t*)colors, 
+            count * sizeof(RaspiAPA102ColorQuad));
+        RaspiAPA102StatsTimerLap(device, &timer, RASPI_APA102_STATS_STAGE_TRANSFER);
     }
-    const size_t bytes = ((bits + 7) & ~7) / 8;
 
-    void* const buffer = malloc(bytes);
-    if (buffer == NULL)
+    if (status == 0)
+    {
+        status = RaspiAPA102DeviceWriteEndFrame(device, count, false);
+        RaspiAPA102StatsTimerLap(device, &timer, RASPI_APA102_STATS_STAGE_END_FRAME);
+    }
+
+    if (status == 0)
+    {
+        status = transport->flush(transport->context);
+        RaspiAPA102StatsTimerLap(device, &timer, RASPI_APA102_STATS_STAGE_FLUSH);
+    }
+
+    RaspiAPA102StatsTimerFrame(device, &timer, RaspiAPA102FrameGetSize(count, device->chain_mode), 
+        status);
+
+    return status;
+}
+
+int RaspiAPA102DeviceAllocateBuffer(RaspiAPA102Device* device, size_t count)
+{
+    if (!device || !count || (count > RASPI_APA102_MAX_COUNT))
     {
         return -1;
     }
 
-    // A start frame of 32 zero bits (<0x00> <0x00> <0x00> <0x00>)
-    const uint32_t init = 0;
-    RaspiAPA102SPIWriteBuffer(device, (uint8_t*)&init, 32);
+    // Leave room for the larger end frame, so that the chain mode can be changed in place
+    const size_t capacity = RaspiAPA102FrameGetSize(count, RASPI_APA102_CHAIN_MODE_LARGE);
+    uint8_t* const frame = malloc(capacity);
+    if (!frame)
+    {
+        return -1;
+    }
+    RaspiAPA102FrameInit(frame, count, device->chain_mode);
 
-    // A 32 bit LED frame for each LED in the string (<0xE0+brightness> <blue> <green> <red>) 
-    RaspiAPA102SPIWriteBuffer(device, (uint8_t*)colors, count * 32);
+    RaspiAPA102DeviceReleaseBuffer(device);
+    device->frame          = frame;
+    device->frame_size     = RaspiAPA102FrameGetSize(count, device->chain_mode);
+    device->frame_capacity = capacity;
+    device->frame_owned    = true;
+    device->count          = count;
+    device->dirty_count    = count;
 
-    // An end frame consisting of at least (n/2) bits of 1, where n is the number of LEDs in the 
-    // string
-    memset(buffer, 0xFF, bytes);
-    RaspiAPA102SPIWriteBuffer(device, buffer, bits);
+    return 0;
+}
 
-    free(buffer);
+int RaspiAPA102DeviceAttachBuffer(RaspiAPA102Device* device, uint8_t* buffer, size_t size, 
+    size_t count)
+{
+    if (!device || !buffer || !count || (count > RASPI_APA102_MAX_COUNT) || 
+        (size < RaspiAPA102FrameGetSize(count, device->chain_mode)) || 
+        (device->frame_owned && (buffer == device->frame)))
+    {
+        return -1;
+    }
+
+    // Only the head and tail room are written, the LED frames belong to the caller
+    memset(buffer, 0x00, RASPI_APA102_START_FRAME_SIZE);
+    RaspiAPA102FrameInitEnd(buffer, count, device->chain_mode);
+
+    RaspiAPA102DeviceReleaseBuffer(device);
+    device->frame          = buffer;
+    device->frame_size     = RaspiAPA102FrameGetSize(count, device->chain_mode);
+    device->frame_capacity = size;
+    device->frame_owned    = false;
+    device->count          = count;
+    device->dirty_count    = count;
+
+    return 0;
+}
+
+int RaspiAPA102DeviceDetachBuffer(RaspiAPA102Device* device, uint8_t** buffer)
+{
+    if (!device)
+    {
+        return -1;
+    }
+
+    if (buffer)
+    {
+        *buffer = device->frame_owned ? NULL : device->frame;
+    }
+    RaspiAPA102DeviceReleaseBuffer(device);
+
+    return 0;
+}
+
+int RaspiAPA102DeviceGetBuffer(const RaspiAPA102Device* device, RaspiAPA102ColorQuad** colors, 
+    size_t* count)
+{
+    if (!device || !device->frame || !colors)
+    {
+        return -1;
+    }
+
+    *colors = RaspiAPA102FrameGetColors(device->frame);
+    if (count)
+    {
+        *count = device->count;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102DeviceSetColor(RaspiAPA102Device* device, size_t index, 
+    RaspiAPA102ColorQuad color)
+{
+    if (!device || !device->frame || (index >= device->count))
+    {
+        return -1;
+    }
+
+    RaspiAPA102FrameGetColors(device->frame)[index] = color;
+    if (index >= device->dirty_count)
+    {
+        device->dirty_count = index + 1;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102DeviceMarkDirty(RaspiAPA102Device* device, size_t index, size_t count)
+{
+    if (!device || !device->frame || (index >= device->count) || (count > device->count - index))
+    {
+        return -1;
+    }
+
+    if (count && (index + count > device->dirty_count))
+    {
+        device->dirty_count = index + count;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102DeviceSetRefreshInterval(RaspiAPA102Device* device, uint32_t interval)
+{
+    if (!device)
+    {
+        return -1;
+    }
+
+    device->refresh_interval = interval;
+    device->refresh_counter  = 0;
+
+    // The next commit always sends the whole buffer
+    device->dirty_count = device->count;
+
+    return 0;
+}
+
+int RaspiAPA102DeviceSetChainMode(RaspiAPA102Device* device, RaspiAPA102ChainMode mode)
+{
+    if (!device || ((unsigned)mode > RASPI_APA102_CHAIN_MODE_MAX_VALUE))
+    {
+        return -1;
+    }
+
+    if (device->frame && 
+        (device->frame_capacity < RaspiAPA102FrameGetSize(device->count, mode)))
+    {
+        return -1;
+    }
+
+    device->chain_mode = mode;
+    if (device->frame)
+    {
+        RaspiAPA102FrameInitEnd(device->frame, device->count, mode);
+        device->frame_size = RaspiAPA102FrameGetSize(device->count, mode);
+    }
+
+    return 0;
+}
+
+int RaspiAPA102DeviceCommit(RaspiAPA102Device* device)
+{
+    if (!device || !device->transport.write || !device->frame)
+    {
+        return -1;
+    }
+
+    size_t count = device->count;
+    if (device->refresh_interval)
+    {
+        if (++device->refresh_counter >= device->refresh_interval)
+        {
+            device->refresh_counter = 0;
+        }
+        else
+        {
+            count = device->dirty_count;
+        }
+    }
+    device->dirty_count = 0;
+    device->bytes_sent = 0;
+
+    if (!count)
+    {
+        return 0;
+    }
+
+    int status;
+    if (count == device->count)
+    {
+        status = RaspiAPA102DeviceWriteFrame(device, device->frame, device->frame_size);
+    }
+    else
+    {
+        // The end frame of the prefix would overlap the following LED frames in the buffer
+        const RaspiAPA102Transport* const transport = &device->transport;
+        RaspiAPA102StatsTimer timer = { 0 };
+        RaspiAPA102StatsTimerStart(device, &timer);
+        status = transport->write(transport->context, device->frame, 
+            RASPI_APA102_START_FRAME_SIZE + count * sizeof(RaspiAPA102ColorQuad));
+        RaspiAPA102StatsTimerLap(device, &timer, RASPI_APA102_STATS_STAGE_TRANSFER);
+        if (status == 0)
+        {
+            status = RaspiAPA102DeviceWriteEndFrame(device, count, true);
+            RaspiAPA102StatsTimerLap(device, &timer, RASPI_APA102_STATS_STAGE_END_FRAME);
+        }
+        if (status == 0)
+        {
+            status = transport->flush(transport->context);
+            RaspiAPA102StatsTimerLap(device, &timer, RASPI_APA102_STATS_STAGE_FLUSH);
+        }
+        RaspiAPA102StatsTimerFrame(device, &timer, 
+            RaspiAPA102FrameGetSize(count, device->chain_mode), status);
+    }
+
+    if (status == 0)
+    {
+        device->bytes_sent = RaspiAPA102FrameGetSize(count, device->chain_mode);
+        device->bytes_sent_total += device->bytes_sent;
+    }
+
+    return status;
+}
+
+int RaspiAPA102DeviceGetBytesSent(const RaspiAPA102Device* device, size_t* last, 
+    uint64_t* total)
+{
+    if (!device)
+    {
+        return -1;
+    }
+
+    if (last)
+    {
+        *last = device->bytes_sent;
+    }
+    if (total)
+    {
+        *total = device->bytes_sent_total;
+    }
 
     return 0;
 }
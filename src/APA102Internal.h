@@ -0,0 +1,124 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Declares functions that are shared between the modules of the library.
+ */
+
+#ifndef APA102_INTERNAL_H
+#define APA102_INTERNAL_H
+
+#include <RaspiAPA102/APA102.h>
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Framing                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the size of the end frame in bytes for the given number of LEDs.
+ *
+ * @param   count   The number of LEDs that were sent.
+ * @param   mode    The chain mode.
+ *
+ * @return  The size of the end frame (including the reset frame) in bytes.
+ */
+static inline size_t RaspiAPA102FrameGetEndSize(size_t count, RaspiAPA102ChainMode mode)
+{
+    return RASPI_APA102_END_FRAME_SIZE(count) + 
+        ((mode == RASPI_APA102_CHAIN_MODE_LARGE) ? RASPI_APA102_RESET_FRAME_SIZE : 0);
+}
+
+/**
+ * @brief   Returns the size of a framed buffer in bytes for the given number of LEDs.
+ *
+ * @param   count   The number of LEDs in the string.
+ * @param   mode    The chain mode.
+ *
+ * @return  The size of the framed buffer in bytes.
+ */
+static inline size_t RaspiAPA102FrameGetSize(size_t count, RaspiAPA102ChainMode mode)
+{
+    return RASPI_APA102_START_FRAME_SIZE + count * sizeof(RaspiAPA102ColorQuad) + 
+        RaspiAPA102FrameGetEndSize(count, mode);
+}
+
+/**
+ * @brief   Initializes the given framed buffer with a start frame, black LED frames and an end 
+ *          frame.
+ *
+ * @param   frame   A pointer to a buffer of `RaspiAPA102FrameGetSize(count, mode)` bytes.
+ * @param   count   The number of LEDs in the string.
+ * @param   mode    The chain mode.
+ */
+void RaspiAPA102FrameInit(uint8_t* frame, size_t count, RaspiAPA102ChainMode mode);
+
+/**
+ * @brief   Writes the end frame of the given framed buffer.
+ *
+ * @param   frame   A pointer to a buffer of `RaspiAPA102FrameGetSize(count, mode)` bytes.
+ * @param   count   The number of LEDs in the string.
+ * @param   mode    The chain mode.
+ */
+void RaspiAPA102FrameInitEnd(uint8_t* frame, size_t count, RaspiAPA102ChainMode mode);
+
+/**
+ * @brief   Returns a pointer to the LED frames inside the given framed buffer.
+ *
+ * @param   frame   A pointer to the framed buffer.
+ *
+ * @return  A pointer to the first `RaspiAPA102ColorQuad` struct.
+ */
+static inline RaspiAPA102ColorQuad* RaspiAPA102FrameGetColors(uint8_t* frame)
+{
+    return (RaspiAPA102ColorQuad*)(frame + RASPI_APA102_START_FRAME_SIZE);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Device                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Sends the given framed buffer to the transport of the given `APA102` device.
+ *
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   frame   A pointer to the framed buffer.
+ * @param   size    The size of the framed buffer in bytes.
+ *
+ * @return  A status code.
+ */
+int RaspiAPA102DeviceWriteFrame(const RaspiAPA102Device* device, const uint8_t* frame, 
+    size_t size);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#endif /* APA102_INTERNAL_H */
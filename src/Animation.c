@@ -0,0 +1,452 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/Animation.h>
+#include <RaspiAPA102/ColorConversion.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+#define RASPI_APA102_NSEC_PER_SEC 1000000000ULL
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Time                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the current value of the given clock in nanoseconds.
+ *
+ * @param   clock   The clock.
+ *
+ * @return  The current value of the given clock in nanoseconds.
+ */
+static uint64_t RaspiAPA102AnimationNow(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+
+    return (uint64_t)now.tv_sec * RASPI_APA102_NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Interpolation                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Applies the given curve to a linear fraction.
+ *
+ * @param   curve       The curve.
+ * @param   fraction    The linear fraction (16-bit fixed-point, `0` to `65536`).
+ *
+ * @return  The resulting fraction (16-bit fixed-point, `0` to `65536`).
+ */
+static uint32_t RaspiAPA102AnimationApplyCurve(RaspiAPA102AnimationCurve curve, uint32_t fraction)
+{
+    const uint64_t f = fraction;
+
+    switch (curve)
+    {
+    case RASPI_APA102_ANIMATION_CURVE_STEP:
+        return 0;
+    case RASPI_APA102_ANIMATION_CURVE_EASE_IN:
+        return (uint32_t)((f * f) >> 16);
+    case RASPI_APA102_ANIMATION_CURVE_EASE_OUT:
+        return 65536 - (uint32_t)(((65536 - f) * (65536 - f)) >> 16);
+    case RASPI_APA102_ANIMATION_CURVE_EASE_IN_OUT:
+        // f^2 * (3 - 2f)
+        return (uint32_t)((f * f * (3 * 65536 - 2 * f)) >> 32);
+    default:
+        return fraction;
+    }
+}
+
+/**
+ * @brief   Interpolates between two color components.
+ *
+ * @param   from        The first value.
+ * @param   to          The second value.
+ * @param   fraction    The fraction (16-bit fixed-point, `0` to `65536`).
+ *
+ * @return  The interpolated value.
+ */
+static inline uint16_t RaspiAPA102AnimationLerp(int32_t from, int32_t to, uint32_t fraction)
+{
+    return (uint16_t)(from + (int32_t)(((int64_t)(to - from) * fraction) >> 16));
+}
+
+/**
+ * @brief   Evaluates the given track.
+ *
+ * @param   state       A pointer to the `RaspiAPA102AnimationTrackState` struct.
+ * @param   time_us     The time relative to the start of the animation in microseconds.
+ * @param   brightness  The LED brightness.
+ * @param   color       Receives the color.
+ *
+ * @return  `true`, if the track is active or `false`, if not.
+ */
+static bool RaspiAPA102AnimationEvaluate(RaspiAPA102AnimationTrackState* state, uint64_t time_us, 
+    uint8_t brightness, RaspiAPA102ColorQuad* color)
+{
+    const RaspiAPA102AnimationTrack* track = &state->track;
+    const RaspiAPA102Keyframe* keyframes = track->keyframes;
+    const size_t count = track->keyframe_count;
+    const uint64_t start = track->start * 1000ULL;
+
+    if (time_us < start)
+    {
+        return false;
+    }
+
+    uint64_t t = time_us - start;
+    const uint64_t duration = keyframes[count - 1].time * 1000ULL;
+    if (track->loop && duration)
+    {
+        t %= duration;
+    }
+
+    // Frames are evaluated in ascending order most of the time, so the search continues at the 
+    // keyframe of the last lookup
+    size_t i = state->cursor;
+    if ((i >= count) || (keyframes[i].time * 1000ULL > t))
+    {
+        i = 0;
+    }
+    while ((i + 1 < count) && (keyframes[i + 1].time * 1000ULL <= t))
+    {
+        ++i;
+    }
+    state->cursor = i;
+
+    const RaspiAPA102Keyframe* from = &keyframes[i];
+    uint16_t value[3] = { from->color[0], from->color[1], from->color[2] };
+    const uint64_t t0 = from->time * 1000ULL;
+    if ((i + 1 < count) && (t > t0))
+    {
+        const RaspiAPA102Keyframe* to = &keyframes[i + 1];
+        const uint64_t t1 = to->time * 1000ULL;
+        const uint32_t fraction = 
+            RaspiAPA102AnimationApplyCurve(from->curve, (uint32_t)(((t - t0) << 16) / (t1 - t0)));
+
+        if (track->space == RASPI_APA102_ANIMATION_SPACE_HSV)
+        {
+            // Shortest way around the color circle
+            const int16_t delta = (int16_t)(uint16_t)(to->color[0] - from->color[0]);
+            value[0] = RaspiAPA102AnimationLerp(from->color[0], from->color[0] + delta, fraction);
+        }
+        else
+        {
+            value[0] = RaspiAPA102AnimationLerp(from->color[0], to->color[0], fraction);
+        }
+        value[1] = RaspiAPA102AnimationLerp(from->color[1], to->color[1], fraction);
+        value[2] = RaspiAPA102AnimationLerp(from->color[2], to->color[2], fraction);
+    }
+
+    if (track->space == RASPI_APA102_ANIMATION_SPACE_HSV)
+    {
+        const uint8_t s = (uint8_t)value[1];
+        const uint8_t v = (uint8_t)value[2];
+        RaspiAPA102HSVFixed2ColorQuadBatchEx(color, &value[0], &s, &v, 1, brightness, 
+            RASPI_APA102_SIMD_SCALAR);
+    }
+    else
+    {
+        RaspiAPA102ColorQuadInit(color, (uint8_t)value[0], (uint8_t)value[1], (uint8_t)value[2], 
+            brightness);
+    }
+
+    return true;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Animation                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Renders the frame for the given time.
+ *
+ * @param   animation   A pointer to the `RaspiAPA102Animation` struct.
+ * @param   time_us     The time relative to the start of the animation in microseconds.
+ *
+ * Only tracks whose color changed are drawn. A track is drawn as well, if it overlaps pixels that 
+ * were already drawn by a track below it in the same frame.
+ */
+static void RaspiAPA102AnimationRender(RaspiAPA102Animation* animation, uint64_t time_us)
+{
+    size_t dirty_begin = animation->count;
+    size_t dirty_end = 0;
+
+    for (size_t i = 0; i < animation->track_count; ++i)
+    {
+        RaspiAPA102AnimationTrackState* state = &animation->tracks[i];
+        RaspiAPA102ColorQuad color;
+        if (!RaspiAPA102AnimationEvaluate(state, time_us, animation->brightness, &color))
+        {
+            continue;
+        }
+
+        const size_t begin = state->track.first;
+        const size_t end = begin + state->track.length;
+        const bool covered = (begin < dirty_end) && (dirty_begin < end);
+        if (state->rendered && !covered && !memcmp(&state->color, &color, sizeof(color)))
+        {
+            continue;
+        }
+
+        for (size_t j = begin; j < end; ++j)
+        {
+            animation->quads[j] = color;
+        }
+        state->color = color;
+        state->rendered = true;
+
+        dirty_begin = (begin < dirty_begin) ? begin : dirty_begin;
+        dirty_end = (end > dirty_end) ? end : dirty_end;
+    }
+
+    animation->dirty_first = (dirty_begin < dirty_end) ? dirty_begin : 0;
+    animation->dirty_count = (dirty_begin < dirty_end) ? dirty_end - dirty_begin : 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Animation                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102AnimationInit(RaspiAPA102Animation* animation, RaspiAPA102ColorQuad* quads, 
+    size_t count, const RaspiAPA102AnimationTrack* tracks, size_t track_count, uint32_t fps)
+{
+    if (!animation || !quads || !count || (track_count && !tracks) || !fps)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < track_count; ++i)
+    {
+        const RaspiAPA102AnimationTrack* track = &tracks[i];
+        if (!track->keyframes || !track->keyframe_count || 
+            ((unsigned)track->space > RASPI_APA102_ANIMATION_SPACE_MAX_VALUE) || 
+            (track->first > count) || (track->length > count - track->first))
+        {
+            return -1;
+        }
+        for (size_t j = 1; j < track->keyframe_count; ++j)
+        {
+            if (track->keyframes[j].time < track->keyframes[j - 1].time)
+            {
+                return -1;
+            }
+        }
+    }
+
+    memset(animation, 0, sizeof(*animation));
+    if (track_count)
+    {
+        animation->tracks = calloc(track_count, sizeof(RaspiAPA102AnimationTrackState));
+        if (!animation->tracks)
+        {
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < track_count; ++i)
+    {
+        animation->tracks[i].track = tracks[i];
+    }
+    animation->quads       = quads;
+    animation->count       = count;
+    animation->track_count = track_count;
+    animation->brightness  = 31;
+    animation->interval_ns = (RASPI_APA102_NSEC_PER_SEC + fps / 2) / fps;
+
+    return 0;
+}
+
+int RaspiAPA102AnimationSetBrightness(RaspiAPA102Animation* animation, uint8_t brightness)
+{
+    if (!animation)
+    {
+        return -1;
+    }
+
+    animation->brightness = brightness & 0b00011111;
+    for (size_t i = 0; i < animation->track_count; ++i)
+    {
+        animation->tracks[i].rendered = false;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102AnimationStart(RaspiAPA102Animation* animation)
+{
+    return RaspiAPA102AnimationStartAt(animation, RaspiAPA102AnimationNow(CLOCK_MONOTONIC));
+}
+
+int RaspiAPA102AnimationStartAt(RaspiAPA102Animation* animation, uint64_t now_ns)
+{
+    if (!animation)
+    {
+        return -1;
+    }
+
+    animation->start_ns        = now_ns;
+    animation->frame           = 0;
+    animation->dirty_first     = 0;
+    animation->dirty_count     = 0;
+    animation->frames_rendered = 0;
+    animation->frames_skipped  = 0;
+    animation->render_ns       = 0;
+    for (size_t i = 0; i < animation->track_count; ++i)
+    {
+        animation->tracks[i].cursor = 0;
+        animation->tracks[i].rendered = false;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102AnimationNextFrame(RaspiAPA102Animation* animation, uint64_t* frame)
+{
+    if (!animation)
+    {
+        return -1;
+    }
+
+    const uint64_t deadline = animation->start_ns + animation->frame * animation->interval_ns;
+    const struct timespec abstime =
+    {
+        .tv_sec  = (time_t)(deadline / RASPI_APA102_NSEC_PER_SEC),
+        .tv_nsec = (long)(deadline % RASPI_APA102_NSEC_PER_SEC)
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &abstime, NULL) == EINTR)
+    {
+        // Interrupted by a signal
+    }
+
+    return RaspiAPA102AnimationNextFrameAt(animation, RaspiAPA102AnimationNow(CLOCK_MONOTONIC), 
+        frame);
+}
+
+int RaspiAPA102AnimationNextFrameAt(RaspiAPA102Animation* animation, uint64_t now_ns, 
+    uint64_t* frame)
+{
+    if (!animation)
+    {
+        return -1;
+    }
+
+    // Always render the newest frame that is due, so a slow frame never delays the following ones
+    uint64_t index = (now_ns > animation->start_ns) 
+        ? (now_ns - animation->start_ns) / animation->interval_ns 
+        : 0;
+    if (index < animation->frame)
+    {
+        index = animation->frame;
+    }
+    animation->frames_skipped += index - animation->frame;
+    animation->frame = index + 1;
+
+    const uint64_t begin = RaspiAPA102AnimationNow(CLOCK_THREAD_CPUTIME_ID);
+    RaspiAPA102AnimationRender(animation, index * animation->interval_ns / 1000);
+    animation->render_ns += RaspiAPA102AnimationNow(CLOCK_THREAD_CPUTIME_ID) - begin;
+    ++animation->frames_rendered;
+
+    if (frame)
+    {
+        *frame = index;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102AnimationGetDirty(const RaspiAPA102Animation* animation, size_t* first, 
+    size_t* count)
+{
+    if (!animation || !first || !count)
+    {
+        return -1;
+    }
+
+    *first = animation->dirty_first;
+    *count = animation->dirty_count;
+
+    return 0;
+}
+
+int RaspiAPA102AnimationGetStats(const RaspiAPA102Animation* animation, uint64_t* frames_rendered, 
+    uint64_t* frames_skipped, uint64_t* render_ns)
+{
+    if (!animation)
+    {
+        return -1;
+    }
+
+    if (frames_rendered)
+    {
+        *frames_rendered = animation->frames_rendered;
+    }
+    if (frames_skipped)
+    {
+        *frames_skipped = animation->frames_skipped;
+    }
+    if (render_ns)
+    {
+        *render_ns = animation->render_ns;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102AnimationDestroy(RaspiAPA102Animation* animation)
+{
+    if (!animation)
+    {
+        return -1;
+    }
+
+    free(animation->tracks);
+    animation->tracks = NULL;
+    animation->track_count = 0;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
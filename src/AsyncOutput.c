@@ -0,0 +1,535 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/AsyncOutput.h>
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <APA102Internal.h>
+#include <StatsInternal.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+#define RASPI_APA102_NSEC_PER_SEC 1000000000ULL
+
+/**
+ * @brief   The number of stack bytes the output thread touches before it enters the loop in 
+ *          real-time mode.
+ */
+#define RASPI_APA102_ASYNC_OUTPUT_STACK_PREFAULT (64 * 1024)
+
+/**
+ * @brief   The size of the stack that is allocated for the output thread, if the memory is locked.
+ */
+#define RASPI_APA102_ASYNC_OUTPUT_STACK_SIZE (256 * 1024)
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Time                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the current value of the monotonic clock in nanoseconds.
+ *
+ * @return  The current value of the monotonic clock in nanoseconds.
+ */
+static uint64_t RaspiAPA102AsyncOutputNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * RASPI_APA102_NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Touches the stack of the calling thread, so that no page faults occur later on.
+ */
+static __attribute__((noinline)) void RaspiAPA102AsyncOutputPrefaultStack(void)
+{
+    volatile uint8_t stack[RASPI_APA102_ASYNC_OUTPUT_STACK_PREFAULT];
+    for (size_t i = 0; i < sizeof(stack); i += 256)
+    {
+        stack[i] = 0;
+    }
+}
+
+/**
+ * @brief   Releases the memory lock and the stack of the output thread.
+ *
+ * @param   output  A pointer to the `RaspiAPA102AsyncOutput` struct.
+ */
+static void RaspiAPA102AsyncOutputUnlock(RaspiAPA102AsyncOutput* output)
+{
+    if (output->realtime_flags & RASPI_APA102_REALTIME_LOCKED)
+    {
+        munlock(output->buffers, output->buffers_size);
+        munlock(output->stack, RASPI_APA102_ASYNC_OUTPUT_STACK_SIZE);
+    }
+    if (output->stack)
+    {
+        munmap(output->stack, RASPI_APA102_ASYNC_OUTPUT_STACK_SIZE);
+    }
+}
+
+/**
+ * @brief   Waits until the next frame deadline, or until the thread should terminate.
+ *
+ * @param   output      A pointer to the `RaspiAPA102AsyncOutput` struct.
+ * @param   deadline    A pointer to the deadline in nanoseconds. Receives the next deadline.
+ *
+ * The mutex must be held by the caller.
+ */
+static void RaspiAPA102AsyncOutputWaitDeadline(RaspiAPA102AsyncOutput* output, uint64_t* deadline)
+{
+    const struct timespec abstime =
+    {
+        .tv_sec  = (time_t)(*deadline / RASPI_APA102_NSEC_PER_SEC),
+        .tv_nsec = (long)(*deadline % RASPI_APA102_NSEC_PER_SEC)
+    };
+
+    if (output->realtime)
+    {
+        // Publishing a frame does not wake the thread before its deadline
+        pthread_mutex_unlock(&output->mutex);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &abstime, NULL) == EINTR)
+        {
+        }
+        pthread_mutex_lock(&output->mutex);
+    }
+    else
+    {
+        while (!output->stop)
+        {
+            if (pthread_cond_timedwait(&output->published, &output->mutex, &abstime) == ETIMEDOUT)
+            {
+                break;
+            }
+        }
+    }
+
+    const uint64_t now = RaspiAPA102AsyncOutputNow();
+    if (!output->stop)
+    {
+        RaspiAPA102StatsHistogramRecord(&output->jitter.wakeup, 
+            (now > *deadline) ? (now - *deadline) : 0);
+    }
+
+    // Skip all deadlines that were missed while the previous frame was transferred, but keep the 
+    // phase of the schedule
+    *deadline += output->interval_ns;
+    if (*deadline <= now)
+    {
+        output->jitter.deadlines_missed += (now - *deadline) / output->interval_ns + 1;
+        *deadline = now + output->interval_ns - (now - *deadline) % output->interval_ns;
+    }
+}
+
+/**
+ * @brief   The entry point of the output thread.
+ *
+ * @param   argument    A pointer to the `RaspiAPA102AsyncOutput` struct.
+ *
+ * @return  Always `NULL`.
+ */
+static void* RaspiAPA102AsyncOutputThread(void* argument)
+{
+    RaspiAPA102AsyncOutput* const output = argument;
+
+    if (output->realtime)
+    {
+        RaspiAPA102AsyncOutputPrefaultStack();
+    }
+
+    uint64_t deadline = RaspiAPA102AsyncOutputNow();
+
+    pthread_mutex_lock(&output->mutex);
+    for (;;)
+    {
+        if (output->interval_ns)
+        {
+            RaspiAPA102AsyncOutputWaitDeadline(output, &deadline);
+        }
+        else
+        {
+            while (!output->stop && !output->pending_valid)
+            {
+                pthread_cond_wait(&output->published, &output->mutex);
+            }
+        }
+
+        if (output->stop)
+        {
+            break;
+        }
+        if (!output->pending_valid)
+        {
+            continue;
+        }
+
+        uint8_t* const frame = output->pending;
+        output->pending = output->front;
+        output->front = frame;
+        output->pending_valid = false;
+        const uint64_t sequence = output->sequence_pending;
+
+        pthread_mutex_unlock(&output->mutex);
+        const uint64_t start = RaspiAPA102AsyncOutputNow();
+        const int status = RaspiAPA102DeviceWriteFrame(output->device, frame, output->frame_size);
+        const uint64_t end = RaspiAPA102AsyncOutputNow();
+        pthread_mutex_lock(&output->mutex);
+
+        if (output->interval_ns)
+        {
+            RaspiAPA102StatsHistogramRecord(&output->jitter.transfer, end - start);
+        }
+        output->status = status;
+        output->sequence_sent = sequence;
+        pthread_cond_broadcast(&output->sent);
+    }
+    pthread_mutex_unlock(&output->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief   Starts the output thread with the given real-time settings.
+ *
+ * @param   output      A pointer to the `RaspiAPA102AsyncOutput` struct.
+ * @param   realtime    A pointer to the `RaspiAPA102AsyncOutputRealtime` struct, or `NULL`.
+ * @param   flags       The `RaspiAPA102RealtimeFlags` to apply (`RASPI_APA102_REALTIME_SCHEDULING`
+ *                      and `RASPI_APA102_REALTIME_AFFINITY`).
+ *
+ * The settings are passed as thread attributes, so they are in effect before the first frame.
+ *
+ * @return  The error code returned by `pthread_create`.
+ */
+static int RaspiAPA102AsyncOutputStart(RaspiAPA102AsyncOutput* output, 
+    const RaspiAPA102AsyncOutputRealtime* realtime, uint32_t flags)
+{
+    pthread_attr_t attr;
+    if (pthread_attr_init(&attr) != 0)
+    {
+        return EAGAIN;
+    }
+
+    if (output->stack)
+    {
+        pthread_attr_setstack(&attr, output->stack, RASPI_APA102_ASYNC_OUTPUT_STACK_SIZE);
+    }
+    if (flags & RASPI_APA102_REALTIME_SCHEDULING)
+    {
+        const struct sched_param param = { .sched_priority = realtime->priority };
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+    if (flags & RASPI_APA102_REALTIME_AFFINITY)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(realtime->cpu, &set);
+        pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    }
+
+    const int error = pthread_create(&output->thread, &attr, &RaspiAPA102AsyncOutputThread, output);
+    pthread_attr_destroy(&attr);
+
+    return error;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Async Output                                                                                   */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102AsyncOutputInit(RaspiAPA102AsyncOutput* output, const RaspiAPA102Device* device, 
+    size_t count, uint32_t fps)
+{
+    return RaspiAPA102AsyncOutputInitEx(output, device, count, fps, NULL);
+}
+
+int RaspiAPA102AsyncOutputInitEx(RaspiAPA102AsyncOutput* output, const RaspiAPA102Device* device, 
+    size_t count, uint32_t fps, const RaspiAPA102AsyncOutputRealtime* realtime)
+{
+    if (!output || !device || !device->transport.write || !count || 
+        (count > RASPI_APA102_MAX_COUNT) || 
+        (realtime && ((realtime->priority < 0) || (realtime->priority > 99) || 
+            (realtime->cpu < -1) || (realtime->cpu >= CPU_SETSIZE))))
+    {
+        return -1;
+    }
+
+    memset(output, 0, sizeof(*output));
+    output->device      = device;
+    output->count       = count;
+    output->frame_size  = RaspiAPA102FrameGetSize(count, device->chain_mode);
+    output->interval_ns = fps ? (RASPI_APA102_NSEC_PER_SEC / fps) : 0;
+    output->realtime    = (realtime != NULL);
+    RaspiAPA102StatsHistogramReset(&output->jitter.wakeup);
+    RaspiAPA102StatsHistogramReset(&output->jitter.transfer);
+
+    // The buffers occupy whole pages, so unlocking them does not affect other allocations
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    output->buffers_size = (3 * output->frame_size + page_size - 1) & ~(page_size - 1);
+    uint8_t* buffers;
+    if (posix_memalign((void**)&buffers, page_size, output->buffers_size) != 0)
+    {
+        memset(output, 0, sizeof(*output));
+        return -1;
+    }
+    if (realtime && realtime->lock_memory)
+    {
+        output->stack = mmap(NULL, RASPI_APA102_ASYNC_OUTPUT_STACK_SIZE, PROT_READ | PROT_WRITE, 
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+        if (output->stack == MAP_FAILED)
+        {
+            free(buffers);
+            memset(output, 0, sizeof(*output));
+            return -1;
+        }
+    }
+    output->buffers = buffers;
+    output->back    = buffers;
+    output->pending = buffers + 1 * output->frame_size;
+    output->front   = buffers + 2 * output->frame_size;
+    // Initializing the buffers touches every page of them
+    RaspiAPA102FrameInit(output->back, count, device->chain_mode);
+    RaspiAPA102FrameInit(output->pending, count, device->chain_mode);
+    RaspiAPA102FrameInit(output->front, count, device->chain_mode);
+
+    // Only the memory owned by the output is locked, the rest of the process is left untouched
+    if (output->stack && (mlock(buffers, output->buffers_size) == 0))
+    {
+        if (mlock(output->stack, RASPI_APA102_ASYNC_OUTPUT_STACK_SIZE) == 0)
+        {
+            output->realtime_flags |= RASPI_APA102_REALTIME_LOCKED;
+        }
+        else
+        {
+            munlock(buffers, output->buffers_size);
+        }
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&output->mutex, NULL);
+    pthread_cond_init(&output->published, &attr);
+    pthread_cond_init(&output->sent, NULL);
+    pthread_condattr_destroy(&attr);
+
+    uint32_t flags = 0;
+    if (realtime && realtime->priority)
+    {
+        flags |= RASPI_APA102_REALTIME_SCHEDULING;
+    }
+    if (realtime && (realtime->cpu >= 0))
+    {
+        flags |= RASPI_APA102_REALTIME_AFFINITY;
+    }
+
+    // Without privileges (`EPERM`) the thread keeps the default scheduling policy, on an 
+    // unavailable CPU (`EINVAL`) it runs without affinity
+    int error = RaspiAPA102AsyncOutputStart(output, realtime, flags);
+    while (error != 0)
+    {
+        if ((error == EPERM) && (flags & RASPI_APA102_REALTIME_SCHEDULING))
+        {
+            flags &= ~(uint32_t)RASPI_APA102_REALTIME_SCHEDULING;
+        }
+        else if ((error == EINVAL) && (flags & RASPI_APA102_REALTIME_AFFINITY))
+        {
+            flags &= ~(uint32_t)RASPI_APA102_REALTIME_AFFINITY;
+        }
+        else
+        {
+            break;
+        }
+        error = RaspiAPA102AsyncOutputStart(output, realtime, flags);
+    }
+    if (error != 0)
+    {
+        pthread_cond_destroy(&output->sent);
+        pthread_cond_destroy(&output->published);
+        pthread_mutex_destroy(&output->mutex);
+        RaspiAPA102AsyncOutputUnlock(output);
+        free(buffers);
+        // The output never started, so `RaspiAPA102AsyncOutputDestroy` has to reject it
+        memset(output, 0, sizeof(*output));
+        return -1;
+    }
+    output->realtime_flags |= flags;
+
+    return 0;
+}
+
+int RaspiAPA102AsyncOutputGetBackBuffer(RaspiAPA102AsyncOutput* output, 
+    RaspiAPA102ColorQuad** colors, size_t* count)
+{
+    if (!output || !colors)
+    {
+        return -1;
+    }
+
+    *colors = RaspiAPA102FrameGetColors(output->back);
+    if (count)
+    {
+        *count = output->count;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102AsyncOutputSwap(RaspiAPA102AsyncOutput* output, uint64_t* sequence)
+{
+    if (!output)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&output->mutex);
+
+    uint8_t* const frame = output->back;
+    output->back = output->pending;
+    output->pending = frame;
+    if (output->pending_valid)
+    {
+        ++output->frames_dropped;
+    }
+    output->pending_valid = true;
+    output->sequence_pending = ++output->sequence_published;
+    if (sequence)
+    {
+        *sequence = output->sequence_pending;
+    }
+    pthread_cond_signal(&output->published);
+
+    pthread_mutex_unlock(&output->mutex);
+
+    // The published buffer is only read by the thread until it returns to the application with 
+    // the next swap
+    memcpy(output->back, frame, output->frame_size);
+
+    return 0;
+}
+
+int RaspiAPA102AsyncOutputWait(RaspiAPA102AsyncOutput* output, uint64_t sequence)
+{
+    if (!output || (sequence > output->sequence_published))
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&output->mutex);
+    while (output->sequence_sent < sequence)
+    {
+        pthread_cond_wait(&output->sent, &output->mutex);
+    }
+    const int status = output->status;
+    pthread_mutex_unlock(&output->mutex);
+
+    return status;
+}
+
+int RaspiAPA102AsyncOutputGetRealtime(const RaspiAPA102AsyncOutput* output, uint32_t* flags)
+{
+    if (!output || !output->buffers || !flags)
+    {
+        return -1;
+    }
+
+    *flags = output->realtime_flags;
+
+    return 0;
+}
+
+int RaspiAPA102AsyncOutputGetJitter(RaspiAPA102AsyncOutput* output, 
+    RaspiAPA102AsyncOutputJitter* jitter, bool reset)
+{
+    if (!output || !output->buffers || !jitter)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&output->mutex);
+    *jitter = output->jitter;
+    if (reset)
+    {
+        RaspiAPA102StatsHistogramReset(&output->jitter.wakeup);
+        RaspiAPA102StatsHistogramReset(&output->jitter.transfer);
+        output->jitter.deadlines_missed = 0;
+    }
+    pthread_mutex_unlock(&output->mutex);
+
+    return 0;
+}
+
+int RaspiAPA102AsyncOutputDestroy(RaspiAPA102AsyncOutput* output)
+{
+    if (!output || !output->buffers)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&output->mutex);
+    output->stop = true;
+    pthread_cond_signal(&output->published);
+    pthread_mutex_unlock(&output->mutex);
+
+    pthread_join(output->thread, NULL);
+
+    pthread_cond_destroy(&output->sent);
+    pthread_cond_destroy(&output->published);
+    pthread_mutex_destroy(&output->mutex);
+
+    RaspiAPA102AsyncOutputUnlock(output);
+    free(output->buffers);
+    memset(output, 0, sizeof(*output));
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
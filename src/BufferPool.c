@@ -0,0 +1,309 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/BufferPool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <APA102Internal.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   The alignment of the LED frames inside a buffer.
+ */
+#define RASPI_APA102_BUFFER_POOL_ALIGNMENT 64
+
+/**
+ * @brief   The offset of the framed buffer inside its pages, so that the LED frames are aligned.
+ */
+#define RASPI_APA102_BUFFER_POOL_OFFSET \
+    (RASPI_APA102_BUFFER_POOL_ALIGNMENT - RASPI_APA102_START_FRAME_SIZE)
+
+/**
+ * @brief   The huge page size that is assumed, if `/proc/meminfo` can not be read.
+ */
+#define RASPI_APA102_BUFFER_POOL_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Returns the default huge page size of the system.
+ *
+ * @return  The huge page size in bytes.
+ */
+static size_t RaspiAPA102BufferPoolGetHugePageSize(void)
+{
+    size_t size = RASPI_APA102_BUFFER_POOL_HUGE_PAGE_SIZE;
+
+    FILE* const file = fopen("/proc/meminfo", "r");
+    if (!file)
+    {
+        return size;
+    }
+
+    char line[128];
+    unsigned long kilobytes;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, "Hugepagesize: %lu kB", &kilobytes) == 1)
+        {
+            size = (size_t)kilobytes * 1024;
+            break;
+        }
+    }
+    fclose(file);
+
+    return size;
+}
+
+/**
+ * @brief   Rounds the given size up to a multiple of the given alignment.
+ *
+ * @param   size        The size.
+ * @param   alignment   The alignment (a power of two).
+ *
+ * @return  The aligned size.
+ */
+static inline size_t RaspiAPA102BufferPoolAlign(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief   Maps the memory of the given pool.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102BufferPool` struct.
+ * @param   size    The minimum size of the mapping in bytes.
+ * @param   flags   A combination of `RaspiAPA102BufferPoolFlags`.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102BufferPoolMap(RaspiAPA102BufferPool* pool, size_t size, uint32_t flags)
+{
+    if (flags & RASPI_APA102_BUFFER_POOL_HUGE_PAGES)
+    {
+#ifdef MAP_HUGETLB
+        const size_t huge_size = 
+            RaspiAPA102BufferPoolAlign(size, RaspiAPA102BufferPoolGetHugePageSize());
+        void* const memory = mmap(NULL, huge_size, PROT_READ | PROT_WRITE, 
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED)
+        {
+            pool->memory      = memory;
+            pool->memory_size = huge_size;
+            pool->huge_pages  = true;
+
+            return 0;
+        }
+#endif
+    }
+
+    void* const memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, 
+        -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        return -1;
+    }
+    pool->memory      = memory;
+    pool->memory_size = size;
+
+#ifdef MADV_HUGEPAGE
+    if (flags & RASPI_APA102_BUFFER_POOL_HUGE_PAGES)
+    {
+        // No reserved huge pages available, transparent huge pages are a hint only
+        madvise(memory, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+int RaspiAPA102BufferPoolInit(RaspiAPA102BufferPool* pool, size_t count, size_t buffer_count, 
+    uint32_t flags)
+{
+    if (!pool || !count || (count > RASPI_APA102_MAX_COUNT) || !buffer_count)
+    {
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+
+    const long page_size = sysconf(_SC_PAGESIZE);
+    pool->buffer_size  = RaspiAPA102FrameGetSize(count, RASPI_APA102_CHAIN_MODE_LARGE);
+    pool->stride       = RaspiAPA102BufferPoolAlign(
+        RASPI_APA102_BUFFER_POOL_OFFSET + pool->buffer_size, (page_size > 0) ? page_size : 4096);
+    pool->count        = count;
+    pool->buffer_count = buffer_count;
+    if (pool->stride > SIZE_MAX / buffer_count)
+    {
+        return -1;
+    }
+
+    pool->available = malloc(buffer_count * sizeof(uint8_t*));
+    pool->in_use = calloc(buffer_count, sizeof(bool));
+    if (!pool->available || !pool->in_use)
+    {
+        free(pool->available);
+        free(pool->in_use);
+        memset(pool, 0, sizeof(*pool));
+        return -1;
+    }
+    if (RaspiAPA102BufferPoolMap(pool, pool->stride * buffer_count, flags) < 0)
+    {
+        free(pool->available);
+        free(pool->in_use);
+        memset(pool, 0, sizeof(*pool));
+        return -1;
+    }
+
+    if (flags & RASPI_APA102_BUFFER_POOL_LOCKED)
+    {
+        if (mlock(pool->memory, pool->memory_size) < 0)
+        {
+            munmap(pool->memory, pool->memory_size);
+            free(pool->available);
+            free(pool->in_use);
+            memset(pool, 0, sizeof(*pool));
+            return -1;
+        }
+        pool->locked = true;
+    }
+
+    // Touches all pages, so that no page faults occur while rendering the first frames
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        uint8_t* const buffer = pool->memory + i * pool->stride + RASPI_APA102_BUFFER_POOL_OFFSET;
+        RaspiAPA102FrameInit(buffer, count, RASPI_APA102_CHAIN_MODE_LARGE);
+        pool->available[buffer_count - 1 - i] = buffer;
+    }
+    pool->available_count = buffer_count;
+
+    pthread_mutex_init(&pool->mutex, NULL);
+
+    return 0;
+}
+
+int RaspiAPA102BufferPoolAcquire(RaspiAPA102BufferPool* pool, uint8_t** buffer, size_t* size)
+{
+    if (!pool || !pool->memory || !buffer)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    const int status = pool->available_count ? 0 : -1;
+    if (status == 0)
+    {
+        *buffer = pool->available[--pool->available_count];
+        pool->in_use[(size_t)(*buffer - pool->memory) / pool->stride] = true;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    if ((status == 0) && size)
+    {
+        *size = pool->buffer_size;
+    }
+
+    return status;
+}
+
+int RaspiAPA102BufferPoolRelease(RaspiAPA102BufferPool* pool, uint8_t* buffer)
+{
+    if (!pool || !pool->memory || !buffer || (buffer < pool->memory) || 
+        (buffer >= pool->memory + pool->stride * pool->buffer_count) || 
+        ((size_t)(buffer - pool->memory) % pool->stride != RASPI_APA102_BUFFER_POOL_OFFSET))
+    {
+        return -1;
+    }
+
+    // A buffer that is released twice would otherwise be handed out twice
+    const size_t index = (size_t)(buffer - pool->memory) / pool->stride;
+    pthread_mutex_lock(&pool->mutex);
+    const int status = pool->in_use[index] ? 0 : -1;
+    if (status == 0)
+    {
+        pool->in_use[index] = false;
+        pool->available[pool->available_count++] = buffer;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return status;
+}
+
+int RaspiAPA102BufferPoolGetInfo(const RaspiAPA102BufferPool* pool, bool* huge_pages, 
+    bool* locked)
+{
+    if (!pool || !pool->memory)
+    {
+        return -1;
+    }
+
+    if (huge_pages)
+    {
+        *huge_pages = pool->huge_pages;
+    }
+    if (locked)
+    {
+        *locked = pool->locked;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102BufferPoolDestroy(RaspiAPA102BufferPool* pool)
+{
+    if (!pool || !pool->memory)
+    {
+        return -1;
+    }
+
+    if (pool->locked)
+    {
+        munlock(pool->memory, pool->memory_size);
+    }
+    munmap(pool->memory, pool->memory_size);
+    free(pool->available);
+    free(pool->in_use);
+    pthread_mutex_destroy(&pool->mutex);
+    memset(pool, 0, sizeof(*pool));
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
@@ -26,16 +26,278 @@
 
 #include <math.h>
 #include <RaspiAPA102/ColorConversion.h>
+#include <SIMDInternal.h>
+
+#if defined(RASPI_APA102_SIMD_X86)
+#   include <immintrin.h>
+#endif
+#if defined(RASPI_APA102_SIMD_ARM)
+#   include <arm_neon.h>
+#endif
 
 /* ============================================================================================== */
 /* Internal functions                                                                             */
 /* ============================================================================================== */
 
 /* ---------------------------------------------------------------------------------------------- */
-/*                                                                                                */
+/* Batch                                                                                          */
 /* ---------------------------------------------------------------------------------------------- */
 
+/**
+ * @brief   Computes a single `RGB` component of the given `HSV` color value.
+ *
+ * @param   h   The hue in sextants (`0.0` to `6.0`).
+ * @param   s   The saturation.
+ * @param   v   The value.
+ * @param   n   The component offset (`5` for red, `3` for green and `1` for blue).
+ *
+ * Evaluates `v - v * s * clamp(min(k, 4 - k), 0, 1)` with `k = (n + h) mod 6`, which selects the 
+ * same `p`, `q`, `t` and `v` terms as the classic sector `switch` without any branches.
+ *
+ * @return  The color component.
+ */
+static inline float RaspiAPA102HSVComponent(float h, float s, float v, float n)
+{
+    float k = n + h;
+    k = (k >= 6.0f) ? k - 6.0f : k;
+    const float x = fminf(fmaxf(fminf(k, 4.0f - k), 0.0f), 1.0f);
+
+    return v - v * s * x;
+}
+
+/**
+ * @brief   Wraps the given hue in degrees and converts it to sextants.
+ *
+ * @param   h   The hue in degrees.
+ *
+ * @return  The hue in sextants (`0.0` to `6.0`).
+ */
+static inline float RaspiAPA102HSVSextant(float h)
+{
+    const float sextant = h * (1.0f / 60.0f);
+
+    return sextant - 6.0f * floorf(sextant * (1.0f / 6.0f));
+}
+
+/**
+ * @brief   Converts the given color component to an 8-bit value.
+ *
+ * @param   value   The color component (`0.0` to `1.0`).
+ *
+ * @return  The 8-bit color component.
+ */
+static inline uint8_t RaspiAPA102ComponentToByte(float value)
+{
+    return (uint8_t)(fminf(fmaxf(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+/**
+ * @brief   Divides the given value by `255` with correct rounding.
+ *
+ * @param   value   The value (`0` to `65535 - 128`).
+ *
+ * @return  The rounded result of `value / 255`.
+ */
+static inline uint32_t RaspiAPA102Div255(uint32_t value)
+{
+    value += 128;
+
+    return (value + (value >> 8)) >> 8;
+}
+
+/**
+ * @brief   Computes a single fixed-point `RGB` component.
+ *
+ * @param   h   The hue in 1/256 sextants (`0` to `1535`).
+ * @param   v   The value.
+ * @param   vs  The product of value and saturation (`v * s / 255`).
+ * @param   n   The component offset (`5` for red, `3` for green and `1` for blue).
+ *
+ * Fixed-point version of `RaspiAPA102HSVComponent`. The modulo and the clamping only use masks and
+ * `min`/`max`, which keeps the SIMD implementations lane parallel.
+ *
+ * @return  The color component.
+ */
+static inline uint8_t RaspiAPA102HSVFixedComponent(int32_t h, int32_t v, int32_t vs, int32_t n)
+{
+    int32_t k = h + n * 256 - 1536;
+    k += (k >> 31) & 1536;
+    int32_t x = (k < 1024 - k) ? k : 1024 - k;
+    x = (x < 0) ? 0 : x;
+    x = (x > 256) ? 256 : x;
+
+    return (uint8_t)(v - ((vs * x + 128) >> 8));
+}
+
+/**
+ * @brief   Converts the given fixed-point `HSV` color values to color quads.
+ *
+ * @param   quads   Receives the color quads.
+ * @param   h       The hues.
+ * @param   s       The saturations.
+ * @param   v       The values.
+ * @param   count   The number of color values.
+ * @param   header  The brightness byte.
+ */
+static void RaspiAPA102HSVFixedScalar(uint8_t* quads, const uint16_t* h, const uint8_t* s, 
+    const uint8_t* v, size_t count, uint8_t header)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const int32_t sextant = (int32_t)(((uint32_t)h[i] * 1536) >> 16);
+        const int32_t vs = (int32_t)RaspiAPA102Div255((uint32_t)v[i] * s[i]);
+
+        quads[i * 4 + 0] = header;
+        quads[i * 4 + 1] = RaspiAPA102HSVFixedComponent(sextant, v[i], vs, 1);
+        quads[i * 4 + 2] = RaspiAPA102HSVFixedComponent(sextant, v[i], vs, 3);
+        quads[i * 4 + 3] = RaspiAPA102HSVFixedComponent(sextant, v[i], vs, 5);
+    }
+}
+
+#if defined(RASPI_APA102_SIMD_X86)
+
+/**
+ * @brief   Computes 8 fixed-point `RGB` components using `SSSE3`.
+ *
+ * @param   h   The hues in 1/256 sextants.
+ * @param   v   The values.
+ * @param   vs  The products of value and saturation.
+ * @param   n   The component offset (`5` for red, `3` for green and `1` for blue).
+ *
+ * @return  The color components (16-bit lanes).
+ */
+RASPI_APA102_TARGET_SSSE3
+static inline __m128i RaspiAPA102HSVFixedComponentSSSE3(__m128i h, __m128i v, __m128i vs, 
+    int16_t n)
+{
+    __m128i k = _mm_add_epi16(h, _mm_set1_epi16((int16_t)(n * 256 - 1536)));
+    k = _mm_add_epi16(k, _mm_and_si128(_mm_srai_epi16(k, 15), _mm_set1_epi16(1536)));
+    __m128i x = _mm_min_epi16(k, _mm_sub_epi16(_mm_set1_epi16(1024), k));
+    x = _mm_max_epi16(x, _mm_setzero_si128());
+    x = _mm_min_epi16(x, _mm_set1_epi16(256));
+    x = _mm_mullo_epi16(vs, x);
+    x = _mm_srli_epi16(_mm_add_epi16(x, _mm_set1_epi16(128)), 8);
+
+    return _mm_sub_epi16(v, x);
+}
+
+/**
+ * @brief   Converts the given fixed-point `HSV` color values to color quads using `SSSE3`.
+ *
+ * @param   quads   Receives the color quads.
+ * @param   h       The hues.
+ * @param   s       The saturations.
+ * @param   v       The values.
+ * @param   count   The number of color values.
+ * @param   header  The brightness byte.
+ *
+ * @return  The number of converted color values.
+ */
+RASPI_APA102_TARGET_SSSE3
+static size_t RaspiAPA102HSVFixedSSSE3(uint8_t* quads, const uint16_t* h, const uint8_t* s, 
+    const uint8_t* v, size_t count, uint8_t header)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i brightness = _mm_set1_epi8((char)header);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i hue = 
+            _mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)&h[i]), _mm_set1_epi16(1536));
+        const __m128i saturation = 
+            _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)&s[i]), zero);
+        const __m128i value = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)&v[i]), zero);
+
+        // Rounded division by 255 (see `RaspiAPA102Div255`)
+        __m128i vs = _mm_add_epi16(_mm_mullo_epi16(value, saturation), _mm_set1_epi16(128));
+        vs = _mm_srli_epi16(_mm_add_epi16(vs, _mm_srli_epi16(vs, 8)), 8);
+
+        const __m128i r = _mm_packus_epi16(
+            RaspiAPA102HSVFixedComponentSSSE3(hue, value, vs, 5), zero);
+        const __m128i g = _mm_packus_epi16(
+            RaspiAPA102HSVFixedComponentSSSE3(hue, value, vs, 3), zero);
+        const __m128i b = _mm_packus_epi16(
+            RaspiAPA102HSVFixedComponentSSSE3(hue, value, vs, 1), zero);
+
+        const __m128i lo = _mm_unpacklo_epi8(brightness, b);
+        const __m128i hi = _mm_unpacklo_epi8(g, r);
+        _mm_storeu_si128((__m128i*)&quads[i * 4 +  0], _mm_unpacklo_epi16(lo, hi));
+        _mm_storeu_si128((__m128i*)&quads[i * 4 + 16], _mm_unpackhi_epi16(lo, hi));
+    }
+
+    return i;
+}
+
+#endif
+
+#if defined(RASPI_APA102_SIMD_ARM)
+
+/**
+ * @brief   Computes 8 fixed-point `RGB` components using `NEON`.
+ *
+ * @param   h   The hues in 1/256 sextants.
+ * @param   v   The values.
+ * @param   vs  The products of value and saturation.
+ * @param   n   The component offset (`5` for red, `3` for green and `1` for blue).
+ *
+ * @return  The color components.
+ */
+static inline uint8x8_t RaspiAPA102HSVFixedComponentNEON(int16x8_t h, uint16x8_t v, 
+    uint16x8_t vs, int16_t n)
+{
+    int16x8_t k = vaddq_s16(h, vdupq_n_s16((int16_t)(n * 256 - 1536)));
+    k = vaddq_s16(k, vandq_s16(vshrq_n_s16(k, 15), vdupq_n_s16(1536)));
+    int16x8_t x = vminq_s16(k, vsubq_s16(vdupq_n_s16(1024), k));
+    x = vmaxq_s16(x, vdupq_n_s16(0));
+    x = vminq_s16(x, vdupq_n_s16(256));
+    const uint16x8_t d = 
+        vshrq_n_u16(vaddq_u16(vmulq_u16(vs, vreinterpretq_u16_s16(x)), vdupq_n_u16(128)), 8);
+
+    return vmovn_u16(vsubq_u16(v, d));
+}
+
+/**
+ * @brief   Converts the given fixed-point `HSV` color values to color quads using `NEON`.
+ *
+ * @param   quads   Receives the color quads.
+ * @param   h       The hues.
+ * @param   s       The saturations.
+ * @param   v       The values.
+ * @param   count   The number of color values.
+ * @param   header  The brightness byte.
+ *
+ * @return  The number of converted color values.
+ */
+static size_t RaspiAPA102HSVFixedNEON(uint8_t* quads, const uint16_t* h, const uint8_t* s, 
+    const uint8_t* v, size_t count, uint8_t header)
+{
+    uint8x8x4_t result;
+    result.val[0] = vdup_n_u8(header);
 
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint16x8_t hue16 = vld1q_u16(&h[i]);
+        const int16x8_t hue = vreinterpretq_s16_u16(vcombine_u16(
+            vshrn_n_u32(vmull_n_u16(vget_low_u16(hue16), 1536), 16), 
+            vshrn_n_u32(vmull_n_u16(vget_high_u16(hue16), 1536), 16)));
+        const uint16x8_t value = vmovl_u8(vld1_u8(&v[i]));
+
+        // Rounded division by 255 (see `RaspiAPA102Div255`)
+        uint16x8_t vs = vmlaq_u16(vdupq_n_u16(128), value, vmovl_u8(vld1_u8(&s[i])));
+        vs = vshrq_n_u16(vaddq_u16(vs, vshrq_n_u16(vs, 8)), 8);
+
+        result.val[1] = RaspiAPA102HSVFixedComponentNEON(hue, value, vs, 1);
+        result.val[2] = RaspiAPA102HSVFixedComponentNEON(hue, value, vs, 3);
+        result.val[3] = RaspiAPA102HSVFixedComponentNEON(hue, value, vs, 5);
+        vst4_u8(&quads[i * 4], result);
+    }
+
+    return i;
+}
+
+#endif
 
 /* ---------------------------------------------------------------------------------------------- */
 
@@ -171,4 +433,139 @@ RaspiAPA102RGB RaspiAPA102HSV2RGB(RaspiAPA102HSV in)
 
 /* ---------------------------------------------------------------------------------------------- */
 
+/* ---------------------------------------------------------------------------------------------- */
+/* Batch                                                                                          */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102RGB2HSVBatch(const float* r, const float* g, const float* b, float* h, float* s, 
+    float* v, size_t count)
+{
+    if (count && (!r || !g || !b || !h || !s || !v))
+    {
+        return -1;
+    }
+
+    const float* restrict in_r = r;
+    const float* restrict in_g = g;
+    const float* restrict in_b = b;
+    float* restrict out_h = h;
+    float* restrict out_s = s;
+    float* restrict out_v = v;
+
+    // The ternaries have no side effects, so the compiler may turn them into selects and vectorize
+    // the loop (this is not guaranteed)
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float max = fmaxf(fmaxf(in_r[i], in_g[i]), in_b[i]);
+        const float min = fminf(fminf(in_r[i], in_g[i]), in_b[i]);
+        const float delta = max - min;
+        const float inverse = (delta > 0.00001f) ? 1.0f / delta : 0.0f;
+
+        float hue = (in_r[i] >= max) 
+            ? (in_g[i] - in_b[i]) * inverse 
+            : ((in_g[i] >= max) 
+                ? 2.0f + (in_b[i] - in_r[i]) * inverse 
+                : 4.0f + (in_r[i] - in_g[i]) * inverse);
+        hue *= 60.0f;
+
+        out_h[i] = (hue < 0.0f) ? hue + 360.0f : hue;
+        out_s[i] = (max > 0.0f) ? delta / fmaxf(max, 0.00001f) : 0.0f;
+        out_v[i] = max;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102HSV2RGBBatch(const float* h, const float* s, const float* v, float* r, float* g, 
+    float* b, size_t count)
+{
+    if (count && (!h || !s || !v || !r || !g || !b))
+    {
+        return -1;
+    }
+
+    const float* restrict in_h = h;
+    const float* restrict in_s = s;
+    const float* restrict in_v = v;
+    float* restrict out_r = r;
+    float* restrict out_g = g;
+    float* restrict out_b = b;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float sextant = RaspiAPA102HSVSextant(in_h[i]);
+
+        out_r[i] = RaspiAPA102HSVComponent(sextant, in_s[i], in_v[i], 5.0f);
+        out_g[i] = RaspiAPA102HSVComponent(sextant, in_s[i], in_v[i], 3.0f);
+        out_b[i] = RaspiAPA102HSVComponent(sextant, in_s[i], in_v[i], 1.0f);
+    }
+
+    return 0;
+}
+
+int RaspiAPA102HSV2ColorQuadBatch(RaspiAPA102ColorQuad* quads, const float* h, const float* s, 
+    const float* v, size_t count, uint8_t brightness)
+{
+    if (count && (!quads || !h || !s || !v))
+    {
+        return -1;
+    }
+
+    const uint8_t header = 0b11100000 | (brightness & 0b00011111);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float sextant = RaspiAPA102HSVSextant(h[i]);
+
+        quads[i].brightness = header;
+        quads[i].r = RaspiAPA102ComponentToByte(RaspiAPA102HSVComponent(sextant, s[i], v[i], 5.0f));
+        quads[i].g = RaspiAPA102ComponentToByte(RaspiAPA102HSVComponent(sextant, s[i], v[i], 3.0f));
+        quads[i].b = RaspiAPA102ComponentToByte(RaspiAPA102HSVComponent(sextant, s[i], v[i], 1.0f));
+    }
+
+    return 0;
+}
+
+int RaspiAPA102HSVFixed2ColorQuadBatch(RaspiAPA102ColorQuad* quads, const uint16_t* h, 
+    const uint8_t* s, const uint8_t* v, size_t count, uint8_t brightness)
+{
+    return RaspiAPA102HSVFixed2ColorQuadBatchEx(quads, h, s, v, count, brightness, 
+        RASPI_APA102_SIMD_AUTO);
+}
+
+int RaspiAPA102HSVFixed2ColorQuadBatchEx(RaspiAPA102ColorQuad* quads, const uint16_t* h, 
+    const uint8_t* s, const uint8_t* v, size_t count, uint8_t brightness, 
+    RaspiAPA102SIMDPath path)
+{
+    if ((count && (!quads || !h || !s || !v)) || !RaspiAPA102SIMDIsSupported(path))
+    {
+        return -1;
+    }
+
+    uint8_t* destination = (uint8_t*)quads;
+    const uint8_t header = 0b11100000 | (brightness & 0b00011111);
+    size_t done = 0;
+    switch (RaspiAPA102SIMDResolve(path))
+    {
+#if defined(RASPI_APA102_SIMD_X86)
+    case RASPI_APA102_SIMD_SSSE3:
+    case RASPI_APA102_SIMD_AVX2:
+        done = RaspiAPA102HSVFixedSSSE3(destination, h, s, v, count, header);
+        break;
+#endif
+#if defined(RASPI_APA102_SIMD_ARM)
+    case RASPI_APA102_SIMD_NEON:
+        done = RaspiAPA102HSVFixedNEON(destination, h, s, v, count, header);
+        break;
+#endif
+    default:
+        break;
+    }
+    RaspiAPA102HSVFixedScalar(&destination[done * 4], &h[done], &s[done], &v[done], count - done, 
+        header);
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
 /***************************************************************************************************/
\ No newline at end of file
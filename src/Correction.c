@@ -0,0 +1,319 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <RaspiAPA102/Correction.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   The maximum linear 8.8 fixed-point value (`255.0`).
+ */
+#define RASPI_APA102_CORRECTION_MAX (255u * 256u)
+
+#define RASPI_APA102_GLOBAL_SCALE(brightness) (((brightness) * 65536u + 15u) / 31u)
+#define RASPI_APA102_LEVEL_SCALE(level) ((31u * 65536u + (level) / 2u) / (level))
+
+/**
+ * @brief   Scales a linear color by a global brightness of `n / 31` (16.16 fixed-point).
+ */
+static const uint32_t RASPI_APA102_GLOBAL_SCALE[32] =
+{
+    RASPI_APA102_GLOBAL_SCALE( 0), RASPI_APA102_GLOBAL_SCALE( 1), RASPI_APA102_GLOBAL_SCALE( 2),
+    RASPI_APA102_GLOBAL_SCALE( 3), RASPI_APA102_GLOBAL_SCALE( 4), RASPI_APA102_GLOBAL_SCALE( 5),
+    RASPI_APA102_GLOBAL_SCALE( 6), RASPI_APA102_GLOBAL_SCALE( 7), RASPI_APA102_GLOBAL_SCALE( 8),
+    RASPI_APA102_GLOBAL_SCALE( 9), RASPI_APA102_GLOBAL_SCALE(10), RASPI_APA102_GLOBAL_SCALE(11),
+    RASPI_APA102_GLOBAL_SCALE(12), RASPI_APA102_GLOBAL_SCALE(13), RASPI_APA102_GLOBAL_SCALE(14),
+    RASPI_APA102_GLOBAL_SCALE(15), RASPI_APA102_GLOBAL_SCALE(16), RASPI_APA102_GLOBAL_SCALE(17),
+    RASPI_APA102_GLOBAL_SCALE(18), RASPI_APA102_GLOBAL_SCALE(19), RASPI_APA102_GLOBAL_SCALE(20),
+    RASPI_APA102_GLOBAL_SCALE(21), RASPI_APA102_GLOBAL_SCALE(22), RASPI_APA102_GLOBAL_SCALE(23),
+    RASPI_APA102_GLOBAL_SCALE(24), RASPI_APA102_GLOBAL_SCALE(25), RASPI_APA102_GLOBAL_SCALE(26),
+    RASPI_APA102_GLOBAL_SCALE(27), RASPI_APA102_GLOBAL_SCALE(28), RASPI_APA102_GLOBAL_SCALE(29),
+    RASPI_APA102_GLOBAL_SCALE(30), RASPI_APA102_GLOBAL_SCALE(31)
+};
+
+/**
+ * @brief   Scales a linear color to the color range of the LED brightness `n` (`31 / n`, 16.16 
+ *          fixed-point).
+ */
+static const uint32_t RASPI_APA102_LEVEL_SCALE[32] =
+{
+    0,                            RASPI_APA102_LEVEL_SCALE( 1), RASPI_APA102_LEVEL_SCALE( 2),
+    RASPI_APA102_LEVEL_SCALE( 3), RASPI_APA102_LEVEL_SCALE( 4), RASPI_APA102_LEVEL_SCALE( 5),
+    RASPI_APA102_LEVEL_SCALE( 6), RASPI_APA102_LEVEL_SCALE( 7), RASPI_APA102_LEVEL_SCALE( 8),
+    RASPI_APA102_LEVEL_SCALE( 9), RASPI_APA102_LEVEL_SCALE(10), RASPI_APA102_LEVEL_SCALE(11),
+    RASPI_APA102_LEVEL_SCALE(12), RASPI_APA102_LEVEL_SCALE(13), RASPI_APA102_LEVEL_SCALE(14),
+    RASPI_APA102_LEVEL_SCALE(15), RASPI_APA102_LEVEL_SCALE(16), RASPI_APA102_LEVEL_SCALE(17),
+    RASPI_APA102_LEVEL_SCALE(18), RASPI_APA102_LEVEL_SCALE(19), RASPI_APA102_LEVEL_SCALE(20),
+    RASPI_APA102_LEVEL_SCALE(21), RASPI_APA102_LEVEL_SCALE(22), RASPI_APA102_LEVEL_SCALE(23),
+    RASPI_APA102_LEVEL_SCALE(24), RASPI_APA102_LEVEL_SCALE(25), RASPI_APA102_LEVEL_SCALE(26),
+    RASPI_APA102_LEVEL_SCALE(27), RASPI_APA102_LEVEL_SCALE(28), RASPI_APA102_LEVEL_SCALE(29),
+    RASPI_APA102_LEVEL_SCALE(30), RASPI_APA102_LEVEL_SCALE(31)
+};
+
+#undef RASPI_APA102_LEVEL_SCALE
+#undef RASPI_APA102_GLOBAL_SCALE
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Correction                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Rebuilds the lookup tables of the given `RaspiAPA102Correction` struct.
+ *
+ * @param   correction  A pointer to the `RaspiAPA102Correction` struct.
+ */
+static void RaspiAPA102CorrectionBuild(RaspiAPA102Correction* correction)
+{
+    for (int c = 0; c < 3; ++c)
+    {
+        const float white = correction->white_balance[c];
+        for (int i = 0; i < 256; ++i)
+        {
+            const float linear = powf((float)i / 255.0f, correction->gamma);
+            correction->lut[c][i] = 
+                (uint16_t)lroundf(linear * white * (float)RASPI_APA102_CORRECTION_MAX);
+        }
+        correction->white[c] = 
+            (uint32_t)lroundf(white * (float)RASPI_APA102_CORRECTION_MAX / 65535.0f * 65536.0f);
+    }
+}
+
+/**
+ * @brief   Quantizes a linear color and writes it to the given color quad.
+ *
+ * @param   flags       The `RaspiAPA102CorrectionFlags`.
+ * @param   quad        A pointer to the destination color quad.
+ * @param   r           The linear red component (8.8 fixed-point).
+ * @param   g           The linear green component (8.8 fixed-point).
+ * @param   b           The linear blue component (8.8 fixed-point).
+ * @param   brightness  The global LED brightness (0..31).
+ * @param   error       A pointer to the quantization error of the LED, or `NULL`.
+ */
+static inline void RaspiAPA102CorrectionQuantize(uint32_t flags, RaspiAPA102ColorQuad* quad, 
+    uint32_t r, uint32_t g, uint32_t b, uint8_t brightness, uint8_t* error)
+{
+    uint32_t level = brightness & 0b00011111;
+
+    if (flags & RASPI_APA102_CORRECTION_BRIGHTNESS)
+    {
+        const uint32_t global = RASPI_APA102_GLOBAL_SCALE[level];
+        r = (r * global) >> 16;
+        g = (g * global) >> 16;
+        b = (b * global) >> 16;
+
+        // Select the lowest LED brightness that can still represent the brightest component and 
+        // scale the color up accordingly
+        uint32_t max = (r > g) ? r : g;
+        max = (max > b) ? max : b;
+        level = (max * 31 + RASPI_APA102_CORRECTION_MAX - 1) / RASPI_APA102_CORRECTION_MAX;
+        level = level ? level : 1;
+
+        const uint64_t scale = RASPI_APA102_LEVEL_SCALE[level];
+        r = (uint32_t)((r * scale) >> 16);
+        g = (uint32_t)((g * scale) >> 16);
+        b = (uint32_t)((b * scale) >> 16);
+        r = (r > RASPI_APA102_CORRECTION_MAX) ? RASPI_APA102_CORRECTION_MAX : r;
+        g = (g > RASPI_APA102_CORRECTION_MAX) ? RASPI_APA102_CORRECTION_MAX : g;
+        b = (b > RASPI_APA102_CORRECTION_MAX) ? RASPI_APA102_CORRECTION_MAX : b;
+    }
+
+    if (error)
+    {
+        // Add the remainder of the last frame and keep the new one for the next frame
+        r += error[0];
+        g += error[1];
+        b += error[2];
+        error[0] = (uint8_t)r;
+        error[1] = (uint8_t)g;
+        error[2] = (uint8_t)b;
+    }
+    else
+    {
+        r += 128;
+        g += 128;
+        b += 128;
+    }
+
+    quad->brightness = (uint8_t)(0b11100000 | level);
+    quad->r = (uint8_t)(r >> 8);
+    quad->g = (uint8_t)(g >> 8);
+    quad->b = (uint8_t)(b >> 8);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Correction                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102CorrectionInit(RaspiAPA102Correction* correction, size_t count, float gamma, 
+    uint32_t flags)
+{
+    if (!correction || !(gamma > 0.0f))
+    {
+        return -1;
+    }
+
+    memset(correction, 0, sizeof(*correction));
+    correction->gamma = gamma;
+    correction->white_balance[0] = 1.0f;
+    correction->white_balance[1] = 1.0f;
+    correction->white_balance[2] = 1.0f;
+    correction->flags = flags;
+    correction->count = count;
+
+    if ((flags & RASPI_APA102_CORRECTION_DITHERING) && count)
+    {
+        correction->error = malloc(count * 3);
+        if (!correction->error)
+        {
+            return -1;
+        }
+        RaspiAPA102CorrectionReset(correction);
+    }
+
+    RaspiAPA102CorrectionBuild(correction);
+
+    return 0;
+}
+
+int RaspiAPA102CorrectionSetGamma(RaspiAPA102Correction* correction, float gamma)
+{
+    if (!correction || !(gamma > 0.0f))
+    {
+        return -1;
+    }
+
+    correction->gamma = gamma;
+    RaspiAPA102CorrectionBuild(correction);
+
+    return 0;
+}
+
+int RaspiAPA102CorrectionSetWhiteBalance(RaspiAPA102Correction* correction, float r, float g, 
+    float b)
+{
+    if (!correction || !(r >= 0.0f && r <= 1.0f) || !(g >= 0.0f && g <= 1.0f) || 
+        !(b >= 0.0f && b <= 1.0f))
+    {
+        return -1;
+    }
+
+    correction->white_balance[0] = r;
+    correction->white_balance[1] = g;
+    correction->white_balance[2] = b;
+    RaspiAPA102CorrectionBuild(correction);
+
+    return 0;
+}
+
+int RaspiAPA102CorrectionApply(RaspiAPA102Correction* correction, RaspiAPA102ColorQuad* quads, 
+    size_t count)
+{
+    if (!correction || (count && !quads) || (count > correction->count))
+    {
+        return -1;
+    }
+
+    const uint32_t flags = correction->flags;
+    uint8_t* error = correction->error;
+    for (size_t i = 0; i < count; ++i)
+    {
+        RaspiAPA102ColorQuad* quad = &quads[i];
+        RaspiAPA102CorrectionQuantize(flags, quad, correction->lut[0][quad->r], 
+            correction->lut[1][quad->g], correction->lut[2][quad->b], quad->brightness, 
+            error ? &error[i * 3] : NULL);
+    }
+
+    return 0;
+}
+
+int RaspiAPA102CorrectionApply16(RaspiAPA102Correction* correction, RaspiAPA102ColorQuad* quads, 
+    const uint16_t* pixels, size_t count, uint8_t brightness)
+{
+    if (!correction || (count && (!quads || !pixels)) || (count > correction->count))
+    {
+        return -1;
+    }
+
+    const uint32_t flags = correction->flags;
+    uint8_t* error = correction->error;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint16_t* pixel = &pixels[i * 3];
+        RaspiAPA102CorrectionQuantize(flags, &quads[i], 
+            (pixel[0] * correction->white[0]) >> 16, (pixel[1] * correction->white[1]) >> 16, 
+            (pixel[2] * correction->white[2]) >> 16, brightness, error ? &error[i * 3] : NULL);
+    }
+
+    return 0;
+}
+
+int RaspiAPA102CorrectionReset(RaspiAPA102Correction* correction)
+{
+    if (!correction)
+    {
+        return -1;
+    }
+
+    if (correction->error)
+    {
+        // Start in the middle, so the first frame is rounded instead of truncated
+        memset(correction->error, 128, correction->count * 3);
+    }
+
+    return 0;
+}
+
+int RaspiAPA102CorrectionDestroy(RaspiAPA102Correction* correction)
+{
+    if (!correction)
+    {
+        return -1;
+    }
+
+    free(correction->error);
+    correction->error = NULL;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
@@ -0,0 +1,918 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/DMA.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <TransportInternal.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   The path of the device node that exposes the physical memory.
+ */
+#define RASPI_APA102_DMA_MEM_PATH "/dev/mem"
+
+/**
+ * @brief   The path of the device node of the `VideoCore` mailbox.
+ */
+#define RASPI_APA102_DMA_MAILBOX_PATH "/dev/vcio"
+
+/**
+ * @brief   The path of the device tree property that holds the peripheral base address.
+ */
+#define RASPI_APA102_DMA_RANGES_PATH "/proc/device-tree/soc/ranges"
+
+/**
+ * @brief   The `ioctl` request of a mailbox property call.
+ */
+#define RASPI_APA102_DMA_MAILBOX_PROPERTY _IOWR(100, 0, char*)
+
+#define RASPI_APA102_DMA_TAG_GET_CLOCK_RATE 0x00030002u
+#define RASPI_APA102_DMA_TAG_ALLOCATE       0x0003000Cu
+#define RASPI_APA102_DMA_TAG_LOCK           0x0003000Du
+#define RASPI_APA102_DMA_TAG_UNLOCK         0x0003000Eu
+#define RASPI_APA102_DMA_TAG_RELEASE        0x0003000Fu
+
+/**
+ * @brief   The mailbox id of the core clock that drives the `SPI` controller.
+ */
+#define RASPI_APA102_DMA_CLOCK_CORE 4
+
+/**
+ * @brief   The core clock frequency in Hz that is assumed if it can not be queried.
+ */
+#define RASPI_APA102_DMA_DEFAULT_CORE_CLOCK 250000000u
+
+/**
+ * @brief   The page size used for the mailbox allocation.
+ */
+#define RASPI_APA102_DMA_PAGE_SIZE 4096
+
+/**
+ * @brief   The size of the control area at the start of the `DMA` memory.
+ */
+#define RASPI_APA102_DMA_CONTROL_SIZE 32
+
+/**
+ * @brief   The index of the word in the control area that receives the sequence number of the last
+ *          frame on the wire.
+ */
+#define RASPI_APA102_DMA_WORD_COMPLETED 0
+
+/**
+ * @brief   The index of the word in the control area that receives the drained `SPI` FIFO data.
+ */
+#define RASPI_APA102_DMA_WORD_SINK 1
+
+/**
+ * @brief   The index of the word in the control area that holds the `CS` value used to start the 
+ *          `TX` channel.
+ */
+#define RASPI_APA102_DMA_WORD_START 2
+
+/**
+ * @brief   The `CS` value used to start a `DMA` channel.
+ */
+#define RASPI_APA102_DMA_CS_START \
+    (RASPI_APA102_DMA_CS_ACTIVE | RASPI_APA102_DMA_CS_END | RASPI_APA102_DMA_CS_PRIORITY(8) | \
+     RASPI_APA102_DMA_CS_PANIC_PRIORITY(8) | RASPI_APA102_DMA_CS_WAIT_FOR_OUTSTANDING_WRITES)
+
+/**
+ * @brief   The interval used to poll the engine state in nanoseconds.
+ */
+#define RASPI_APA102_DMA_POLL_INTERVAL 50000
+
+_Static_assert(sizeof(RaspiAPA102DMAControlBlock) == 32, "Invalid control block size");
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Layout                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Rounds the given value up to a multiple of `alignment`.
+ *
+ * @param   value       The value.
+ * @param   alignment   The alignment (a power of two).
+ *
+ * @return  The aligned value.
+ */
+static inline size_t RaspiAPA102DMAAlign(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief   Returns the maximum number of chunks of a frame.
+ *
+ * @param   capacity    The maximum size of a framed buffer in bytes.
+ *
+ * @return  The maximum number of chunks.
+ */
+static inline size_t RaspiAPA102DMAGetChunkCount(size_t capacity)
+{
+    return (RaspiAPA102DMAAlign(capacity, 4) + RASPI_APA102_DMA_MAX_CHUNK - 1) / 
+        RASPI_APA102_DMA_MAX_CHUNK;
+}
+
+/**
+ * @brief   Computes the layout of a frame slot.
+ *
+ * @param   capacity        The maximum size of a framed buffer in bytes.
+ * @param   blocks_offset   Receives the offset of the control blocks inside a slot.
+ * @param   data_offset     Receives the offset of the framed buffer inside a slot.
+ *
+ * A slot starts with the sequence number of its frame, followed by the `SPI` header words and the
+ * addresses of the `TX` control blocks of all chunks. The control blocks and the framed buffer 
+ * follow at 32 byte aligned offsets.
+ *
+ * @return  The size of a slot in bytes.
+ */
+static size_t RaspiAPA102DMAGetLayout(size_t capacity, size_t* blocks_offset, size_t* data_offset)
+{
+    const size_t chunks = RaspiAPA102DMAGetChunkCount(capacity);
+
+    *blocks_offset = RaspiAPA102DMAAlign((1 + 2 * chunks) * sizeof(uint32_t), 32);
+    *data_offset = *blocks_offset + 
+        (RASPI_APA102_DMA_BLOCKS_PER_CHUNK * chunks + 1) * sizeof(RaspiAPA102DMAControlBlock);
+
+    return *data_offset + RaspiAPA102DMAAlign(capacity, 32);
+}
+
+/**
+ * @brief   Returns a pointer to the given frame slot.
+ *
+ * @param   dma         A pointer to the `RaspiAPA102DMA` struct.
+ * @param   sequence    The sequence number of the frame.
+ *
+ * @return  A pointer to the frame slot.
+ */
+static inline uint8_t* RaspiAPA102DMAGetSlot(const RaspiAPA102DMA* dma, uint32_t sequence)
+{
+    return dma->memory + RASPI_APA102_DMA_CONTROL_SIZE + 
+        (sequence % RASPI_APA102_DMA_SLOT_COUNT) * dma->slot_size;
+}
+
+/**
+ * @brief   Translates the given pointer into the `DMA` memory to a bus address.
+ *
+ * @param   dma     A pointer to the `RaspiAPA102DMA` struct.
+ * @param   pointer A pointer into the `DMA` memory.
+ *
+ * @return  The bus address.
+ */
+static inline uint32_t RaspiAPA102DMAGetBus(const RaspiAPA102DMA* dma, const void* pointer)
+{
+    return dma->memory_bus + (uint32_t)((const uint8_t*)pointer - dma->memory);
+}
+
+/**
+ * @brief   Returns the bus address of the given register of the given `DMA` channel.
+ *
+ * @param   channel The `DMA` channel.
+ * @param   index   The index of the register.
+ *
+ * @return  The bus address.
+ */
+static inline uint32_t RaspiAPA102DMAGetChannelBus(int channel, unsigned index)
+{
+    return RASPI_APA102_DMA_BUS_PERIPHERALS + RASPI_APA102_DMA_OFFSET + 
+        (uint32_t)channel * RASPI_APA102_DMA_CHANNEL_SIZE + index * 4;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Control blocks                                                                                 */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given control block.
+ *
+ * @param   block           A pointer to the `RaspiAPA102DMAControlBlock` struct.
+ * @param   transfer_info   The transfer information.
+ * @param   source          The source address.
+ * @param   destination     The destination address.
+ * @param   length          The transfer length in bytes.
+ * @param   next            The address of the next control block, or `0`.
+ */
+static void RaspiAPA102DMASetBlock(RaspiAPA102DMAControlBlock* block, uint32_t transfer_info, 
+    uint32_t source, uint32_t destination, uint32_t length, uint32_t next)
+{
+    block->transfer_info = transfer_info;
+    block->source        = source;
+    block->destination   = destination;
+    block->length        = length;
+    block->stride        = 0;
+    block->next          = next;
+    block->reserved[0]   = 0;
+    block->reserved[1]   = 0;
+}
+
+/**
+ * @brief   Builds the control block chain of the given frame slot.
+ *
+ * @param   dma         A pointer to the `RaspiAPA102DMA` struct.
+ * @param   sequence    The sequence number of the frame.
+ * @param   size        The size of the frame in bytes (a multiple of 4).
+ *
+ * For every chunk, the `RX` chain starts the `TX` channel at the `TX` chain of the chunk (`SPI` 
+ * header word followed by the data) and drains the received bytes, which also waits for the 
+ * transfer to complete. The last control block stores the sequence number of the frame in the 
+ * control area and stops the `RX` channel.
+ *
+ * @return  A pointer to the first `RX` control block.
+ */
+static RaspiAPA102DMAControlBlock* RaspiAPA102DMABuildChain(RaspiAPA102DMA* dma, 
+    uint32_t sequence, size_t size)
+{
+    uint8_t* const slot = RaspiAPA102DMAGetSlot(dma, sequence);
+    uint32_t* const control = (uint32_t*)dma->memory;
+    uint32_t* const words = (uint32_t*)slot;
+    uint32_t* const headers = words + 1;
+    uint32_t* const starts = headers + RaspiAPA102DMAGetChunkCount(dma->capacity);
+    RaspiAPA102DMAControlBlock* const blocks = 
+        (RaspiAPA102DMAControlBlock*)(slot + dma->blocks_offset);
+    const uint32_t data = RaspiAPA102DMAGetBus(dma, slot + dma->data_offset);
+
+    const uint32_t fifo = RASPI_APA102_DMA_BUS_PERIPHERALS + RASPI_APA102_DMA_SPI_OFFSET + 
+        RASPI_APA102_SPI_FIFO * 4;
+    const uint32_t ti_tx = RASPI_APA102_DMA_TI_WAIT_RESP | RASPI_APA102_DMA_TI_DEST_DREQ | 
+        RASPI_APA102_DMA_TI_PERMAP(RASPI_APA102_DMA_DREQ_SPI_TX);
+    const uint32_t ti_rx = RASPI_APA102_DMA_TI_WAIT_RESP | RASPI_APA102_DMA_TI_SRC_DREQ | 
+        RASPI_APA102_DMA_TI_PERMAP(RASPI_APA102_DMA_DREQ_SPI_RX);
+
+    words[0] = sequence;
+
+    const size_t chunks = (size + RASPI_APA102_DMA_MAX_CHUNK - 1) / RASPI_APA102_DMA_MAX_CHUNK;
+    RaspiAPA102DMAControlBlock* const last = &blocks[RASPI_APA102_DMA_BLOCKS_PER_CHUNK * chunks];
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        const size_t offset = i * RASPI_APA102_DMA_MAX_CHUNK;
+        const uint32_t length = (uint32_t)((size - offset < RASPI_APA102_DMA_MAX_CHUNK) ? 
+            size - offset : RASPI_APA102_DMA_MAX_CHUNK);
+
+        RaspiAPA102DMAControlBlock* const block = &blocks[RASPI_APA102_DMA_BLOCKS_PER_CHUNK * i];
+        RaspiAPA102DMAControlBlock* const next = block + RASPI_APA102_DMA_BLOCKS_PER_CHUNK;
+
+        // In `DMA` mode, the first word written to the FIFO while `TA` is clear configures the 
+        // transfer length and the `CS` register
+        headers[i] = (length << 16) | RASPI_APA102_SPI_CS_TA;
+        starts[i] = RaspiAPA102DMAGetBus(dma, &block[0]);
+
+        RaspiAPA102DMASetBlock(&block[0], ti_tx, RaspiAPA102DMAGetBus(dma, &headers[i]), fifo, 4, 
+            RaspiAPA102DMAGetBus(dma, &block[1]));
+        RaspiAPA102DMASetBlock(&block[1], ti_tx | RASPI_APA102_DMA_TI_SRC_INC, 
+            data + (uint32_t)offset, fifo, length, 0);
+        RaspiAPA102DMASetBlock(&block[2], RASPI_APA102_DMA_TI_WAIT_RESP, 
+            RaspiAPA102DMAGetBus(dma, &starts[i]), 
+            RaspiAPA102DMAGetChannelBus(dma->tx_channel, RASPI_APA102_DMA_CONBLK_AD), 4, 
+            RaspiAPA102DMAGetBus(dma, &block[3]));
+        RaspiAPA102DMASetBlock(&block[3], RASPI_APA102_DMA_TI_WAIT_RESP, 
+            RaspiAPA102DMAGetBus(dma, &control[RASPI_APA102_DMA_WORD_START]), 
+            RaspiAPA102DMAGetChannelBus(dma->tx_channel, RASPI_APA102_DMA_CS), 4, 
+            RaspiAPA102DMAGetBus(dma, &block[4]));
+        RaspiAPA102DMASetBlock(&block[4], ti_rx, fifo, 
+            RaspiAPA102DMAGetBus(dma, &control[RASPI_APA102_DMA_WORD_SINK]), length, 
+            RaspiAPA102DMAGetBus(dma, (i + 1 < chunks) ? &next[2] : last));
+    }
+    RaspiAPA102DMASetBlock(last, RASPI_APA102_DMA_TI_WAIT_RESP, RaspiAPA102DMAGetBus(dma, words), 
+        RaspiAPA102DMAGetBus(dma, &control[RASPI_APA102_DMA_WORD_COMPLETED]), 4, 0);
+    dma->last = last;
+
+    return &blocks[2];
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Engine                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the sequence number of the last frame on the wire.
+ *
+ * @param   dma A pointer to the `RaspiAPA102DMA` struct.
+ *
+ * @return  The sequence number.
+ */
+static inline uint32_t RaspiAPA102DMALoadCompleted(const RaspiAPA102DMA* dma)
+{
+    return ((volatile const uint32_t*)dma->memory)[RASPI_APA102_DMA_WORD_COMPLETED];
+}
+
+/**
+ * @brief   Starts the `RX` channel at the given control block.
+ *
+ * @param   dma     A pointer to the `RaspiAPA102DMA` struct.
+ * @param   block   A pointer to the first control block.
+ */
+static void RaspiAPA102DMAStart(RaspiAPA102DMA* dma, const RaspiAPA102DMAControlBlock* block)
+{
+    dma->rx[RASPI_APA102_DMA_CONBLK_AD] = RaspiAPA102DMAGetBus(dma, block);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    dma->rx[RASPI_APA102_DMA_CS] = RASPI_APA102_DMA_CS_START;
+}
+
+/**
+ * @brief   Waits until the frame with the given sequence number is on the wire.
+ *
+ * @param   dma         A pointer to the `RaspiAPA102DMA` struct.
+ * @param   sequence    The sequence number of the frame.
+ *
+ * @return  A status code. Fails, if a `DMA` channel signals an error or stopped early.
+ */
+static int RaspiAPA102DMAWaitFor(const RaspiAPA102DMA* dma, uint32_t sequence)
+{
+    const struct timespec interval = { 0, RASPI_APA102_DMA_POLL_INTERVAL };
+
+    while ((int32_t)(RaspiAPA102DMALoadCompleted(dma) - sequence) < 0)
+    {
+        const uint32_t status = dma->rx[RASPI_APA102_DMA_CS];
+        if ((status | dma->tx[RASPI_APA102_DMA_CS]) & RASPI_APA102_DMA_CS_ERROR)
+        {
+            return -1;
+        }
+        if (!(status & RASPI_APA102_DMA_CS_ACTIVE) && 
+            ((int32_t)(RaspiAPA102DMALoadCompleted(dma) - sequence) < 0))
+        {
+            return -1;
+        }
+        nanosleep(&interval, NULL);
+    }
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Hardware                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Reads the physical base address of the peripheral block.
+ *
+ * @param   base    Receives the physical base address.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102DMAGetPeripheralBase(uint32_t* base)
+{
+    FILE* file = fopen(RASPI_APA102_DMA_RANGES_PATH, "rb");
+    if (!file)
+    {
+        return -1;
+    }
+    uint8_t ranges[12];
+    const size_t size = fread(ranges, 1, sizeof(ranges), file);
+    fclose(file);
+    if (size < 8)
+    {
+        return -1;
+    }
+
+    // The `BCM2711` uses two cells for the parent address
+    *base = ((uint32_t)ranges[4] << 24) | ((uint32_t)ranges[5] << 16) | 
+        ((uint32_t)ranges[6] << 8) | ranges[7];
+    if (!*base && (size == 12))
+    {
+        *base = ((uint32_t)ranges[8] << 24) | ((uint32_t)ranges[9] << 16) | 
+            ((uint32_t)ranges[10] << 8) | ranges[11];
+    }
+
+    return *base ? 0 : -1;
+}
+
+/**
+ * @brief   Maps the given range of physical memory.
+ *
+ * @param   address The physical address (page aligned).
+ * @param   size    The size of the range in bytes.
+ *
+ * @return  A pointer to the mapping, or `NULL` if the mapping failed.
+ */
+static void* RaspiAPA102DMAMapPhysical(uint32_t address, size_t size)
+{
+    const int fd = open(RASPI_APA102_DMA_MEM_PATH, O_RDWR | O_SYNC | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    void* const mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)address);
+    close(fd);
+
+    return (mapping == MAP_FAILED) ? NULL : mapping;
+}
+
+/**
+ * @brief   Performs a mailbox property call with a single tag.
+ *
+ * @param   fd      The file descriptor of the mailbox.
+ * @param   tag     The tag.
+ * @param   values  A pointer to the value buffer. Receives the response.
+ * @param   count   The number of 32-bit values.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102DMAMailboxCall(int fd, uint32_t tag, uint32_t* values, size_t count)
+{
+    uint32_t buffer[16] __attribute__((aligned(16)));
+    if (count > sizeof(buffer) / sizeof(buffer[0]) - 6)
+    {
+        return -1;
+    }
+
+    buffer[0] = (uint32_t)((6 + count) * sizeof(uint32_t));
+    buffer[1] = 0;
+    buffer[2] = tag;
+    buffer[3] = (uint32_t)(count * sizeof(uint32_t));
+    buffer[4] = (uint32_t)(count * sizeof(uint32_t));
+    memcpy(&buffer[5], values, count * sizeof(uint32_t));
+    buffer[5 + count] = 0;
+
+    if ((ioctl(fd, RASPI_APA102_DMA_MAILBOX_PROPERTY, buffer) < 0) || (buffer[1] != 0x80000000u))
+    {
+        return -1;
+    }
+    memcpy(values, &buffer[5], count * sizeof(uint32_t));
+
+    return 0;
+}
+
+/**
+ * @brief   Allocates uncached `DMA` memory through the mailbox and maps it.
+ *
+ * @param   dma     A pointer to the `RaspiAPA102DMA` struct.
+ * @param   base    The physical base address of the peripheral block.
+ * @param   size    The size of the memory in bytes.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102DMAAllocate(RaspiAPA102DMA* dma, uint32_t base, size_t size)
+{
+    dma->mailbox = open(RASPI_APA102_DMA_MAILBOX_PATH, O_RDWR | O_CLOEXEC);
+    if (dma->mailbox < 0)
+    {
+        return -1;
+    }
+
+    // Direct (uncached) allocations; the `BCM2835` additionally needs coherent accesses
+    const uint32_t flags = (base == 0x20000000u) ? 0x0C : 0x04;
+    size = RaspiAPA102DMAAlign(size, RASPI_APA102_DMA_PAGE_SIZE);
+
+    uint32_t values[3] = { (uint32_t)size, RASPI_APA102_DMA_PAGE_SIZE, flags };
+    if ((RaspiAPA102DMAMailboxCall(dma->mailbox, RASPI_APA102_DMA_TAG_ALLOCATE, values, 3) < 0) || 
+        !values[0])
+    {
+        return -1;
+    }
+    dma->memory_handle = values[0];
+
+    values[0] = dma->memory_handle;
+    if ((RaspiAPA102DMAMailboxCall(dma->mailbox, RASPI_APA102_DMA_TAG_LOCK, values, 1) < 0) || 
+        !values[0])
+    {
+        return -1;
+    }
+    dma->memory_bus  = values[0];
+    dma->memory_size = size;
+    dma->memory      = RaspiAPA102DMAMapPhysical(dma->memory_bus & ~0xC0000000u, size);
+
+    return dma->memory ? 0 : -1;
+}
+
+/**
+ * @brief   Releases the `DMA` memory allocated through the mailbox.
+ *
+ * @param   dma A pointer to the `RaspiAPA102DMA` struct.
+ */
+static void RaspiAPA102DMARelease(RaspiAPA102DMA* dma)
+{
+    if (dma->mailbox < 0)
+    {
+        return;
+    }
+
+    if (dma->memory)
+    {
+        munmap(dma->memory, dma->memory_size);
+    }
+    if (dma->memory_handle)
+    {
+        uint32_t handle = dma->memory_handle;
+        RaspiAPA102DMAMailboxCall(dma->mailbox, RASPI_APA102_DMA_TAG_UNLOCK, &handle, 1);
+        handle = dma->memory_handle;
+        RaspiAPA102DMAMailboxCall(dma->mailbox, RASPI_APA102_DMA_TAG_RELEASE, &handle, 1);
+    }
+    close(dma->mailbox);
+    dma->mailbox = -1;
+}
+
+/**
+ * @brief   Maps the peripheral registers and allocates the `DMA` memory.
+ *
+ * @param   dma     A pointer to the `RaspiAPA102DMA` struct.
+ * @param   size    The size of the `DMA` memory in bytes.
+ * @param   clock   Receives the core clock frequency in Hz.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102DMAOpenHardware(RaspiAPA102DMA* dma, size_t size, uint32_t* clock)
+{
+    uint32_t base;
+    if (RaspiAPA102DMAGetPeripheralBase(&base) < 0)
+    {
+        return -1;
+    }
+
+    dma->dma_mapping = RaspiAPA102DMAMapPhysical(base + RASPI_APA102_DMA_OFFSET, 
+        RASPI_APA102_DMA_PAGE_SIZE);
+    dma->spi_mapping = RaspiAPA102DMAMapPhysical(base + RASPI_APA102_DMA_SPI_OFFSET, 
+        RASPI_APA102_DMA_PAGE_SIZE);
+    if (!dma->dma_mapping || !dma->spi_mapping || (RaspiAPA102DMAAllocate(dma, base, size) < 0))
+    {
+        return -1;
+    }
+
+    uint32_t values[2] = { RASPI_APA102_DMA_CLOCK_CORE, 0 };
+    if ((RaspiAPA102DMAMailboxCall(dma->mailbox, RASPI_APA102_DMA_TAG_GET_CLOCK_RATE, values, 
+        2) == 0) && values[1])
+    {
+        *clock = values[1];
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Unmaps the peripheral registers and releases the `DMA` memory.
+ *
+ * @param   dma A pointer to the `RaspiAPA102DMA` struct.
+ */
+static void RaspiAPA102DMACloseHardware(RaspiAPA102DMA* dma)
+{
+    RaspiAPA102DMARelease(dma);
+    if (dma->dma_mapping)
+    {
+        munmap(dma->dma_mapping, RASPI_APA102_DMA_PAGE_SIZE);
+    }
+    if (dma->spi_mapping)
+    {
+        munmap(dma->spi_mapping, RASPI_APA102_DMA_PAGE_SIZE);
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transport                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Copies the given buffer into the next free frame slot.
+ *
+ * @param   context A pointer to the `RaspiAPA102DMA` struct.
+ * @param   buffer  A pointer to the data buffer.
+ * @param   size    The number of bytes to write.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102DMATransportWrite(void* context, const uint8_t* buffer, size_t size)
+{
+    RaspiAPA102DMA* const dma = context;
+
+    uint8_t* frame;
+    if (RaspiAPA102DMAGetFrame(dma, &frame) < 0)
+    {
+        return -1;
+    }
+    if (size > dma->capacity - dma->pending)
+    {
+        dma->pending = 0;
+        return -1;
+    }
+    memcpy(frame + dma->pending, buffer, size);
+    dma->pending += size;
+
+    return 0;
+}
+
+/**
+ * @brief   Submits the frame that was written since the last flush.
+ *
+ * @param   context A pointer to the `RaspiAPA102DMA` struct.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102DMATransportFlush(void* context)
+{
+    RaspiAPA102DMA* const dma = context;
+
+    const size_t size = dma->pending;
+    dma->pending = 0;
+
+    return size ? RaspiAPA102DMASubmit(dma, size) : 0;
+}
+
+/**
+ * @brief   Destroys and releases an engine created by `RaspiAPA102DMATransportCreate`.
+ *
+ * @param   context A pointer to the `RaspiAPA102DMA` struct.
+ */
+static void RaspiAPA102DMATransportClose(void* context)
+{
+    // Let the queued frames drain before the engine is stopped
+    RaspiAPA102DMAWait(context);
+    RaspiAPA102DMADestroy(context);
+    free(context);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Library functions                                                                              */
+/* ============================================================================================== */
+
+int RaspiAPA102DMATransportCreate(RaspiAPA102Transport* transport, uint32_t speed_hz, 
+    size_t capacity)
+{
+    if (!transport)
+    {
+        return -1;
+    }
+
+    RaspiAPA102DMA* const dma = malloc(sizeof(RaspiAPA102DMA));
+    if (!dma)
+    {
+        return -1;
+    }
+    if (RaspiAPA102DMAInit(dma, NULL, RASPI_APA102_DMA_DEFAULT_TX_CHANNEL, 
+        RASPI_APA102_DMA_DEFAULT_RX_CHANNEL, capacity, speed_hz) < 0)
+    {
+        free(dma);
+        return -1;
+    }
+
+    RaspiAPA102DMAGetTransport(dma, transport);
+    transport->close = &RaspiAPA102DMATransportClose;
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* DMA                                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102DMAGetMemorySize(size_t capacity, size_t* size)
+{
+    if (!capacity || (capacity > UINT32_MAX / (2 * RASPI_APA102_DMA_SLOT_COUNT)) || !size)
+    {
+        return -1;
+    }
+
+    size_t blocks_offset;
+    size_t data_offset;
+    *size = RASPI_APA102_DMA_CONTROL_SIZE + RASPI_APA102_DMA_SLOT_COUNT * 
+        RaspiAPA102DMAGetLayout(capacity, &blocks_offset, &data_offset);
+
+    return 0;
+}
+
+int RaspiAPA102DMAInit(RaspiAPA102DMA* dma, const RaspiAPA102DMARegion* region, int tx_channel, 
+    int rx_channel, size_t capacity, uint32_t speed_hz)
+{
+    size_t size;
+    if (!dma || 
+        (tx_channel < 0) || (tx_channel > RASPI_APA102_DMA_MAX_CHANNEL) || 
+        (rx_channel < 0) || (rx_channel > RASPI_APA102_DMA_MAX_CHANNEL) || 
+        (tx_channel == rx_channel) || !speed_hz || 
+        (RaspiAPA102DMAGetMemorySize(capacity, &size) < 0))
+    {
+        return -1;
+    }
+    if (region && (!region->peripherals || !region->memory || (region->memory_size < size) || 
+        ((uintptr_t)region->memory & 31) || (region->memory_bus & 31)))
+    {
+        return -1;
+    }
+
+    memset(dma, 0, sizeof(*dma));
+    dma->mailbox    = -1;
+    dma->tx_channel = tx_channel;
+    dma->rx_channel = rx_channel;
+    dma->capacity   = capacity;
+    dma->slot_size  = RaspiAPA102DMAGetLayout(capacity, &dma->blocks_offset, &dma->data_offset);
+
+    volatile uint32_t* registers;
+    uint32_t clock = RASPI_APA102_DMA_DEFAULT_CORE_CLOCK;
+    if (region)
+    {
+        registers        = region->peripherals + RASPI_APA102_DMA_OFFSET / 4;
+        dma->spi         = region->peripherals + RASPI_APA102_DMA_SPI_OFFSET / 4;
+        dma->memory      = region->memory;
+        dma->memory_bus  = region->memory_bus;
+        dma->memory_size = region->memory_size;
+    }
+    else
+    {
+        if (RaspiAPA102DMAOpenHardware(dma, size, &clock) < 0)
+        {
+            RaspiAPA102DMACloseHardware(dma);
+            return -1;
+        }
+        registers = dma->dma_mapping;
+        dma->spi  = dma->spi_mapping;
+    }
+    dma->tx = registers + tx_channel * RASPI_APA102_DMA_CHANNEL_SIZE / 4;
+    dma->rx = registers + rx_channel * RASPI_APA102_DMA_CHANNEL_SIZE / 4;
+
+    memset(dma->memory, 0, size);
+    uint32_t* const control = (uint32_t*)dma->memory;
+    control[RASPI_APA102_DMA_WORD_START] = RASPI_APA102_DMA_CS_START;
+
+    // Reset both channels and clear their error flags
+    registers[RASPI_APA102_DMA_ENABLE] |= (1u << tx_channel) | (1u << rx_channel);
+    dma->tx[RASPI_APA102_DMA_CS] = RASPI_APA102_DMA_CS_RESET;
+    dma->rx[RASPI_APA102_DMA_CS] = RASPI_APA102_DMA_CS_RESET;
+    dma->tx[RASPI_APA102_DMA_CS] = 0;
+    dma->rx[RASPI_APA102_DMA_CS] = 0;
+    dma->tx[RASPI_APA102_DMA_DEBUG] = 7;
+    dma->rx[RASPI_APA102_DMA_DEBUG] = 7;
+
+    // The clock divider has to be even; `0` selects the maximum divider of 65536
+    uint32_t divider = (clock + speed_hz - 1) / speed_hz;
+    divider = (divider < 2) ? 2 : (divider + 1) & ~1u;
+    dma->spi[RASPI_APA102_SPI_CS]  = RASPI_APA102_SPI_CS_CLEAR_TX | RASPI_APA102_SPI_CS_CLEAR_RX;
+    dma->spi[RASPI_APA102_SPI_CLK] = (divider > 65534) ? 0 : divider;
+    dma->spi[RASPI_APA102_SPI_CS]  = RASPI_APA102_SPI_CS_DMAEN | RASPI_APA102_SPI_CS_ADCS;
+
+    return 0;
+}
+
+int RaspiAPA102DMAGetFrame(RaspiAPA102DMA* dma, uint8_t** frame)
+{
+    if (!dma || !dma->memory || !frame)
+    {
+        return -1;
+    }
+
+    const uint32_t sequence = dma->sequence + 1;
+    if ((sequence > RASPI_APA102_DMA_SLOT_COUNT) && 
+        (RaspiAPA102DMAWaitFor(dma, sequence - RASPI_APA102_DMA_SLOT_COUNT) < 0))
+    {
+        return -1;
+    }
+    *frame = RaspiAPA102DMAGetSlot(dma, sequence) + dma->data_offset;
+
+    return 0;
+}
+
+int RaspiAPA102DMASubmit(RaspiAPA102DMA* dma, size_t size)
+{
+    uint8_t* frame;
+    if (!dma || !size || (size > dma->capacity) || (RaspiAPA102DMAGetFrame(dma, &frame) < 0))
+    {
+        return -1;
+    }
+
+    const size_t padded = RaspiAPA102DMAAlign(size, 4);
+    memset(frame + size, frame[size - 1], padded - size);
+
+    const uint32_t sequence = dma->sequence + 1;
+    RaspiAPA102DMAControlBlock* const previous = dma->last;
+    RaspiAPA102DMAControlBlock* const first = RaspiAPA102DMABuildChain(dma, sequence, padded);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (!previous)
+    {
+        dma->sequence = sequence;
+        RaspiAPA102DMAStart(dma, first);
+        return 0;
+    }
+
+    // Link the frame to the end of the previous frame. The controller loads the address of the
+    // next control block together with the current one, so the link is missed if the last control
+    // block of the previous frame is already running
+    const uint32_t previous_bus = RaspiAPA102DMAGetBus(dma, previous);
+    previous->next = RaspiAPA102DMAGetBus(dma, first);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    dma->sequence = sequence;
+
+    for (;;)
+    {
+        const uint32_t status = dma->rx[RASPI_APA102_DMA_CS];
+        if (status & RASPI_APA102_DMA_CS_ERROR)
+        {
+            return -1;
+        }
+        if (status & RASPI_APA102_DMA_CS_ACTIVE)
+        {
+            if ((dma->rx[RASPI_APA102_DMA_CONBLK_AD] == previous_bus) && 
+                !dma->rx[RASPI_APA102_DMA_NEXTCONBK])
+            {
+                // The channel stops after the current control block
+                continue;
+            }
+            return 0;
+        }
+        if (RaspiAPA102DMALoadCompleted(dma) != sequence)
+        {
+            RaspiAPA102DMAStart(dma, first);
+        }
+        return 0;
+    }
+}
+
+int RaspiAPA102DMAWait(RaspiAPA102DMA* dma)
+{
+    if (!dma || !dma->memory)
+    {
+        return -1;
+    }
+
+    return dma->sequence ? RaspiAPA102DMAWaitFor(dma, dma->sequence) : 0;
+}
+
+int RaspiAPA102DMAGetCompleted(const RaspiAPA102DMA* dma, uint32_t* sequence)
+{
+    if (!dma || !dma->memory || !sequence)
+    {
+        return -1;
+    }
+
+    *sequence = RaspiAPA102DMALoadCompleted(dma);
+
+    return 0;
+}
+
+int RaspiAPA102DMAGetTransport(RaspiAPA102DMA* dma, RaspiAPA102Transport* transport)
+{
+    if (!dma || !transport)
+    {
+        return -1;
+    }
+
+    memset(transport, 0, sizeof(*transport));
+    transport->context = dma;
+    transport->write   = &RaspiAPA102DMATransportWrite;
+    transport->flush   = &RaspiAPA102DMATransportFlush;
+
+    return 0;
+}
+
+int RaspiAPA102DMADestroy(RaspiAPA102DMA* dma)
+{
+    if (!dma)
+    {
+        return -1;
+    }
+
+    if (dma->tx && dma->rx && dma->spi)
+    {
+        dma->rx[RASPI_APA102_DMA_CS] = RASPI_APA102_DMA_CS_RESET;
+        dma->tx[RASPI_APA102_DMA_CS] = RASPI_APA102_DMA_CS_RESET;
+        dma->spi[RASPI_APA102_SPI_CS] = 
+            RASPI_APA102_SPI_CS_CLEAR_TX | RASPI_APA102_SPI_CS_CLEAR_RX;
+    }
+    RaspiAPA102DMACloseHardware(dma);
+    memset(dma, 0, sizeof(*dma));
+    dma->mailbox = -1;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
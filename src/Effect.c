@@ -0,0 +1,602 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/Effect.h>
+#include <RaspiAPA102/ColorConversion.h>
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   The number of pixels converted at once by the hue based effects.
+ */
+#define RASPI_APA102_EFFECT_CHUNK_SIZE 256
+
+/**
+ * @brief   The number of noise cells along a single flame of the fire effect.
+ */
+#define RASPI_APA102_EFFECT_FIRE_CELLS 4
+
+/* ============================================================================================== */
+/* Internal types                                                                                 */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102EffectState` struct.
+ *
+ * Holds the per-frame values of an effect in fixed-point, so that every pixel is computed with 
+ * integer arithmetic only.
+ */
+typedef struct RaspiAPA102EffectState_
+{
+    /**
+     * @brief   A pointer to the `RaspiAPA102Effect` struct.
+     */
+    const RaspiAPA102Effect* effect;
+    /**
+     * @brief   The canvas (only used by `RaspiAPA102EffectRenderParallel`).
+     */
+    RaspiAPA102ColorQuad* canvas;
+    /**
+     * @brief   The pattern phase at position `0` (a full pattern is `2^32`).
+     */
+    uint32_t phase;
+    /**
+     * @brief   The pattern phase increment per pixel.
+     */
+    uint32_t step;
+    /**
+     * @brief   The noise coordinate increment per pixel (16.16 fixed-point, in noise cells).
+     */
+    uint64_t noise_step;
+    /**
+     * @brief   The noise coordinate of the time (16.16 fixed-point, in noise cells).
+     */
+    uint64_t noise_time;
+    /**
+     * @brief   The brightness byte of the rendered LED frames.
+     */
+    uint8_t header;
+} RaspiAPA102EffectState;
+
+/**
+ * @brief   Defines the `RaspiAPA102EffectNoise` struct.
+ *
+ * Samples two dimensional value noise along a row of increasing coordinates. The lattice values
+ * are only hashed when a pixel enters a new cell.
+ */
+typedef struct RaspiAPA102EffectNoise_
+{
+    /**
+     * @brief   The seed of the lattice.
+     */
+    uint32_t seed;
+    /**
+     * @brief   The lattice row below the time coordinate.
+     */
+    uint32_t row;
+    /**
+     * @brief   The interpolation weight between the two lattice rows (0..256).
+     */
+    uint32_t weight;
+    /**
+     * @brief   The current lattice column.
+     */
+    uint32_t column;
+    /**
+     * @brief   The values of the current and the next lattice column.
+     */
+    uint32_t values[2];
+    /**
+     * @brief   Signals, if `column` and `values` are valid.
+     */
+    bool valid;
+} RaspiAPA102EffectNoise;
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Helpers                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Interpolates between two 8-bit values.
+ *
+ * @param   a       The first value.
+ * @param   b       The second value.
+ * @param   weight  The weight of the second value (0..256).
+ *
+ * @return  The interpolated value.
+ */
+static inline uint32_t RaspiAPA102EffectLerp(uint32_t a, uint32_t b, uint32_t weight)
+{
+    return (a * (256 - weight) + b * weight) >> 8;
+}
+
+/**
+ * @brief   Applies the smoothstep curve to the given 8-bit fraction.
+ *
+ * @param   fraction    The fraction (0..255).
+ *
+ * @return  The weight (0..256).
+ */
+static inline uint32_t RaspiAPA102EffectSmooth(uint32_t fraction)
+{
+    const uint32_t value = (fraction * fraction * (768 - 2 * fraction)) >> 16;
+
+    return value + (value >> 7);
+}
+
+/**
+ * @brief   Writes a single pixel that is interpolated between two colors.
+ *
+ * @param   quad    Receives the pixel.
+ * @param   header  The brightness byte.
+ * @param   from    The first color.
+ * @param   to      The second color.
+ * @param   weight  The weight of the second color (0..255).
+ *
+ * The colors are passed by value: the byte stores to `quad` could alias any pointer, which would
+ * force the compiler to reload them for every pixel.
+ */
+static inline void RaspiAPA102EffectMix(RaspiAPA102ColorQuad* quad, uint8_t header, 
+    RaspiAPA102ColorQuad from, RaspiAPA102ColorQuad to, uint32_t weight)
+{
+    weight += weight >> 7;
+
+    quad->brightness = header;
+    quad->b = (uint8_t)RaspiAPA102EffectLerp(from.b, to.b, weight);
+    quad->g = (uint8_t)RaspiAPA102EffectLerp(from.g, to.g, weight);
+    quad->r = (uint8_t)RaspiAPA102EffectLerp(from.r, to.r, weight);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Noise                                                                                          */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the value of the given lattice point.
+ *
+ * @param   x       The lattice column.
+ * @param   y       The lattice row.
+ * @param   seed    The seed.
+ *
+ * @return  The value (0..255).
+ */
+static inline uint32_t RaspiAPA102EffectHash(uint32_t x, uint32_t y, uint32_t seed)
+{
+    uint32_t hash = (x * 0x9E3779B1u) ^ ((y + seed) * 0x85EBCA77u);
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6Du;
+    hash ^= hash >> 12;
+    hash *= 0x297A2D39u;
+    hash ^= hash >> 15;
+
+    return hash >> 24;
+}
+
+/**
+ * @brief   Initializes the given `RaspiAPA102EffectNoise` struct.
+ *
+ * @param   noise   A pointer to the `RaspiAPA102EffectNoise` struct.
+ * @param   seed    The seed.
+ * @param   time    The time coordinate (16.16 fixed-point).
+ */
+static void RaspiAPA102EffectNoiseInit(RaspiAPA102EffectNoise* noise, uint32_t seed, 
+    uint64_t time)
+{
+    noise->seed   = seed;
+    noise->row    = (uint32_t)(time >> 16);
+    noise->weight = RaspiAPA102EffectSmooth((uint32_t)(time >> 8) & 0xFF);
+    noise->valid  = false;
+}
+
+/**
+ * @brief   Returns the value of the given lattice column, interpolated between the two rows.
+ *
+ * @param   noise   A pointer to the `RaspiAPA102EffectNoise` struct.
+ * @param   column  The lattice column.
+ *
+ * @return  The value (0..255).
+ */
+static inline uint32_t RaspiAPA102EffectNoiseColumn(const RaspiAPA102EffectNoise* noise, 
+    uint32_t column)
+{
+    return RaspiAPA102EffectLerp(RaspiAPA102EffectHash(column, noise->row, noise->seed), 
+        RaspiAPA102EffectHash(column, noise->row + 1, noise->seed), noise->weight);
+}
+
+/**
+ * @brief   Samples the noise at the given coordinate.
+ *
+ * @param   noise   A pointer to the `RaspiAPA102EffectNoise` struct.
+ * @param   x       The coordinate (16.16 fixed-point).
+ *
+ * @return  The value (0..255).
+ */
+static inline uint32_t RaspiAPA102EffectNoiseSample(RaspiAPA102EffectNoise* noise, uint64_t x)
+{
+    const uint32_t column = (uint32_t)(x >> 16);
+    if (!noise->valid || (column != noise->column))
+    {
+        if (noise->valid && (column == noise->column + 1))
+        {
+            noise->values[0] = noise->values[1];
+        }
+        else
+        {
+            noise->values[0] = RaspiAPA102EffectNoiseColumn(noise, column);
+        }
+        noise->values[1] = RaspiAPA102EffectNoiseColumn(noise, column + 1);
+        noise->column = column;
+        noise->valid = true;
+    }
+
+    return RaspiAPA102EffectLerp(noise->values[0], noise->values[1], 
+        RaspiAPA102EffectSmooth((uint32_t)(x >> 8) & 0xFF));
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Kernels                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Renders a range of the rainbow effect.
+ *
+ * @param   state   A pointer to the `RaspiAPA102EffectState` struct.
+ * @param   quads   Receives the color quads of the range.
+ * @param   offset  The position of the first pixel of the range.
+ * @param   count   The number of pixels in the range.
+ */
+static void RaspiAPA102EffectRenderRainbow(const RaspiAPA102EffectState* state, 
+    RaspiAPA102ColorQuad* quads, size_t offset, size_t count)
+{
+    uint16_t h[RASPI_APA102_EFFECT_CHUNK_SIZE];
+    uint8_t s[RASPI_APA102_EFFECT_CHUNK_SIZE];
+    uint8_t v[RASPI_APA102_EFFECT_CHUNK_SIZE];
+    memset(s, 0xFF, sizeof(s));
+    memset(v, 0xFF, sizeof(v));
+
+    uint32_t phase = (uint32_t)offset * state->step - state->phase;
+    for (size_t i = 0; i < count; i += RASPI_APA102_EFFECT_CHUNK_SIZE)
+    {
+        const size_t n = (count - i < RASPI_APA102_EFFECT_CHUNK_SIZE) ? 
+            count - i : RASPI_APA102_EFFECT_CHUNK_SIZE;
+        for (size_t j = 0; j < n; ++j)
+        {
+            h[j] = (uint16_t)(phase >> 16);
+            phase += state->step;
+        }
+
+        // The batch conversion picks the SIMD implementation of the current CPU
+        RaspiAPA102HSVFixed2ColorQuadBatch(&quads[i], h, s, v, n, state->effect->brightness);
+    }
+}
+
+/**
+ * @brief   Renders a range of the chase effect.
+ *
+ * @param   state   A pointer to the `RaspiAPA102EffectState` struct.
+ * @param   quads   Receives the color quads of the range.
+ * @param   offset  The position of the first pixel of the range.
+ * @param   count   The number of pixels in the range.
+ */
+static void RaspiAPA102EffectRenderChase(const RaspiAPA102EffectState* state, 
+    RaspiAPA102ColorQuad* quads, size_t offset, size_t count)
+{
+    const RaspiAPA102ColorQuad from = state->effect->colors[0];
+    const RaspiAPA102ColorQuad to = state->effect->colors[1];
+    const uint8_t header = state->header;
+    const uint32_t step = state->step;
+
+    // The distance behind the closest head, the tail fades out quadratically
+    uint32_t distance = state->phase - (uint32_t)offset * step;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t intensity = 255 - (distance >> 24);
+        RaspiAPA102EffectMix(&quads[i], header, from, to, 255 - ((intensity * intensity) >> 8));
+        distance -= step;
+    }
+}
+
+/**
+ * @brief   Renders a range of the gradient effect.
+ *
+ * @param   state   A pointer to the `RaspiAPA102EffectState` struct.
+ * @param   quads   Receives the color quads of the range.
+ * @param   offset  The position of the first pixel of the range.
+ * @param   count   The number of pixels in the range.
+ */
+static void RaspiAPA102EffectRenderGradient(const RaspiAPA102EffectState* state, 
+    RaspiAPA102ColorQuad* quads, size_t offset, size_t count)
+{
+    const RaspiAPA102ColorQuad from = state->effect->colors[0];
+    const RaspiAPA102ColorQuad to = state->effect->colors[1];
+    const uint8_t header = state->header;
+    const uint32_t step = state->step;
+
+    uint32_t phase = (uint32_t)offset * step - state->phase;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t position = phase >> 23;
+        const uint32_t weight = (position < 256) ? position : 511 - position;
+        RaspiAPA102EffectMix(&quads[i], header, from, to, weight);
+        phase += step;
+    }
+}
+
+/**
+ * @brief   Renders a range of the noise effect.
+ *
+ * @param   state   A pointer to the `RaspiAPA102EffectState` struct.
+ * @param   quads   Receives the color quads of the range.
+ * @param   offset  The position of the first pixel of the range.
+ * @param   count   The number of pixels in the range.
+ */
+static void RaspiAPA102EffectRenderNoise(const RaspiAPA102EffectState* state, 
+    RaspiAPA102ColorQuad* quads, size_t offset, size_t count)
+{
+    // Two octaves, the second one with half the feature size and half the amplitude
+    RaspiAPA102EffectNoise octaves[2];
+    RaspiAPA102EffectNoiseInit(&octaves[0], state->effect->seed, state->noise_time);
+    RaspiAPA102EffectNoiseInit(&octaves[1], state->effect->seed ^ 0xA5A5A5A5u, 
+        state->noise_time * 2);
+
+    const RaspiAPA102ColorQuad from = state->effect->colors[0];
+    const RaspiAPA102ColorQuad to = state->effect->colors[1];
+    const uint8_t header = state->header;
+    const uint64_t step = state->noise_step;
+
+    uint64_t x = (uint64_t)offset * step;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t value = RaspiAPA102EffectNoiseSample(&octaves[0], x) * 2 + 
+            RaspiAPA102EffectNoiseSample(&octaves[1], x * 2);
+        RaspiAPA102EffectMix(&quads[i], header, from, to, (value * 85) >> 8);
+        x += step;
+    }
+}
+
+/**
+ * @brief   Renders a range of the fire effect.
+ *
+ * @param   state   A pointer to the `RaspiAPA102EffectState` struct.
+ * @param   quads   Receives the color quads of the range.
+ * @param   offset  The position of the first pixel of the range.
+ * @param   count   The number of pixels in the range.
+ */
+static void RaspiAPA102EffectRenderFire(const RaspiAPA102EffectState* state, 
+    RaspiAPA102ColorQuad* quads, size_t offset, size_t count)
+{
+    const uint64_t step = state->noise_step * RASPI_APA102_EFFECT_FIRE_CELLS;
+    const uint64_t time = state->noise_time * RASPI_APA102_EFFECT_FIRE_CELLS;
+
+    // The flames evolve over time and rise towards higher positions
+    RaspiAPA102EffectNoise noise;
+    RaspiAPA102EffectNoiseInit(&noise, state->effect->seed, time);
+
+    const uint8_t header = state->header;
+    const uint32_t section_step = state->step;
+
+    uint64_t x = (uint64_t)offset * step - time;
+    uint32_t position = (uint32_t)offset * section_step;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t falloff = 255 - (position >> 24);
+        uint32_t heat = (RaspiAPA102EffectNoiseSample(&noise, x) * falloff * 3) >> 9;
+        if (heat > 255)
+        {
+            heat = 255;
+        }
+
+        // Black to red to yellow to white
+        const uint32_t level = (heat * 191) >> 8;
+        const uint8_t ramp = (uint8_t)((level & 0x3F) << 2);
+        RaspiAPA102ColorQuad* const quad = &quads[i];
+        quad->brightness = header;
+        if (level & 0x80)
+        {
+            quad->r = 255;
+            quad->g = 255;
+            quad->b = ramp;
+        }
+        else if (level & 0x40)
+        {
+            quad->r = 255;
+            quad->g = ramp;
+            quad->b = 0;
+        }
+        else
+        {
+            quad->r = ramp;
+            quad->g = 0;
+            quad->b = 0;
+        }
+
+        x += step;
+        position += section_step;
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Rendering                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Computes the per-frame values of the given effect.
+ *
+ * @param   effect  A pointer to the `RaspiAPA102Effect` struct.
+ * @param   time_ns The time in nanoseconds.
+ * @param   state   Receives the per-frame values.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102EffectPrepare(const RaspiAPA102Effect* effect, uint64_t time_ns, 
+    RaspiAPA102EffectState* state)
+{
+    if (((unsigned)effect->type > RASPI_APA102_EFFECT_MAX_VALUE) || !isfinite(effect->scale) || 
+        (effect->scale < 1.0f) || !isfinite(effect->speed))
+    {
+        return -1;
+    }
+
+    // Whole seconds and the remainder are reduced separately to keep the precision of the phase
+    const double speed = effect->speed;
+    const double seconds = (double)(time_ns / 1000000000ull);
+    const double fraction = (double)(time_ns % 1000000000ull) * 1e-9;
+    double cycles = (seconds * speed - floor(seconds * speed)) + fraction * speed;
+    cycles -= floor(cycles);
+
+    memset(state, 0, sizeof(*state));
+    state->effect     = effect;
+    state->phase      = (uint32_t)(uint64_t)(cycles * 4294967296.0);
+    state->step       = (uint32_t)(uint64_t)llround(4294967296.0 / effect->scale);
+    state->noise_step = (uint64_t)llround(65536.0 / effect->scale);
+    state->noise_time = (uint64_t)(int64_t)llround(
+        (seconds * speed + fraction * speed) * 65536.0);
+    state->header     = 0b11100000 | (effect->brightness & 0b00011111);
+
+    return 0;
+}
+
+/**
+ * @brief   Renders a range of pixels with the kernel of the given effect.
+ *
+ * @param   state   A pointer to the `RaspiAPA102EffectState` struct.
+ * @param   quads   Receives the color quads of the range.
+ * @param   offset  The position of the first pixel of the range.
+ * @param   count   The number of pixels in the range.
+ */
+static void RaspiAPA102EffectRenderRange(const RaspiAPA102EffectState* state, 
+    RaspiAPA102ColorQuad* quads, size_t offset, size_t count)
+{
+    switch (state->effect->type)
+    {
+    case RASPI_APA102_EFFECT_RAINBOW:
+        RaspiAPA102EffectRenderRainbow(state, quads, offset, count);
+        break;
+    case RASPI_APA102_EFFECT_CHASE:
+        RaspiAPA102EffectRenderChase(state, quads, offset, count);
+        break;
+    case RASPI_APA102_EFFECT_GRADIENT:
+        RaspiAPA102EffectRenderGradient(state, quads, offset, count);
+        break;
+    case RASPI_APA102_EFFECT_NOISE:
+        RaspiAPA102EffectRenderNoise(state, quads, offset, count);
+        break;
+    case RASPI_APA102_EFFECT_FIRE:
+        RaspiAPA102EffectRenderFire(state, quads, offset, count);
+        break;
+    }
+}
+
+/**
+ * @brief   Renders a single tile of `RaspiAPA102EffectRenderParallel`.
+ *
+ * @param   context A pointer to the `RaspiAPA102EffectState` struct.
+ * @param   begin   The index of the first pixel of the tile.
+ * @param   end     The index behind the last pixel of the tile.
+ */
+static void RaspiAPA102EffectRenderTile(void* context, size_t begin, size_t end)
+{
+    const RaspiAPA102EffectState* const state = context;
+    RaspiAPA102EffectRenderRange(state, &state->canvas[begin], begin, end - begin);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Effect                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102EffectInit(RaspiAPA102Effect* effect, RaspiAPA102EffectType type)
+{
+    if (!effect || ((unsigned)type > RASPI_APA102_EFFECT_MAX_VALUE))
+    {
+        return -1;
+    }
+
+    memset(effect, 0, sizeof(*effect));
+    effect->type       = type;
+    effect->scale      = 60.0f;
+    effect->speed      = 1.0f;
+    effect->brightness = 31;
+    RaspiAPA102ColorQuadInit(&effect->colors[0], 255, 255, 255, 31);
+    RaspiAPA102ColorQuadInit(&effect->colors[1], 0, 0, 0, 31);
+
+    return 0;
+}
+
+int RaspiAPA102EffectRender(const RaspiAPA102Effect* effect, RaspiAPA102ColorQuad* quads, 
+    size_t offset, size_t count, uint64_t time_ns)
+{
+    if (!effect || (count && !quads))
+    {
+        return -1;
+    }
+
+    RaspiAPA102EffectState state;
+    if (RaspiAPA102EffectPrepare(effect, time_ns, &state) < 0)
+    {
+        return -1;
+    }
+    RaspiAPA102EffectRenderRange(&state, quads, offset, count);
+
+    return 0;
+}
+
+int RaspiAPA102EffectRenderParallel(const RaspiAPA102Effect* effect, 
+    RaspiAPA102ThreadPool* pool, RaspiAPA102ColorQuad* quads, size_t count, uint64_t time_ns)
+{
+    if (!effect || !pool || (count && !quads))
+    {
+        return -1;
+    }
+
+    RaspiAPA102EffectState state;
+    if (RaspiAPA102EffectPrepare(effect, time_ns, &state) < 0)
+    {
+        return -1;
+    }
+    state.canvas = quads;
+
+    return RaspiAPA102ThreadPoolRun(pool, count, RASPI_APA102_EFFECT_TILE_SIZE, 
+        &RaspiAPA102EffectRenderTile, &state);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
@@ -0,0 +1,468 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/FrameRing.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+#define RASPI_APA102_NSEC_PER_SEC 1000000000ULL
+
+_Static_assert(sizeof(RaspiAPA102FrameRingHeader) == 192, "Unexpected frame ring header size");
+_Static_assert(sizeof(RaspiAPA102FrameRingSlot) == 64, "Unexpected frame ring slot size");
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Time                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the current value of the monotonic clock in nanoseconds.
+ *
+ * @return  The current value of the monotonic clock in nanoseconds.
+ */
+static uint64_t RaspiAPA102FrameRingNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * RASPI_APA102_NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Ring                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the slot with the given index.
+ *
+ * @param   header  A pointer to the `RaspiAPA102FrameRingHeader` struct.
+ * @param   index   The index of the slot.
+ *
+ * @return  A pointer to the slot.
+ */
+static inline RaspiAPA102FrameRingSlot* RaspiAPA102FrameRingGetSlot(
+    RaspiAPA102FrameRingHeader* header, uint32_t index)
+{
+    return (RaspiAPA102FrameRingSlot*)((uint8_t*)header + header->header_size + 
+        (size_t)index * header->slot_size);
+}
+
+/**
+ * @brief   Initializes a new frame ring in the given file.
+ *
+ * @param   ring        A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   fd          The file descriptor.
+ * @param   count       The number of LEDs per frame.
+ * @param   slot_count  The number of slots.
+ *
+ * The file descriptor is closed in any case.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102FrameRingInitFile(RaspiAPA102FrameRing* ring, int fd, size_t count, 
+    uint32_t slot_count)
+{
+    const size_t slot_size = 
+        (sizeof(RaspiAPA102FrameRingSlot) + count * sizeof(RaspiAPA102ColorQuad) + 63) & ~63;
+    const size_t size = sizeof(RaspiAPA102FrameRingHeader) + slot_count * slot_size;
+
+    if (ftruncate(fd, (off_t)size) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    RaspiAPA102FrameRingHeader* header = mapping;
+    memset(header, 0, size);
+    header->version     = RASPI_APA102_FRAME_RING_VERSION;
+    header->header_size = sizeof(RaspiAPA102FrameRingHeader);
+    header->slot_count  = slot_count;
+    header->slot_size   = slot_size;
+    header->pixel_count = count;
+    for (uint32_t i = 0; i < slot_count; ++i)
+    {
+        RaspiAPA102FrameRingSlot* slot = RaspiAPA102FrameRingGetSlot(header, i);
+        RaspiAPA102ColorQuad* quads = (RaspiAPA102ColorQuad*)&slot[1];
+        for (size_t j = 0; j < count; ++j)
+        {
+            RaspiAPA102ColorQuadInit(&quads[j], 0, 0, 0, 0);
+        }
+    }
+    // The magic value is written last, so a concurrent `open` never sees a partial header
+    __atomic_store_n(&header->magic, RASPI_APA102_FRAME_RING_MAGIC, __ATOMIC_RELEASE);
+
+    ring->header   = header;
+    ring->size     = size;
+    ring->consumed = 0;
+
+    return 0;
+}
+
+/**
+ * @brief   Maps an existing frame ring from the given file.
+ *
+ * @param   ring    A pointer to the `RaspiAPA102FrameRing` struct.
+ * @param   fd      The file descriptor.
+ *
+ * The file descriptor is closed in any case.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102FrameRingOpenFD(RaspiAPA102FrameRing* ring, int fd)
+{
+    struct stat info;
+    if ((fstat(fd, &info) < 0) || ((size_t)info.st_size < sizeof(RaspiAPA102FrameRingHeader)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    const size_t size = (size_t)info.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    RaspiAPA102FrameRingHeader* header = mapping;
+    if ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != RASPI_APA102_FRAME_RING_MAGIC) || 
+        (header->version != RASPI_APA102_FRAME_RING_VERSION) || 
+        (header->header_size < sizeof(RaspiAPA102FrameRingHeader)) || 
+        (header->slot_count < 2) || (header->slot_count & (header->slot_count - 1)) || 
+        (header->slot_size < sizeof(RaspiAPA102FrameRingSlot) + 
+            header->pixel_count * sizeof(RaspiAPA102ColorQuad)) || 
+        (header->header_size + header->slot_count * header->slot_size > size))
+    {
+        munmap(mapping, size);
+        return -1;
+    }
+
+    ring->header   = header;
+    ring->size     = size;
+    ring->consumed = __atomic_load_n(&header->write_sequence, __ATOMIC_ACQUIRE);
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Lifecycle                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102FrameRingCreate(RaspiAPA102FrameRing* ring, const char* name, size_t count, 
+    uint32_t slot_count)
+{
+    return RaspiAPA102FrameRingCreateEx(ring, name, count, slot_count, 
+        RASPI_APA102_FRAME_RING_DEFAULT_MODE, 0);
+}
+
+int RaspiAPA102FrameRingCreateEx(RaspiAPA102FrameRing* ring, const char* name, size_t count, 
+    uint32_t slot_count, mode_t mode, uint32_t flags)
+{
+    if (!ring || !name || !count || (slot_count < 2) || (slot_count & (slot_count - 1)))
+    {
+        return -1;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->name = strdup(name);
+    if (!ring->name)
+    {
+        return -1;
+    }
+
+    // Only an explicit request replaces an existing ring, which may still be in use
+    if (flags & RASPI_APA102_FRAME_RING_REPLACE)
+    {
+        shm_unlink(name);
+    }
+    const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, mode);
+    if ((fd < 0) || (RaspiAPA102FrameRingInitFile(ring, fd, count, slot_count) < 0))
+    {
+        if (fd >= 0)
+        {
+            shm_unlink(name);
+        }
+        free(ring->name);
+        ring->name = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102FrameRingOpen(RaspiAPA102FrameRing* ring, const char* name)
+{
+    if (!ring || !name)
+    {
+        return -1;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    return RaspiAPA102FrameRingOpenFD(ring, fd);
+}
+
+int RaspiAPA102FrameRingCreateFile(RaspiAPA102FrameRing* ring, const char* path, size_t count, 
+    uint32_t slot_count)
+{
+    return RaspiAPA102FrameRingCreateFileEx(ring, path, count, slot_count, 
+        RASPI_APA102_FRAME_RING_DEFAULT_MODE, 0);
+}
+
+int RaspiAPA102FrameRingCreateFileEx(RaspiAPA102FrameRing* ring, const char* path, size_t count, 
+    uint32_t slot_count, mode_t mode, uint32_t flags)
+{
+    if (!ring || !path || !count || (slot_count < 2) || (slot_count & (slot_count - 1)))
+    {
+        return -1;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    // Truncating a file that is still mapped by a consumer would make its accesses fault, so an 
+    // existing ring is unlinked instead
+    if (flags & RASPI_APA102_FRAME_RING_REPLACE)
+    {
+        unlink(path);
+    }
+    const int fd = open(path, O_RDWR | O_CREAT | O_EXCL, mode);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (RaspiAPA102FrameRingInitFile(ring, fd, count, slot_count) < 0)
+    {
+        unlink(path);
+        return -1;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102FrameRingOpenFile(RaspiAPA102FrameRing* ring, const char* path)
+{
+    if (!ring || !path)
+    {
+        return -1;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    const int fd = open(path, O_RDWR);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    return RaspiAPA102FrameRingOpenFD(ring, fd);
+}
+
+int RaspiAPA102FrameRingDestroy(RaspiAPA102FrameRing* ring)
+{
+    if (!ring || !ring->header)
+    {
+        return -1;
+    }
+
+    munmap(ring->header, ring->size);
+    ring->header = NULL;
+    if (ring->name)
+    {
+        shm_unlink(ring->name);
+        free(ring->name);
+        ring->name = NULL;
+    }
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Producer                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102FrameRingBeginWrite(RaspiAPA102FrameRing* ring, RaspiAPA102ColorQuad** quads, 
+    size_t* count)
+{
+    if (!ring || !ring->header || !quads)
+    {
+        return -1;
+    }
+
+    RaspiAPA102FrameRingHeader* header = ring->header;
+    const uint32_t write = header->write_sequence;
+    const uint32_t read = __atomic_load_n(&header->read_sequence, __ATOMIC_ACQUIRE);
+
+    *quads = NULL;
+    if (write - read < header->slot_count)
+    {
+        RaspiAPA102FrameRingSlot* slot = 
+            RaspiAPA102FrameRingGetSlot(header, write & (header->slot_count - 1));
+        *quads = (RaspiAPA102ColorQuad*)&slot[1];
+    }
+    if (count)
+    {
+        *count = (size_t)header->pixel_count;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102FrameRingPublish(RaspiAPA102FrameRing* ring)
+{
+    if (!ring || !ring->header)
+    {
+        return -1;
+    }
+
+    RaspiAPA102FrameRingHeader* header = ring->header;
+    const uint32_t write = header->write_sequence;
+    const uint32_t read = __atomic_load_n(&header->read_sequence, __ATOMIC_ACQUIRE);
+    if (write - read >= header->slot_count)
+    {
+        return -1;
+    }
+
+    RaspiAPA102FrameRingSlot* slot = 
+        RaspiAPA102FrameRingGetSlot(header, write & (header->slot_count - 1));
+    slot->sequence = write;
+    slot->publish_ns = RaspiAPA102FrameRingNow();
+    __atomic_store_n(&header->write_sequence, write + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Consumer                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102FrameRingAcquire(RaspiAPA102FrameRing* ring, const RaspiAPA102ColorQuad** quads, 
+    size_t* count, uint32_t* sequence, uint64_t* publish_ns)
+{
+    if (!ring || !ring->header || !quads)
+    {
+        return -1;
+    }
+
+    RaspiAPA102FrameRingHeader* header = ring->header;
+    const uint32_t write = __atomic_load_n(&header->write_sequence, __ATOMIC_ACQUIRE);
+
+    *quads = NULL;
+    if (count)
+    {
+        *count = (size_t)header->pixel_count;
+    }
+    if (write == ring->consumed)
+    {
+        return 0;
+    }
+
+    // Claim the newest frame. The producer never writes to the slot of `read_sequence`
+    const uint32_t newest = write - 1;
+    __atomic_store_n(&header->read_sequence, newest, __ATOMIC_RELEASE);
+    ring->consumed = write;
+
+    const RaspiAPA102FrameRingSlot* slot = 
+        RaspiAPA102FrameRingGetSlot(header, newest & (header->slot_count - 1));
+    *quads = (const RaspiAPA102ColorQuad*)&slot[1];
+    if (sequence)
+    {
+        *sequence = slot->sequence;
+    }
+    if (publish_ns)
+    {
+        *publish_ns = slot->publish_ns;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102FrameRingUpdateDevice(RaspiAPA102FrameRing* ring, const RaspiAPA102Device* device, 
+    bool* updated, uint64_t* latency_ns)
+{
+    if (!ring || !device || !updated)
+    {
+        return -1;
+    }
+
+    const RaspiAPA102ColorQuad* quads;
+    size_t count;
+    uint64_t publish_ns;
+    if (RaspiAPA102FrameRingAcquire(ring, &quads, &count, NULL, &publish_ns) < 0)
+    {
+        return -1;
+    }
+
+    *updated = false;
+    if (!quads)
+    {
+        return 0;
+    }
+
+    // The slot is passed to the transport directly and stays valid until the next `acquire`
+    if (RaspiAPA102DeviceUpdate(device, quads, count) < 0)
+    {
+        return -1;
+    }
+    *updated = true;
+    if (latency_ns)
+    {
+        *latency_ns = RaspiAPA102FrameRingNow() - publish_ns;
+    }
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
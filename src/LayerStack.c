@@ -0,0 +1,746 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/LayerStack.h>
+#include <SIMDInternal.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(RASPI_APA102_SIMD_X86)
+#   include <immintrin.h>
+#endif
+#if defined(RASPI_APA102_SIMD_ARM)
+#   include <arm_neon.h>
+#endif
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Dirty ranges                                                                                   */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Extends the given dirty range by the given range.
+ *
+ * @param   begin   A pointer to the first pixel of the dirty range.
+ * @param   end     A pointer to the position behind the last pixel of the dirty range.
+ * @param   offset  The first pixel of the added range.
+ * @param   count   The number of pixels in the added range.
+ */
+static void RaspiAPA102LayerStackExtend(size_t* begin, size_t* end, size_t offset, size_t count)
+{
+    if (!count)
+    {
+        return;
+    }
+
+    if (*begin >= *end)
+    {
+        *begin = offset;
+        *end = offset + count;
+        return;
+    }
+
+    if (offset < *begin)
+    {
+        *begin = offset;
+    }
+    if (offset + count > *end)
+    {
+        *end = offset + count;
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Scalar                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Blends the given layer pixels into the composed pixels.
+ *
+ * @param   output  A pointer to the composed quads.
+ * @param   pixels  A pointer to the layer quads.
+ * @param   count   The number of pixels.
+ * @param   mode    The blend mode.
+ * @param   opacity The opacity of the layer.
+ *
+ * The weight of a pixel is `opacity * coverage` (`0` to `256`), where the 5-bit coverage is 
+ * expanded to 8 bits. The brightness bytes of the composed quads are kept. All implementations 
+ * produce the same result.
+ */
+static void RaspiAPA102LayerBlendScalar(uint8_t* output, const uint8_t* pixels, size_t count, 
+    RaspiAPA102BlendMode mode, uint32_t opacity)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t coverage5 = pixels[0] & 0b00011111;
+        const uint32_t coverage = (coverage5 << 3) | (coverage5 >> 2);
+        uint32_t weight = (opacity * coverage + 255) >> 8;
+        weight += weight >> 7;
+
+        for (size_t j = 1; j < 4; ++j)
+        {
+            const uint32_t d = output[j];
+            const uint32_t s = pixels[j];
+            uint32_t b;
+            switch (mode)
+            {
+            case RASPI_APA102_BLEND_ADD:
+                b = (d + s > 255) ? 255 : d + s;
+                break;
+            case RASPI_APA102_BLEND_MULTIPLY:
+                b = (d * (s + (s >> 7))) >> 8;
+                break;
+            case RASPI_APA102_BLEND_MAX:
+                b = (d > s) ? d : s;
+                break;
+            default:
+                b = s;
+                break;
+            }
+            output[j] = (uint8_t)((d * (256 - weight) + b * weight) >> 8);
+        }
+
+        output += 4;
+        pixels += 4;
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* x86                                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+#if defined(RASPI_APA102_SIMD_X86)
+
+/**
+ * @brief   Blends 2 pixels that were widened to 16-bit lanes using `SSSE3`.
+ *
+ * @param   d           The composed pixels.
+ * @param   s           The layer pixels.
+ * @param   b           The blended pixels (ignored for `RASPI_APA102_BLEND_MULTIPLY`).
+ * @param   c           The 5-bit coverage of every lane.
+ * @param   mode        The blend mode.
+ * @param   opacity     The opacity in every lane.
+ *
+ * @return  The mixed pixels.
+ */
+RASPI_APA102_TARGET_SSSE3
+static inline __m128i RaspiAPA102LayerMixSSSE3(__m128i d, __m128i s, __m128i b, __m128i c, 
+    RaspiAPA102BlendMode mode, __m128i opacity)
+{
+    c = _mm_or_si128(_mm_slli_epi16(c, 3), _mm_srli_epi16(c, 2));
+    __m128i weight = _mm_srli_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(c, opacity), _mm_set1_epi16(255)), 8);
+    weight = _mm_add_epi16(weight, _mm_srli_epi16(weight, 7));
+
+    if (mode == RASPI_APA102_BLEND_MULTIPLY)
+    {
+        b = _mm_srli_epi16(_mm_mullo_epi16(d, _mm_add_epi16(s, _mm_srli_epi16(s, 7))), 8);
+    }
+
+    return _mm_srli_epi16(_mm_add_epi16(
+        _mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(256), weight)), 
+        _mm_mullo_epi16(b, weight)), 8);
+}
+
+/**
+ * @brief   Blends the given layer pixels into the composed pixels using `SSSE3`.
+ *
+ * @param   output  A pointer to the composed quads.
+ * @param   pixels  A pointer to the layer quads.
+ * @param   count   The number of pixels.
+ * @param   mode    The blend mode.
+ * @param   opacity The opacity of the layer.
+ *
+ * Every iteration blends 4 pixels in 16-bit lanes. The remaining pixels are left to the caller.
+ *
+ * @return  The number of blended pixels.
+ */
+RASPI_APA102_TARGET_SSSE3
+static size_t RaspiAPA102LayerBlendSSSE3(uint8_t* output, const uint8_t* pixels, size_t count, 
+    RaspiAPA102BlendMode mode, uint32_t opacity)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12);
+    const __m128i coverage_mask = _mm_set1_epi8(0b00011111);
+    const __m128i header_mask = _mm_set1_epi32(0xFF);
+    const __m128i factor = _mm_set1_epi16((short)opacity);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i d = _mm_loadu_si128((const __m128i*)&output[i * 4]);
+        const __m128i s = _mm_loadu_si128((const __m128i*)&pixels[i * 4]);
+        const __m128i c = _mm_and_si128(_mm_shuffle_epi8(s, spread), coverage_mask);
+
+        __m128i b;
+        switch (mode)
+        {
+        case RASPI_APA102_BLEND_ADD:
+            b = _mm_adds_epu8(d, s);
+            break;
+        case RASPI_APA102_BLEND_MAX:
+            b = _mm_max_epu8(d, s);
+            break;
+        default:
+            b = s;
+            break;
+        }
+
+        const __m128i lo = RaspiAPA102LayerMixSSSE3(_mm_unpacklo_epi8(d, zero), 
+            _mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero), 
+            mode, factor);
+        const __m128i hi = RaspiAPA102LayerMixSSSE3(_mm_unpackhi_epi8(d, zero), 
+            _mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero), 
+            mode, factor);
+
+        const __m128i value = _mm_or_si128(_mm_and_si128(d, header_mask), 
+            _mm_andnot_si128(header_mask, _mm_packus_epi16(lo, hi)));
+        _mm_storeu_si128((__m128i*)&output[i * 4], value);
+    }
+
+    return i;
+}
+
+/**
+ * @brief   Blends 4 pixels that were widened to 16-bit lanes using `AVX2`.
+ *
+ * @param   d           The composed pixels.
+ * @param   s           The layer pixels.
+ * @param   b           The blended pixels (ignored for `RASPI_APA102_BLEND_MULTIPLY`).
+ * @param   c           The 5-bit coverage of every lane.
+ * @param   mode        The blend mode.
+ * @param   opacity     The opacity in every lane.
+ *
+ * @return  The mixed pixels.
+ */
+RASPI_APA102_TARGET_AVX2
+static inline __m256i RaspiAPA102LayerMixAVX2(__m256i d, __m256i s, __m256i b, __m256i c, 
+    RaspiAPA102BlendMode mode, __m256i opacity)
+{
+    c = _mm256_or_si256(_mm256_slli_epi16(c, 3), _mm256_srli_epi16(c, 2));
+    __m256i weight = _mm256_srli_epi16(
+        _mm256_add_epi16(_mm256_mullo_epi16(c, opacity), _mm256_set1_epi16(255)), 8);
+    weight = _mm256_add_epi16(weight, _mm256_srli_epi16(weight, 7));
+
+    if (mode == RASPI_APA102_BLEND_MULTIPLY)
+    {
+        b = _mm256_srli_epi16(
+            _mm256_mullo_epi16(d, _mm256_add_epi16(s, _mm256_srli_epi16(s, 7))), 8);
+    }
+
+    return _mm256_srli_epi16(_mm256_add_epi16(
+        _mm256_mullo_epi16(d, _mm256_sub_epi16(_mm256_set1_epi16(256), weight)), 
+        _mm256_mullo_epi16(b, weight)), 8);
+}
+
+/**
+ * @brief   Blends the given layer pixels into the composed pixels using `AVX2`.
+ *
+ * @param   output  A pointer to the composed quads.
+ * @param   pixels  A pointer to the layer quads.
+ * @param   count   The number of pixels.
+ * @param   mode    The blend mode.
+ * @param   opacity The opacity of the layer.
+ *
+ * The unpack and pack instructions operate on each 128-bit lane separately, so the pixel order 
+ * is preserved without any cross-lane permutes.
+ *
+ * @return  The number of blended pixels.
+ */
+RASPI_APA102_TARGET_AVX2
+static size_t RaspiAPA102LayerBlendAVX2(uint8_t* output, const uint8_t* pixels, size_t count, 
+    RaspiAPA102BlendMode mode, uint32_t opacity)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12, 
+        0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12);
+    const __m256i coverage_mask = _mm256_set1_epi8(0b00011111);
+    const __m256i header_mask = _mm256_set1_epi32(0xFF);
+    const __m256i factor = _mm256_set1_epi16((short)opacity);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i d = _mm256_loadu_si256((const __m256i*)&output[i * 4]);
+        const __m256i s = _mm256_loadu_si256((const __m256i*)&pixels[i * 4]);
+        const __m256i c = _mm256_and_si256(_mm256_shuffle_epi8(s, spread), coverage_mask);
+
+        __m256i b;
+        switch (mode)
+        {
+        case RASPI_APA102_BLEND_ADD:
+            b = _mm256_adds_epu8(d, s);
+            break;
+        case RASPI_APA102_BLEND_MAX:
+            b = _mm256_max_epu8(d, s);
+            break;
+        default:
+            b = s;
+            break;
+        }
+
+        const __m256i lo = RaspiAPA102LayerMixAVX2(_mm256_unpacklo_epi8(d, zero), 
+            _mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(b, zero), 
+            _mm256_unpacklo_epi8(c, zero), mode, factor);
+        const __m256i hi = RaspiAPA102LayerMixAVX2(_mm256_unpackhi_epi8(d, zero), 
+            _mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(b, zero), 
+            _mm256_unpackhi_epi8(c, zero), mode, factor);
+
+        const __m256i value = _mm256_or_si256(_mm256_and_si256(d, header_mask), 
+            _mm256_andnot_si256(header_mask, _mm256_packus_epi16(lo, hi)));
+        _mm256_storeu_si256((__m256i*)&output[i * 4], value);
+    }
+
+    return i + RaspiAPA102LayerBlendSSSE3(&output[i * 4], &pixels[i * 4], count - i, mode, 
+        opacity);
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+/* ARM                                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+#if defined(RASPI_APA102_SIMD_ARM)
+
+/**
+ * @brief   Blends a single color component of 8 pixels using `NEON`.
+ *
+ * @param   d       The composed components.
+ * @param   s       The layer components.
+ * @param   weight  The weights (`0` to `256`).
+ * @param   mode    The blend mode.
+ *
+ * @return  The mixed components.
+ */
+static inline uint8x8_t RaspiAPA102LayerMixNEON(uint8x8_t d, uint8x8_t s, uint16x8_t weight, 
+    RaspiAPA102BlendMode mode)
+{
+    const uint16x8_t d16 = vmovl_u8(d);
+    uint16x8_t b;
+    switch (mode)
+    {
+    case RASPI_APA102_BLEND_ADD:
+        b = vmovl_u8(vqadd_u8(d, s));
+        break;
+    case RASPI_APA102_BLEND_MULTIPLY:
+    {
+        const uint16x8_t s16 = vmovl_u8(s);
+        b = vshrq_n_u16(vmulq_u16(d16, vsraq_n_u16(s16, s16, 7)), 8);
+        break;
+    }
+    case RASPI_APA102_BLEND_MAX:
+        b = vmovl_u8(vmax_u8(d, s));
+        break;
+    default:
+        b = vmovl_u8(s);
+        break;
+    }
+
+    const uint16x8_t value = vmlaq_u16(vmulq_u16(d16, vsubq_u16(vdupq_n_u16(256), weight)), b, 
+        weight);
+
+    return vshrn_n_u16(value, 8);
+}
+
+/**
+ * @brief   Blends the given layer pixels into the composed pixels using `NEON`.
+ *
+ * @param   output  A pointer to the composed quads.
+ * @param   pixels  A pointer to the layer quads.
+ * @param   count   The number of pixels.
+ * @param   mode    The blend mode.
+ * @param   opacity The opacity of the layer.
+ *
+ * The structure loads deinterleave 16 pixels into separate component registers, so the coverage
+ * is already in a register of its own and the brightness bytes are stored back unchanged.
+ *
+ * @return  The number of blended pixels.
+ */
+static size_t RaspiAPA102LayerBlendNEON(uint8_t* output, const uint8_t* pixels, size_t count, 
+    RaspiAPA102BlendMode mode, uint32_t opacity)
+{
+    const uint8x8_t factor = vdup_n_u8((uint8_t)opacity);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x4_t d = vld4q_u8(&output[i * 4]);
+        const uint8x16x4_t s = vld4q_u8(&pixels[i * 4]);
+
+        const uint8x16_t c5 = vandq_u8(s.val[0], vdupq_n_u8(0b00011111));
+        const uint8x16_t c = vorrq_u8(vshlq_n_u8(c5, 3), vshrq_n_u8(c5, 2));
+        uint16x8_t weight_lo = vshrq_n_u16(vaddq_u16(vmull_u8(vget_low_u8(c), factor), 
+            vdupq_n_u16(255)), 8);
+        uint16x8_t weight_hi = vshrq_n_u16(vaddq_u16(vmull_u8(vget_high_u8(c), factor), 
+            vdupq_n_u16(255)), 8);
+        weight_lo = vsraq_n_u16(weight_lo, weight_lo, 7);
+        weight_hi = vsraq_n_u16(weight_hi, weight_hi, 7);
+
+        for (int j = 1; j < 4; ++j)
+        {
+            d.val[j] = vcombine_u8(
+                RaspiAPA102LayerMixNEON(vget_low_u8(d.val[j]), vget_low_u8(s.val[j]), weight_lo, 
+                    mode), 
+                RaspiAPA102LayerMixNEON(vget_high_u8(d.val[j]), vget_high_u8(s.val[j]), 
+                    weight_hi, mode));
+        }
+        vst4q_u8(&output[i * 4], d);
+    }
+
+    return i;
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Blending                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Blends a range of the given layer into the composed pixels.
+ *
+ * @param   stack   A pointer to the `RaspiAPA102LayerStack` struct.
+ * @param   layer   A pointer to the `RaspiAPA102Layer` struct.
+ * @param   offset  The first pixel of the range.
+ * @param   count   The number of pixels in the range.
+ */
+static void RaspiAPA102LayerStackBlend(RaspiAPA102LayerStack* stack, 
+    const RaspiAPA102Layer* layer, size_t offset, size_t count)
+{
+    uint8_t* const output = (uint8_t*)&stack->output[offset];
+    const uint8_t* const pixels = (const uint8_t*)&layer->pixels[offset];
+
+    size_t done = 0;
+    switch (stack->path)
+    {
+#if defined(RASPI_APA102_SIMD_X86)
+    case RASPI_APA102_SIMD_SSSE3:
+        done = RaspiAPA102LayerBlendSSSE3(output, pixels, count, layer->mode, layer->opacity);
+        break;
+    case RASPI_APA102_SIMD_AVX2:
+        done = RaspiAPA102LayerBlendAVX2(output, pixels, count, layer->mode, layer->opacity);
+        break;
+#endif
+#if defined(RASPI_APA102_SIMD_ARM)
+    case RASPI_APA102_SIMD_NEON:
+        done = RaspiAPA102LayerBlendNEON(output, pixels, count, layer->mode, layer->opacity);
+        break;
+#endif
+    default:
+        break;
+    }
+    RaspiAPA102LayerBlendScalar(&output[done * 4], &pixels[done * 4], count - done, layer->mode, 
+        layer->opacity);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Layer Stack                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102LayerStackInit(RaspiAPA102LayerStack* stack, size_t count, 
+    size_t layer_capacity, uint8_t brightness)
+{
+    if (!stack || !count || (count > RASPI_APA102_MAX_COUNT) || !layer_capacity)
+    {
+        return -1;
+    }
+
+    memset(stack, 0, sizeof(*stack));
+    stack->output = malloc(count * sizeof(RaspiAPA102ColorQuad));
+    stack->layers = calloc(layer_capacity, sizeof(RaspiAPA102Layer));
+    if (!stack->output || !stack->layers)
+    {
+        free(stack->layers);
+        free(stack->output);
+        memset(stack, 0, sizeof(*stack));
+        return -1;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        RaspiAPA102ColorQuadInit(&stack->output[i], 0, 0, 0, brightness);
+    }
+
+    stack->count          = count;
+    stack->layer_capacity = layer_capacity;
+    stack->header         = 0b11100000 | (brightness & 0b00011111);
+    stack->path           = RaspiAPA102SIMDResolve(RASPI_APA102_SIMD_AUTO);
+
+    return 0;
+}
+
+int RaspiAPA102LayerStackAddLayer(RaspiAPA102LayerStack* stack, RaspiAPA102BlendMode mode, 
+    uint8_t opacity, RaspiAPA102LayerRender render, void* context, size_t* index)
+{
+    if (!stack || !stack->output || ((unsigned)mode > RASPI_APA102_BLEND_MAX_VALUE) || 
+        (stack->layer_count >= stack->layer_capacity))
+    {
+        return -1;
+    }
+
+    RaspiAPA102Layer* const layer = &stack->layers[stack->layer_count];
+    memset(layer, 0, sizeof(*layer));
+    // A coverage of zero makes all pixels transparent
+    layer->pixels = calloc(stack->count, sizeof(RaspiAPA102ColorQuad));
+    if (!layer->pixels)
+    {
+        return -1;
+    }
+    layer->render      = render;
+    layer->context     = context;
+    layer->mode        = mode;
+    layer->opacity     = opacity;
+    layer->visible     = true;
+    layer->dirty_begin = 0;
+    layer->dirty_end   = stack->count;
+
+    if (index)
+    {
+        *index = stack->layer_count;
+    }
+    ++stack->layer_count;
+
+    return 0;
+}
+
+int RaspiAPA102LayerStackSetBlend(RaspiAPA102LayerStack* stack, size_t index, 
+    RaspiAPA102BlendMode mode, uint8_t opacity)
+{
+    if (!stack || (index >= stack->layer_count) || 
+        ((unsigned)mode > RASPI_APA102_BLEND_MAX_VALUE))
+    {
+        return -1;
+    }
+
+    RaspiAPA102Layer* const layer = &stack->layers[index];
+    if ((layer->mode == mode) && (layer->opacity == opacity))
+    {
+        return 0;
+    }
+    layer->mode = mode;
+    layer->opacity = opacity;
+    if (layer->visible)
+    {
+        RaspiAPA102LayerStackExtend(&stack->dirty_begin, &stack->dirty_end, 0, stack->count);
+    }
+
+    return 0;
+}
+
+int RaspiAPA102LayerStackSetVisible(RaspiAPA102LayerStack* stack, size_t index, bool visible)
+{
+    if (!stack || (index >= stack->layer_count))
+    {
+        return -1;
+    }
+
+    RaspiAPA102Layer* const layer = &stack->layers[index];
+    if (layer->visible == visible)
+    {
+        return 0;
+    }
+    layer->visible = visible;
+    RaspiAPA102LayerStackExtend(&stack->dirty_begin, &stack->dirty_end, 0, stack->count);
+
+    return 0;
+}
+
+int RaspiAPA102LayerStackGetPixels(RaspiAPA102LayerStack* stack, size_t index, 
+    RaspiAPA102ColorQuad** pixels)
+{
+    if (!stack || (index >= stack->layer_count) || !pixels)
+    {
+        return -1;
+    }
+
+    *pixels = stack->layers[index].pixels;
+
+    return 0;
+}
+
+int RaspiAPA102LayerStackMarkDirty(RaspiAPA102LayerStack* stack, size_t index, size_t offset, 
+    size_t count)
+{
+    if (!stack || (index >= stack->layer_count) || (offset > stack->count) || 
+        (count > stack->count - offset))
+    {
+        return -1;
+    }
+
+    RaspiAPA102Layer* const layer = &stack->layers[index];
+    RaspiAPA102LayerStackExtend(&layer->dirty_begin, &layer->dirty_end, offset, count);
+
+    return 0;
+}
+
+int RaspiAPA102LayerStackSetPath(RaspiAPA102LayerStack* stack, RaspiAPA102SIMDPath path)
+{
+    if (!stack || !RaspiAPA102SIMDIsSupported(path))
+    {
+        return -1;
+    }
+
+    stack->path = RaspiAPA102SIMDResolve(path);
+
+    return 0;
+}
+
+int RaspiAPA102LayerStackCompose(RaspiAPA102LayerStack* stack, size_t* offset, size_t* count)
+{
+    if (!stack || !stack->output)
+    {
+        return -1;
+    }
+
+    int status = 0;
+    size_t begin = stack->dirty_begin;
+    size_t end = stack->dirty_end;
+    uint64_t rendered = 0;
+
+    // Re-render the modified ranges of the visible layers, hidden layers keep them for later
+    for (size_t i = 0; i < stack->layer_count; ++i)
+    {
+        RaspiAPA102Layer* const layer = &stack->layers[i];
+        if (!layer->visible || (layer->dirty_begin >= layer->dirty_end))
+        {
+            continue;
+        }
+
+        const size_t n = layer->dirty_end - layer->dirty_begin;
+        if (layer->render)
+        {
+            if (layer->render(layer->context, &layer->pixels[layer->dirty_begin], 
+                layer->dirty_begin, n) < 0)
+            {
+                status = -1;
+            }
+            rendered += n;
+        }
+        RaspiAPA102LayerStackExtend(&begin, &end, layer->dirty_begin, n);
+        layer->dirty_begin = 0;
+        layer->dirty_end = 0;
+    }
+
+    const size_t recomposed = (begin < end) ? end - begin : 0;
+    if (recomposed)
+    {
+        RaspiAPA102ColorQuad black;
+        RaspiAPA102ColorQuadInit(&black, 0, 0, 0, stack->header);
+        for (size_t i = begin; i < end; ++i)
+        {
+            stack->output[i] = black;
+        }
+
+        for (size_t i = 0; i < stack->layer_count; ++i)
+        {
+            const RaspiAPA102Layer* const layer = &stack->layers[i];
+            if (layer->visible && layer->opacity)
+            {
+                RaspiAPA102LayerStackBlend(stack, layer, begin, recomposed);
+            }
+        }
+    }
+    stack->dirty_begin = 0;
+    stack->dirty_end = 0;
+
+    ++stack->stats.frames;
+    stack->stats.recomposed = recomposed;
+    stack->stats.recomposed_total += recomposed;
+    stack->stats.rendered = rendered;
+    stack->stats.rendered_total += rendered;
+
+    if (offset)
+    {
+        *offset = recomposed ? begin : 0;
+    }
+    if (count)
+    {
+        *count = recomposed;
+    }
+
+    return status;
+}
+
+int RaspiAPA102LayerStackGetOutput(const RaspiAPA102LayerStack* stack, 
+    const RaspiAPA102ColorQuad** output, size_t* count)
+{
+    if (!stack || !stack->output || !output)
+    {
+        return -1;
+    }
+
+    *output = stack->output;
+    if (count)
+    {
+        *count = stack->count;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102LayerStackGetStats(const RaspiAPA102LayerStack* stack, 
+    RaspiAPA102LayerStackStats* stats)
+{
+    if (!stack || !stack->output || !stats)
+    {
+        return -1;
+    }
+
+    *stats = stack->stats;
+
+    return 0;
+}
+
+int RaspiAPA102LayerStackDestroy(RaspiAPA102LayerStack* stack)
+{
+    if (!stack || !stack->output)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < stack->layer_count; ++i)
+    {
+        free(stack->layers[i].pixels);
+    }
+    free(stack->layers);
+    free(stack->output);
+    memset(stack, 0, sizeof(*stack));
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
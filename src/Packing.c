@@ -0,0 +1,359 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/Packing.h>
+#include <SIMDInternal.h>
+#include <string.h>
+
+#if defined(RASPI_APA102_SIMD_X86)
+#   include <immintrin.h>
+#endif
+#if defined(RASPI_APA102_SIMD_ARM)
+#   include <arm_neon.h>
+#endif
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   The pixel size and the source byte offsets of the red, green and blue components for
+ *          every `RaspiAPA102PixelFormat`.
+ */
+static const uint8_t RASPI_APA102_PIXEL_FORMAT_LAYOUT[][4] =
+{
+    /* RGB  */ { 3, 0, 1, 2 },
+    /* BGR  */ { 3, 2, 1, 0 },
+    /* GRB  */ { 3, 1, 0, 2 },
+    /* RGBA */ { 4, 0, 1, 2 },
+    /* BGRA */ { 4, 2, 1, 0 },
+    /* ARGB */ { 4, 1, 2, 3 }
+};
+
+/**
+ * @brief   The color component (0 = red, 1 = green, 2 = blue) of the three color bytes on the wire
+ *          for every `RaspiAPA102ChannelOrder`.
+ */
+static const uint8_t RASPI_APA102_CHANNEL_ORDER_LAYOUT[][3] =
+{
+    /* BGR */ { 2, 1, 0 },
+    /* BRG */ { 2, 0, 1 },
+    /* GBR */ { 1, 2, 0 },
+    /* GRB */ { 1, 0, 2 },
+    /* RBG */ { 0, 2, 1 },
+    /* RGB */ { 0, 1, 2 }
+};
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Scalar                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Converts the given pixels to color quads.
+ *
+ * @param   packer  A pointer to the `RaspiAPA102Packer` struct.
+ * @param   quads   A pointer to the destination quads.
+ * @param   pixels  A pointer to the source pixels.
+ * @param   count   The number of pixels.
+ */
+static void RaspiAPA102PackScalar(const RaspiAPA102Packer* packer, uint8_t* quads, 
+    const uint8_t* pixels, size_t count)
+{
+    const size_t stride = packer->stride;
+    const uint8_t o0 = packer->offsets[0];
+    const uint8_t o1 = packer->offsets[1];
+    const uint8_t o2 = packer->offsets[2];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        quads[0] = packer->header;
+        quads[1] = pixels[o0];
+        quads[2] = pixels[o1];
+        quads[3] = pixels[o2];
+        quads  += 4;
+        pixels += stride;
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* x86                                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+#if defined(RASPI_APA102_SIMD_X86)
+
+/**
+ * @brief   Converts the given pixels to color quads using `SSSE3`.
+ *
+ * @param   packer  A pointer to the `RaspiAPA102Packer` struct.
+ * @param   quads   A pointer to the destination quads.
+ * @param   pixels  A pointer to the source pixels.
+ * @param   count   The number of pixels.
+ *
+ * Every iteration loads 16 bytes, but only consumes 4 pixels. The remaining pixels that can not 
+ * be loaded without reading past the end of the source array are left to the caller.
+ *
+ * @return  The number of converted pixels.
+ */
+RASPI_APA102_TARGET_SSSE3
+static size_t RaspiAPA102PackSSSE3(const RaspiAPA102Packer* packer, uint8_t* quads, 
+    const uint8_t* pixels, size_t count)
+{
+    const size_t stride = packer->stride;
+    const __m128i shuffle = _mm_loadu_si128((const __m128i*)packer->shuffle);
+    const __m128i header = _mm_set1_epi32(packer->header);
+
+    size_t i = 0;
+    for (; (count - i) * stride >= 16; i += 4)
+    {
+        __m128i value = _mm_loadu_si128((const __m128i*)&pixels[i * stride]);
+        value = _mm_or_si128(_mm_shuffle_epi8(value, shuffle), header);
+        _mm_storeu_si128((__m128i*)&quads[i * 4], value);
+    }
+
+    return i;
+}
+
+/**
+ * @brief   Converts the given pixels to color quads using `AVX2`.
+ *
+ * @param   packer  A pointer to the `RaspiAPA102Packer` struct.
+ * @param   quads   A pointer to the destination quads.
+ * @param   pixels  A pointer to the source pixels.
+ * @param   count   The number of pixels.
+ *
+ * `vpshufb` does not cross 128-bit lanes, so 4 pixels are loaded into each lane and the same 
+ * shuffle is applied to both of them.
+ *
+ * @return  The number of converted pixels.
+ */
+RASPI_APA102_TARGET_AVX2
+static size_t RaspiAPA102PackAVX2(const RaspiAPA102Packer* packer, uint8_t* quads, 
+    const uint8_t* pixels, size_t count)
+{
+    const size_t stride = packer->stride;
+    const __m256i shuffle = 
+        _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)packer->shuffle));
+    const __m256i header = _mm256_set1_epi32(packer->header);
+
+    size_t i = 0;
+    for (; (count - i) * stride >= 4 * stride + 16; i += 8)
+    {
+        const uint8_t* source = &pixels[i * stride];
+        __m256i value = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)source)), 
+            _mm_loadu_si128((const __m128i*)&source[4 * stride]), 1);
+        value = _mm256_or_si256(_mm256_shuffle_epi8(value, shuffle), header);
+        _mm256_storeu_si256((__m256i*)&quads[i * 4], value);
+    }
+
+    return i + RaspiAPA102PackSSSE3(packer, &quads[i * 4], &pixels[i * stride], count - i);
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+/* ARM                                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+#if defined(RASPI_APA102_SIMD_ARM)
+
+/**
+ * @brief   Converts the given pixels to color quads using `NEON`.
+ *
+ * @param   packer  A pointer to the `RaspiAPA102Packer` struct.
+ * @param   quads   A pointer to the destination quads.
+ * @param   pixels  A pointer to the source pixels.
+ * @param   count   The number of pixels.
+ *
+ * The structure loads deinterleave 16 pixels into separate component registers, which are then
+ * re-interleaved in wire order together with the brightness byte.
+ *
+ * @return  The number of converted pixels.
+ */
+static size_t RaspiAPA102PackNEON(const RaspiAPA102Packer* packer, uint8_t* quads, 
+    const uint8_t* pixels, size_t count)
+{
+    const uint8_t o0 = packer->offsets[0];
+    const uint8_t o1 = packer->offsets[1];
+    const uint8_t o2 = packer->offsets[2];
+    uint8x16x4_t value;
+    value.val[0] = vdupq_n_u8(packer->header);
+
+    size_t i = 0;
+    if (packer->stride == 3)
+    {
+        for (; i + 16 <= count; i += 16)
+        {
+            const uint8x16x3_t source = vld3q_u8(&pixels[i * 3]);
+            value.val[1] = source.val[o0];
+            value.val[2] = source.val[o1];
+            value.val[3] = source.val[o2];
+            vst4q_u8(&quads[i * 4], value);
+        }
+    }
+    else
+    {
+        for (; i + 16 <= count; i += 16)
+        {
+            const uint8x16x4_t source = vld4q_u8(&pixels[i * 4]);
+            value.val[1] = source.val[o0];
+            value.val[2] = source.val[o1];
+            value.val[3] = source.val[o2];
+            vst4q_u8(&quads[i * 4], value);
+        }
+    }
+
+    return i;
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Packer                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102PackerInit(RaspiAPA102Packer* packer, RaspiAPA102PixelFormat format, 
+    RaspiAPA102ChannelOrder order, uint8_t brightness)
+{
+    if (!packer || ((unsigned)format > RASPI_APA102_PIXEL_FORMAT_MAX_VALUE) || 
+        ((unsigned)order > RASPI_APA102_CHANNEL_ORDER_MAX_VALUE))
+    {
+        return -1;
+    }
+
+    memset(packer, 0, sizeof(*packer));
+    packer->format = format;
+    packer->order  = order;
+    packer->stride = RASPI_APA102_PIXEL_FORMAT_LAYOUT[format][0];
+    for (int i = 0; i < 3; ++i)
+    {
+        const uint8_t component = RASPI_APA102_CHANNEL_ORDER_LAYOUT[order][i];
+        packer->offsets[i] = RASPI_APA102_PIXEL_FORMAT_LAYOUT[format][1 + component];
+    }
+    packer->header = 0b11100000 | (brightness & 0b00011111);
+
+    // The brightness bytes are cleared by the shuffle (high bit set) and OR-ed in afterwards
+    for (size_t i = 0; i < 4; ++i)
+    {
+        packer->shuffle[i * 4] = 0x80;
+        for (size_t j = 0; j < 3; ++j)
+        {
+            packer->shuffle[i * 4 + 1 + j] = (uint8_t)(i * packer->stride + packer->offsets[j]);
+        }
+    }
+
+    packer->path = RaspiAPA102SIMDResolve(RASPI_APA102_SIMD_AUTO);
+
+    return 0;
+}
+
+int RaspiAPA102PackerSetBrightness(RaspiAPA102Packer* packer, uint8_t brightness)
+{
+    if (!packer)
+    {
+        return -1;
+    }
+
+    packer->header = 0b11100000 | (brightness & 0b00011111);
+
+    return 0;
+}
+
+int RaspiAPA102PackerSetPath(RaspiAPA102Packer* packer, RaspiAPA102SIMDPath path)
+{
+    if (!packer || !RaspiAPA102SIMDIsSupported(path))
+    {
+        return -1;
+    }
+
+    packer->path = RaspiAPA102SIMDResolve(path);
+
+    return 0;
+}
+
+int RaspiAPA102PackerPack(const RaspiAPA102Packer* packer, RaspiAPA102ColorQuad* quads, 
+    const uint8_t* pixels, size_t count)
+{
+    if (!packer || (count && (!quads || !pixels)))
+    {
+        return -1;
+    }
+
+    uint8_t* destination = (uint8_t*)quads;
+    size_t done = 0;
+    switch (packer->path)
+    {
+#if defined(RASPI_APA102_SIMD_X86)
+    case RASPI_APA102_SIMD_SSSE3:
+        done = RaspiAPA102PackSSSE3(packer, destination, pixels, count);
+        break;
+    case RASPI_APA102_SIMD_AVX2:
+        done = RaspiAPA102PackAVX2(packer, destination, pixels, count);
+        break;
+#endif
+#if defined(RASPI_APA102_SIMD_ARM)
+    case RASPI_APA102_SIMD_NEON:
+        done = RaspiAPA102PackNEON(packer, destination, pixels, count);
+        break;
+#endif
+    default:
+        break;
+    }
+    RaspiAPA102PackScalar(packer, &destination[done * 4], &pixels[done * packer->stride], 
+        count - done);
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Convenience                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102PackPixels(RaspiAPA102ColorQuad* quads, const uint8_t* pixels, size_t count, 
+    RaspiAPA102PixelFormat format, uint8_t brightness)
+{
+    RaspiAPA102Packer packer;
+    if (RaspiAPA102PackerInit(&packer, format, RASPI_APA102_CHANNEL_ORDER_BGR, brightness) < 0)
+    {
+        return -1;
+    }
+
+    return RaspiAPA102PackerPack(&packer, quads, pixels, count);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
@@ -0,0 +1,747 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/Receiver.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+#define RASPI_APA102_NSEC_PER_SEC 1000000000ULL
+
+/**
+ * @brief   The size of a single receive buffer (the largest `E1.31` data packet is 638 bytes).
+ */
+#define RASPI_APA102_RECEIVER_BUFFER_SIZE 1024
+
+/**
+ * @brief   The requested size of the socket receive buffer.
+ */
+#define RASPI_APA102_RECEIVER_SOCKET_BUFFER_SIZE (1024 * 1024)
+
+/**
+ * @brief   The maximum number of channels in a universe.
+ */
+#define RASPI_APA102_RECEIVER_MAX_CHANNELS 512
+
+#define RASPI_APA102_ARTNET_HEADER_SIZE         18
+#define RASPI_APA102_ARTNET_SYNC_SIZE           14
+#define RASPI_APA102_ARTNET_OP_DMX              0x5000
+#define RASPI_APA102_ARTNET_OP_SYNC             0x5200
+
+#define RASPI_APA102_E131_HEADER_SIZE           126
+#define RASPI_APA102_E131_SYNC_SIZE             49
+#define RASPI_APA102_E131_VECTOR_ROOT_DATA      0x00000004
+#define RASPI_APA102_E131_VECTOR_ROOT_EXTENDED  0x00000008
+#define RASPI_APA102_E131_VECTOR_DATA_PACKET    0x00000002
+#define RASPI_APA102_E131_VECTOR_SYNC           0x00000001
+#define RASPI_APA102_E131_OPTION_PREVIEW        0x80
+#define RASPI_APA102_E131_OPTION_TERMINATED     0x40
+
+/* ============================================================================================== */
+/* Internal types                                                                                 */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102ReceiverBatch` struct.
+ */
+typedef struct RaspiAPA102ReceiverBatch_
+{
+    /**
+     * @brief   The message headers.
+     */
+    struct mmsghdr messages[RASPI_APA102_RECEIVER_BATCH_SIZE];
+    /**
+     * @brief   The data vectors.
+     */
+    struct iovec vectors[RASPI_APA102_RECEIVER_BATCH_SIZE];
+    /**
+     * @brief   The control message buffers (receive timestamps).
+     */
+    union
+    {
+        struct cmsghdr header;
+        uint8_t data[CMSG_SPACE(sizeof(struct timespec))];
+    } control[RASPI_APA102_RECEIVER_BATCH_SIZE];
+    /**
+     * @brief   The data buffers.
+     */
+    uint8_t buffers[RASPI_APA102_RECEIVER_BATCH_SIZE][RASPI_APA102_RECEIVER_BUFFER_SIZE];
+} RaspiAPA102ReceiverBatch;
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Time                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the current value of the given clock in nanoseconds.
+ *
+ * @param   clock   The clock.
+ *
+ * @return  The current value of the given clock in nanoseconds.
+ */
+static uint64_t RaspiAPA102ReceiverNow(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+
+    return (uint64_t)now.tv_sec * RASPI_APA102_NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Frames                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Sends the current frame and starts a new one.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102ReceiverCommit(RaspiAPA102Receiver* receiver)
+{
+    if ((RaspiAPA102DeviceGetBuffer(receiver->device, &receiver->quads, &receiver->count) == 0) && 
+        (receiver->dirty_last > receiver->count))
+    {
+        receiver->dirty_last = receiver->count;
+    }
+    if (receiver->dirty_first < receiver->dirty_last)
+    {
+        RaspiAPA102DeviceMarkDirty(receiver->device, receiver->dirty_first, 
+            receiver->dirty_last - receiver->dirty_first);
+    }
+    const int status = RaspiAPA102DeviceCommit(receiver->device);
+
+    const uint64_t now = RaspiAPA102ReceiverNow(CLOCK_REALTIME);
+    const uint64_t latency = (now > receiver->frame_start) ? now - receiver->frame_start : 0;
+    RaspiAPA102ReceiverStats* stats = &receiver->stats;
+    if (!stats->frames || (latency < stats->latency_min))
+    {
+        stats->latency_min = latency;
+    }
+    if (latency > stats->latency_max)
+    {
+        stats->latency_max = latency;
+    }
+    stats->latency_sum += latency;
+    ++stats->frames;
+
+    memset(receiver->received, 0, (receiver->universe_count + 63) / 64 * sizeof(uint64_t));
+    receiver->received_count = 0;
+    receiver->dirty_first = receiver->count;
+    receiver->dirty_last = 0;
+
+    return status;
+}
+
+/**
+ * @brief   Handles a data packet.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   universe    The universe.
+ * @param   sequenced   Signals, if the packet carries a sequence number (`Art-Net` uses `0` to
+ *                      disable sequencing).
+ * @param   sequence    The sequence number of the packet.
+ * @param   data        A pointer to the channel data.
+ * @param   size        The number of channels.
+ * @param   timestamp   The receive time of the packet (`CLOCK_REALTIME`).
+ * @param   frames      Incremented for every sent frame.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102ReceiverHandleData(RaspiAPA102Receiver* receiver, uint16_t universe, 
+    bool sequenced, uint8_t sequence, const uint8_t* data, size_t size, uint64_t timestamp, 
+    size_t* frames)
+{
+    if ((universe < receiver->first_universe) || 
+        ((size_t)(universe - receiver->first_universe) >= receiver->universe_count))
+    {
+        ++receiver->stats.ignored;
+        return 0;
+    }
+    const size_t index = universe - receiver->first_universe;
+    const uint64_t bit = 1ULL << (index % 64);
+
+    // The sequence number wraps from 255 to 0, so the first packet is tracked separately
+    if (sequenced)
+    {
+        if ((receiver->sequenced[index / 64] & bit) && 
+            (sequence != (uint8_t)(receiver->sequence[index] + 1)))
+        {
+            ++receiver->stats.sequence_errors;
+        }
+        receiver->sequenced[index / 64] |= bit;
+        receiver->sequence[index] = sequence;
+    }
+    else
+    {
+        receiver->sequenced[index / 64] &= ~bit;
+    }
+
+    // The transmit buffer of the device may have been replaced since the last packet
+    if (RaspiAPA102DeviceGetBuffer(receiver->device, &receiver->quads, &receiver->count) < 0)
+    {
+        return -1;
+    }
+
+    const bool synchronous = RaspiAPA102ReceiverNow(CLOCK_MONOTONIC) < receiver->sync_until;
+    if ((receiver->received[index / 64] & bit) && !synchronous)
+    {
+        // The source sent less universes than expected, the repetition starts the next frame
+        if (RaspiAPA102ReceiverCommit(receiver) < 0)
+        {
+            return -1;
+        }
+        ++*frames;
+    }
+    if (!receiver->received_count && (receiver->dirty_first >= receiver->dirty_last))
+    {
+        receiver->frame_start = timestamp;
+    }
+
+    const size_t first = index * receiver->pixels_per_universe;
+    if (first >= receiver->count)
+    {
+        ++receiver->stats.ignored;
+        return 0;
+    }
+    size_t count = size / receiver->packer.stride;
+    if (count > receiver->pixels_per_universe)
+    {
+        count = receiver->pixels_per_universe;
+    }
+    if (count > receiver->count - first)
+    {
+        count = receiver->count - first;
+    }
+    if (count)
+    {
+        RaspiAPA102PackerPack(&receiver->packer, &receiver->quads[first], data, count);
+        receiver->dirty_first = (first < receiver->dirty_first) ? first : receiver->dirty_first;
+        receiver->dirty_last = 
+            (first + count > receiver->dirty_last) ? first + count : receiver->dirty_last;
+    }
+
+    if (!(receiver->received[index / 64] & bit))
+    {
+        receiver->received[index / 64] |= bit;
+        ++receiver->received_count;
+    }
+    if ((receiver->received_count == receiver->universe_count) && !synchronous)
+    {
+        if (RaspiAPA102ReceiverCommit(receiver) < 0)
+        {
+            return -1;
+        }
+        ++*frames;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Handles a synchronization packet.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   frames      Incremented for every sent frame.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102ReceiverHandleSync(RaspiAPA102Receiver* receiver, size_t* frames)
+{
+    ++receiver->stats.syncs;
+    receiver->sync_until = 
+        RaspiAPA102ReceiverNow(CLOCK_MONOTONIC) + RASPI_APA102_RECEIVER_SYNC_TIMEOUT;
+    if (!receiver->received_count)
+    {
+        return 0;
+    }
+
+    if (RaspiAPA102ReceiverCommit(receiver) < 0)
+    {
+        return -1;
+    }
+    ++*frames;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Protocols                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Reads a 16-bit big-endian value.
+ *
+ * @param   data    A pointer to the data.
+ *
+ * @return  The value.
+ */
+static inline uint16_t RaspiAPA102ReceiverRead16(const uint8_t* data)
+{
+    return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+/**
+ * @brief   Reads a 32-bit big-endian value.
+ *
+ * @param   data    A pointer to the data.
+ *
+ * @return  The value.
+ */
+static inline uint32_t RaspiAPA102ReceiverRead32(const uint8_t* data)
+{
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | 
+        data[3];
+}
+
+/**
+ * @brief   Handles a datagram.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   data        A pointer to the datagram.
+ * @param   size        The size of the datagram.
+ * @param   timestamp   The receive time of the datagram (`CLOCK_REALTIME`).
+ * @param   frames      Incremented for every sent frame.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102ReceiverHandlePacket(RaspiAPA102Receiver* receiver, const uint8_t* data, 
+    size_t size, uint64_t timestamp, size_t* frames)
+{
+    static const uint8_t ARTNET_ID[8] = { 'A', 'r', 't', '-', 'N', 'e', 't', 0 };
+    static const uint8_t E131_ID[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+
+    ++receiver->stats.packets;
+
+    if ((size >= 10) && !memcmp(data, ARTNET_ID, sizeof(ARTNET_ID)))
+    {
+        const uint16_t opcode = (uint16_t)(data[8] | (data[9] << 8));
+        if ((opcode == RASPI_APA102_ARTNET_OP_DMX) && (size >= RASPI_APA102_ARTNET_HEADER_SIZE))
+        {
+            const uint16_t universe = (uint16_t)(data[14] | ((data[15] & 0x7F) << 8));
+            size_t length = RaspiAPA102ReceiverRead16(&data[16]);
+            if ((length > RASPI_APA102_RECEIVER_MAX_CHANNELS) || 
+                (length > size - RASPI_APA102_ARTNET_HEADER_SIZE))
+            {
+                ++receiver->stats.invalid;
+                return 0;
+            }
+            return RaspiAPA102ReceiverHandleData(receiver, universe, data[12] != 0, data[12], 
+                &data[RASPI_APA102_ARTNET_HEADER_SIZE], length, timestamp, frames);
+        }
+        if ((opcode == RASPI_APA102_ARTNET_OP_SYNC) && (size >= RASPI_APA102_ARTNET_SYNC_SIZE))
+        {
+            return RaspiAPA102ReceiverHandleSync(receiver, frames);
+        }
+        ++receiver->stats.ignored;
+        return 0;
+    }
+
+    if ((size >= 44) && (RaspiAPA102ReceiverRead16(&data[0]) == 0x0010) && 
+        !memcmp(&data[4], E131_ID, sizeof(E131_ID)))
+    {
+        const uint32_t root_vector = RaspiAPA102ReceiverRead32(&data[18]);
+        const uint32_t vector = RaspiAPA102ReceiverRead32(&data[40]);
+        if ((root_vector == RASPI_APA102_E131_VECTOR_ROOT_DATA) && 
+            (vector == RASPI_APA102_E131_VECTOR_DATA_PACKET) && 
+            (size >= RASPI_APA102_E131_HEADER_SIZE))
+        {
+            const size_t count = RaspiAPA102ReceiverRead16(&data[123]);
+            if ((data[117] != 0x02) || (data[118] != 0xA1) || !count || 
+                (count - 1 > RASPI_APA102_RECEIVER_MAX_CHANNELS) || 
+                (count - 1 > size - RASPI_APA102_E131_HEADER_SIZE))
+            {
+                ++receiver->stats.invalid;
+                return 0;
+            }
+            if ((data[112] & (RASPI_APA102_E131_OPTION_PREVIEW | 
+                RASPI_APA102_E131_OPTION_TERMINATED)) || (data[125] != 0x00))
+            {
+                // Preview data, terminated streams and alternate start codes
+                ++receiver->stats.ignored;
+                return 0;
+            }
+            receiver->sync_address = RaspiAPA102ReceiverRead16(&data[109]);
+            return RaspiAPA102ReceiverHandleData(receiver, RaspiAPA102ReceiverRead16(&data[113]), 
+                true, data[111], &data[RASPI_APA102_E131_HEADER_SIZE], count - 1, timestamp, 
+                frames);
+        }
+        if ((root_vector == RASPI_APA102_E131_VECTOR_ROOT_EXTENDED) && 
+            (vector == RASPI_APA102_E131_VECTOR_SYNC) && (size >= RASPI_APA102_E131_SYNC_SIZE))
+        {
+            const uint16_t address = RaspiAPA102ReceiverRead16(&data[45]);
+            if (receiver->sync_address && (address != receiver->sync_address))
+            {
+                ++receiver->stats.ignored;
+                return 0;
+            }
+            return RaspiAPA102ReceiverHandleSync(receiver, frames);
+        }
+        ++receiver->stats.ignored;
+        return 0;
+    }
+
+    ++receiver->stats.invalid;
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Receiver                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Initializes the given receiver on the given socket.
+ *
+ * @param   receiver    A pointer to the `RaspiAPA102Receiver` struct.
+ * @param   device      A pointer to the `RaspiAPA102Device` struct.
+ * @param   fd          The bound socket. The socket is closed on failure.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102ReceiverInit(RaspiAPA102Receiver* receiver, RaspiAPA102Device* device, 
+    int fd)
+{
+    // The receive timestamps are optional, the latency falls back to the processing time
+    const int enable = 1;
+    const int size = RASPI_APA102_RECEIVER_SOCKET_BUFFER_SIZE;
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+    receiver->fd = fd;
+    receiver->device = device;
+    receiver->batch = calloc(1, sizeof(RaspiAPA102ReceiverBatch));
+    if (!receiver->batch || 
+        (RaspiAPA102DeviceGetBuffer(device, &receiver->quads, &receiver->count) < 0) || 
+        (RaspiAPA102PackerInit(&receiver->packer, RASPI_APA102_PIXEL_FORMAT_RGB, 
+            RASPI_APA102_CHANNEL_ORDER_BGR, 31) < 0) ||
+        (RaspiAPA102ReceiverSetUniverses(receiver, 1, 
+            RASPI_APA102_RECEIVER_DEFAULT_PIXELS_PER_UNIVERSE, RASPI_APA102_PIXEL_FORMAT_RGB) < 0))
+    {
+        RaspiAPA102ReceiverDestroy(receiver);
+        return -1;
+    }
+
+    RaspiAPA102ReceiverBatch* batch = receiver->batch;
+    for (size_t i = 0; i < RASPI_APA102_RECEIVER_BATCH_SIZE; ++i)
+    {
+        batch->vectors[i].iov_base = batch->buffers[i];
+        batch->vectors[i].iov_len = RASPI_APA102_RECEIVER_BUFFER_SIZE;
+        batch->messages[i].msg_hdr.msg_iov = &batch->vectors[i];
+        batch->messages[i].msg_hdr.msg_iovlen = 1;
+        batch->messages[i].msg_hdr.msg_control = batch->control[i].data;
+    }
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+int RaspiAPA102ReceiverInitUDP(RaspiAPA102Receiver* receiver, RaspiAPA102Device* device, 
+    const char* address, uint16_t port)
+{
+    if (!receiver || !device)
+    {
+        return -1;
+    }
+
+    memset(receiver, 0, sizeof(*receiver));
+    receiver->fd = -1;
+    struct sockaddr_in local = { 0 };
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (address && (inet_pton(AF_INET, address, &local.sin_addr) != 1))
+    {
+        return -1;
+    }
+
+    const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    const int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (bind(fd, (const struct sockaddr*)&local, sizeof(local)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return RaspiAPA102ReceiverInit(receiver, device, fd);
+}
+
+int RaspiAPA102ReceiverInitUnix(RaspiAPA102Receiver* receiver, RaspiAPA102Device* device, 
+    const char* path)
+{
+    if (!receiver || !device || !path)
+    {
+        return -1;
+    }
+
+    memset(receiver, 0, sizeof(*receiver));
+    receiver->fd = -1;
+    struct sockaddr_un local = { 0 };
+    local.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(local.sun_path))
+    {
+        return -1;
+    }
+    strcpy(local.sun_path, path);
+
+    const int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (const struct sockaddr*)&local, sizeof(local)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    receiver->path = strdup(path);
+    if (!receiver->path)
+    {
+        unlink(path);
+        close(fd);
+        return -1;
+    }
+
+    return RaspiAPA102ReceiverInit(receiver, device, fd);
+}
+
+int RaspiAPA102ReceiverSetUniverses(RaspiAPA102Receiver* receiver, uint16_t first_universe, 
+    size_t pixels_per_universe, RaspiAPA102PixelFormat format)
+{
+    if (!receiver || !receiver->device || !pixels_per_universe)
+    {
+        return -1;
+    }
+
+    RaspiAPA102Packer packer;
+    if ((RaspiAPA102PackerInit(&packer, format, RASPI_APA102_CHANNEL_ORDER_BGR, 31) < 0) || 
+        (pixels_per_universe * packer.stride > RASPI_APA102_RECEIVER_MAX_CHANNELS))
+    {
+        return -1;
+    }
+    packer.header = receiver->packer.header;
+
+    const size_t universe_count = 
+        (receiver->count + pixels_per_universe - 1) / pixels_per_universe;
+    uint64_t* received = calloc((universe_count + 63) / 64, sizeof(uint64_t));
+    uint64_t* sequenced = calloc((universe_count + 63) / 64, sizeof(uint64_t));
+    uint8_t* sequence = calloc(universe_count ? universe_count : 1, 1);
+    if (!received || !sequenced || !sequence)
+    {
+        free(received);
+        free(sequenced);
+        free(sequence);
+        return -1;
+    }
+
+    free(receiver->received);
+    free(receiver->sequenced);
+    free(receiver->sequence);
+    receiver->packer = packer;
+    receiver->first_universe = first_universe;
+    receiver->pixels_per_universe = pixels_per_universe;
+    receiver->universe_count = universe_count;
+    receiver->received = received;
+    receiver->received_count = 0;
+    receiver->sequenced = sequenced;
+    receiver->sequence = sequence;
+    receiver->dirty_first = receiver->count;
+    receiver->dirty_last = 0;
+
+    return 0;
+}
+
+int RaspiAPA102ReceiverSetBrightness(RaspiAPA102Receiver* receiver, uint8_t brightness)
+{
+    if (!receiver)
+    {
+        return -1;
+    }
+
+    return RaspiAPA102PackerSetBrightness(&receiver->packer, brightness);
+}
+
+int RaspiAPA102ReceiverGetFD(const RaspiAPA102Receiver* receiver, int* fd)
+{
+    if (!receiver || !receiver->batch || !fd)
+    {
+        return -1;
+    }
+
+    *fd = receiver->fd;
+
+    return 0;
+}
+
+int RaspiAPA102ReceiverPoll(RaspiAPA102Receiver* receiver, int timeout, size_t* frames)
+{
+    if (!receiver || !receiver->batch)
+    {
+        return -1;
+    }
+
+    size_t sent = 0;
+    if (frames)
+    {
+        *frames = 0;
+    }
+
+    struct pollfd descriptor = { .fd = receiver->fd, .events = POLLIN };
+    const int ready = poll(&descriptor, 1, timeout);
+    if (ready <= 0)
+    {
+        return ((ready < 0) && (errno != EINTR)) ? -1 : 0;
+    }
+
+    RaspiAPA102ReceiverBatch* batch = receiver->batch;
+    for (;;)
+    {
+        for (size_t i = 0; i < RASPI_APA102_RECEIVER_BATCH_SIZE; ++i)
+        {
+            batch->messages[i].msg_hdr.msg_controllen = sizeof(batch->control[i].data);
+        }
+        const int count = recvmmsg(receiver->fd, batch->messages, RASPI_APA102_RECEIVER_BATCH_SIZE, 
+            MSG_DONTWAIT, NULL);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            return -1;
+        }
+        ++receiver->stats.batches;
+
+        const uint64_t now = RaspiAPA102ReceiverNow(CLOCK_REALTIME);
+        for (int i = 0; i < count; ++i)
+        {
+            uint64_t timestamp = now;
+            struct msghdr* header = &batch->messages[i].msg_hdr;
+            for (struct cmsghdr* control = CMSG_FIRSTHDR(header); control; 
+                control = CMSG_NXTHDR(header, control))
+            {
+                if ((control->cmsg_level == SOL_SOCKET) && 
+                    (control->cmsg_type == SCM_TIMESTAMPNS))
+                {
+                    struct timespec time;
+                    memcpy(&time, CMSG_DATA(control), sizeof(time));
+                    timestamp = 
+                        (uint64_t)time.tv_sec * RASPI_APA102_NSEC_PER_SEC + (uint64_t)time.tv_nsec;
+                }
+            }
+
+            if (RaspiAPA102ReceiverHandlePacket(receiver, batch->buffers[i], 
+                batch->messages[i].msg_len, timestamp, &sent) < 0)
+            {
+                return -1;
+            }
+        }
+        if (count < RASPI_APA102_RECEIVER_BATCH_SIZE)
+        {
+            break;
+        }
+    }
+
+    if (frames)
+    {
+        *frames = sent;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102ReceiverGetStats(const RaspiAPA102Receiver* receiver, 
+    RaspiAPA102ReceiverStats* stats)
+{
+    if (!receiver || !stats)
+    {
+        return -1;
+    }
+
+    *stats = receiver->stats;
+
+    return 0;
+}
+
+int RaspiAPA102ReceiverDestroy(RaspiAPA102Receiver* receiver)
+{
+    if (!receiver)
+    {
+        return -1;
+    }
+
+    if (receiver->fd >= 0)
+    {
+        close(receiver->fd);
+    }
+    if (receiver->path)
+    {
+        unlink(receiver->path);
+        free(receiver->path);
+    }
+    free(receiver->batch);
+    free(receiver->received);
+    free(receiver->sequenced);
+    free(receiver->sequence);
+    memset(receiver, 0, sizeof(*receiver));
+    receiver->fd = -1;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
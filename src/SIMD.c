@@ -0,0 +1,109 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/SIMD.h>
+#include <SIMDInternal.h>
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* SIMD                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+bool RaspiAPA102SIMDIsSupported(RaspiAPA102SIMDPath path)
+{
+#if defined(RASPI_APA102_SIMD_X86)
+    __builtin_cpu_init();
+#endif
+
+    switch (path)
+    {
+    case RASPI_APA102_SIMD_AUTO:
+    case RASPI_APA102_SIMD_SCALAR:
+        return true;
+#if defined(RASPI_APA102_SIMD_X86)
+    case RASPI_APA102_SIMD_SSSE3:
+        return __builtin_cpu_supports("ssse3");
+    case RASPI_APA102_SIMD_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#if defined(RASPI_APA102_SIMD_ARM)
+    case RASPI_APA102_SIMD_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+RaspiAPA102SIMDPath RaspiAPA102SIMDResolve(RaspiAPA102SIMDPath path)
+{
+    if (path != RASPI_APA102_SIMD_AUTO)
+    {
+        return path;
+    }
+
+    static const RaspiAPA102SIMDPath preferred[] =
+    {
+        RASPI_APA102_SIMD_AVX2,
+        RASPI_APA102_SIMD_SSSE3,
+        RASPI_APA102_SIMD_NEON
+    };
+    for (unsigned i = 0; i < sizeof(preferred) / sizeof(preferred[0]); ++i)
+    {
+        if (RaspiAPA102SIMDIsSupported(preferred[i]))
+        {
+            return preferred[i];
+        }
+    }
+
+    return RASPI_APA102_SIMD_SCALAR;
+}
+
+const char* RaspiAPA102SIMDGetName(RaspiAPA102SIMDPath path)
+{
+    static const char* const names[] =
+    {
+        "auto",
+        "scalar",
+        "ssse3",
+        "avx2",
+        "neon"
+    };
+
+    if ((unsigned)path > RASPI_APA102_SIMD_MAX_VALUE)
+    {
+        return "unknown";
+    }
+
+    return names[path];
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
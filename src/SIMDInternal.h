@@ -0,0 +1,67 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Declares the compile-time SIMD configuration of the library.
+ */
+
+#ifndef SIMD_INTERNAL_H
+#define SIMD_INTERNAL_H
+
+#include <RaspiAPA102/SIMD.h>
+
+/* ============================================================================================== */
+/* Macros                                                                                         */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Target detection                                                                               */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * The x86 implementations are compiled with function level target attributes and selected at
+ * runtime, so the library itself does not require any `-m` flags.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#   define RASPI_APA102_SIMD_X86
+#   define RASPI_APA102_TARGET_SSSE3 __attribute__((target("ssse3")))
+#   define RASPI_APA102_TARGET_AVX2  __attribute__((target("avx2")))
+#endif
+
+/**
+ * `NEON` is only available if it is enabled for the whole translation unit (always the case on
+ * AArch64; `-mfpu=neon` on 32-bit ARM).
+ */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define RASPI_APA102_SIMD_ARM
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#endif /* SIMD_INTERNAL_H */
@@ -0,0 +1,726 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/Sequence.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <StatsInternal.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   The token type of unchanged quads.
+ */
+#define RASPI_APA102_SEQUENCE_TOKEN_SKIP    0
+
+/**
+ * @brief   The token type of individually changed quads.
+ */
+#define RASPI_APA102_SEQUENCE_TOKEN_LITERAL 1
+
+/**
+ * @brief   The token type of quads changed by the same value.
+ */
+#define RASPI_APA102_SEQUENCE_TOKEN_REPEAT  2
+
+/**
+ * @brief   The maximum size of an encoded token header.
+ */
+#define RASPI_APA102_SEQUENCE_TOKEN_MAX_SIZE 10
+
+/**
+ * @brief   The minimum number of equal values that is encoded as a repeat token.
+ */
+#define RASPI_APA102_SEQUENCE_REPEAT_MIN 3
+
+_Static_assert(sizeof(RaspiAPA102SequenceHeader) == 64, "Unexpected sequence header size");
+_Static_assert(sizeof(RaspiAPA102SequenceRecord) == 8, "Unexpected sequence record size");
+_Static_assert(sizeof(RaspiAPA102ColorQuad) == 4, "Unexpected color quad size");
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Encoding                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Loads a 32-bit value from an unaligned address.
+ *
+ * @param   data    A pointer to the data.
+ *
+ * @return  The loaded value.
+ */
+static inline uint32_t RaspiAPA102SequenceLoad(const void* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+
+    return value;
+}
+
+/**
+ * @brief   Stores a 32-bit value to an unaligned address.
+ *
+ * @param   data    A pointer to the data.
+ * @param   value   The value to store.
+ */
+static inline void RaspiAPA102SequenceStore(void* data, uint32_t value)
+{
+    memcpy(data, &value, sizeof(value));
+}
+
+/**
+ * @brief   Writes a token header.
+ *
+ * @param   buffer  A pointer to the output buffer (at least 
+ *                  `RASPI_APA102_SEQUENCE_TOKEN_MAX_SIZE` bytes).
+ * @param   type    The token type.
+ * @param   length  The number of quads covered by the token.
+ *
+ * @return  The number of bytes written.
+ */
+static size_t RaspiAPA102SequenceWriteToken(uint8_t* buffer, unsigned type, uint64_t length)
+{
+    uint64_t value = (length << 2) | type;
+    size_t size = 0;
+    while (value >= 0x80)
+    {
+        buffer[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[size++] = (uint8_t)value;
+
+    return size;
+}
+
+/**
+ * @brief   Reads a token header.
+ *
+ * @param   data    A pointer to the read position. Receives the position after the header.
+ * @param   end     A pointer to the end of the payload.
+ * @param   value   Receives the token header.
+ *
+ * @return  A status code.
+ */
+static inline int RaspiAPA102SequenceReadToken(const uint8_t** data, const uint8_t* end, 
+    uint64_t* value)
+{
+    const uint8_t* position = *data;
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (position >= end)
+        {
+            return -1;
+        }
+        const uint8_t byte = *position++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *data = position;
+            *value = result;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief   Encodes the difference between two frames.
+ *
+ * @param   buffer      A pointer to the output buffer.
+ * @param   quads       A pointer to the color quads of the frame.
+ * @param   reference   A pointer to the color quads of the reference frame, or `NULL` for an 
+ *                      all-zero reference.
+ * @param   count       The number of quads.
+ *
+ * The output buffer has to hold at least `count * 4 + RASPI_APA102_SEQUENCE_TOKEN_MAX_SIZE` bytes.
+ *
+ * @return  The number of bytes written.
+ */
+static size_t RaspiAPA102SequenceEncode(uint8_t* buffer, const RaspiAPA102ColorQuad* quads, 
+    const RaspiAPA102ColorQuad* reference, size_t count)
+{
+#define RASPI_APA102_SEQUENCE_XOR(index) \
+    (RaspiAPA102SequenceLoad(&quads[index]) ^ \
+        (reference ? RaspiAPA102SequenceLoad(&reference[index]) : 0))
+
+    size_t size = 0;
+    size_t i = 0;
+    while (i < count)
+    {
+        const uint32_t value = RASPI_APA102_SEQUENCE_XOR(i);
+        size_t j = i + 1;
+        while ((j < count) && (RASPI_APA102_SEQUENCE_XOR(j) == value))
+        {
+            ++j;
+        }
+
+        if (!value)
+        {
+            size += RaspiAPA102SequenceWriteToken(&buffer[size], RASPI_APA102_SEQUENCE_TOKEN_SKIP, 
+                j - i);
+            i = j;
+            continue;
+        }
+        if (j - i >= RASPI_APA102_SEQUENCE_REPEAT_MIN)
+        {
+            size += RaspiAPA102SequenceWriteToken(&buffer[size], 
+                RASPI_APA102_SEQUENCE_TOKEN_REPEAT, j - i);
+            RaspiAPA102SequenceStore(&buffer[size], value);
+            size += 4;
+            i = j;
+            continue;
+        }
+
+        // Extend the literal until the next run of unchanged quads or equal values
+        j = i + 1;
+        while (j < count)
+        {
+            const uint32_t next = RASPI_APA102_SEQUENCE_XOR(j);
+            size_t run = 1;
+            while ((run < RASPI_APA102_SEQUENCE_REPEAT_MIN) && (j + run < count) && 
+                (RASPI_APA102_SEQUENCE_XOR(j + run) == next))
+            {
+                ++run;
+            }
+            if ((!next && (run >= 2)) || (run >= RASPI_APA102_SEQUENCE_REPEAT_MIN))
+            {
+                break;
+            }
+            ++j;
+        }
+
+        size += RaspiAPA102SequenceWriteToken(&buffer[size], RASPI_APA102_SEQUENCE_TOKEN_LITERAL, 
+            j - i);
+        for (; i < j; ++i)
+        {
+            RaspiAPA102SequenceStore(&buffer[size], RASPI_APA102_SEQUENCE_XOR(i));
+            size += 4;
+        }
+    }
+
+#undef RASPI_APA102_SEQUENCE_XOR
+
+    return size;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Decoding                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the record of the given frame.
+ *
+ * @param   player  A pointer to the `RaspiAPA102SequencePlayer` struct.
+ * @param   frame   The index of the frame.
+ *
+ * @return  A pointer to the record, or `NULL` if the record is out of bounds.
+ */
+static const RaspiAPA102SequenceRecord* RaspiAPA102SequenceGetRecord(
+    const RaspiAPA102SequencePlayer* player, uint64_t frame)
+{
+    const uint64_t offset = player->index[frame];
+    if ((offset % 4) || (offset < player->header->header_size) || 
+        (offset > player->header->index_offset - sizeof(RaspiAPA102SequenceRecord)))
+    {
+        return NULL;
+    }
+
+    const RaspiAPA102SequenceRecord* record = 
+        (const RaspiAPA102SequenceRecord*)(player->data + offset);
+    if (record->size > player->header->index_offset - offset - sizeof(*record))
+    {
+        return NULL;
+    }
+
+    return record;
+}
+
+/**
+ * @brief   Applies the given frame record to the given buffer.
+ *
+ * @param   player  A pointer to the `RaspiAPA102SequencePlayer` struct.
+ * @param   record  A pointer to the record.
+ * @param   quads   A pointer to the destination buffer.
+ *
+ * Extends the dirty range of the player by the changed quads.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SequenceApply(RaspiAPA102SequencePlayer* player, 
+    const RaspiAPA102SequenceRecord* record, RaspiAPA102ColorQuad* quads)
+{
+    const size_t count = player->header->pixel_count;
+    const uint8_t* data = (const uint8_t*)(record + 1);
+    const uint8_t* end = data + record->size;
+
+    size_t first = count;
+    size_t last = 0;
+    if (record->type == RASPI_APA102_SEQUENCE_RECORD_KEYFRAME)
+    {
+        memset(quads, 0, count * sizeof(RaspiAPA102ColorQuad));
+        first = 0;
+        last = count;
+    }
+
+    size_t position = 0;
+    while (data < end)
+    {
+        uint64_t token;
+        if (RaspiAPA102SequenceReadToken(&data, end, &token) < 0)
+        {
+            return -1;
+        }
+        const uint64_t length = token >> 2;
+        if (length > count - position)
+        {
+            return -1;
+        }
+
+        switch (token & 3)
+        {
+        case RASPI_APA102_SEQUENCE_TOKEN_SKIP:
+            position += length;
+            continue;
+        case RASPI_APA102_SEQUENCE_TOKEN_LITERAL:
+            if (length > (size_t)(end - data) / 4)
+            {
+                return -1;
+            }
+            for (size_t i = 0; i < length; ++i)
+            {
+                uint8_t* quad = (uint8_t*)&quads[position + i];
+                RaspiAPA102SequenceStore(quad, 
+                    RaspiAPA102SequenceLoad(quad) ^ RaspiAPA102SequenceLoad(&data[i * 4]));
+            }
+            data += length * 4;
+            break;
+        case RASPI_APA102_SEQUENCE_TOKEN_REPEAT:
+        {
+            if (end - data < 4)
+            {
+                return -1;
+            }
+            const uint32_t value = RaspiAPA102SequenceLoad(data);
+            for (size_t i = 0; i < length; ++i)
+            {
+                uint8_t* quad = (uint8_t*)&quads[position + i];
+                RaspiAPA102SequenceStore(quad, RaspiAPA102SequenceLoad(quad) ^ value);
+            }
+            data += 4;
+            break;
+        }
+        default:
+            return -1;
+        }
+
+        if (length)
+        {
+            first = (position < first) ? position : first;
+            last = (position + length > last) ? position + length : last;
+        }
+        position += length;
+    }
+
+    if (first < last)
+    {
+        if (!player->dirty_count)
+        {
+            player->dirty_first = first;
+            player->dirty_count = last - first;
+        }
+        else
+        {
+            const size_t dirty_last = player->dirty_first + player->dirty_count;
+            player->dirty_first = (first < player->dirty_first) ? first : player->dirty_first;
+            player->dirty_count = ((last > dirty_last) ? last : dirty_last) - player->dirty_first;
+        }
+    }
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Writer                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Writes the given data to the output file.
+ *
+ * @param   writer  A pointer to the `RaspiAPA102SequenceWriter` struct.
+ * @param   data    A pointer to the data.
+ * @param   size    The number of bytes to write.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SequenceWriterWrite(RaspiAPA102SequenceWriter* writer, const void* data, 
+    size_t size)
+{
+    if (fwrite(data, 1, size, writer->file) != size)
+    {
+        return -1;
+    }
+    writer->offset += size;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Writer                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102SequenceWriterOpen(RaspiAPA102SequenceWriter* writer, const char* path, 
+    size_t count, uint32_t fps, uint32_t keyframe_interval)
+{
+    // The payload size of a record is stored as a 32-bit value
+    const size_t limit = (UINT32_MAX - RASPI_APA102_SEQUENCE_TOKEN_MAX_SIZE) / 
+        sizeof(RaspiAPA102ColorQuad);
+    if (!writer || !path || !count || (count > limit) || !fps || !keyframe_interval)
+    {
+        return -1;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    writer->previous = malloc(count * sizeof(RaspiAPA102ColorQuad));
+    writer->buffer = malloc(count * sizeof(RaspiAPA102ColorQuad) + 
+        RASPI_APA102_SEQUENCE_TOKEN_MAX_SIZE);
+    writer->file = fopen(path, "wb");
+    if (!writer->previous || !writer->buffer || !writer->file)
+    {
+        goto Error;
+    }
+
+    writer->header.magic = RASPI_APA102_SEQUENCE_MAGIC;
+    writer->header.version = RASPI_APA102_SEQUENCE_VERSION;
+    writer->header.header_size = sizeof(RaspiAPA102SequenceHeader);
+    writer->header.fps = fps;
+    writer->header.pixel_count = count;
+    writer->keyframe_interval = keyframe_interval;
+
+    // The header is rewritten with the final frame count and index offset on close
+    if (RaspiAPA102SequenceWriterWrite(writer, &writer->header, sizeof(writer->header)) < 0)
+    {
+        goto Error;
+    }
+
+    return 0;
+
+Error:
+    if (writer->file)
+    {
+        fclose(writer->file);
+    }
+    free(writer->previous);
+    free(writer->buffer);
+    memset(writer, 0, sizeof(*writer));
+    return -1;
+}
+
+int RaspiAPA102SequenceWriterAppend(RaspiAPA102SequenceWriter* writer, 
+    const RaspiAPA102ColorQuad* quads)
+{
+    if (!writer || !writer->file || !quads)
+    {
+        return -1;
+    }
+
+    if (writer->header.frame_count == writer->index_capacity)
+    {
+        const size_t capacity = writer->index_capacity ? writer->index_capacity * 2 : 1024;
+        uint64_t* index = realloc(writer->index, capacity * sizeof(uint64_t));
+        if (!index)
+        {
+            return -1;
+        }
+        writer->index = index;
+        writer->index_capacity = capacity;
+    }
+
+    const size_t count = writer->header.pixel_count;
+    RaspiAPA102SequenceRecord record = { 0 };
+    record.type = RASPI_APA102_SEQUENCE_RECORD_KEYFRAME;
+    if (writer->header.frame_count % writer->keyframe_interval)
+    {
+        record.type = RASPI_APA102_SEQUENCE_RECORD_DELTA;
+    }
+    const size_t size = RaspiAPA102SequenceEncode(writer->buffer, quads, 
+        (record.type == RASPI_APA102_SEQUENCE_RECORD_DELTA) ? writer->previous : NULL, count);
+    record.size = (uint32_t)size;
+
+    // Records start at 4-byte aligned offsets
+    static const uint8_t padding[4] = { 0 };
+    writer->index[writer->header.frame_count] = writer->offset;
+    if ((RaspiAPA102SequenceWriterWrite(writer, &record, sizeof(record)) < 0) || 
+        (RaspiAPA102SequenceWriterWrite(writer, writer->buffer, size) < 0) ||
+        (RaspiAPA102SequenceWriterWrite(writer, padding, (4 - size % 4) % 4) < 0))
+    {
+        return -1;
+    }
+
+    memcpy(writer->previous, quads, count * sizeof(RaspiAPA102ColorQuad));
+    ++writer->header.frame_count;
+
+    return 0;
+}
+
+int RaspiAPA102SequenceWriterClose(RaspiAPA102SequenceWriter* writer)
+{
+    if (!writer || !writer->file)
+    {
+        return -1;
+    }
+
+    // Keep the index 8-byte aligned in the mapped file
+    int status = 0;
+    static const uint8_t padding[8] = { 0 };
+    if (RaspiAPA102SequenceWriterWrite(writer, padding, (8 - writer->offset % 8) % 8) < 0)
+    {
+        status = -1;
+    }
+
+    writer->header.index_offset = writer->offset;
+    if ((status < 0) || 
+        (RaspiAPA102SequenceWriterWrite(writer, writer->index, 
+            writer->header.frame_count * sizeof(uint64_t)) < 0) ||
+        (fseek(writer->file, 0, SEEK_SET) < 0) ||
+        (fwrite(&writer->header, sizeof(writer->header), 1, writer->file) != 1))
+    {
+        status = -1;
+    }
+
+    if (fclose(writer->file) != 0)
+    {
+        status = -1;
+    }
+    free(writer->index);
+    free(writer->previous);
+    free(writer->buffer);
+    memset(writer, 0, sizeof(*writer));
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Player                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102SequencePlayerOpen(RaspiAPA102SequencePlayer* player, const char* path)
+{
+    if (!player || !path)
+    {
+        return -1;
+    }
+
+    memset(player, 0, sizeof(*player));
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat info;
+    if ((fstat(fd, &info) < 0) || ((size_t)info.st_size < sizeof(RaspiAPA102SequenceHeader)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    const size_t size = (size_t)info.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return -1;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    const RaspiAPA102SequenceHeader* header = mapping;
+    if ((header->magic != RASPI_APA102_SEQUENCE_MAGIC) || 
+        (header->version != RASPI_APA102_SEQUENCE_VERSION) || 
+        (header->header_size < sizeof(RaspiAPA102SequenceHeader)) || !header->fps ||
+        !header->pixel_count || (header->pixel_count > SIZE_MAX / sizeof(RaspiAPA102ColorQuad)) ||
+        (header->index_offset % sizeof(uint64_t)) || (header->index_offset > size) || 
+        (header->index_offset < header->header_size) ||
+        (header->frame_count > (size - header->index_offset) / sizeof(uint64_t)))
+    {
+        munmap(mapping, size);
+        return -1;
+    }
+
+    player->data = mapping;
+    player->size = size;
+    player->header = header;
+    player->index = (const uint64_t*)(player->data + header->index_offset);
+
+    return 0;
+}
+
+int RaspiAPA102SequencePlayerGetInfo(const RaspiAPA102SequencePlayer* player, size_t* count, 
+    uint32_t* fps, uint64_t* frame_count)
+{
+    if (!player || !player->header)
+    {
+        return -1;
+    }
+
+    if (count)
+    {
+        *count = player->header->pixel_count;
+    }
+    if (fps)
+    {
+        *fps = player->header->fps;
+    }
+    if (frame_count)
+    {
+        *frame_count = player->header->frame_count;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102SequencePlayerDecode(RaspiAPA102SequencePlayer* player, uint64_t frame, 
+    RaspiAPA102ColorQuad* quads)
+{
+    if (!player || !player->header || !quads || (frame >= player->header->frame_count))
+    {
+        return -1;
+    }
+
+    player->dirty_first = 0;
+    player->dirty_count = 0;
+    if (player->decoded == frame + 1)
+    {
+        return 0;
+    }
+
+    const RaspiAPA102SequenceRecord* record = RaspiAPA102SequenceGetRecord(player, frame);
+    if (!record)
+    {
+        goto Error;
+    }
+
+    // Sequential playback applies a single delta, everything else restarts at a keyframe
+    uint64_t start = frame;
+    if ((record->type != RASPI_APA102_SEQUENCE_RECORD_KEYFRAME) && (player->decoded != frame))
+    {
+        while (start > 0)
+        {
+            --start;
+            const RaspiAPA102SequenceRecord* previous = 
+                RaspiAPA102SequenceGetRecord(player, start);
+            if (!previous)
+            {
+                goto Error;
+            }
+            if (previous->type == RASPI_APA102_SEQUENCE_RECORD_KEYFRAME)
+            {
+                break;
+            }
+        }
+    }
+
+    for (uint64_t i = start; i <= frame; ++i)
+    {
+        record = RaspiAPA102SequenceGetRecord(player, i);
+        if (!record || ((i == 0) && (record->type != RASPI_APA102_SEQUENCE_RECORD_KEYFRAME)) ||
+            (RaspiAPA102SequenceApply(player, record, quads) < 0))
+        {
+            goto Error;
+        }
+    }
+    player->decoded = frame + 1;
+
+    return 0;
+
+Error:
+    player->decoded = 0;
+    return -1;
+}
+
+int RaspiAPA102SequencePlayerUpdateDevice(RaspiAPA102SequencePlayer* player, 
+    RaspiAPA102Device* device, uint64_t frame)
+{
+    if (!player || !player->header || !device)
+    {
+        return -1;
+    }
+
+    RaspiAPA102ColorQuad* quads;
+    size_t count;
+    if ((RaspiAPA102DeviceGetBuffer(device, &quads, &count) < 0) || 
+        (count < player->header->pixel_count))
+    {
+        return -1;
+    }
+
+    RaspiAPA102StatsTimer timer = { 0 };
+    RaspiAPA102StatsTimerStart(device, &timer);
+    const int status = RaspiAPA102SequencePlayerDecode(player, frame, quads);
+    RaspiAPA102StatsTimerLap(device, &timer, RASPI_APA102_STATS_STAGE_PACK);
+
+    if ((status < 0) || 
+        (player->dirty_count && 
+        (RaspiAPA102DeviceMarkDirty(device, player->dirty_first, player->dirty_count) < 0)))
+    {
+        return -1;
+    }
+
+    return RaspiAPA102DeviceCommit(device);
+}
+
+int RaspiAPA102SequencePlayerClose(RaspiAPA102SequencePlayer* player)
+{
+    if (!player || !player->data)
+    {
+        return -1;
+    }
+
+    munmap((void*)player->data, player->size);
+    memset(player, 0, sizeof(*player));
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
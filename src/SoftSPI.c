@@ -0,0 +1,968 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/SoftSPI.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <TransportInternal.h>
+#ifdef RASPI_APA102_HAVE_WIRINGPI
+#   include <wiringPi.h>
+#endif
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   The path of the device node that exposes the `GPIO` register block.
+ */
+#define RASPI_APA102_GPIOMEM_PATH "/dev/gpiomem"
+
+/**
+ * @brief   The size of the `GPIO` register block mapping.
+ */
+#define RASPI_APA102_GPIOMEM_SIZE 4096
+
+/**
+ * @brief   The index of the first `GPFSEL` register.
+ */
+#define RASPI_APA102_GPFSEL0 (0x00 / 4)
+
+/**
+ * @brief   The index of the `GPSET0` register.
+ */
+#define RASPI_APA102_GPSET0 (0x1C / 4)
+
+/**
+ * @brief   The index of the `GPCLR0` register.
+ */
+#define RASPI_APA102_GPCLR0 (0x28 / 4)
+
+/**
+ * @brief   The number of busy-wait iterations used to calibrate the loop.
+ */
+#define RASPI_APA102_CALIBRATION_LOOPS 2000000
+
+/**
+ * @brief   The minimum number of bits a write needs to contain to adjust the clock period.
+ */
+#define RASPI_APA102_ADJUST_MIN_BITS 64
+
+/**
+ * @brief   The number of bytes per lane that are encoded at once by the multi-lane engine.
+ */
+#define RASPI_APA102_MULTI_LANE_CHUNK 64
+
+/**
+ * @brief   The number of phases of a multi-lane update (start frames, LED frames, end frame).
+ */
+#define RASPI_APA102_MULTI_LANE_PHASES 3
+
+/* ============================================================================================== */
+/* Internal types                                                                                 */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102MultiLanePhase` struct.
+ *
+ * A phase writes the same number of bytes to all lanes.
+ */
+typedef struct RaspiAPA102MultiLanePhase_
+{
+    /**
+     * @brief   The data buffers of the lanes.
+     */
+    const uint8_t* lanes[RASPI_APA102_MULTI_LANE_MAX];
+    /**
+     * @brief   The buffer sizes of the lanes in bytes.
+     */
+    size_t sizes[RASPI_APA102_MULTI_LANE_MAX];
+    /**
+     * @brief   The number of bytes written per lane.
+     */
+    size_t size;
+    /**
+     * @brief   The 32-bit pattern that pads lanes with less data.
+     */
+    const uint8_t* padding;
+} RaspiAPA102MultiLanePhase;
+
+/* ============================================================================================== */
+/* Internal variables                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Pads lanes with ones (the default for raw writes and end frames).
+ */
+static const uint8_t g_multi_lane_padding_ones[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+/**
+ * @brief   Pads the LED phase of lanes with less LEDs with LED frames that turn the LEDs off.
+ */
+static const uint8_t g_multi_lane_padding_off[4] = { 0xE0, 0x00, 0x00, 0x00 };
+
+/**
+ * @brief   Guards the one-time calibration.
+ */
+static pthread_once_t g_calibration_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief   The number of busy-wait iterations per nanosecond.
+ */
+static double g_loops_per_ns;
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Timing                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the current value of the monotonic clock in nanoseconds.
+ *
+ * @return  The current value of the monotonic clock in nanoseconds.
+ */
+static uint64_t RaspiAPA102SoftSPINow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief   Busy-waits for the given number of iterations.
+ *
+ * @param   loops   The number of iterations.
+ */
+static inline void RaspiAPA102SoftSPISpin(uint32_t loops)
+{
+    for (uint32_t i = 0; i < loops; ++i)
+    {
+        // Prevents the compiler from removing or collapsing the loop
+        __asm__ __volatile__("" ::: "memory");
+    }
+}
+
+/**
+ * @brief   Measures the number of busy-wait iterations per nanosecond.
+ */
+static void RaspiAPA102SoftSPIRunCalibration(void)
+{
+    // The fastest of multiple runs is the least disturbed by the scheduler
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 5; ++i)
+    {
+        const uint64_t start = RaspiAPA102SoftSPINow();
+        RaspiAPA102SoftSPISpin(RASPI_APA102_CALIBRATION_LOOPS);
+        const uint64_t elapsed = RaspiAPA102SoftSPINow() - start;
+        if (elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+
+    g_loops_per_ns = (double)RASPI_APA102_CALIBRATION_LOOPS / (double)(best ? best : 1);
+}
+
+/**
+ * @brief   Moves the busy-wait delay towards the value that would have hit the requested clock 
+ *          period exactly.
+ *
+ * @param   half_period_loops   A pointer to the number of busy-wait iterations per half clock 
+ *                              period.
+ * @param   clock_hz            The requested clock frequency in Hz.
+ * @param   elapsed             The measured duration of the write in nanoseconds.
+ * @param   bits                The number of clock periods of the write.
+ *
+ * The calibration does not account for the time spent in the register writes, so the delay is 
+ * corrected after every sufficiently long write.
+ */
+static void RaspiAPA102SoftSPIAdjust(double* half_period_loops, uint32_t clock_hz, 
+    uint64_t elapsed, uint64_t bits)
+{
+    if (bits < RASPI_APA102_ADJUST_MIN_BITS)
+    {
+        return;
+    }
+
+    const double target_ns = 1000000000.0 / clock_hz;
+    const double measured_ns = (double)elapsed / (double)bits;
+    const double correction = (target_ns - measured_ns) / 2.0 * g_loops_per_ns;
+    *half_period_loops += correction / 2.0;
+    if (*half_period_loops < 0.0)
+    {
+        *half_period_loops = 0.0;
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Registers                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Maps the `GPIO` register block.
+ *
+ * @param   mapping_size    Receives the size of the mapping.
+ *
+ * @return  A pointer to the `GPIO` register block, or `NULL` if the mapping failed.
+ */
+static volatile uint32_t* RaspiAPA102SoftSPIMapRegisters(size_t* mapping_size)
+{
+    const int fd = open(RASPI_APA102_GPIOMEM_PATH, O_RDWR | O_SYNC | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    void* const mapping = mmap(NULL, RASPI_APA102_GPIOMEM_SIZE, PROT_READ | PROT_WRITE, 
+        MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    *mapping_size = RASPI_APA102_GPIOMEM_SIZE;
+
+    return mapping;
+}
+
+/**
+ * @brief   Configures the given pin as output using the `GPFSEL` registers.
+ *
+ * @param   registers   A pointer to the `GPIO` register block.
+ * @param   pin         The number of the pin.
+ */
+static void RaspiAPA102SoftSPIRegisterModeOutput(volatile uint32_t* registers, int pin)
+{
+    volatile uint32_t* const fsel = &registers[RASPI_APA102_GPFSEL0 + pin / 10];
+    const unsigned shift = (pin % 10) * 3;
+    *fsel = (*fsel & ~(7u << shift)) | (1u << shift);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Pins                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Configures the given pin as output.
+ *
+ * @param   spi A pointer to the `RaspiAPA102SoftSPI` struct.
+ * @param   pin The number of the pin.
+ */
+static void RaspiAPA102SoftSPIPinModeOutput(RaspiAPA102SoftSPI* spi, int pin)
+{
+    if (spi->registers)
+    {
+        RaspiAPA102SoftSPIRegisterModeOutput(spi->registers, pin);
+        return;
+    }
+
+#ifdef RASPI_APA102_HAVE_WIRINGPI
+    pinMode(pin, OUTPUT);
+#endif
+}
+
+/**
+ * @brief   Drives the given pin.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102SoftSPI` struct.
+ * @param   pin     The number of the pin.
+ * @param   value   The new value of the pin.
+ */
+static void RaspiAPA102SoftSPIPinWrite(RaspiAPA102SoftSPI* spi, int pin, bool value)
+{
+    if (spi->registers)
+    {
+        spi->registers[value ? RASPI_APA102_GPSET0 : RASPI_APA102_GPCLR0] = 1u << pin;
+        return;
+    }
+
+#ifdef RASPI_APA102_HAVE_WIRINGPI
+    digitalWrite(pin, value ? HIGH : LOW);
+#endif
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Engine                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Clocks out the given buffer using the `GPIO` set/clear registers.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102SoftSPI` struct.
+ * @param   buffer  A pointer to the data buffer.
+ * @param   size    The number of bytes to write.
+ * @param   loops   The number of busy-wait iterations per half clock period.
+ *
+ * The falling clock edge and a falling data line are batched into a single write to `GPCLR0`, so
+ * each bit takes three register writes.
+ */
+static void RaspiAPA102SoftSPIWriteRegisters(RaspiAPA102SoftSPI* spi, const uint8_t* buffer, 
+    size_t size, uint32_t loops)
+{
+    volatile uint32_t* const set = &spi->registers[RASPI_APA102_GPSET0];
+    volatile uint32_t* const clr = &spi->registers[RASPI_APA102_GPCLR0];
+    const uint32_t mask_sclk = 1u << spi->pin_sclk;
+    const uint32_t mask_mosi = 1u << spi->pin_mosi;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        const uint8_t byte = buffer[i];
+        for (int j = 7; j >= 0; --j)
+        {
+            if ((byte >> j) & 1)
+            {
+                *clr = mask_sclk;
+                *set = mask_mosi;
+            }
+            else
+            {
+                *clr = mask_sclk | mask_mosi;
+            }
+            RaspiAPA102SoftSPISpin(loops);
+            *set = mask_sclk;
+            RaspiAPA102SoftSPISpin(loops);
+        }
+    }
+    *clr = mask_sclk;
+}
+
+/**
+ * @brief   Clocks out the given buffer using `wiringPi`.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102SoftSPI` struct.
+ * @param   buffer  A pointer to the data buffer.
+ * @param   size    The number of bytes to write.
+ * @param   loops   The number of busy-wait iterations per half clock period.
+ */
+static void RaspiAPA102SoftSPIWritePins(RaspiAPA102SoftSPI* spi, const uint8_t* buffer, 
+    size_t size, uint32_t loops)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        const uint8_t byte = buffer[i];
+        for (int j = 7; j >= 0; --j)
+        {
+            RaspiAPA102SoftSPIPinWrite(spi, spi->pin_mosi, (byte >> j) & 1);
+            RaspiAPA102SoftSPISpin(loops);
+            RaspiAPA102SoftSPIPinWrite(spi, spi->pin_sclk, true);
+            RaspiAPA102SoftSPISpin(loops);
+            RaspiAPA102SoftSPIPinWrite(spi, spi->pin_sclk, false);
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Multi-lane engine                                                                              */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Transposes an 8x8 bit matrix.
+ *
+ * @param   x   The matrix. Byte `n` is row `n`, bit `m` of each row is column `m`.
+ *
+ * @return  The transposed matrix. Bit `m` of byte `n` is bit `n` of byte `m` of the input.
+ */
+static inline uint64_t RaspiAPA102Transpose8x8(uint64_t x)
+{
+    uint64_t t;
+    t = (x ^ (x >>  7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t <<  7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+
+    return x;
+}
+
+/**
+ * @brief   Transposes a range of the given lane buffers into `GPIO` set masks.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   lanes   A pointer to an array of `lane_count` data buffers.
+ * @param   sizes   A pointer to an array of `lane_count` buffer sizes in bytes.
+ * @param   offset  The offset of the first byte to encode.
+ * @param   size    The number of bytes to encode per lane.
+ * @param   padding The 32-bit pattern that pads lanes with less data. Byte `i` of a lane is padded
+ *                  with `padding[i % 4]`.
+ * @param   masks   Receives `size * 8` `GPIO` masks.
+ */
+static void RaspiAPA102MultiLaneSPIEncodeRange(const RaspiAPA102MultiLaneSPI* spi, 
+    const uint8_t* const* lanes, const size_t* sizes, size_t offset, size_t size, 
+    const uint8_t* padding, uint32_t* masks)
+{
+    for (size_t i = offset; i < offset + size; ++i)
+    {
+        // Row `n` of the matrix holds the current byte of lane `n`
+        uint64_t matrix = 0;
+        for (size_t lane = 0; lane < spi->lane_count; ++lane)
+        {
+            const uint64_t byte = (i < sizes[lane]) ? lanes[lane][i] : padding[i & 3];
+            matrix |= byte << (lane * 8);
+        }
+        matrix = RaspiAPA102Transpose8x8(matrix);
+
+        // Row `m` of the transposed matrix holds bit `m` of all lanes; bits are sent MSB first
+        for (int bit = 7; bit >= 0; --bit)
+        {
+            *masks++ = spi->lane_masks[(matrix >> (bit * 8)) & 0xFF];
+        }
+    }
+}
+
+/**
+ * @brief   Clocks out the given `GPIO` set masks.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   masks   A pointer to the `GPIO` set masks.
+ * @param   count   The number of masks.
+ * @param   loops   The number of busy-wait iterations per half clock period.
+ */
+static void RaspiAPA102MultiLaneSPIWriteMasks(RaspiAPA102MultiLaneSPI* spi, const uint32_t* masks, 
+    size_t count, uint32_t loops)
+{
+    volatile uint32_t* const set = &spi->registers[RASPI_APA102_GPSET0];
+    volatile uint32_t* const clr = &spi->registers[RASPI_APA102_GPCLR0];
+    const uint32_t mask_sclk = 1u << spi->pin_sclk;
+    const uint32_t mask_mosi = spi->mask_mosi;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t mask = masks[i];
+        *clr = mask_sclk | (mask_mosi & ~mask);
+        *set = mask;
+        RaspiAPA102SoftSPISpin(loops);
+        *set = mask_sclk;
+        RaspiAPA102SoftSPISpin(loops);
+    }
+    *clr = mask_sclk;
+}
+
+/**
+ * @brief   Writes the given number of bytes of the given lane buffers.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   lanes   A pointer to an array of `lane_count` data buffers.
+ * @param   sizes   A pointer to an array of `lane_count` buffer sizes in bytes.
+ * @param   size    The number of bytes to write per lane.
+ * @param   padding The 32-bit pattern that pads lanes with less data.
+ */
+static void RaspiAPA102MultiLaneSPIWriteSize(RaspiAPA102MultiLaneSPI* spi, 
+    const uint8_t* const* lanes, const size_t* sizes, size_t size, const uint8_t* padding)
+{
+    const uint32_t loops = (uint32_t)(spi->half_period_loops + 0.5);
+    const uint64_t start = RaspiAPA102SoftSPINow();
+
+    // Encoding the next chunk stretches a single low phase of the clock, which is harmless for 
+    // the static `APA102` protocol
+    uint32_t masks[RASPI_APA102_MULTI_LANE_CHUNK * 8];
+    for (size_t offset = 0; offset < size; offset += RASPI_APA102_MULTI_LANE_CHUNK)
+    {
+        const size_t chunk = (size - offset < RASPI_APA102_MULTI_LANE_CHUNK) ? 
+            size - offset : RASPI_APA102_MULTI_LANE_CHUNK;
+        RaspiAPA102MultiLaneSPIEncodeRange(spi, lanes, sizes, offset, chunk, padding, masks);
+        RaspiAPA102MultiLaneSPIWriteMasks(spi, masks, chunk * 8, loops);
+    }
+
+    const uint64_t elapsed = RaspiAPA102SoftSPINow() - start;
+    const uint64_t bits = (uint64_t)size * 8;
+    spi->bits_written += bits;
+    spi->time_ns += elapsed;
+    RaspiAPA102SoftSPIAdjust(&spi->half_period_loops, spi->clock_hz, elapsed, bits);
+}
+
+/**
+ * @brief   Describes the phases of a multi-lane update.
+ *
+ * @param   spi     A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ * @param   colors  A pointer to an array of `lane_count` pointers to `RaspiAPA102ColorQuad` 
+ *                  arrays.
+ * @param   counts  A pointer to an array of `lane_count` LED counts.
+ * @param   phases  Receives `RASPI_APA102_MULTI_LANE_PHASES` phases.
+ *
+ * Lanes with less LEDs are padded with LED frames that turn the LEDs off, as four bytes of ones
+ * would be latched as a white LED frame. The end frame is sized for the longest lane.
+ */
+static void RaspiAPA102MultiLaneSPIGetPhases(const RaspiAPA102MultiLaneSPI* spi, 
+    const RaspiAPA102ColorQuad* const* colors, const size_t* counts, 
+    RaspiAPA102MultiLanePhase* phases)
+{
+    static const uint8_t start_frame[RASPI_APA102_START_FRAME_SIZE] = { 0 };
+
+    size_t count = 0;
+    for (size_t i = 0; i < spi->lane_count; ++i)
+    {
+        phases[0].lanes[i] = start_frame;
+        phases[0].sizes[i] = sizeof(start_frame);
+        phases[1].lanes[i] = (const uint8_t*)colors[i];
+        phases[1].sizes[i] = counts[i] * sizeof(RaspiAPA102ColorQuad);
+        phases[2].lanes[i] = start_frame;
+        phases[2].sizes[i] = 0;
+        if (counts[i] > count)
+        {
+            count = counts[i];
+        }
+    }
+
+    phases[0].size    = sizeof(start_frame);
+    phases[0].padding = g_multi_lane_padding_ones;
+    phases[1].size    = count * sizeof(RaspiAPA102ColorQuad);
+    phases[1].padding = g_multi_lane_padding_off;
+    phases[2].size    = RASPI_APA102_END_FRAME_SIZE(count);
+    phases[2].padding = g_multi_lane_padding_ones;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transport                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Writes the given buffer.
+ *
+ * @param   context A pointer to the `RaspiAPA102SoftSPI` struct.
+ * @param   buffer  A pointer to the data buffer.
+ * @param   size    The number of bytes to write.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SoftSPITransportWrite(void* context, const uint8_t* buffer, size_t size)
+{
+    return RaspiAPA102SoftSPIWrite(context, buffer, size);
+}
+
+/**
+ * @brief   Completes the current frame by deasserting the chip select pin.
+ *
+ * @param   context A pointer to the `RaspiAPA102SoftSPI` struct.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SoftSPITransportFlush(void* context)
+{
+    RaspiAPA102SoftSPI* const spi = context;
+
+    if (spi->selected)
+    {
+        RaspiAPA102SoftSPIPinWrite(spi, spi->pin_cs, true);
+        spi->selected = false;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Destroys and releases an engine created by `RaspiAPA102SoftSPITransportCreate`.
+ *
+ * @param   context A pointer to the `RaspiAPA102SoftSPI` struct.
+ */
+static void RaspiAPA102SoftSPITransportClose(void* context)
+{
+    RaspiAPA102SoftSPIDestroy(context);
+    free(context);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Library functions                                                                              */
+/* ============================================================================================== */
+
+int RaspiAPA102SoftSPITransportCreate(RaspiAPA102Transport* transport, int pin_sclk, 
+    int pin_mosi, int pin_cs, uint32_t clock_hz)
+{
+    if (!transport)
+    {
+        return -1;
+    }
+
+    RaspiAPA102SoftSPI* const spi = malloc(sizeof(RaspiAPA102SoftSPI));
+    if (!spi)
+    {
+        return -1;
+    }
+    if (RaspiAPA102SoftSPIInit(spi, NULL, pin_sclk, pin_mosi, pin_cs, clock_hz) < 0)
+    {
+        free(spi);
+        return -1;
+    }
+
+    RaspiAPA102SoftSPIGetTransport(spi, transport);
+    transport->close = &RaspiAPA102SoftSPITransportClose;
+
+    return 0;
+}
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Soft SPI                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102SoftSPICalibrate(double* loops_per_us)
+{
+    pthread_once(&g_calibration_once, &RaspiAPA102SoftSPIRunCalibration);
+
+    if (loops_per_us)
+    {
+        *loops_per_us = g_loops_per_ns * 1000.0;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102SoftSPIInit(RaspiAPA102SoftSPI* spi, volatile uint32_t* registers, int pin_sclk, 
+    int pin_mosi, int pin_cs, uint32_t clock_hz)
+{
+    if (!spi || 
+        (pin_sclk < 0) || (pin_sclk > 29) || 
+        (pin_mosi < 0) || (pin_mosi > 29) || 
+        (pin_cs < -1)  || (pin_cs   > 29) ||
+        (pin_mosi == pin_sclk) || (pin_cs == pin_sclk) || (pin_cs == pin_mosi) ||
+        !clock_hz)
+    {
+        return -1;
+    }
+
+    memset(spi, 0, sizeof(*spi));
+    spi->registers = registers;
+    spi->pin_sclk  = pin_sclk;
+    spi->pin_mosi  = pin_mosi;
+    spi->pin_cs    = pin_cs;
+    spi->clock_hz  = clock_hz;
+
+    if (!registers)
+    {
+        spi->registers = RaspiAPA102SoftSPIMapRegisters(&spi->mapping_size);
+    }
+    if (!spi->registers)
+    {
+#ifdef RASPI_APA102_HAVE_WIRINGPI
+        wiringPiSetupGpio();
+#else
+        return -1;
+#endif
+    }
+
+    RaspiAPA102SoftSPICalibrate(NULL);
+    const double half_period_ns = 1000000000.0 / (2.0 * clock_hz);
+    spi->half_period_loops = half_period_ns * g_loops_per_ns;
+
+    RaspiAPA102SoftSPIPinModeOutput(spi, pin_sclk);
+    RaspiAPA102SoftSPIPinModeOutput(spi, pin_mosi);
+    RaspiAPA102SoftSPIPinWrite(spi, pin_sclk, false);
+    if (pin_cs >= 0)
+    {
+        RaspiAPA102SoftSPIPinModeOutput(spi, pin_cs);
+        RaspiAPA102SoftSPIPinWrite(spi, pin_cs, true);
+    }
+
+    return 0;
+}
+
+int RaspiAPA102SoftSPIWrite(RaspiAPA102SoftSPI* spi, const uint8_t* buffer, size_t size)
+{
+    if (!spi || (!buffer && size))
+    {
+        return -1;
+    }
+
+    if ((spi->pin_cs >= 0) && !spi->selected)
+    {
+        RaspiAPA102SoftSPIPinWrite(spi, spi->pin_cs, false);
+        spi->selected = true;
+    }
+
+    const uint32_t loops = (uint32_t)(spi->half_period_loops + 0.5);
+    const uint64_t start = RaspiAPA102SoftSPINow();
+    if (spi->registers)
+    {
+        RaspiAPA102SoftSPIWriteRegisters(spi, buffer, size, loops);
+    }
+    else
+    {
+        RaspiAPA102SoftSPIWritePins(spi, buffer, size, loops);
+    }
+    const uint64_t elapsed = RaspiAPA102SoftSPINow() - start;
+
+    const uint64_t bits = (uint64_t)size * 8;
+    spi->bits_written += bits;
+    spi->time_ns += elapsed;
+
+    RaspiAPA102SoftSPIAdjust(&spi->half_period_loops, spi->clock_hz, elapsed, bits);
+
+    return 0;
+}
+
+int RaspiAPA102SoftSPIGetBitRate(const RaspiAPA102SoftSPI* spi, double* bits_per_second)
+{
+    if (!spi || !bits_per_second)
+    {
+        return -1;
+    }
+
+    *bits_per_second = spi->time_ns ? 
+        (double)spi->bits_written * 1000000000.0 / (double)spi->time_ns : 0.0;
+
+    return 0;
+}
+
+int RaspiAPA102SoftSPIGetTransport(RaspiAPA102SoftSPI* spi, RaspiAPA102Transport* transport)
+{
+    if (!spi || !transport)
+    {
+        return -1;
+    }
+
+    transport->context = spi;
+    transport->open    = NULL;
+    transport->write   = &RaspiAPA102SoftSPITransportWrite;
+    transport->flush   = &RaspiAPA102SoftSPITransportFlush;
+    transport->close   = NULL;
+
+    return 0;
+}
+
+int RaspiAPA102SoftSPIDestroy(RaspiAPA102SoftSPI* spi)
+{
+    if (!spi)
+    {
+        return -1;
+    }
+
+    if (spi->mapping_size)
+    {
+        munmap((void*)spi->registers, spi->mapping_size);
+    }
+    spi->registers = NULL;
+    spi->mapping_size = 0;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Multi-lane Soft SPI                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102MultiLaneSPIInit(RaspiAPA102MultiLaneSPI* spi, volatile uint32_t* registers, 
+    int pin_sclk, const int* pins_mosi, size_t lane_count, uint32_t clock_hz)
+{
+    if (!spi || (pin_sclk < 0) || (pin_sclk > 29) || !pins_mosi || !lane_count || 
+        (lane_count > RASPI_APA102_MULTI_LANE_MAX) || !clock_hz)
+    {
+        return -1;
+    }
+    uint32_t pins = 1u << pin_sclk;
+    for (size_t i = 0; i < lane_count; ++i)
+    {
+        if ((pins_mosi[i] < 0) || (pins_mosi[i] > 29) || (pins & (1u << pins_mosi[i])))
+        {
+            return -1;
+        }
+        pins |= 1u << pins_mosi[i];
+    }
+
+    memset(spi, 0, sizeof(*spi));
+    spi->registers  = registers;
+    spi->pin_sclk   = pin_sclk;
+    spi->lane_count = lane_count;
+    spi->clock_hz   = clock_hz;
+    for (size_t i = 0; i < lane_count; ++i)
+    {
+        spi->pins_mosi[i] = pins_mosi[i];
+        spi->mask_mosi |= 1u << pins_mosi[i];
+    }
+    for (size_t value = 0; value < 256; ++value)
+    {
+        for (size_t i = 0; i < lane_count; ++i)
+        {
+            if (value & (1u << i))
+            {
+                spi->lane_masks[value] |= 1u << pins_mosi[i];
+            }
+        }
+    }
+
+    if (!registers)
+    {
+        spi->registers = RaspiAPA102SoftSPIMapRegisters(&spi->mapping_size);
+        if (!spi->registers)
+        {
+            return -1;
+        }
+    }
+
+    RaspiAPA102SoftSPICalibrate(NULL);
+    const double half_period_ns = 1000000000.0 / (2.0 * clock_hz);
+    spi->half_period_loops = half_period_ns * g_loops_per_ns;
+
+    RaspiAPA102SoftSPIRegisterModeOutput(spi->registers, pin_sclk);
+    for (size_t i = 0; i < lane_count; ++i)
+    {
+        RaspiAPA102SoftSPIRegisterModeOutput(spi->registers, pins_mosi[i]);
+    }
+    spi->registers[RASPI_APA102_GPCLR0] = 1u << pin_sclk;
+
+    return 0;
+}
+
+int RaspiAPA102MultiLaneSPIEncode(const RaspiAPA102MultiLaneSPI* spi, const uint8_t* const* lanes, 
+    const size_t* sizes, size_t size, uint32_t* masks)
+{
+    if (!spi || !lanes || !sizes || (!masks && size))
+    {
+        return -1;
+    }
+
+    RaspiAPA102MultiLaneSPIEncodeRange(spi, lanes, sizes, 0, size, g_multi_lane_padding_ones, 
+        masks);
+
+    return 0;
+}
+
+int RaspiAPA102MultiLaneSPIWrite(RaspiAPA102MultiLaneSPI* spi, const uint8_t* const* lanes, 
+    const size_t* sizes)
+{
+    if (!spi || !lanes || !sizes)
+    {
+        return -1;
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < spi->lane_count; ++i)
+    {
+        if (sizes[i] > size)
+        {
+            size = sizes[i];
+        }
+    }
+    RaspiAPA102MultiLaneSPIWriteSize(spi, lanes, sizes, size, g_multi_lane_padding_ones);
+
+    return 0;
+}
+
+int RaspiAPA102MultiLaneSPIEncodeUpdate(const RaspiAPA102MultiLaneSPI* spi, 
+    const RaspiAPA102ColorQuad* const* colors, const size_t* counts, uint32_t* masks, 
+    size_t* count)
+{
+    if (!spi || !colors || !counts || !count)
+    {
+        return -1;
+    }
+
+    RaspiAPA102MultiLanePhase phases[RASPI_APA102_MULTI_LANE_PHASES];
+    RaspiAPA102MultiLaneSPIGetPhases(spi, colors, counts, phases);
+
+    size_t size = 0;
+    for (size_t i = 0; i < RASPI_APA102_MULTI_LANE_PHASES; ++i)
+    {
+        size += phases[i].size;
+    }
+    if (!masks)
+    {
+        *count = size * 8;
+        return 0;
+    }
+    if (*count < size * 8)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < RASPI_APA102_MULTI_LANE_PHASES; ++i)
+    {
+        RaspiAPA102MultiLaneSPIEncodeRange(spi, phases[i].lanes, phases[i].sizes, 0, 
+            phases[i].size, phases[i].padding, masks);
+        masks += phases[i].size * 8;
+    }
+    *count = size * 8;
+
+    return 0;
+}
+
+int RaspiAPA102MultiLaneSPIUpdate(RaspiAPA102MultiLaneSPI* spi, 
+    const RaspiAPA102ColorQuad* const* colors, const size_t* counts)
+{
+    if (!spi || !colors || !counts)
+    {
+        return -1;
+    }
+
+    RaspiAPA102MultiLanePhase phases[RASPI_APA102_MULTI_LANE_PHASES];
+    RaspiAPA102MultiLaneSPIGetPhases(spi, colors, counts, phases);
+    for (size_t i = 0; i < RASPI_APA102_MULTI_LANE_PHASES; ++i)
+    {
+        RaspiAPA102MultiLaneSPIWriteSize(spi, phases[i].lanes, phases[i].sizes, phases[i].size, 
+            phases[i].padding);
+    }
+
+    return 0;
+}
+
+int RaspiAPA102MultiLaneSPIGetBitRate(const RaspiAPA102MultiLaneSPI* spi, 
+    double* bits_per_second)
+{
+    if (!spi || !bits_per_second)
+    {
+        return -1;
+    }
+
+    *bits_per_second = spi->time_ns ? (double)spi->bits_written * (double)spi->lane_count * 
+        1000000000.0 / (double)spi->time_ns : 0.0;
+
+    return 0;
+}
+
+int RaspiAPA102MultiLaneSPIDestroy(RaspiAPA102MultiLaneSPI* spi)
+{
+    if (!spi)
+    {
+        return -1;
+    }
+
+    if (spi->mapping_size)
+    {
+        munmap((void*)spi->registers, spi->mapping_size);
+    }
+    spi->registers = NULL;
+    spi->mapping_size = 0;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
@@ -0,0 +1,384 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/Stats.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <StatsInternal.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+#define RASPI_APA102_NSEC_PER_MSEC 1000000ULL
+
+/**
+ * @brief   The names of all stages.
+ */
+static const char* RASPI_APA102_STATS_STAGE_NAMES[RASPI_APA102_STATS_STAGE_MAX_VALUE + 1] =
+{
+    "pack", "transfer", "end frame", "flush", "frame", "interval"
+};
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Histogram                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the lower bound of the given bucket.
+ *
+ * @param   index   The index of the bucket.
+ *
+ * @return  The smallest value counted in the bucket.
+ */
+static uint64_t RaspiAPA102StatsGetBucketStart(size_t index)
+{
+    if (index < RASPI_APA102_STATS_SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    const unsigned exponent = (unsigned)(index / RASPI_APA102_STATS_SUB_BUCKETS) + 3;
+    const uint64_t mantissa = 
+        RASPI_APA102_STATS_SUB_BUCKETS + index % RASPI_APA102_STATS_SUB_BUCKETS;
+
+    return mantissa << (exponent - 4);
+}
+
+/**
+ * @brief   Returns the center of the given bucket.
+ *
+ * @param   index   The index of the bucket.
+ *
+ * @return  The center of the bucket.
+ */
+static double RaspiAPA102StatsGetBucketCenter(size_t index)
+{
+    const uint64_t start = RaspiAPA102StatsGetBucketStart(index);
+    const uint64_t end = RaspiAPA102StatsGetBucketStart(index + 1);
+
+    return (start + end - 1) / 2.0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Library functions                                                                              */
+/* ============================================================================================== */
+
+void RaspiAPA102StatsHistogramReset(RaspiAPA102StatsHistogram* histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = UINT64_MAX;
+}
+
+void RaspiAPA102StatsHistogramRecord(RaspiAPA102StatsHistogram* histogram, uint64_t value)
+{
+    size_t index = value;
+    if (value >= RASPI_APA102_STATS_SUB_BUCKETS)
+    {
+        // 16 linear sub-buckets per power of two
+        const unsigned exponent = 63 - (unsigned)__builtin_clzll(value);
+        index = (exponent - 3) * RASPI_APA102_STATS_SUB_BUCKETS + 
+            ((value >> (exponent - 4)) & (RASPI_APA102_STATS_SUB_BUCKETS - 1));
+        if (index >= RASPI_APA102_STATS_BUCKETS)
+        {
+            index = RASPI_APA102_STATS_BUCKETS - 1;
+        }
+    }
+
+    __atomic_fetch_add(&histogram->buckets[index], 1, __ATOMIC_RELAXED);
+    const uint64_t microseconds = (value + 500) / 1000;
+    __atomic_fetch_add(&histogram->sum, value, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum_squares, microseconds * microseconds, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+
+    uint64_t current = __atomic_load_n(&histogram->min, __ATOMIC_RELAXED);
+    while ((value < current) && !__atomic_compare_exchange_n(&histogram->min, &current, value, 
+        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+    current = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+    while ((value > current) && !__atomic_compare_exchange_n(&histogram->max, &current, value, 
+        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+#ifdef RASPI_APA102_ENABLE_STATS
+
+void RaspiAPA102StatsRecord(RaspiAPA102Stats* stats, RaspiAPA102StatsStage stage, uint64_t value)
+{
+    RaspiAPA102StatsHistogramRecord(&stats->stages[stage], value);
+}
+
+void RaspiAPA102StatsRecordFrame(RaspiAPA102Stats* stats, uint64_t start, uint64_t end, 
+    size_t bytes, int status)
+{
+    if (status < 0)
+    {
+        __atomic_fetch_add(&stats->errors, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    RaspiAPA102StatsRecord(stats, RASPI_APA102_STATS_STAGE_FRAME, end - start);
+    const uint64_t last = __atomic_exchange_n(&stats->last_frame, start, __ATOMIC_RELAXED);
+    if (last && (start > last))
+    {
+        RaspiAPA102StatsRecord(stats, RASPI_APA102_STATS_STAGE_INTERVAL, start - last);
+    }
+    __atomic_fetch_add(&stats->bytes, bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->frames, 1, __ATOMIC_RELAXED);
+
+    if (stats->dump_file && (end >= stats->dump_next))
+    {
+        stats->dump_next = end + stats->dump_interval;
+        RaspiAPA102StatsDump(stats, stats->dump_file);
+    }
+}
+
+#endif
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Device                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102DeviceEnableStats(RaspiAPA102Device* device, bool enable)
+{
+#ifdef RASPI_APA102_ENABLE_STATS
+    if (!device)
+    {
+        return -1;
+    }
+
+    if (!enable)
+    {
+        free(device->stats);
+        device->stats = NULL;
+        return 0;
+    }
+
+    RaspiAPA102Stats* stats = device->stats;
+    if (!stats)
+    {
+        stats = malloc(sizeof(RaspiAPA102Stats));
+        if (!stats)
+        {
+            return -1;
+        }
+    }
+    memset(stats, 0, sizeof(*stats));
+    for (size_t i = 0; i <= RASPI_APA102_STATS_STAGE_MAX_VALUE; ++i)
+    {
+        RaspiAPA102StatsHistogramReset(&stats->stages[i]);
+    }
+    device->stats = stats;
+
+    return 0;
+#else
+    (void)device;
+    (void)enable;
+
+    return -1;
+#endif
+}
+
+int RaspiAPA102DeviceGetStats(const RaspiAPA102Device* device, RaspiAPA102Stats* stats)
+{
+    if (!device || !device->stats || !stats)
+    {
+        return -1;
+    }
+
+    const RaspiAPA102Stats* const source = device->stats;
+    for (size_t i = 0; i <= RASPI_APA102_STATS_STAGE_MAX_VALUE; ++i)
+    {
+        const RaspiAPA102StatsHistogram* const from = &source->stages[i];
+        RaspiAPA102StatsHistogram* const to = &stats->stages[i];
+        to->count = __atomic_load_n(&from->count, __ATOMIC_RELAXED);
+        to->sum = __atomic_load_n(&from->sum, __ATOMIC_RELAXED);
+        to->sum_squares = __atomic_load_n(&from->sum_squares, __ATOMIC_RELAXED);
+        to->min = __atomic_load_n(&from->min, __ATOMIC_RELAXED);
+        to->max = __atomic_load_n(&from->max, __ATOMIC_RELAXED);
+        for (size_t j = 0; j < RASPI_APA102_STATS_BUCKETS; ++j)
+        {
+            to->buckets[j] = __atomic_load_n(&from->buckets[j], __ATOMIC_RELAXED);
+        }
+    }
+    stats->frames = __atomic_load_n(&source->frames, __ATOMIC_RELAXED);
+    stats->errors = __atomic_load_n(&source->errors, __ATOMIC_RELAXED);
+    stats->bytes = __atomic_load_n(&source->bytes, __ATOMIC_RELAXED);
+    stats->last_frame = __atomic_load_n(&source->last_frame, __ATOMIC_RELAXED);
+    stats->dump_file = NULL;
+    stats->dump_interval = 0;
+    stats->dump_next = 0;
+
+    return 0;
+}
+
+int RaspiAPA102DeviceRecordStage(const RaspiAPA102Device* device, RaspiAPA102StatsStage stage, 
+    uint64_t duration)
+{
+#ifdef RASPI_APA102_ENABLE_STATS
+    if (!device || !device->stats || (stage > RASPI_APA102_STATS_STAGE_MAX_VALUE))
+    {
+        return -1;
+    }
+
+    RaspiAPA102StatsRecord(device->stats, stage, duration);
+
+    return 0;
+#else
+    (void)device;
+    (void)stage;
+    (void)duration;
+
+    return -1;
+#endif
+}
+
+int RaspiAPA102DeviceSetStatsDump(RaspiAPA102Device* device, FILE* file, uint32_t interval)
+{
+    if (!device || !device->stats || (file && !interval))
+    {
+        return -1;
+    }
+
+    device->stats->dump_interval = interval * RASPI_APA102_NSEC_PER_MSEC;
+    device->stats->dump_next = 0;
+    device->stats->dump_file = file;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Evaluation                                                                                     */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102StatsGetPercentile(const RaspiAPA102StatsHistogram* histogram, double percentile, 
+    uint64_t* value)
+{
+    if (!histogram || !value || (percentile < 0.0) || (percentile > 100.0) || !histogram->count)
+    {
+        return -1;
+    }
+
+    const uint64_t target = (uint64_t)ceil(percentile / 100.0 * histogram->count);
+    uint64_t seen = 0;
+    size_t index = 0;
+    for (; index < RASPI_APA102_STATS_BUCKETS - 1; ++index)
+    {
+        seen += histogram->buckets[index];
+        if (seen && (seen >= target))
+        {
+            break;
+        }
+    }
+
+    // The exact extremes are known, everything else is reported as the bucket center
+    uint64_t result = (uint64_t)RaspiAPA102StatsGetBucketCenter(index);
+    result = (result < histogram->min) ? histogram->min : result;
+    result = (result > histogram->max) ? histogram->max : result;
+    *value = result;
+
+    return 0;
+}
+
+int RaspiAPA102StatsGetDeviation(const RaspiAPA102StatsHistogram* histogram, double* deviation)
+{
+    if (!histogram || !deviation || !histogram->count)
+    {
+        return -1;
+    }
+
+    const double mean = (double)histogram->sum / histogram->count / 1e3;
+    const double variance = (double)histogram->sum_squares / histogram->count - mean * mean;
+    *deviation = (variance > 0.0) ? sqrt(variance) * 1e3 : 0.0;
+
+    return 0;
+}
+
+int RaspiAPA102StatsGetBitRate(const RaspiAPA102Stats* stats, double* rate)
+{
+    if (!stats || !rate)
+    {
+        return -1;
+    }
+
+    const uint64_t duration = stats->stages[RASPI_APA102_STATS_STAGE_FRAME].sum;
+    *rate = duration ? stats->bytes * 8.0 * 1e9 / duration : 0.0;
+
+    return 0;
+}
+
+int RaspiAPA102StatsDump(const RaspiAPA102Stats* stats, FILE* file)
+{
+    if (!stats || !file)
+    {
+        return -1;
+    }
+
+    double rate;
+    double jitter = 0.0;
+    RaspiAPA102StatsGetBitRate(stats, &rate);
+    RaspiAPA102StatsGetDeviation(&stats->stages[RASPI_APA102_STATS_STAGE_INTERVAL], &jitter);
+    fprintf(file, "frames %llu, errors %llu, bytes %llu, %.2f Mbit/s, jitter %.1f us\n", 
+        (unsigned long long)stats->frames, (unsigned long long)stats->errors, 
+        (unsigned long long)stats->bytes, rate / 1e6, jitter / 1e3);
+
+    for (size_t i = 0; i <= RASPI_APA102_STATS_STAGE_MAX_VALUE; ++i)
+    {
+        const RaspiAPA102StatsHistogram* const histogram = &stats->stages[i];
+        if (!histogram->count)
+        {
+            continue;
+        }
+        uint64_t p50;
+        uint64_t p99;
+        RaspiAPA102StatsGetPercentile(histogram, 50.0, &p50);
+        RaspiAPA102StatsGetPercentile(histogram, 99.0, &p99);
+        fprintf(file, "  %-9s count %llu, min %.1f, avg %.1f, p50 %.1f, p99 %.1f, max %.1f us\n", 
+            RASPI_APA102_STATS_STAGE_NAMES[i], (unsigned long long)histogram->count, 
+            histogram->min / 1e3, (double)histogram->sum / histogram->count / 1e3, p50 / 1e3, 
+            p99 / 1e3, histogram->max / 1e3);
+    }
+    fflush(file);
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
@@ -0,0 +1,208 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Declares the instrumentation hooks used by the modules of the library.
+ *
+ * Without `RASPI_APA102_ENABLE_STATS`, all hooks are empty inline functions.
+ */
+
+#ifndef STATS_INTERNAL_H
+#define STATS_INTERNAL_H
+
+#include <RaspiAPA102/Stats.h>
+#include <time.h>
+
+/* ============================================================================================== */
+/* Internal types                                                                                 */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102StatsTimer` struct.
+ */
+typedef struct RaspiAPA102StatsTimer_
+{
+    /**
+     * @brief   The start time of the frame.
+     */
+    uint64_t start;
+    /**
+     * @brief   The end time of the last recorded stage.
+     */
+    uint64_t last;
+} RaspiAPA102StatsTimer;
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Histogram                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Clears the given histogram.
+ *
+ * @param   histogram   A pointer to the `RaspiAPA102StatsHistogram` struct.
+ */
+void RaspiAPA102StatsHistogramReset(RaspiAPA102StatsHistogram* histogram);
+
+/**
+ * @brief   Records a value in the given histogram.
+ *
+ * @param   histogram   A pointer to the `RaspiAPA102StatsHistogram` struct.
+ * @param   value       The duration in nanoseconds.
+ *
+ * The histograms are available independent of `RASPI_APA102_ENABLE_STATS`.
+ */
+void RaspiAPA102StatsHistogramRecord(RaspiAPA102StatsHistogram* histogram, uint64_t value);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Device                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+#ifdef RASPI_APA102_ENABLE_STATS
+
+/**
+ * @brief   Records a value in the histogram of the given stage.
+ *
+ * @param   stats   A pointer to the `RaspiAPA102Stats` struct.
+ * @param   stage   The stage.
+ * @param   value   The duration in nanoseconds.
+ */
+void RaspiAPA102StatsRecord(RaspiAPA102Stats* stats, RaspiAPA102StatsStage stage, uint64_t value);
+
+/**
+ * @brief   Records a completed frame.
+ *
+ * @param   stats   A pointer to the `RaspiAPA102Stats` struct.
+ * @param   start   The start time of the frame.
+ * @param   end     The end time of the frame.
+ * @param   bytes   The number of bytes sent.
+ * @param   status  The status code of the frame.
+ */
+void RaspiAPA102StatsRecordFrame(RaspiAPA102Stats* stats, uint64_t start, uint64_t end, 
+    size_t bytes, int status);
+
+/**
+ * @brief   Returns the current value of the monotonic clock in nanoseconds.
+ *
+ * @return  The current value of the monotonic clock in nanoseconds.
+ */
+static inline uint64_t RaspiAPA102StatsNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief   Starts timing a frame or stage of the given device.
+ *
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   timer   A pointer to the `RaspiAPA102StatsTimer` struct.
+ */
+static inline void RaspiAPA102StatsTimerStart(const RaspiAPA102Device* device, 
+    RaspiAPA102StatsTimer* timer)
+{
+    if (device->stats)
+    {
+        timer->start = RaspiAPA102StatsNow();
+        timer->last = timer->start;
+    }
+}
+
+/**
+ * @brief   Records the time since the last stage for the given stage.
+ *
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   timer   A pointer to the `RaspiAPA102StatsTimer` struct.
+ * @param   stage   The stage.
+ */
+static inline void RaspiAPA102StatsTimerLap(const RaspiAPA102Device* device, 
+    RaspiAPA102StatsTimer* timer, RaspiAPA102StatsStage stage)
+{
+    if (device->stats)
+    {
+        const uint64_t now = RaspiAPA102StatsNow();
+        RaspiAPA102StatsRecord(device->stats, stage, now - timer->last);
+        timer->last = now;
+    }
+}
+
+/**
+ * @brief   Records a completed frame.
+ *
+ * @param   device  A pointer to the `RaspiAPA102Device` struct.
+ * @param   timer   A pointer to the `RaspiAPA102StatsTimer` struct.
+ * @param   bytes   The number of bytes sent.
+ * @param   status  The status code of the frame.
+ */
+static inline void RaspiAPA102StatsTimerFrame(const RaspiAPA102Device* device, 
+    RaspiAPA102StatsTimer* timer, size_t bytes, int status)
+{
+    if (device->stats)
+    {
+        RaspiAPA102StatsRecordFrame(device->stats, timer->start, RaspiAPA102StatsNow(), bytes, 
+            status);
+    }
+}
+
+#else
+
+static inline void RaspiAPA102StatsTimerStart(const RaspiAPA102Device* device, 
+    RaspiAPA102StatsTimer* timer)
+{
+    (void)device;
+    (void)timer;
+}
+
+static inline void RaspiAPA102StatsTimerLap(const RaspiAPA102Device* device, 
+    RaspiAPA102StatsTimer* timer, RaspiAPA102StatsStage stage)
+{
+    (void)device;
+    (void)timer;
+    (void)stage;
+}
+
+static inline void RaspiAPA102StatsTimerFrame(const RaspiAPA102Device* device, 
+    RaspiAPA102StatsTimer* timer, size_t bytes, int status)
+{
+    (void)device;
+    (void)timer;
+    (void)bytes;
+    (void)status;
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#endif /* STATS_INTERNAL_H */
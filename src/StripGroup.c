@@ -0,0 +1,322 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/StripGroup.h>
+#include <stdlib.h>
+#include <string.h>
+#include <StatsInternal.h>
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Workers                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   The entry point of a worker thread.
+ *
+ * @param   argument    A pointer to the `RaspiAPA102StripWorker` struct.
+ *
+ * @return  Always `NULL`.
+ */
+static void* RaspiAPA102StripWorkerThread(void* argument)
+{
+    RaspiAPA102StripWorker* const worker = argument;
+    RaspiAPA102StripGroup* const group = worker->group;
+
+    uint64_t generation = 0;
+
+    pthread_mutex_lock(&group->mutex);
+    for (;;)
+    {
+        while (!group->stop && (group->generation == generation))
+        {
+            pthread_cond_wait(&group->committed, &group->mutex);
+        }
+        if (group->stop)
+        {
+            break;
+        }
+        generation = group->generation;
+
+        pthread_mutex_unlock(&group->mutex);
+        const int status = RaspiAPA102DeviceCommit(worker->device);
+        pthread_mutex_lock(&group->mutex);
+
+        if (status < 0)
+        {
+            group->status = status;
+        }
+        if (--group->pending == 0)
+        {
+            pthread_cond_broadcast(&group->completed);
+        }
+    }
+    pthread_mutex_unlock(&group->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief   Stops and joins the first `count` worker threads.
+ *
+ * @param   group   A pointer to the `RaspiAPA102StripGroup` struct.
+ * @param   count   The number of running worker threads.
+ */
+static void RaspiAPA102StripGroupStopWorkers(RaspiAPA102StripGroup* group, size_t count)
+{
+    pthread_mutex_lock(&group->mutex);
+    group->stop = true;
+    pthread_cond_broadcast(&group->committed);
+    pthread_mutex_unlock(&group->mutex);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        pthread_join(group->workers[i].thread, NULL);
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Mapping                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Copies the canvas range of the given segment into the transmit buffer of its device.
+ *
+ * @param   group   A pointer to the `RaspiAPA102StripGroup` struct.
+ * @param   segment A pointer to the `RaspiAPA102StripSegment` struct.
+ */
+static void RaspiAPA102StripGroupMapSegment(RaspiAPA102StripGroup* group, 
+    const RaspiAPA102StripSegment* segment)
+{
+    RaspiAPA102ColorQuad* colors;
+    RaspiAPA102DeviceGetBuffer(segment->device, &colors, NULL);
+
+    RaspiAPA102StatsTimer timer = { 0 };
+    RaspiAPA102StatsTimerStart(segment->device, &timer);
+
+    const RaspiAPA102ColorQuad* const source = &group->canvas[segment->canvas_offset];
+    RaspiAPA102ColorQuad* const destination = &colors[segment->device_offset];
+
+    if (segment->reversed)
+    {
+        for (size_t i = 0; i < segment->length; ++i)
+        {
+            destination[segment->length - 1 - i] = source[i];
+        }
+    }
+    else
+    {
+        memcpy(destination, source, segment->length * sizeof(RaspiAPA102ColorQuad));
+    }
+    RaspiAPA102StatsTimerLap(segment->device, &timer, RASPI_APA102_STATS_STAGE_PACK);
+
+    RaspiAPA102DeviceMarkDirty(segment->device, segment->device_offset, segment->length);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Strip Group                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102StripGroupInit(RaspiAPA102StripGroup* group, size_t canvas_size, 
+    const RaspiAPA102StripSegment* segments, size_t segment_count)
+{
+    if (!group || !canvas_size || !segments || !segment_count)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < segment_count; ++i)
+    {
+        const RaspiAPA102StripSegment* const segment = &segments[i];
+        if (!segment->device || !segment->device->frame || !segment->length ||
+            (segment->canvas_offset >= canvas_size) || 
+            (segment->length > canvas_size - segment->canvas_offset) ||
+            (segment->device_offset >= segment->device->count) ||
+            (segment->length > segment->device->count - segment->device_offset))
+        {
+            return -1;
+        }
+    }
+
+    memset(group, 0, sizeof(*group));
+    group->canvas_size   = canvas_size;
+    group->segment_count = segment_count;
+    group->canvas        = calloc(canvas_size, sizeof(RaspiAPA102ColorQuad));
+    group->segments      = malloc(segment_count * sizeof(RaspiAPA102StripSegment));
+    group->workers       = calloc(segment_count, sizeof(RaspiAPA102StripWorker));
+    if (!group->canvas || !group->segments || !group->workers)
+    {
+        goto cleanup;
+    }
+    memcpy(group->segments, segments, segment_count * sizeof(RaspiAPA102StripSegment));
+    for (size_t i = 0; i < canvas_size; ++i)
+    {
+        RaspiAPA102ColorQuadInit(&group->canvas[i], 0, 0, 0, 0);
+    }
+
+    // One worker for each distinct device
+    for (size_t i = 0; i < segment_count; ++i)
+    {
+        size_t j = 0;
+        while ((j < group->worker_count) && (group->workers[j].device != segments[i].device))
+        {
+            ++j;
+        }
+        if (j == group->worker_count)
+        {
+            group->workers[j].group  = group;
+            group->workers[j].device = segments[i].device;
+            ++group->worker_count;
+        }
+    }
+
+    pthread_mutex_init(&group->mutex, NULL);
+    pthread_cond_init(&group->committed, NULL);
+    pthread_cond_init(&group->completed, NULL);
+
+    for (size_t i = 0; i < group->worker_count; ++i)
+    {
+        if (pthread_create(&group->workers[i].thread, NULL, &RaspiAPA102StripWorkerThread, 
+            &group->workers[i]) != 0)
+        {
+            RaspiAPA102StripGroupStopWorkers(group, i);
+            pthread_cond_destroy(&group->completed);
+            pthread_cond_destroy(&group->committed);
+            pthread_mutex_destroy(&group->mutex);
+            goto cleanup;
+        }
+    }
+
+    return 0;
+
+cleanup:
+    free(group->workers);
+    free(group->segments);
+    free(group->canvas);
+    memset(group, 0, sizeof(*group));
+
+    return -1;
+}
+
+int RaspiAPA102StripGroupGetCanvas(RaspiAPA102StripGroup* group, RaspiAPA102ColorQuad** canvas, 
+    size_t* size)
+{
+    if (!group || !canvas)
+    {
+        return -1;
+    }
+
+    *canvas = group->canvas;
+    if (size)
+    {
+        *size = group->canvas_size;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102StripGroupCommit(RaspiAPA102StripGroup* group)
+{
+    if (!group || !group->canvas)
+    {
+        return -1;
+    }
+
+    // The transmit buffers are owned by the workers until the previous frame completed
+    pthread_mutex_lock(&group->mutex);
+    while (group->pending > 0)
+    {
+        pthread_cond_wait(&group->completed, &group->mutex);
+    }
+    pthread_mutex_unlock(&group->mutex);
+
+    for (size_t i = 0; i < group->segment_count; ++i)
+    {
+        RaspiAPA102StripGroupMapSegment(group, &group->segments[i]);
+    }
+
+    pthread_mutex_lock(&group->mutex);
+    ++group->generation;
+    group->pending = group->worker_count;
+    group->status = 0;
+    pthread_cond_broadcast(&group->committed);
+    pthread_mutex_unlock(&group->mutex);
+
+    return 0;
+}
+
+int RaspiAPA102StripGroupWait(RaspiAPA102StripGroup* group)
+{
+    if (!group || !group->canvas)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&group->mutex);
+    while (group->pending > 0)
+    {
+        pthread_cond_wait(&group->completed, &group->mutex);
+    }
+    const int status = group->status;
+    pthread_mutex_unlock(&group->mutex);
+
+    return status;
+}
+
+int RaspiAPA102StripGroupDestroy(RaspiAPA102StripGroup* group)
+{
+    if (!group || !group->canvas)
+    {
+        return -1;
+    }
+
+    RaspiAPA102StripGroupWait(group);
+    RaspiAPA102StripGroupStopWorkers(group, group->worker_count);
+
+    pthread_cond_destroy(&group->completed);
+    pthread_cond_destroy(&group->committed);
+    pthread_mutex_destroy(&group->mutex);
+
+    free(group->workers);
+    free(group->segments);
+    free(group->canvas);
+    memset(group, 0, sizeof(*group));
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
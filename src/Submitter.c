@@ -0,0 +1,829 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/Submitter.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/spi/spidev.h>
+#include <TransportInternal.h>
+
+#if defined(__has_include)
+#   if __has_include(<linux/io_uring.h>)
+#       include <linux/io_uring.h>
+#   endif
+#endif
+
+// `IORING_OP_WRITE` with the current file position requires a 5.6 kernel (and headers)
+#if defined(IORING_FEAT_RW_CUR_POS) && defined(__NR_io_uring_setup) && \
+    defined(__NR_io_uring_enter)
+#   define RASPI_APA102_SUBMITTER_IO_URING
+#endif
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+#define RASPI_APA102_NSEC_PER_SEC 1000000000ULL
+
+/**
+ * @brief   The maximum number of bytes per write, if a target has no chunk size.
+ */
+#define RASPI_APA102_SUBMITTER_MAX_CHUNK (1u << 30)
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Time                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the current value of the monotonic clock in nanoseconds.
+ *
+ * @return  The current value of the monotonic clock in nanoseconds.
+ */
+static uint64_t RaspiAPA102SubmitterNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * RASPI_APA102_NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* io_uring                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+#ifdef RASPI_APA102_SUBMITTER_IO_URING
+
+/**
+ * @brief   Creates the `io_uring` instance of the given submitter and maps its rings.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ *
+ * The submission queue holds one entry per target, as every target has at most one write in 
+ * flight.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SubmitterSetupRing(RaspiAPA102Submitter* submitter)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    const int fd = (int)syscall(__NR_io_uring_setup, (unsigned)submitter->capacity, &params);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (!(params.features & IORING_FEAT_RW_CUR_POS))
+    {
+        close(fd);
+        return -1;
+    }
+    submitter->ring_fd = fd;
+
+    submitter->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    submitter->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP);
+    if (single_mmap && (submitter->cq_ring_size > submitter->sq_ring_size))
+    {
+        submitter->sq_ring_size = submitter->cq_ring_size;
+    }
+
+    void* ring = mmap(NULL, submitter->sq_ring_size, PROT_READ | PROT_WRITE, 
+        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED)
+    {
+        return -1;
+    }
+    submitter->sq_ring = ring;
+
+    if (!single_mmap)
+    {
+        ring = mmap(NULL, submitter->cq_ring_size, PROT_READ | PROT_WRITE, 
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring == MAP_FAILED)
+        {
+            return -1;
+        }
+        submitter->cq_ring = ring;
+    }
+
+    submitter->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* const sqes = mmap(NULL, submitter->sqes_size, PROT_READ | PROT_WRITE, 
+        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        return -1;
+    }
+    submitter->sqes = sqes;
+
+    uint8_t* const sq = submitter->sq_ring;
+    uint8_t* const cq = single_mmap ? sq : submitter->cq_ring;
+    submitter->sq_tail  = (volatile uint32_t*)(sq + params.sq_off.tail);
+    submitter->sq_mask  = *(const uint32_t*)(sq + params.sq_off.ring_mask);
+    submitter->sq_array = (uint32_t*)(sq + params.sq_off.array);
+    submitter->cq_head  = (volatile uint32_t*)(cq + params.cq_off.head);
+    submitter->cq_tail  = (volatile uint32_t*)(cq + params.cq_off.tail);
+    submitter->cq_mask  = *(const uint32_t*)(cq + params.cq_off.ring_mask);
+    submitter->cqes     = cq + params.cq_off.cqes;
+
+    return 0;
+}
+
+/**
+ * @brief   Submits the prepared submission queue entries and optionally waits for completions.
+ *
+ * @param   submitter       A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   min_complete    The number of completions to wait for.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SubmitterEnter(RaspiAPA102Submitter* submitter, unsigned min_complete)
+{
+    const unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+    for (;;)
+    {
+        const long result = syscall(__NR_io_uring_enter, submitter->ring_fd, 
+            submitter->sq_pending, min_complete, flags, NULL, 0);
+        if (result >= 0)
+        {
+            submitter->sq_pending -= (uint32_t)result;
+            return 0;
+        }
+        if ((errno == EINTR) && !min_complete)
+        {
+            continue;
+        }
+        // An interrupted wait or a temporary lack of resources is retried by the caller
+        return ((errno == EINTR) || (errno == EAGAIN) || (errno == EBUSY)) ? 0 : -1;
+    }
+}
+
+/**
+ * @brief   Prepares a write in the submission queue.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   index       The index of the target.
+ * @param   data        A pointer to the data.
+ * @param   size        The number of bytes to write.
+ */
+static void RaspiAPA102SubmitterPrepareWrite(RaspiAPA102Submitter* submitter, size_t index, 
+    const uint8_t* data, size_t size)
+{
+    // The submitter is the only producer, so the tail can be read without synchronization
+    const uint32_t tail = *submitter->sq_tail;
+    const uint32_t slot = tail & submitter->sq_mask;
+
+    struct io_uring_sqe* const sqe = &((struct io_uring_sqe*)submitter->sqes)[slot];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode    = IORING_OP_WRITE;
+    sqe->fd        = submitter->targets[index].fd;
+    sqe->addr      = (uintptr_t)data;
+    sqe->len       = (uint32_t)size;
+    sqe->off       = (uint64_t)-1;
+    sqe->user_data = index;
+
+    submitter->sq_array[slot] = slot;
+    __atomic_store_n(submitter->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++submitter->sq_pending;
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Targets                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Returns the write at the given position of the queue of the given target.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   target      A pointer to the `RaspiAPA102SubmitterTarget` struct.
+ * @param   position    The position relative to the oldest queued write.
+ *
+ * @return  A pointer to the `RaspiAPA102SubmitterWrite` struct.
+ */
+static inline RaspiAPA102SubmitterWrite* RaspiAPA102SubmitterGetWrite(
+    const RaspiAPA102Submitter* submitter, const RaspiAPA102SubmitterTarget* target, 
+    size_t position)
+{
+    return &target->writes[(target->head + position) % submitter->depth];
+}
+
+/**
+ * @brief   Appends a write to the queue of the given target.
+ *
+ * @param   target      A pointer to the `RaspiAPA102SubmitterTarget` struct.
+ * @param   data        A pointer to the data.
+ * @param   size        The size of the data in bytes.
+ * @param   frame_end   Signals, if the write completes a frame.
+ *
+ * If the queue is full, the incomplete frame at the end of the queue is discarded, so that later 
+ * frames are not corrupted.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SubmitterEnqueue(RaspiAPA102SubmitterTarget* target, const uint8_t* data, 
+    size_t size, bool frame_end)
+{
+    const RaspiAPA102Submitter* const submitter = target->submitter;
+
+    if (target->length == submitter->depth)
+    {
+        while ((target->length > target->submitted) && 
+            !RaspiAPA102SubmitterGetWrite(submitter, target, target->length - 1)->frame_end)
+        {
+            --target->length;
+        }
+        return -1;
+    }
+
+    RaspiAPA102SubmitterWrite* const write = 
+        RaspiAPA102SubmitterGetWrite(submitter, target, target->length++);
+    write->data      = data;
+    write->size      = size;
+    write->submit_ns = 0;
+    write->frame_end = frame_end;
+
+    return 0;
+}
+
+/**
+ * @brief   Accounts the result of a write of the given target.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   target      A pointer to the `RaspiAPA102SubmitterTarget` struct.
+ * @param   result      The number of written bytes, or a negative error code.
+ * @param   frames      Incremented for every completed frame.
+ */
+static void RaspiAPA102SubmitterAdvance(RaspiAPA102Submitter* submitter, 
+    RaspiAPA102SubmitterTarget* target, long result, size_t* frames)
+{
+    if (result <= 0)
+    {
+        // Drop the remaining writes of the affected frame
+        bool frame_end = false;
+        while (target->submitted && !frame_end)
+        {
+            frame_end = RaspiAPA102SubmitterGetWrite(submitter, target, 0)->frame_end;
+            target->head = (target->head + 1) % submitter->depth;
+            --target->length;
+            --target->submitted;
+        }
+        target->offset = 0;
+        ++target->stats.errors;
+        return;
+    }
+
+    const RaspiAPA102SubmitterWrite* const write = 
+        RaspiAPA102SubmitterGetWrite(submitter, target, 0);
+    target->stats.bytes += (uint64_t)result;
+    target->offset += (size_t)result;
+    if (target->offset < write->size)
+    {
+        return;
+    }
+
+    target->offset = 0;
+    target->head = (target->head + 1) % submitter->depth;
+    --target->length;
+    --target->submitted;
+    if (!write->frame_end)
+    {
+        return;
+    }
+
+    const uint64_t now = RaspiAPA102SubmitterNow();
+    const uint64_t latency = now - write->submit_ns;
+    RaspiAPA102SubmitterStats* const stats = &target->stats;
+    ++stats->frames;
+    stats->last_completion_ns = now;
+    stats->last_latency_ns    = latency;
+    stats->total_latency_ns  += latency;
+    if (latency > stats->max_latency_ns)
+    {
+        stats->max_latency_ns = latency;
+    }
+    ++*frames;
+}
+
+/**
+ * @brief   Issues the next write of the given target, if it is idle.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   index       The index of the target.
+ * @param   frames      Incremented for every completed frame.
+ *
+ * The `poll` backend keeps writing until the file descriptor would block.
+ */
+static void RaspiAPA102SubmitterProgress(RaspiAPA102Submitter* submitter, size_t index, 
+    size_t* frames)
+{
+    RaspiAPA102SubmitterTarget* const target = &submitter->targets[index];
+
+    while (!target->busy && target->submitted)
+    {
+        const RaspiAPA102SubmitterWrite* const entry = 
+            RaspiAPA102SubmitterGetWrite(submitter, target, 0);
+        const uint8_t* const data = entry->data + target->offset;
+        size_t size = entry->size - target->offset;
+        if (size > target->chunk_size)
+        {
+            size = target->chunk_size;
+        }
+
+#ifdef RASPI_APA102_SUBMITTER_IO_URING
+        if (submitter->backend == RASPI_APA102_SUBMITTER_BACKEND_IO_URING)
+        {
+            RaspiAPA102SubmitterPrepareWrite(submitter, index, data, size);
+            target->busy = true;
+            ++submitter->in_flight;
+            return;
+        }
+#endif
+
+        const ssize_t result = write(target->fd, data, size);
+        if ((result < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        if ((result < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+        {
+            target->busy = true;
+            ++submitter->in_flight;
+            return;
+        }
+        RaspiAPA102SubmitterAdvance(submitter, target, (long)result, frames);
+    }
+}
+
+/**
+ * @brief   Adds a target.
+ *
+ * @param   submitter   A pointer to the `RaspiAPA102Submitter` struct.
+ * @param   fd          The file descriptor.
+ * @param   chunk_size  The maximum number of bytes per write, or `0` for no limit.
+ * @param   owned       Signals, if the file descriptor is closed by the submitter.
+ * @param   target      Receives the index of the target.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SubmitterAdd(RaspiAPA102Submitter* submitter, int fd, size_t chunk_size, 
+    bool owned, size_t* target)
+{
+    if (submitter->target_count == submitter->capacity)
+    {
+        return -1;
+    }
+
+    RaspiAPA102SubmitterTarget* const entry = &submitter->targets[submitter->target_count];
+    memset(entry, 0, sizeof(*entry));
+    entry->writes = calloc(submitter->depth, sizeof(RaspiAPA102SubmitterWrite));
+    if (!entry->writes)
+    {
+        return -1;
+    }
+    entry->submitter  = submitter;
+    entry->fd         = fd;
+    entry->owned      = owned;
+    entry->chunk_size = (chunk_size && (chunk_size < RASPI_APA102_SUBMITTER_MAX_CHUNK)) ? 
+        chunk_size : RASPI_APA102_SUBMITTER_MAX_CHUNK;
+
+    *target = submitter->target_count++;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transport                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Queues the given buffer for the target.
+ *
+ * @param   context A pointer to the `RaspiAPA102SubmitterTarget` struct.
+ * @param   buffer  A pointer to the data buffer.
+ * @param   size    The number of bytes to write.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SubmitterTransportWrite(void* context, const uint8_t* buffer, size_t size)
+{
+    if (!size)
+    {
+        return 0;
+    }
+
+    return RaspiAPA102SubmitterEnqueue(context, buffer, size, false);
+}
+
+/**
+ * @brief   Completes the current frame of the target.
+ *
+ * @param   context A pointer to the `RaspiAPA102SubmitterTarget` struct.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SubmitterTransportFlush(void* context)
+{
+    RaspiAPA102SubmitterTarget* const target = context;
+
+    if (target->length > target->submitted)
+    {
+        RaspiAPA102SubmitterGetWrite(target->submitter, target, target->length - 1)->frame_end = 
+            true;
+    }
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+int RaspiAPA102SubmitterInit(RaspiAPA102Submitter* submitter, RaspiAPA102SubmitterBackend backend, 
+    size_t capacity, size_t depth)
+{
+    if (!submitter || ((unsigned)backend > RASPI_APA102_SUBMITTER_BACKEND_MAX_VALUE) || 
+        !capacity || (capacity > UINT16_MAX) || !depth)
+    {
+        return -1;
+    }
+
+    memset(submitter, 0, sizeof(*submitter));
+    submitter->ring_fd  = -1;
+    submitter->capacity = capacity;
+    submitter->depth    = depth;
+
+    submitter->targets  = calloc(capacity, sizeof(RaspiAPA102SubmitterTarget));
+    submitter->poll_fds = calloc(capacity, sizeof(struct pollfd));
+    if (!submitter->targets || !submitter->poll_fds)
+    {
+        RaspiAPA102SubmitterDestroy(submitter);
+        return -1;
+    }
+
+    submitter->backend = RASPI_APA102_SUBMITTER_BACKEND_POLL;
+    if (backend != RASPI_APA102_SUBMITTER_BACKEND_POLL)
+    {
+#ifdef RASPI_APA102_SUBMITTER_IO_URING
+        if (RaspiAPA102SubmitterSetupRing(submitter) == 0)
+        {
+            submitter->backend = RASPI_APA102_SUBMITTER_BACKEND_IO_URING;
+        }
+#endif
+        if ((submitter->backend != RASPI_APA102_SUBMITTER_BACKEND_IO_URING) && 
+            (backend == RASPI_APA102_SUBMITTER_BACKEND_IO_URING))
+        {
+            RaspiAPA102SubmitterDestroy(submitter);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int RaspiAPA102SubmitterGetBackend(const RaspiAPA102Submitter* submitter, 
+    RaspiAPA102SubmitterBackend* backend)
+{
+    if (!submitter || !submitter->targets || !backend)
+    {
+        return -1;
+    }
+
+    *backend = submitter->backend;
+
+    return 0;
+}
+
+int RaspiAPA102SubmitterOpenTarget(RaspiAPA102Submitter* submitter, const char* path, 
+    uint32_t speed_hz, size_t* target)
+{
+    if (!submitter || !submitter->targets || !path || !speed_hz || !target)
+    {
+        return -1;
+    }
+
+    // `io_uring` waits for blocking files itself, non-blocking files would complete with `EAGAIN`
+    const int flags = O_WRONLY | O_CLOEXEC | 
+        ((submitter->backend == RASPI_APA102_SUBMITTER_BACKEND_POLL) ? O_NONBLOCK : 0);
+    const int fd = open(path, flags);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // Stand-ins for `spidev` nodes reject the configuration requests
+    const uint8_t mode = SPI_MODE_0;
+    const uint8_t bits_per_word = 8;
+    ioctl(fd, SPI_IOC_WR_MODE, &mode);
+    ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits_per_word);
+    ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz);
+
+    if (RaspiAPA102SubmitterAdd(submitter, fd, RaspiAPA102SPIDevGetBufsiz(), true, target) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return 0;
+}
+
+int RaspiAPA102SubmitterAddTarget(RaspiAPA102Submitter* submitter, int fd, size_t chunk_size, 
+    size_t* target)
+{
+    if (!submitter || !submitter->targets || (fd < 0) || !target)
+    {
+        return -1;
+    }
+
+    if (submitter->backend == RASPI_APA102_SUBMITTER_BACKEND_POLL)
+    {
+        const int flags = fcntl(fd, F_GETFL);
+        if ((flags < 0) || (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0))
+        {
+            return -1;
+        }
+    }
+
+    return RaspiAPA102SubmitterAdd(submitter, fd, chunk_size, false, target);
+}
+
+int RaspiAPA102SubmitterGetTransport(RaspiAPA102Submitter* submitter, size_t target, 
+    RaspiAPA102Transport* transport)
+{
+    if (!submitter || !submitter->targets || (target >= submitter->target_count) || !transport)
+    {
+        return -1;
+    }
+
+    transport->context = &submitter->targets[target];
+    transport->open    = NULL;
+    transport->write   = &RaspiAPA102SubmitterTransportWrite;
+    transport->flush   = &RaspiAPA102SubmitterTransportFlush;
+    transport->close   = NULL;
+
+    return 0;
+}
+
+int RaspiAPA102SubmitterQueueFrame(RaspiAPA102Submitter* submitter, size_t target, 
+    const uint8_t* frame, size_t size)
+{
+    if (!submitter || !submitter->targets || (target >= submitter->target_count) || !frame || 
+        !size)
+    {
+        return -1;
+    }
+
+    return RaspiAPA102SubmitterEnqueue(&submitter->targets[target], frame, size, true);
+}
+
+int RaspiAPA102SubmitterSubmit(RaspiAPA102Submitter* submitter)
+{
+    if (!submitter || !submitter->targets)
+    {
+        return -1;
+    }
+
+    const uint64_t now = RaspiAPA102SubmitterNow();
+    for (size_t i = 0; i < submitter->target_count; ++i)
+    {
+        RaspiAPA102SubmitterTarget* const target = &submitter->targets[i];
+
+        // Release all complete frames; the writes of an incomplete frame stay queued
+        for (size_t j = target->submitted; j < target->length; ++j)
+        {
+            RaspiAPA102SubmitterWrite* const write = 
+                RaspiAPA102SubmitterGetWrite(submitter, target, j);
+            if (write->frame_end)
+            {
+                write->submit_ns = now;
+                target->submitted = j + 1;
+            }
+        }
+
+        // Non-blocking writes may complete frames right away; they are reported by the next reap
+        RaspiAPA102SubmitterProgress(submitter, i, &submitter->completed);
+    }
+
+#ifdef RASPI_APA102_SUBMITTER_IO_URING
+    if (submitter->sq_pending)
+    {
+        return RaspiAPA102SubmitterEnter(submitter, 0);
+    }
+#endif
+
+    return 0;
+}
+
+int RaspiAPA102SubmitterReap(RaspiAPA102Submitter* submitter, bool wait, size_t* frames)
+{
+    if (!submitter || !submitter->targets)
+    {
+        return -1;
+    }
+
+    size_t completed = submitter->completed;
+    submitter->completed = 0;
+    int status = 0;
+
+#ifdef RASPI_APA102_SUBMITTER_IO_URING
+    if (submitter->backend == RASPI_APA102_SUBMITTER_BACKEND_IO_URING)
+    {
+        if (submitter->sq_pending || (wait && submitter->in_flight))
+        {
+            status = RaspiAPA102SubmitterEnter(submitter, 
+                (wait && submitter->in_flight) ? 1 : 0);
+        }
+
+        uint32_t head = *submitter->cq_head;
+        const uint32_t tail = __atomic_load_n(submitter->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            const struct io_uring_cqe* const cqe = 
+                &((const struct io_uring_cqe*)submitter->cqes)[head & submitter->cq_mask];
+            const size_t index = (size_t)cqe->user_data;
+            const int result = cqe->res;
+
+            RaspiAPA102SubmitterTarget* const target = &submitter->targets[index];
+            target->busy = false;
+            --submitter->in_flight;
+            if ((result != -EAGAIN) && (result != -EINTR))
+            {
+                RaspiAPA102SubmitterAdvance(submitter, target, result, &completed);
+            }
+            RaspiAPA102SubmitterProgress(submitter, index, &completed);
+        }
+        __atomic_store_n(submitter->cq_head, head, __ATOMIC_RELEASE);
+
+        if ((status == 0) && submitter->sq_pending)
+        {
+            status = RaspiAPA102SubmitterEnter(submitter, 0);
+        }
+    }
+    else
+#endif
+    if (submitter->in_flight)
+    {
+        struct pollfd* const fds = submitter->poll_fds;
+        nfds_t count = 0;
+        for (size_t i = 0; i < submitter->target_count; ++i)
+        {
+            if (submitter->targets[i].busy)
+            {
+                fds[count].fd      = submitter->targets[i].fd;
+                fds[count].events  = POLLOUT;
+                fds[count].revents = 0;
+                ++count;
+            }
+        }
+
+        const int result = poll(fds, count, wait ? -1 : 0);
+        if ((result < 0) && (errno != EINTR))
+        {
+            status = -1;
+        }
+
+        nfds_t position = 0;
+        for (size_t i = 0; (result > 0) && (i < submitter->target_count); ++i)
+        {
+            RaspiAPA102SubmitterTarget* const target = &submitter->targets[i];
+            if (!target->busy)
+            {
+                continue;
+            }
+            const short revents = fds[position++].revents;
+            if (!revents)
+            {
+                continue;
+            }
+
+            target->busy = false;
+            --submitter->in_flight;
+            if (!(revents & POLLOUT))
+            {
+                // The reader is gone or the file descriptor is invalid
+                RaspiAPA102SubmitterAdvance(submitter, target, -EPIPE, &completed);
+            }
+            RaspiAPA102SubmitterProgress(submitter, i, &completed);
+        }
+    }
+
+    if (frames)
+    {
+        *frames = completed;
+    }
+
+    return status;
+}
+
+int RaspiAPA102SubmitterWait(RaspiAPA102Submitter* submitter)
+{
+    if (!submitter || !submitter->targets)
+    {
+        return -1;
+    }
+
+    while (submitter->in_flight || submitter->sq_pending)
+    {
+        if (RaspiAPA102SubmitterReap(submitter, true, NULL) < 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int RaspiAPA102SubmitterGetStats(const RaspiAPA102Submitter* submitter, size_t target, 
+    RaspiAPA102SubmitterStats* stats)
+{
+    if (!submitter || !submitter->targets || (target >= submitter->target_count) || !stats)
+    {
+        return -1;
+    }
+
+    *stats = submitter->targets[target].stats;
+
+    return 0;
+}
+
+int RaspiAPA102SubmitterDestroy(RaspiAPA102Submitter* submitter)
+{
+    if (!submitter)
+    {
+        return -1;
+    }
+
+    if (submitter->sqes)
+    {
+        munmap(submitter->sqes, submitter->sqes_size);
+    }
+    if (submitter->cq_ring)
+    {
+        munmap(submitter->cq_ring, submitter->cq_ring_size);
+    }
+    if (submitter->sq_ring)
+    {
+        munmap(submitter->sq_ring, submitter->sq_ring_size);
+    }
+    if (submitter->ring_fd >= 0)
+    {
+        close(submitter->ring_fd);
+    }
+
+    for (size_t i = 0; submitter->targets && (i < submitter->target_count); ++i)
+    {
+        if (submitter->targets[i].owned)
+        {
+            close(submitter->targets[i].fd);
+        }
+        free(submitter->targets[i].writes);
+    }
+    free(submitter->targets);
+    free(submitter->poll_fds);
+    memset(submitter, 0, sizeof(*submitter));
+    submitter->ring_fd = -1;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
@@ -0,0 +1,438 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <RaspiAPA102/ThreadPool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   The distance between two tile queues in `uint32_t` elements, so that every queue lives 
+ *          in its own cache line.
+ */
+#define RASPI_APA102_THREAD_POOL_QUEUE_STRIDE (64 / sizeof(uint32_t))
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Queues                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Packs the given range of tile indices into a queue word.
+ *
+ * @param   begin   The index of the first tile.
+ * @param   end     The index behind the last tile.
+ *
+ * @return  The queue word.
+ */
+static inline uint32_t RaspiAPA102ThreadPoolPack(uint32_t begin, uint32_t end)
+{
+    return begin | (end << 16);
+}
+
+/**
+ * @brief   Returns the tile queue of the given thread.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   index   The index of the thread (`0` is the calling thread).
+ *
+ * @return  A pointer to the queue word.
+ */
+static inline uint32_t* RaspiAPA102ThreadPoolGetQueue(RaspiAPA102ThreadPool* pool, size_t index)
+{
+    return &pool->queues[index * RASPI_APA102_THREAD_POOL_QUEUE_STRIDE];
+}
+
+/**
+ * @brief   Takes the first tile from the queue of the given thread.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   index   The index of the thread.
+ * @param   tile    Receives the index of the tile.
+ *
+ * @return  `true`, if a tile was taken or `false`, if the queue is empty.
+ */
+static bool RaspiAPA102ThreadPoolPop(RaspiAPA102ThreadPool* pool, size_t index, uint32_t* tile)
+{
+    uint32_t* const queue = RaspiAPA102ThreadPoolGetQueue(pool, index);
+
+    uint32_t value = __atomic_load_n(queue, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        const uint32_t begin = value & 0xFFFF;
+        const uint32_t end = value >> 16;
+        if (begin >= end)
+        {
+            return false;
+        }
+        if (__atomic_compare_exchange_n(queue, &value, RaspiAPA102ThreadPoolPack(begin + 1, end), 
+            false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *tile = begin;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief   Steals the back half of the first non-empty queue of another thread.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   index   The index of the stealing thread. Its own queue has to be empty.
+ * @param   tile    Receives the index of the first stolen tile. The remaining stolen tiles are 
+ *                  moved to the queue of the stealing thread.
+ *
+ * @return  `true`, if a tile was stolen or `false`, if all queues are empty.
+ */
+static bool RaspiAPA102ThreadPoolSteal(RaspiAPA102ThreadPool* pool, size_t index, uint32_t* tile)
+{
+    const size_t count = pool->worker_count + 1;
+    for (size_t i = 1; i < count; ++i)
+    {
+        uint32_t* const queue = RaspiAPA102ThreadPoolGetQueue(pool, (index + i) % count);
+
+        uint32_t value = __atomic_load_n(queue, __ATOMIC_ACQUIRE);
+        for (;;)
+        {
+            const uint32_t begin = value & 0xFFFF;
+            const uint32_t end = value >> 16;
+            if (begin >= end)
+            {
+                break;
+            }
+
+            // The owner keeps the front half, so both continue on adjacent pixels
+            const uint32_t stolen = (end - begin + 1) / 2;
+            if (__atomic_compare_exchange_n(queue, &value, 
+                RaspiAPA102ThreadPoolPack(begin, end - stolen), false, __ATOMIC_ACQ_REL, 
+                __ATOMIC_ACQUIRE))
+            {
+                *tile = end - stolen;
+                __atomic_store_n(RaspiAPA102ThreadPoolGetQueue(pool, index), 
+                    RaspiAPA102ThreadPoolPack(end - stolen + 1, end), __ATOMIC_RELEASE);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief   Processes tiles until all queues are empty.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   index   The index of the current thread.
+ *
+ * @return  The number of successful steals.
+ */
+static uint64_t RaspiAPA102ThreadPoolWork(RaspiAPA102ThreadPool* pool, size_t index)
+{
+    uint64_t steals = 0;
+    for (;;)
+    {
+        uint32_t tile;
+        if (!RaspiAPA102ThreadPoolPop(pool, index, &tile))
+        {
+            if (!RaspiAPA102ThreadPoolSteal(pool, index, &tile))
+            {
+                break;
+            }
+            ++steals;
+        }
+
+        const size_t begin = (size_t)tile * pool->tile_size;
+        const size_t end = (pool->count - begin < pool->tile_size) ? 
+            pool->count : begin + pool->tile_size;
+        pool->function(pool->context, begin, end);
+    }
+
+    return steals;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Workers                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   The entry point of a worker thread.
+ *
+ * @param   argument    A pointer to the `RaspiAPA102ThreadPoolWorker` struct.
+ *
+ * @return  Always `NULL`.
+ */
+static void* RaspiAPA102ThreadPoolWorkerThread(void* argument)
+{
+    RaspiAPA102ThreadPoolWorker* const worker = argument;
+    RaspiAPA102ThreadPool* const pool = worker->pool;
+
+    uint64_t generation = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;)
+    {
+        while (!pool->stop && (pool->generation == generation))
+        {
+            pthread_cond_wait(&pool->started, &pool->mutex);
+        }
+        if (pool->stop)
+        {
+            break;
+        }
+        generation = pool->generation;
+
+        pthread_mutex_unlock(&pool->mutex);
+        const uint64_t steals = RaspiAPA102ThreadPoolWork(pool, worker->index);
+        pthread_mutex_lock(&pool->mutex);
+
+        pool->steals += steals;
+        if (--pool->pending == 0)
+        {
+            pthread_cond_broadcast(&pool->completed);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief   Stops and joins the first `count` worker threads.
+ *
+ * @param   pool    A pointer to the `RaspiAPA102ThreadPool` struct.
+ * @param   count   The number of running worker threads.
+ */
+static void RaspiAPA102ThreadPoolStopWorkers(RaspiAPA102ThreadPool* pool, size_t count)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->started);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Thread Pool                                                                                    */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102ThreadPoolInit(RaspiAPA102ThreadPool* pool, size_t thread_count)
+{
+    if (!pool)
+    {
+        return -1;
+    }
+
+    if (!thread_count)
+    {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (online > 0) ? (size_t)online : 1;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    pool->worker_count = thread_count - 1;
+    if (posix_memalign((void**)&pool->queues, 64, 
+        thread_count * RASPI_APA102_THREAD_POOL_QUEUE_STRIDE * sizeof(uint32_t)) != 0)
+    {
+        pool->queues = NULL;
+        goto cleanup;
+    }
+    memset(pool->queues, 0, thread_count * RASPI_APA102_THREAD_POOL_QUEUE_STRIDE * 
+        sizeof(uint32_t));
+    if (pool->worker_count)
+    {
+        pool->workers = calloc(pool->worker_count, sizeof(RaspiAPA102ThreadPoolWorker));
+        if (!pool->workers)
+        {
+            goto cleanup;
+        }
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->started, NULL);
+    pthread_cond_init(&pool->completed, NULL);
+
+    for (size_t i = 0; i < pool->worker_count; ++i)
+    {
+        pool->workers[i].pool  = pool;
+        pool->workers[i].index = i + 1;
+        if (pthread_create(&pool->workers[i].thread, NULL, &RaspiAPA102ThreadPoolWorkerThread, 
+            &pool->workers[i]) != 0)
+        {
+            RaspiAPA102ThreadPoolStopWorkers(pool, i);
+            pthread_cond_destroy(&pool->completed);
+            pthread_cond_destroy(&pool->started);
+            pthread_mutex_destroy(&pool->mutex);
+            goto cleanup;
+        }
+    }
+
+    return 0;
+
+cleanup:
+    free(pool->workers);
+    free(pool->queues);
+    memset(pool, 0, sizeof(*pool));
+
+    return -1;
+}
+
+int RaspiAPA102ThreadPoolGetThreadCount(const RaspiAPA102ThreadPool* pool, size_t* count)
+{
+    if (!pool || !pool->queues || !count)
+    {
+        return -1;
+    }
+
+    *count = pool->worker_count + 1;
+
+    return 0;
+}
+
+int RaspiAPA102ThreadPoolRun(RaspiAPA102ThreadPool* pool, size_t count, size_t tile_size, 
+    RaspiAPA102ThreadPoolFunction function, void* context)
+{
+    if (!pool || !pool->queues || !tile_size || !function)
+    {
+        return -1;
+    }
+
+    if (!count)
+    {
+        return 0;
+    }
+
+    if ((count - 1) / tile_size >= RASPI_APA102_THREAD_POOL_MAX_TILES)
+    {
+        tile_size = (count + RASPI_APA102_THREAD_POOL_MAX_TILES - 1) / 
+            RASPI_APA102_THREAD_POOL_MAX_TILES;
+    }
+    const size_t tiles = (count + tile_size - 1) / tile_size;
+
+    if (!pool->worker_count || (tiles == 1))
+    {
+        function(context, 0, count);
+
+        pthread_mutex_lock(&pool->mutex);
+        ++pool->runs;
+        pthread_mutex_unlock(&pool->mutex);
+
+        return 0;
+    }
+
+    // Contiguous shares keep the pixels of a thread together, stealing takes care of the balance
+    const size_t threads = pool->worker_count + 1;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        __atomic_store_n(RaspiAPA102ThreadPoolGetQueue(pool, i), RaspiAPA102ThreadPoolPack(
+            (uint32_t)(tiles * i / threads), (uint32_t)(tiles * (i + 1) / threads)), 
+            __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->function  = function;
+    pool->context   = context;
+    pool->count     = count;
+    pool->tile_size = tile_size;
+    pool->pending   = pool->worker_count;
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->started);
+    pthread_mutex_unlock(&pool->mutex);
+
+    const uint64_t steals = RaspiAPA102ThreadPoolWork(pool, 0);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->steals += steals;
+    while (pool->pending > 0)
+    {
+        pthread_cond_wait(&pool->completed, &pool->mutex);
+    }
+    ++pool->runs;
+    pthread_mutex_unlock(&pool->mutex);
+
+    return 0;
+}
+
+int RaspiAPA102ThreadPoolGetStats(RaspiAPA102ThreadPool* pool, uint64_t* runs, uint64_t* steals)
+{
+    if (!pool || !pool->queues)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    if (runs)
+    {
+        *runs = pool->runs;
+    }
+    if (steals)
+    {
+        *steals = pool->steals;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return 0;
+}
+
+int RaspiAPA102ThreadPoolDestroy(RaspiAPA102ThreadPool* pool)
+{
+    if (!pool || !pool->queues)
+    {
+        return -1;
+    }
+
+    RaspiAPA102ThreadPoolStopWorkers(pool, pool->worker_count);
+
+    pthread_cond_destroy(&pool->completed);
+    pthread_cond_destroy(&pool->started);
+    pthread_mutex_destroy(&pool->mutex);
+
+    free(pool->workers);
+    free(pool->queues);
+    memset(pool, 0, sizeof(*pool));
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
@@ -0,0 +1,173 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <RaspiAPA102/Transport.h>
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transport                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Appends the given buffer to the captured data.
+ *
+ * @param   context A pointer to the `RaspiAPA102Capture` struct.
+ * @param   buffer  A pointer to the data buffer.
+ * @param   size    The number of bytes to write.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102CaptureWrite(void* context, const uint8_t* buffer, size_t size)
+{
+    RaspiAPA102Capture* const capture = context;
+
+    if (capture->frame_complete)
+    {
+        if (!capture->accumulate)
+        {
+            capture->size = 0;
+        }
+        capture->frame_complete = false;
+    }
+
+    if (capture->size + size > capture->capacity)
+    {
+        size_t capacity = capture->capacity ? capture->capacity : 64;
+        while (capacity < capture->size + size)
+        {
+            capacity *= 2;
+        }
+
+        uint8_t* const data = realloc(capture->data, capacity);
+        if (!data)
+        {
+            return -1;
+        }
+        capture->data = data;
+        capture->capacity = capacity;
+    }
+
+    memcpy(capture->data + capture->size, buffer, size);
+    capture->size += size;
+    capture->bytes_total += size;
+
+    return 0;
+}
+
+/**
+ * @brief   Completes the current frame.
+ *
+ * @param   context A pointer to the `RaspiAPA102Capture` struct.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102CaptureFlush(void* context)
+{
+    RaspiAPA102Capture* const capture = context;
+
+    capture->frame_complete = true;
+    ++capture->frame_count;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Exported functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Capture                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+int RaspiAPA102CaptureInit(RaspiAPA102Capture* capture, bool accumulate)
+{
+    if (!capture)
+    {
+        return -1;
+    }
+
+    memset(capture, 0, sizeof(*capture));
+    capture->accumulate = accumulate;
+
+    return 0;
+}
+
+int RaspiAPA102CaptureGetTransport(RaspiAPA102Capture* capture, RaspiAPA102Transport* transport)
+{
+    if (!capture || !transport)
+    {
+        return -1;
+    }
+
+    transport->context = capture;
+    transport->open    = NULL;
+    transport->write   = &RaspiAPA102CaptureWrite;
+    transport->flush   = &RaspiAPA102CaptureFlush;
+    transport->close   = NULL;
+
+    return 0;
+}
+
+int RaspiAPA102CaptureReset(RaspiAPA102Capture* capture)
+{
+    if (!capture)
+    {
+        return -1;
+    }
+
+    capture->size           = 0;
+    capture->frame_complete = false;
+    capture->frame_count    = 0;
+    capture->bytes_total    = 0;
+
+    return 0;
+}
+
+int RaspiAPA102CaptureDestroy(RaspiAPA102Capture* capture)
+{
+    if (!capture)
+    {
+        return -1;
+    }
+
+    free(capture->data);
+    capture->data     = NULL;
+    capture->size     = 0;
+    capture->capacity = 0;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
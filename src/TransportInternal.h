@@ -0,0 +1,146 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Declares the transport backends that are bundled with the library.
+ */
+
+#ifndef TRANSPORT_INTERNAL_H
+#define TRANSPORT_INTERNAL_H
+
+#include <linux/spi/spidev.h>
+#include <RaspiAPA102/Transport.h>
+
+/* ============================================================================================== */
+/* Internal types                                                                                 */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102SPIDevSubmitHook` function prototype.
+ *
+ * @param   user        The user data passed to `RaspiAPA102SPIDevTransportCreateEx`.
+ * @param   transfers   A pointer to the chained `spi_ioc_transfer` structs of a single message.
+ * @param   count       The number of structs in the passed array.
+ *
+ * Replaces the `SPI_IOC_MESSAGE` request of the `spidev` transport (e.g. to record the messages 
+ * in tests).
+ *
+ * @return  A status code.
+ */
+typedef int (*RaspiAPA102SPIDevSubmitHook)(void* user, const struct spi_ioc_transfer* transfers, 
+    size_t count);
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* DMA                                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Creates a transport that streams frames to the hardware `SPI` controller through `DMA`.
+ *
+ * @param   transport   Receives the transport.
+ * @param   speed_hz    The `SPI` clock frequency in Hz.
+ * @param   capacity    The maximum size of a framed buffer in bytes.
+ *
+ * The transport owns a `RaspiAPA102DMA` engine on the default channels that is released when the 
+ * transport is closed.
+ *
+ * @return  A status code.
+ */
+int RaspiAPA102DMATransportCreate(RaspiAPA102Transport* transport, uint32_t speed_hz, 
+    size_t capacity);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* SPIDev                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Reads the `bufsiz` parameter of the `spidev` driver.
+ *
+ * @return  The maximum number of bytes in a single `spidev` message, aligned down to the transfer
+ *          alignment of the driver.
+ */
+size_t RaspiAPA102SPIDevGetBufsiz(void);
+
+/**
+ * @brief   Creates a transport that writes to the given `spidev` device node.
+ *
+ * @param   transport   Receives the transport.
+ * @param   path        The path of the `spidev` device node.
+ * @param   speed_hz    The `SPI` clock frequency in Hz.
+ *
+ * @return  A status code.
+ */
+int RaspiAPA102SPIDevTransportCreate(RaspiAPA102Transport* transport, const char* path,
+    uint32_t speed_hz);
+
+/**
+ * @brief   Creates a transport that writes to the given `spidev` device node.
+ *
+ * @param   transport   Receives the transport.
+ * @param   path        The path of the `spidev` device node.
+ * @param   speed_hz    The `SPI` clock frequency in Hz.
+ * @param   bufsiz      The maximum number of bytes in a single message, or `0` to read the 
+ *                      `bufsiz` parameter of the `spidev` driver. The value is aligned down to 
+ *                      the transfer alignment of the driver.
+ * @param   submit      A hook that replaces the `SPI_IOC_MESSAGE` request, or `NULL`.
+ * @param   user        The user data passed to the `submit` hook.
+ *
+ * @return  A status code.
+ */
+int RaspiAPA102SPIDevTransportCreateEx(RaspiAPA102Transport* transport, const char* path,
+    uint32_t speed_hz, size_t bufsiz, RaspiAPA102SPIDevSubmitHook submit, void* user);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Soft SPI                                                                                       */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Creates a transport that emulates `SPI` on the given `GPIO` pins.
+ *
+ * @param   transport   Receives the transport.
+ * @param   pin_sclk    The number of the `SCLK` pin.
+ * @param   pin_mosi    The number of the `MOSI` pin.
+ * @param   pin_cs      The number of the chip select pin, or `-1` if not needed.
+ * @param   clock_hz    The requested clock frequency in Hz.
+ *
+ * The transport owns a `RaspiAPA102SoftSPI` engine that is released when the transport is 
+ * closed.
+ *
+ * @return  A status code.
+ */
+int RaspiAPA102SoftSPITransportCreate(RaspiAPA102Transport* transport, int pin_sclk, 
+    int pin_mosi, int pin_cs, uint32_t clock_hz);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#endif /* TRANSPORT_INTERNAL_H */
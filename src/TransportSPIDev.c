@@ -0,0 +1,347 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/spi/spidev.h>
+#include <TransportInternal.h>
+
+/* ============================================================================================== */
+/* Internal constants                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   The path of the `spidev` module parameter that limits the size of a single message.
+ */
+#define RASPI_APA102_SPIDEV_BUFSIZ_PATH "/sys/module/spidev/parameters/bufsiz"
+
+/**
+ * @brief   The default `bufsiz` of the `spidev` driver.
+ */
+#define RASPI_APA102_SPIDEV_BUFSIZ_DEFAULT 4096
+
+/**
+ * @brief   The alignment the `spidev` driver applies to every transfer inside its bounce buffer.
+ *
+ * Newer kernels align each transfer to `ARCH_DMA_MINALIGN` (up to 128 bytes on ARM64) before 
+ * checking the accumulated size against `bufsiz`.
+ */
+#define RASPI_APA102_SPIDEV_ALIGNMENT 128
+
+/**
+ * @brief   The maximum number of `spi_ioc_transfer` segments chained in a single message.
+ */
+#define RASPI_APA102_SPIDEV_MAX_TRANSFERS 16
+
+/**
+ * @brief   The maximum number of pending segments.
+ *
+ * An update of a string with 200k LEDs in `RASPI_APA102_CHAIN_MODE_LARGE` consists of 15 segments 
+ * (start frame, LED frames and 13 end frame blocks).
+ */
+#define RASPI_APA102_SPIDEV_MAX_SEGMENTS 16
+
+/* ============================================================================================== */
+/* Internal types                                                                                 */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102SPIDevSegment` struct.
+ */
+typedef struct RaspiAPA102SPIDevSegment_
+{
+    /**
+     * @brief   A pointer to the data.
+     */
+    const uint8_t* data;
+    /**
+     * @brief   The size of the data in bytes.
+     */
+    size_t size;
+} RaspiAPA102SPIDevSegment;
+
+/**
+ * @brief   Defines the `RaspiAPA102SPIDevContext` struct.
+ */
+typedef struct RaspiAPA102SPIDevContext_
+{
+    /**
+     * @brief   The file descriptor of the `spidev` device node.
+     */
+    int fd;
+    /**
+     * @brief   The `SPI` clock frequency in Hz.
+     */
+    uint32_t speed_hz;
+    /**
+     * @brief   The maximum number of bytes the `spidev` driver accepts in a single message.
+     */
+    size_t bufsiz;
+    /**
+     * @brief   The segments written since the last flush.
+     */
+    RaspiAPA102SPIDevSegment segments[RASPI_APA102_SPIDEV_MAX_SEGMENTS];
+    /**
+     * @brief   The number of pending segments.
+     */
+    size_t segment_count;
+    /**
+     * @brief   The hook that replaces the `SPI_IOC_MESSAGE` request, or `NULL`.
+     */
+    RaspiAPA102SPIDevSubmitHook submit;
+    /**
+     * @brief   The user data passed to the `submit` hook.
+     */
+    void* user;
+} RaspiAPA102SPIDevContext;
+
+/* ============================================================================================== */
+/* Internal functions                                                                             */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Helper                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Submits the given chain of transfers as a single `SPI_IOC_MESSAGE`.
+ *
+ * @param   spidev      A pointer to the `RaspiAPA102SPIDevContext` struct.
+ * @param   transfers   A pointer to an array of `spi_ioc_transfer` structs.
+ * @param   count       The number of structs in the passed array.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SPIDevSubmit(RaspiAPA102SPIDevContext* spidev, 
+    struct spi_ioc_transfer* transfers, size_t count)
+{
+    if (!count)
+    {
+        return 0;
+    }
+    if (spidev->submit)
+    {
+        return spidev->submit(spidev->user, transfers, count);
+    }
+
+    int result;
+    do
+    {
+        result = ioctl(spidev->fd, SPI_IOC_MESSAGE(count), transfers);
+    } while ((result < 0) && (errno == EINTR));
+
+    return (result < 0) ? -1 : 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Transport                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Submits all pending segments.
+ *
+ * @param   context A pointer to the `RaspiAPA102SPIDevContext` struct.
+ *
+ * The segments are chained into as few `SPI_IOC_MESSAGE` transfers as possible. The `spidev` 
+ * driver bounds the accumulated size of all transfers in a message by `bufsiz`, so larger 
+ * segments are split and continued in the next message.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SPIDevFlush(void* context)
+{
+    RaspiAPA102SPIDevContext* const spidev = context;
+
+    struct spi_ioc_transfer transfers[RASPI_APA102_SPIDEV_MAX_TRANSFERS];
+    size_t transfer_count = 0;
+    size_t budget = spidev->bufsiz;
+
+    for (size_t i = 0; i < spidev->segment_count; ++i)
+    {
+        const uint8_t* data = spidev->segments[i].data;
+        size_t remaining = spidev->segments[i].size;
+
+        while (remaining > 0)
+        {
+            if ((transfer_count == RASPI_APA102_SPIDEV_MAX_TRANSFERS) || 
+                (budget < RASPI_APA102_SPIDEV_ALIGNMENT))
+            {
+                if (RaspiAPA102SPIDevSubmit(spidev, transfers, transfer_count) < 0)
+                {
+                    spidev->segment_count = 0;
+                    return -1;
+                }
+                transfer_count = 0;
+                budget = spidev->bufsiz;
+            }
+
+            const size_t length = (remaining < budget) ? remaining : budget;
+            const size_t slot = (length + RASPI_APA102_SPIDEV_ALIGNMENT - 1) & 
+                ~(size_t)(RASPI_APA102_SPIDEV_ALIGNMENT - 1);
+
+            struct spi_ioc_transfer* transfer = &transfers[transfer_count++];
+            memset(transfer, 0, sizeof(*transfer));
+            transfer->tx_buf        = (uintptr_t)data;
+            transfer->len           = (uint32_t)length;
+            transfer->speed_hz      = spidev->speed_hz;
+            transfer->bits_per_word = 8;
+
+            data      += length;
+            remaining -= length;
+            budget    -= (slot < budget) ? slot : budget;
+        }
+    }
+
+    spidev->segment_count = 0;
+
+    return RaspiAPA102SPIDevSubmit(spidev, transfers, transfer_count);
+}
+
+/**
+ * @brief   Queues the given buffer for the next message.
+ *
+ * @param   context A pointer to the `RaspiAPA102SPIDevContext` struct.
+ * @param   buffer  A pointer to the data buffer.
+ * @param   size    The number of bytes to write.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102SPIDevWrite(void* context, const uint8_t* buffer, size_t size)
+{
+    RaspiAPA102SPIDevContext* const spidev = context;
+
+    if (spidev->segment_count == RASPI_APA102_SPIDEV_MAX_SEGMENTS)
+    {
+        if (RaspiAPA102SPIDevFlush(spidev) < 0)
+        {
+            return -1;
+        }
+    }
+
+    spidev->segments[spidev->segment_count].data = buffer;
+    spidev->segments[spidev->segment_count].size = size;
+    ++spidev->segment_count;
+
+    return 0;
+}
+
+/**
+ * @brief   Closes the `spidev` device node and releases the context.
+ *
+ * @param   context A pointer to the `RaspiAPA102SPIDevContext` struct.
+ */
+static void RaspiAPA102SPIDevClose(void* context)
+{
+    RaspiAPA102SPIDevContext* const spidev = context;
+
+    close(spidev->fd);
+    free(spidev);
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+/* Library functions                                                                              */
+/* ============================================================================================== */
+
+size_t RaspiAPA102SPIDevGetBufsiz(void)
+{
+    size_t bufsiz = RASPI_APA102_SPIDEV_BUFSIZ_DEFAULT;
+
+    FILE* file = fopen(RASPI_APA102_SPIDEV_BUFSIZ_PATH, "r");
+    if (file)
+    {
+        unsigned long value;
+        if ((fscanf(file, "%lu", &value) == 1) && (value >= RASPI_APA102_SPIDEV_ALIGNMENT))
+        {
+            bufsiz = value;
+        }
+        fclose(file);
+    }
+
+    // Each transfer occupies an aligned slot in the bounce buffer
+    return bufsiz & ~(size_t)(RASPI_APA102_SPIDEV_ALIGNMENT - 1);
+}
+
+int RaspiAPA102SPIDevTransportCreate(RaspiAPA102Transport* transport, const char* path, 
+    uint32_t speed_hz)
+{
+    return RaspiAPA102SPIDevTransportCreateEx(transport, path, speed_hz, 0, NULL, NULL);
+}
+
+int RaspiAPA102SPIDevTransportCreateEx(RaspiAPA102Transport* transport, const char* path, 
+    uint32_t speed_hz, size_t bufsiz, RaspiAPA102SPIDevSubmitHook submit, void* user)
+{
+    if (!transport || !path || !speed_hz || 
+        (bufsiz && (bufsiz < RASPI_APA102_SPIDEV_ALIGNMENT)))
+    {
+        return -1;
+    }
+
+    RaspiAPA102SPIDevContext* const spidev = calloc(1, sizeof(RaspiAPA102SPIDevContext));
+    if (!spidev)
+    {
+        return -1;
+    }
+
+    spidev->fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (spidev->fd < 0)
+    {
+        free(spidev);
+        return -1;
+    }
+
+    // Character devices that are not driven by `spidev` (e.g. stand-ins used for testing) reject 
+    // the configuration requests. This is not fatal as long as the message requests succeed.
+    const uint8_t mode = SPI_MODE_0;
+    const uint8_t bits_per_word = 8;
+    ioctl(spidev->fd, SPI_IOC_WR_MODE, &mode);
+    ioctl(spidev->fd, SPI_IOC_WR_BITS_PER_WORD, &bits_per_word);
+    ioctl(spidev->fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz);
+
+    spidev->speed_hz = speed_hz;
+    spidev->bufsiz   = bufsiz ? (bufsiz & ~(size_t)(RASPI_APA102_SPIDEV_ALIGNMENT - 1)) : 
+        RaspiAPA102SPIDevGetBufsiz();
+    spidev->submit   = submit;
+    spidev->user     = user;
+
+    transport->context = spidev;
+    transport->open    = NULL;
+    transport->write   = &RaspiAPA102SPIDevWrite;
+    transport->flush   = &RaspiAPA102SPIDevFlush;
+    transport->close   = &RaspiAPA102SPIDevClose;
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/***************************************************************************************************/
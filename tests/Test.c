@@ -0,0 +1,142 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102TestSuite` struct.
+ */
+typedef struct RaspiAPA102TestSuite_
+{
+    /**
+     * @brief   The name of the suite.
+     */
+    const char* name;
+    /**
+     * @brief   The suite entry point.
+     */
+    void (*run)(void);
+} RaspiAPA102TestSuite;
+
+/**
+ * @brief   All registered test suites.
+ */
+static const RaspiAPA102TestSuite RASPI_APA102_TEST_SUITES[] =
+{
+    { "color"     , RaspiAPA102TestColor      },
+    { "dma"       , RaspiAPA102TestDMA        },
+    { "framing"   , RaspiAPA102TestFraming    },
+    { "layer"     , RaspiAPA102TestLayer      },
+    { "packing"   , RaspiAPA102TestPacking    },
+    { "softspi"   , RaspiAPA102TestSoftSPI    },
+    { "spidev"    , RaspiAPA102TestSPIDev     },
+    { "stripgroup", RaspiAPA102TestStripGroup },
+    { "submitter" , RaspiAPA102TestSubmitter  }
+};
+
+/* ============================================================================================== */
+/* Globals                                                                                        */
+/* ============================================================================================== */
+
+/**
+ * @brief   The number of failed checks.
+ */
+static size_t RaspiAPA102TestFailures = 0;
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Harness                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+bool RaspiAPA102TestCheck(bool condition, const char* expression, const char* file, int line)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        ++RaspiAPA102TestFailures;
+    }
+
+    return condition;
+}
+
+/* ============================================================================================== */
+/* Entry Point                                                                                    */
+/* ============================================================================================== */
+
+int main(int argc, char** argv)
+{
+    const size_t count = sizeof(RASPI_APA102_TEST_SUITES) / sizeof(RASPI_APA102_TEST_SUITES[0]);
+
+    // Reject unknown suite names, so that a typo in the test registration can not pass silently
+    for (int j = 1; j < argc; ++j)
+    {
+        bool known = false;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!strcmp(argv[j], RASPI_APA102_TEST_SUITES[i].name))
+            {
+                known = true;
+            }
+        }
+        if (!known)
+        {
+            fprintf(stderr, "unknown suite: %s\n", argv[j]);
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        bool selected = (argc < 2);
+        for (int j = 1; j < argc; ++j)
+        {
+            if (!strcmp(argv[j], RASPI_APA102_TEST_SUITES[i].name))
+            {
+                selected = true;
+            }
+        }
+        if (selected)
+        {
+            const size_t failures = RaspiAPA102TestFailures;
+            RASPI_APA102_TEST_SUITES[i].run();
+            printf("%s: %s\n", RASPI_APA102_TEST_SUITES[i].name, 
+                (RaspiAPA102TestFailures == failures) ? "passed" : "FAILED");
+        }
+    }
+
+    return RaspiAPA102TestFailures ? 1 : 0;
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,143 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+/**
+ * @file
+ * @brief   Declares the test harness and the individual test suites.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================================== */
+/* Macros                                                                                         */
+/* ============================================================================================== */
+
+/**
+ * @brief   Checks the given condition and records a failure, if it does not hold.
+ *
+ * @param   condition   The condition to check.
+ *
+ * Evaluates to the value of the condition, so that a test case can stop early.
+ */
+#define RASPI_APA102_TEST_CHECK(condition) \
+    RaspiAPA102TestCheck((condition), #condition, __FILE__, __LINE__)
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Harness                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Records the result of a single check.
+ *
+ * @param   condition   The result of the check.
+ * @param   expression  The checked expression.
+ * @param   file        The name of the source file.
+ * @param   line        The line number.
+ *
+ * A failed check is printed to `stderr` and fails the current suite.
+ *
+ * @return  The value of `condition`.
+ */
+bool RaspiAPA102TestCheck(bool condition, const char* expression, const char* file, int line);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Suites                                                                                         */
+/* ---------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief   Checks the batch color conversions of all supported implementations against the 
+ *          `double` routines.
+ */
+void RaspiAPA102TestColor(void);
+
+/**
+ * @brief   Runs the control block chains of the `DMA` engine on a simulated controller and checks 
+ *          the byte stream on the wire.
+ */
+void RaspiAPA102TestDMA(void);
+
+/**
+ * @brief   Checks the byte stream of the device functions for both chain modes (capture 
+ *          transport).
+ */
+void RaspiAPA102TestFraming(void);
+
+/**
+ * @brief   Decodes the lanes of the multi-lane software `SPI` engine (in-memory `GPIO` registers).
+ */
+void RaspiAPA102TestSoftSPI(void);
+
+/**
+ * @brief   Checks the blend modes of all supported layer stack implementations against the scalar 
+ *          implementation.
+ */
+void RaspiAPA102TestLayer(void);
+
+/**
+ * @brief   Checks every pixel format and channel order of all supported packer implementations 
+ *          against a reference conversion.
+ */
+void RaspiAPA102TestPacking(void);
+
+/**
+ * @brief   Records the messages of the `spidev` transport and checks the message limits of the 
+ *          driver and the joined byte stream.
+ */
+void RaspiAPA102TestSPIDev(void);
+
+/**
+ * @brief   Commits frames of a strip group to two capture-backed devices and checks the mapped 
+ *          and reversed segments.
+ */
+void RaspiAPA102TestStripGroup(void);
+
+/**
+ * @brief   Checks the submission engine with both backends against pipes.
+ */
+void RaspiAPA102TestSubmitter(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+
+/* ============================================================================================== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEST_H */
@@ -0,0 +1,310 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/ColorConversion.h>
+#include <RaspiAPA102/SIMD.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The maximum error of the floating-point batch conversions compared to the `double`
+ *          routines.
+ */
+#define RASPI_APA102_TEST_COLOR_EPSILON 1e-4
+
+/**
+ * @brief   The maximum error of the hue in degrees.
+ */
+#define RASPI_APA102_TEST_COLOR_EPSILON_HUE 1e-2
+
+/**
+ * @brief   The maximum error of the fixed-point conversion in 8-bit steps.
+ */
+#define RASPI_APA102_TEST_COLOR_MAX_ERROR 2
+
+/**
+ * @brief   The number of steps per color component of the test grids.
+ */
+#define RASPI_APA102_TEST_COLOR_STEPS 32
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Returns the distance of the given hues in degrees.
+ *
+ * @param   a   The first hue.
+ * @param   b   The second hue.
+ *
+ * @return  The distance on the color circle (`0.0` to `180.0`).
+ */
+static double RaspiAPA102TestColorHueDistance(double a, double b)
+{
+    const double distance = fmod(fabs(a - b), 360.0);
+
+    return (distance > 180.0) ? 360.0 - distance : distance;
+}
+
+/**
+ * @brief   Converts the given color component to 8 bits the same way as the quad conversions.
+ *
+ * @param   value   The color component (`0.0` to `1.0`).
+ *
+ * @return  The 8-bit color component.
+ */
+static int RaspiAPA102TestColorToByte(double value)
+{
+    return (int)lround(value * 255.0);
+}
+
+/**
+ * @brief   Checks `RaspiAPA102HSV2RGBBatch` against `RaspiAPA102HSV2RGB`.
+ *
+ * Hues outside of the color circle are included to cover the wrap around.
+ */
+static void RaspiAPA102TestColorHSV2RGB(void)
+{
+    const size_t steps = RASPI_APA102_TEST_COLOR_STEPS;
+    const size_t count = (3 * steps) * (steps + 1) * (steps + 1);
+    float* const buffer = malloc(6 * count * sizeof(float));
+    if (!RASPI_APA102_TEST_CHECK(buffer))
+    {
+        return;
+    }
+    float* const h = buffer;
+    float* const s = h + count;
+    float* const v = s + count;
+    float* const r = v + count;
+    float* const g = r + count;
+    float* const b = g + count;
+
+    size_t n = 0;
+    for (size_t i = 0; i < 3 * steps; ++i)
+    {
+        for (size_t j = 0; j <= steps; ++j)
+        {
+            for (size_t k = 0; k <= steps; ++k)
+            {
+                h[n] = -360.0f + 1080.0f * (float)i / (float)(3 * steps) + 0.37f;
+                s[n] = (float)j / (float)steps;
+                v[n] = (float)k / (float)steps;
+                ++n;
+            }
+        }
+    }
+
+    RASPI_APA102_TEST_CHECK(RaspiAPA102HSV2RGBBatch(h, s, v, r, g, b, count) == 0);
+
+    double max_error = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const double hue = fmod(fmod((double)h[i], 360.0) + 360.0, 360.0);
+        const RaspiAPA102RGB expected = 
+            RaspiAPA102HSV2RGB((RaspiAPA102HSV){ hue, (double)s[i], (double)v[i] });
+        max_error = fmax(max_error, fabs(expected.r - (double)r[i]));
+        max_error = fmax(max_error, fabs(expected.g - (double)g[i]));
+        max_error = fmax(max_error, fabs(expected.b - (double)b[i]));
+    }
+    RASPI_APA102_TEST_CHECK(max_error <= RASPI_APA102_TEST_COLOR_EPSILON);
+
+    free(buffer);
+}
+
+/**
+ * @brief   Checks `RaspiAPA102RGB2HSVBatch` against `RaspiAPA102RGB2HSV`.
+ *
+ * The hue of achromatic colors is undefined and only checked for the batch convention (`0.0`).
+ */
+static void RaspiAPA102TestColorRGB2HSV(void)
+{
+    const size_t steps = RASPI_APA102_TEST_COLOR_STEPS;
+    const size_t count = (steps + 1) * (steps + 1) * (steps + 1);
+    float* const buffer = malloc(6 * count * sizeof(float));
+    if (!RASPI_APA102_TEST_CHECK(buffer))
+    {
+        return;
+    }
+    float* const r = buffer;
+    float* const g = r + count;
+    float* const b = g + count;
+    float* const h = b + count;
+    float* const s = h + count;
+    float* const v = s + count;
+
+    size_t n = 0;
+    for (size_t i = 0; i <= steps; ++i)
+    {
+        for (size_t j = 0; j <= steps; ++j)
+        {
+            for (size_t k = 0; k <= steps; ++k)
+            {
+                r[n] = (float)i / (float)steps;
+                g[n] = (float)j / (float)steps;
+                b[n] = (float)k / (float)steps;
+                ++n;
+            }
+        }
+    }
+
+    RASPI_APA102_TEST_CHECK(RaspiAPA102RGB2HSVBatch(r, g, b, h, s, v, count) == 0);
+
+    double max_error = 0.0;
+    double max_error_hue = 0.0;
+    size_t achromatic_errors = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const RaspiAPA102HSV expected = 
+            RaspiAPA102RGB2HSV((RaspiAPA102RGB){ (double)r[i], (double)g[i], (double)b[i] });
+        max_error = fmax(max_error, fabs(expected.s - (double)s[i]));
+        max_error = fmax(max_error, fabs(expected.v - (double)v[i]));
+        if ((r[i] == g[i]) && (g[i] == b[i]))
+        {
+            achromatic_errors += (h[i] != 0.0f);
+            continue;
+        }
+        RASPI_APA102_TEST_CHECK((h[i] >= 0.0f) && (h[i] < 360.0f));
+        max_error_hue = 
+            fmax(max_error_hue, RaspiAPA102TestColorHueDistance(expected.h, (double)h[i]));
+    }
+    RASPI_APA102_TEST_CHECK(max_error <= RASPI_APA102_TEST_COLOR_EPSILON);
+    RASPI_APA102_TEST_CHECK(max_error_hue <= RASPI_APA102_TEST_COLOR_EPSILON_HUE);
+    RASPI_APA102_TEST_CHECK(achromatic_errors == 0);
+
+    free(buffer);
+}
+
+/**
+ * @brief   Checks `RaspiAPA102HSVFixed2ColorQuadBatchEx` for every supported implementation 
+ *          against `RaspiAPA102HSV2RGB`.
+ *
+ * All implementations have to produce the same result as the scalar one. The number of values is
+ * odd, so that the scalar remainder of the vectorized implementations is covered.
+ */
+static void RaspiAPA102TestColorHSVFixed(void)
+{
+    const size_t hue_steps = 1021;
+    const size_t steps = 51;
+    const size_t count = hue_steps * (steps + 1) * (steps + 1);
+    const uint8_t brightness = 17;
+
+    uint16_t* const h = malloc(count * sizeof(uint16_t));
+    uint8_t* const s = malloc(count);
+    uint8_t* const v = malloc(count);
+    RaspiAPA102ColorQuad* const expected = malloc(count * sizeof(RaspiAPA102ColorQuad));
+    RaspiAPA102ColorQuad* const quads = malloc(count * sizeof(RaspiAPA102ColorQuad));
+    if (!RASPI_APA102_TEST_CHECK(h && s && v && expected && quads))
+    {
+        free(h);
+        free(s);
+        free(v);
+        free(expected);
+        free(quads);
+        return;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < hue_steps; ++i)
+    {
+        for (size_t j = 0; j <= steps; ++j)
+        {
+            for (size_t k = 0; k <= steps; ++k)
+            {
+                h[n] = (uint16_t)(i * 65536 / hue_steps);
+                s[n] = (uint8_t)(j * 255 / steps);
+                v[n] = (uint8_t)(k * 255 / steps);
+                ++n;
+            }
+        }
+    }
+
+    RASPI_APA102_TEST_CHECK(RaspiAPA102HSVFixed2ColorQuadBatchEx(expected, h, s, v, count, 
+        brightness, RASPI_APA102_SIMD_SCALAR) == 0);
+
+    int max_error = 0;
+    size_t brightness_errors = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const RaspiAPA102RGB rgb = RaspiAPA102HSV2RGB((RaspiAPA102HSV){ 
+            (double)h[i] * 360.0 / 65536.0, (double)s[i] / 255.0, (double)v[i] / 255.0 });
+        const int error_r = abs(RaspiAPA102TestColorToByte(rgb.r) - expected[i].r);
+        const int error_g = abs(RaspiAPA102TestColorToByte(rgb.g) - expected[i].g);
+        const int error_b = abs(RaspiAPA102TestColorToByte(rgb.b) - expected[i].b);
+        max_error = (error_r > max_error) ? error_r : max_error;
+        max_error = (error_g > max_error) ? error_g : max_error;
+        max_error = (error_b > max_error) ? error_b : max_error;
+        brightness_errors += (expected[i].brightness != (0xE0 | brightness));
+    }
+    RASPI_APA102_TEST_CHECK(max_error <= RASPI_APA102_TEST_COLOR_MAX_ERROR);
+    RASPI_APA102_TEST_CHECK(brightness_errors == 0);
+
+    for (int path = RASPI_APA102_SIMD_SCALAR + 1; path <= RASPI_APA102_SIMD_MAX_VALUE; ++path)
+    {
+        if (!RaspiAPA102SIMDIsSupported((RaspiAPA102SIMDPath)path))
+        {
+            continue;
+        }
+        printf("color: checking the %s implementation\n", 
+            RaspiAPA102SIMDGetName((RaspiAPA102SIMDPath)path));
+
+        RASPI_APA102_TEST_CHECK(RaspiAPA102HSVFixed2ColorQuadBatchEx(quads, h, s, v, count, 
+            brightness, (RaspiAPA102SIMDPath)path) == 0);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            mismatches += (quads[i].brightness != expected[i].brightness) || 
+                (quads[i].r != expected[i].r) || (quads[i].g != expected[i].g) || 
+                (quads[i].b != expected[i].b);
+        }
+        RASPI_APA102_TEST_CHECK(mismatches == 0);
+    }
+
+    free(h);
+    free(s);
+    free(v);
+    free(expected);
+    free(quads);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102TestColor(void)
+{
+    RaspiAPA102TestColorHSV2RGB();
+    RaspiAPA102TestColorRGB2HSV();
+    RaspiAPA102TestColorHSVFixed();
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,354 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/DMA.h>
+#include <RaspiAPA102/Transport.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The bus address of the simulated uncached memory.
+ */
+#define RASPI_APA102_TEST_DMA_MEMORY_BUS 0xC0000000u
+
+/**
+ * @brief   The bus address of the `SPI` FIFO register.
+ */
+#define RASPI_APA102_TEST_DMA_FIFO_BUS \
+    (RASPI_APA102_DMA_BUS_PERIPHERALS + RASPI_APA102_DMA_SPI_OFFSET + RASPI_APA102_SPI_FIFO * 4)
+
+/**
+ * @brief   The number of frames streamed per string length.
+ */
+#define RASPI_APA102_TEST_DMA_FRAMES 30
+
+/**
+ * @brief   The string lengths covered by the suite (the last one takes two `SPI` transfers).
+ */
+static const size_t RASPI_APA102_TEST_DMA_SIZES[] = { 1, 100, 1000, 20000 };
+
+/* ============================================================================================== */
+/* Internal types                                                                                 */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102TestDMASimulator` struct.
+ *
+ * Simulates the `DMA` and `SPI` controllers on an in-memory peripheral region.
+ */
+typedef struct RaspiAPA102TestDMASimulator_
+{
+    /**
+     * @brief   The simulated peripheral region and uncached memory.
+     */
+    RaspiAPA102DMARegion region;
+    /**
+     * @brief   The `TX` channel.
+     */
+    int tx_channel;
+    /**
+     * @brief   The `RX` channel (the sequencer).
+     */
+    int rx_channel;
+    /**
+     * @brief   The bytes put on the wire.
+     */
+    uint8_t* wire;
+    /**
+     * @brief   The number of bytes put on the wire.
+     */
+    size_t wire_size;
+    /**
+     * @brief   The number of received bytes that were not yet drained.
+     */
+    size_t undrained;
+    /**
+     * @brief   The number of bytes left in the current `SPI` transfer.
+     */
+    size_t remaining;
+    /**
+     * @brief   The number of times the sequencer was started.
+     */
+    unsigned runs;
+    /**
+     * @brief   Receives writes to invalid bus addresses.
+     */
+    uint32_t scratch;
+} RaspiAPA102TestDMASimulator;
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Translates the given bus address into a pointer to the simulated memory.
+ *
+ * @param   sim A pointer to the `RaspiAPA102TestDMASimulator` struct.
+ * @param   bus The bus address.
+ *
+ * @return  A pointer to the addressed word, or to a scratch word, if the address is invalid.
+ */
+static volatile uint32_t* RaspiAPA102TestDMATranslate(RaspiAPA102TestDMASimulator* sim, 
+    uint32_t bus)
+{
+    if ((bus >= sim->region.memory_bus) &&
+        (bus - sim->region.memory_bus < sim->region.memory_size))
+    {
+        return (volatile uint32_t*)(sim->region.memory + (bus - sim->region.memory_bus));
+    }
+    if ((bus >= RASPI_APA102_DMA_BUS_PERIPHERALS) &&
+        (bus - RASPI_APA102_DMA_BUS_PERIPHERALS < RASPI_APA102_DMA_PERIPHERAL_SIZE))
+    {
+        return sim->region.peripherals + (bus - RASPI_APA102_DMA_BUS_PERIPHERALS) / 4;
+    }
+
+    RASPI_APA102_TEST_CHECK(!"invalid bus address");
+    sim->scratch = 0;
+
+    return &sim->scratch;
+}
+
+/**
+ * @brief   Returns the registers of the given `DMA` channel.
+ *
+ * @param   sim     A pointer to the `RaspiAPA102TestDMASimulator` struct.
+ * @param   channel The channel.
+ *
+ * @return  A pointer to the registers of the channel.
+ */
+static volatile uint32_t* RaspiAPA102TestDMAGetChannel(RaspiAPA102TestDMASimulator* sim, 
+    int channel)
+{
+    return sim->region.peripherals +
+        (RASPI_APA102_DMA_OFFSET + (uint32_t)channel * RASPI_APA102_DMA_CHANNEL_SIZE) / 4;
+}
+
+/**
+ * @brief   Runs the `TX` channel until its chain ends and shifts the FIFO data onto the wire.
+ *
+ * @param   sim A pointer to the `RaspiAPA102TestDMASimulator` struct.
+ */
+static void RaspiAPA102TestDMARunTX(RaspiAPA102TestDMASimulator* sim)
+{
+    volatile uint32_t* const channel = RaspiAPA102TestDMAGetChannel(sim, sim->tx_channel);
+    volatile uint32_t* const spi = sim->region.peripherals + RASPI_APA102_DMA_SPI_OFFSET / 4;
+
+    for (uint32_t address = channel[RASPI_APA102_DMA_CONBLK_AD]; address; )
+    {
+        const RaspiAPA102DMAControlBlock* block =
+            (const RaspiAPA102DMAControlBlock*)RaspiAPA102TestDMATranslate(sim, address);
+        if (!RASPI_APA102_TEST_CHECK(block->destination == RASPI_APA102_TEST_DMA_FIFO_BUS) ||
+            !RASPI_APA102_TEST_CHECK(block->length % 4 == 0))
+        {
+            break;
+        }
+        const volatile uint32_t* source = RaspiAPA102TestDMATranslate(sim, block->source);
+        for (uint32_t i = 0; i < block->length / 4; ++i)
+        {
+            const uint32_t word =
+                source[(block->transfer_info & RASPI_APA102_DMA_TI_SRC_INC) ? i : 0];
+            if (!(spi[RASPI_APA102_SPI_CS] & RASPI_APA102_SPI_CS_TA))
+            {
+                // The first word configures the transfer
+                sim->remaining = word >> 16;
+                spi[RASPI_APA102_SPI_CS] |= word & 0xFF;
+                continue;
+            }
+            memcpy(sim->wire + sim->wire_size, &word, 4);
+            sim->wire_size += 4;
+            sim->undrained += 4;
+            sim->remaining -= 4;
+            if (!sim->remaining)
+            {
+                spi[RASPI_APA102_SPI_CS] &= ~RASPI_APA102_SPI_CS_TA;
+            }
+        }
+        address = block->next;
+    }
+    channel[RASPI_APA102_DMA_CS] &= ~RASPI_APA102_DMA_CS_ACTIVE;
+    channel[RASPI_APA102_DMA_CONBLK_AD] = 0;
+}
+
+/**
+ * @brief   Runs the `RX` channel (the sequencer) until its chain ends.
+ *
+ * @param   sim A pointer to the `RaspiAPA102TestDMASimulator` struct.
+ */
+static void RaspiAPA102TestDMARun(RaspiAPA102TestDMASimulator* sim)
+{
+    volatile uint32_t* const channel = RaspiAPA102TestDMAGetChannel(sim, sim->rx_channel);
+    if (!(channel[RASPI_APA102_DMA_CS] & RASPI_APA102_DMA_CS_ACTIVE))
+    {
+        return;
+    }
+    ++sim->runs;
+
+    const uint32_t tx_bus = RASPI_APA102_DMA_BUS_PERIPHERALS + RASPI_APA102_DMA_OFFSET + 
+        (uint32_t)sim->tx_channel * RASPI_APA102_DMA_CHANNEL_SIZE;
+    for (uint32_t address = channel[RASPI_APA102_DMA_CONBLK_AD]; address; )
+    {
+        const RaspiAPA102DMAControlBlock* block =
+            (const RaspiAPA102DMAControlBlock*)RaspiAPA102TestDMATranslate(sim, address);
+        if (block->source == RASPI_APA102_TEST_DMA_FIFO_BUS)
+        {
+            // Draining waits for the received bytes of the current transfer
+            RASPI_APA102_TEST_CHECK(sim->undrained == block->length);
+            sim->undrained = 0;
+        }
+        else
+        {
+            const uint32_t value = *RaspiAPA102TestDMATranslate(sim, block->source);
+            *RaspiAPA102TestDMATranslate(sim, block->destination) = value;
+            if ((block->destination == tx_bus) && (value & RASPI_APA102_DMA_CS_ACTIVE))
+            {
+                RaspiAPA102TestDMARunTX(sim);
+            }
+        }
+        address = block->next;
+    }
+    channel[RASPI_APA102_DMA_CS] &= ~RASPI_APA102_DMA_CS_ACTIVE;
+    channel[RASPI_APA102_DMA_CONBLK_AD] = 0;
+}
+
+/**
+ * @brief   Streams frames through the engine on the simulated controller and compares the bytes 
+ *          on the wire with the capture transport.
+ *
+ * @param   count   The number of LEDs.
+ */
+static void RaspiAPA102TestDMASimulate(size_t count)
+{
+    const size_t capacity = RASPI_APA102_FRAME_SIZE(count);
+    size_t memory_size;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DMAGetMemorySize(capacity, &memory_size) == 0);
+
+    RaspiAPA102TestDMASimulator sim;
+    memset(&sim, 0, sizeof(sim));
+    sim.tx_channel = RASPI_APA102_DMA_DEFAULT_TX_CHANNEL;
+    sim.rx_channel = RASPI_APA102_DMA_DEFAULT_RX_CHANNEL;
+    sim.region.peripherals = calloc(RASPI_APA102_DMA_PERIPHERAL_SIZE / 4, sizeof(uint32_t));
+    sim.region.memory = aligned_alloc(32, (memory_size + 31) & ~(size_t)31);
+    sim.region.memory_bus = RASPI_APA102_TEST_DMA_MEMORY_BUS;
+    sim.region.memory_size = memory_size;
+    sim.wire = malloc(RASPI_APA102_TEST_DMA_FRAMES * (capacity + 4));
+    uint8_t* const expected = malloc(RASPI_APA102_TEST_DMA_FRAMES * (capacity + 4));
+    RaspiAPA102ColorQuad* const quads = malloc(count * sizeof(RaspiAPA102ColorQuad));
+    if (!RASPI_APA102_TEST_CHECK(sim.region.peripherals && sim.region.memory && sim.wire && 
+        expected && quads))
+    {
+        free(quads);
+        free(expected);
+        free(sim.wire);
+        free(sim.region.memory);
+        free((void*)sim.region.peripherals);
+        return;
+    }
+
+    RaspiAPA102DMA dma;
+    RaspiAPA102Transport transport;
+    RaspiAPA102Device device;
+    RaspiAPA102Capture capture;
+    RaspiAPA102Transport capture_transport;
+    RaspiAPA102Device reference;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DMAInit(&dma, &sim.region, sim.tx_channel, 
+        sim.rx_channel, capacity, 4000000) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DMAGetTransport(&dma, &transport) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceInitTransport(&device, &transport) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102CaptureInit(&capture, false) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102CaptureGetTransport(&capture, &capture_transport) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceInitTransport(&reference, &capture_transport) == 0);
+
+    size_t expected_size = 0;
+    for (unsigned frame = 0; frame < RASPI_APA102_TEST_DMA_FRAMES; ++frame)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const unsigned position = (unsigned)(i * 256 / count + frame * 8) & 0xFF;
+            RaspiAPA102ColorQuadInit(&quads[i], (uint8_t)position, (uint8_t)(255 - position),
+                (uint8_t)(position * 3), (uint8_t)(frame + i));
+        }
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceUpdate(&device, quads, count) == 0);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceUpdate(&reference, quads, count) == 0);
+
+        // The wire carries the frame padded to whole FIFO words
+        memcpy(expected + expected_size, capture.data, capture.size);
+        expected_size += capture.size;
+        while (expected_size % 4)
+        {
+            expected[expected_size] = expected[expected_size - 1];
+            ++expected_size;
+        }
+
+        // Let frames queue up, so that the engine has to link them to the running chain
+        if ((frame % RASPI_APA102_DMA_SLOT_COUNT) == RASPI_APA102_DMA_SLOT_COUNT - 1)
+        {
+            RaspiAPA102TestDMARun(&sim);
+        }
+    }
+    RaspiAPA102TestDMARun(&sim);
+
+    uint32_t completed;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DMAGetCompleted(&dma, &completed) == 0);
+    RASPI_APA102_TEST_CHECK(completed == RASPI_APA102_TEST_DMA_FRAMES);
+    RASPI_APA102_TEST_CHECK(sim.runs > 0);
+    RASPI_APA102_TEST_CHECK(sim.undrained == 0);
+    if (RASPI_APA102_TEST_CHECK(sim.wire_size == expected_size))
+    {
+        RASPI_APA102_TEST_CHECK(!memcmp(sim.wire, expected, expected_size));
+    }
+
+    RaspiAPA102DeviceDestroy(&device);
+    RaspiAPA102DMADestroy(&dma);
+    RaspiAPA102DeviceDestroy(&reference);
+    RaspiAPA102CaptureDestroy(&capture);
+    free(quads);
+    free(expected);
+    free(sim.wire);
+    free(sim.region.memory);
+    free((void*)sim.region.peripherals);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102TestDMA(void)
+{
+    const size_t count = 
+        sizeof(RASPI_APA102_TEST_DMA_SIZES) / sizeof(RASPI_APA102_TEST_DMA_SIZES[0]);
+    for (size_t i = 0; i < count; ++i)
+    {
+        RaspiAPA102TestDMASimulate(RASPI_APA102_TEST_DMA_SIZES[i]);
+    }
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,197 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Transport.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The string lengths covered by the suite.
+ */
+static const size_t RASPI_APA102_TEST_FRAMING_SIZES[] = { 1, 47, 10000, 50000, 100000 };
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Returns a distinct color for the given LED.
+ *
+ * @param   index   The index of the LED.
+ * @param   seed    A value mixed into the color.
+ *
+ * @return  The color quad.
+ */
+static RaspiAPA102ColorQuad RaspiAPA102TestFramingGetColor(size_t index, uint8_t seed)
+{
+    RaspiAPA102ColorQuad quad;
+    RaspiAPA102ColorQuadInit(&quad, (uint8_t)index, (uint8_t)(index >> 8), 
+        (uint8_t)(index >> 16) ^ seed, (uint8_t)index);
+
+    return quad;
+}
+
+/**
+ * @brief   Checks the captured byte stream of a single frame.
+ *
+ * @param   capture     A pointer to the `RaspiAPA102Capture` struct.
+ * @param   colors      The expected LED frames.
+ * @param   count       The number of LED frames.
+ * @param   end_size    The expected size of the end frame in bytes.
+ * @param   end_value   The expected value of the end frame bytes.
+ */
+static void RaspiAPA102TestFramingCheckStream(const RaspiAPA102Capture* capture, 
+    const RaspiAPA102ColorQuad* colors, size_t count, size_t end_size, uint8_t end_value)
+{
+    const size_t led_size = count * sizeof(RaspiAPA102ColorQuad);
+    if (!RASPI_APA102_TEST_CHECK(capture->size == 
+        RASPI_APA102_START_FRAME_SIZE + led_size + end_size))
+    {
+        return;
+    }
+
+    // Start frame of 32 zero bits
+    const uint8_t* data = capture->data;
+    for (size_t i = 0; i < RASPI_APA102_START_FRAME_SIZE; ++i)
+    {
+        RASPI_APA102_TEST_CHECK(data[i] == 0x00);
+    }
+    data += RASPI_APA102_START_FRAME_SIZE;
+
+    // LED frames (<0xE0+brightness> <blue> <green> <red>)
+    RASPI_APA102_TEST_CHECK(!memcmp(data, colors, led_size));
+    if (count)
+    {
+        RASPI_APA102_TEST_CHECK(data[0] == (0xE0 | (colors[0].brightness & 0x1F)));
+        RASPI_APA102_TEST_CHECK(data[1] == colors[0].b);
+        RASPI_APA102_TEST_CHECK(data[3] == colors[0].r);
+    }
+    data += led_size;
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < end_size; ++i)
+    {
+        mismatches += (data[i] != end_value);
+    }
+    RASPI_APA102_TEST_CHECK(mismatches == 0);
+}
+
+/**
+ * @brief   Checks full, prefix and `RaspiAPA102DeviceUpdate` frames of the given length in the 
+ *          given chain mode.
+ *
+ * @param   count   The number of LEDs in the string.
+ * @param   mode    The chain mode.
+ */
+static void RaspiAPA102TestFramingRun(size_t count, RaspiAPA102ChainMode mode)
+{
+    const bool large = (mode == RASPI_APA102_CHAIN_MODE_LARGE);
+    const size_t reset_size = large ? RASPI_APA102_RESET_FRAME_SIZE : 0;
+
+    RaspiAPA102ColorQuad* const colors = malloc(count * sizeof(RaspiAPA102ColorQuad));
+    if (!RASPI_APA102_TEST_CHECK(colors))
+    {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        colors[i] = RaspiAPA102TestFramingGetColor(i, 0x5A);
+    }
+
+    RaspiAPA102Capture capture;
+    RaspiAPA102Transport transport;
+    RaspiAPA102Device device;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102CaptureInit(&capture, false) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102CaptureGetTransport(&capture, &transport) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceInitTransport(&device, &transport) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceAllocateBuffer(&device, count) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceSetChainMode(&device, mode) == 0);
+
+    // Full commit of the transmit buffer
+    for (size_t i = 0; i < count; ++i)
+    {
+        RaspiAPA102DeviceSetColor(&device, i, colors[i]);
+    }
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceCommit(&device) == 0);
+    RaspiAPA102TestFramingCheckStream(&capture, colors, count, 
+        reset_size + RASPI_APA102_END_FRAME_SIZE(count), large ? 0x00 : 0xFF);
+
+    // Dirty prefix up to the middle of the string, terminated by zero bits in both modes
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceSetRefreshInterval(&device, 1000) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceCommit(&device) == 0);
+    const size_t prefix = count / 2 + 1;
+    colors[prefix - 1] = RaspiAPA102TestFramingGetColor(prefix - 1, 0xA5);
+    RaspiAPA102DeviceSetColor(&device, prefix - 1, colors[prefix - 1]);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceCommit(&device) == 0);
+    if (prefix < count)
+    {
+        RaspiAPA102TestFramingCheckStream(&capture, colors, prefix, 
+            reset_size + RASPI_APA102_END_FRAME_SIZE(prefix), 0x00);
+    }
+    else
+    {
+        RaspiAPA102TestFramingCheckStream(&capture, colors, count, 
+            reset_size + RASPI_APA102_END_FRAME_SIZE(count), large ? 0x00 : 0xFF);
+    }
+
+    size_t bytes_sent;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceGetBytesSent(&device, &bytes_sent, NULL) == 0);
+    RASPI_APA102_TEST_CHECK(bytes_sent == capture.size);
+
+    // Update from a separate array
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceUpdate(&device, colors, count) == 0);
+    RaspiAPA102TestFramingCheckStream(&capture, colors, count, 
+        reset_size + RASPI_APA102_END_FRAME_SIZE(count), large ? 0x00 : 0xFF);
+
+    RaspiAPA102DeviceDestroy(&device);
+    RaspiAPA102CaptureDestroy(&capture);
+    free(colors);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102TestFraming(void)
+{
+    const size_t count = 
+        sizeof(RASPI_APA102_TEST_FRAMING_SIZES) / sizeof(RASPI_APA102_TEST_FRAMING_SIZES[0]);
+    for (size_t i = 0; i < count; ++i)
+    {
+        RaspiAPA102TestFramingRun(RASPI_APA102_TEST_FRAMING_SIZES[i], 
+            RASPI_APA102_CHAIN_MODE_DEFAULT);
+        RaspiAPA102TestFramingRun(RASPI_APA102_TEST_FRAMING_SIZES[i], 
+            RASPI_APA102_CHAIN_MODE_LARGE);
+    }
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,207 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/LayerStack.h>
+#include <RaspiAPA102/SIMD.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The number of pixels (odd, so that the scalar remainder of the vectorized 
+ *          implementations is covered).
+ */
+#define RASPI_APA102_TEST_LAYER_COUNT 1027
+
+/**
+ * @brief   The first pixel of the partially recomposed range (not aligned to the vector width).
+ */
+#define RASPI_APA102_TEST_LAYER_DIRTY_OFFSET 5
+
+/**
+ * @brief   The number of pixels of the partially recomposed range.
+ */
+#define RASPI_APA102_TEST_LAYER_DIRTY_COUNT 517
+
+/**
+ * @brief   The opacities of the top layer covered by the suite.
+ */
+static const uint8_t RASPI_APA102_TEST_LAYER_OPACITIES[] = { 255, 128, 7, 1 };
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Returns the next value of a linear congruential generator.
+ *
+ * @param   state   A pointer to the generator state.
+ *
+ * @return  The next pseudo-random byte.
+ */
+static uint8_t RaspiAPA102TestLayerRandom(uint32_t* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+
+    return (uint8_t)(*state >> 24);
+}
+
+/**
+ * @brief   Fills the given range of layer pixels with pseudo-random colors and coverages.
+ *
+ * @param   pixels  A pointer to the layer pixels.
+ * @param   count   The number of pixels.
+ * @param   state   A pointer to the generator state.
+ *
+ * Every eighth pixel is saturated and opaque, so that the clamping of the blend modes is covered.
+ */
+static void RaspiAPA102TestLayerFill(RaspiAPA102ColorQuad* pixels, size_t count, uint32_t* state)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if ((i & 7) == 0)
+        {
+            RaspiAPA102ColorQuadInit(&pixels[i], 255, 255, 255, 31);
+            continue;
+        }
+        const uint8_t r = RaspiAPA102TestLayerRandom(state);
+        const uint8_t g = RaspiAPA102TestLayerRandom(state);
+        const uint8_t b = RaspiAPA102TestLayerRandom(state);
+        RaspiAPA102ColorQuadInit(&pixels[i], r, g, b, RaspiAPA102TestLayerRandom(state) & 0x1F);
+    }
+}
+
+/**
+ * @brief   Composes a base layer and a top layer with the given blend mode.
+ *
+ * @param   path    The blend implementation.
+ * @param   mode    The blend mode of the top layer.
+ * @param   opacity The opacity of the top layer.
+ * @param   result  Receives the composed pixels of a full frame, followed by the composed pixels 
+ *                  after recomposing a partial range.
+ */
+static void RaspiAPA102TestLayerCompose(RaspiAPA102SIMDPath path, RaspiAPA102BlendMode mode, 
+    uint8_t opacity, RaspiAPA102ColorQuad* result)
+{
+    const size_t count = RASPI_APA102_TEST_LAYER_COUNT;
+    uint32_t state = 0x5EED0000u + (uint32_t)mode * 256 + opacity;
+
+    RaspiAPA102LayerStack stack;
+    if (!RASPI_APA102_TEST_CHECK(RaspiAPA102LayerStackInit(&stack, count, 2, 17) == 0))
+    {
+        return;
+    }
+    RASPI_APA102_TEST_CHECK(RaspiAPA102LayerStackSetPath(&stack, path) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102LayerStackAddLayer(&stack, RASPI_APA102_BLEND_ALPHA, 200, 
+        NULL, NULL, NULL) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102LayerStackAddLayer(&stack, mode, opacity, NULL, NULL, 
+        NULL) == 0);
+
+    RaspiAPA102ColorQuad* pixels[2];
+    for (size_t i = 0; i < 2; ++i)
+    {
+        RASPI_APA102_TEST_CHECK(RaspiAPA102LayerStackGetPixels(&stack, i, &pixels[i]) == 0);
+        RaspiAPA102TestLayerFill(pixels[i], count, &state);
+    }
+
+    const RaspiAPA102ColorQuad* output;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102LayerStackCompose(&stack, NULL, NULL) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102LayerStackGetOutput(&stack, &output, NULL) == 0);
+    memcpy(result, output, count * sizeof(RaspiAPA102ColorQuad));
+
+    // Recompose a range that starts and ends in the middle of a vector
+    RaspiAPA102TestLayerFill(&pixels[1][RASPI_APA102_TEST_LAYER_DIRTY_OFFSET], 
+        RASPI_APA102_TEST_LAYER_DIRTY_COUNT, &state);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102LayerStackMarkDirty(&stack, 1, 
+        RASPI_APA102_TEST_LAYER_DIRTY_OFFSET, RASPI_APA102_TEST_LAYER_DIRTY_COUNT) == 0);
+    size_t offset;
+    size_t recomposed;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102LayerStackCompose(&stack, &offset, &recomposed) == 0);
+    RASPI_APA102_TEST_CHECK((offset == RASPI_APA102_TEST_LAYER_DIRTY_OFFSET) && 
+        (recomposed == RASPI_APA102_TEST_LAYER_DIRTY_COUNT));
+    memcpy(result + count, output, count * sizeof(RaspiAPA102ColorQuad));
+
+    RaspiAPA102LayerStackDestroy(&stack);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102TestLayer(void)
+{
+    const size_t count = 2 * RASPI_APA102_TEST_LAYER_COUNT;
+    RaspiAPA102ColorQuad* const expected = calloc(count, sizeof(RaspiAPA102ColorQuad));
+    RaspiAPA102ColorQuad* const result = calloc(count, sizeof(RaspiAPA102ColorQuad));
+    if (!RASPI_APA102_TEST_CHECK(expected && result))
+    {
+        free(expected);
+        free(result);
+        return;
+    }
+
+    const size_t opacity_count = 
+        sizeof(RASPI_APA102_TEST_LAYER_OPACITIES) / sizeof(RASPI_APA102_TEST_LAYER_OPACITIES[0]);
+    for (int path = RASPI_APA102_SIMD_SCALAR + 1; path <= RASPI_APA102_SIMD_MAX_VALUE; ++path)
+    {
+        if (!RaspiAPA102SIMDIsSupported((RaspiAPA102SIMDPath)path))
+        {
+            continue;
+        }
+        printf("layer: checking the %s implementation\n", 
+            RaspiAPA102SIMDGetName((RaspiAPA102SIMDPath)path));
+
+        for (int mode = 0; mode <= RASPI_APA102_BLEND_MAX_VALUE; ++mode)
+        {
+            for (size_t i = 0; i < opacity_count; ++i)
+            {
+                const uint8_t opacity = RASPI_APA102_TEST_LAYER_OPACITIES[i];
+                RaspiAPA102TestLayerCompose(RASPI_APA102_SIMD_SCALAR, (RaspiAPA102BlendMode)mode, 
+                    opacity, expected);
+                RaspiAPA102TestLayerCompose((RaspiAPA102SIMDPath)path, (RaspiAPA102BlendMode)mode, 
+                    opacity, result);
+
+                size_t mismatches = 0;
+                for (size_t j = 0; j < count; ++j)
+                {
+                    mismatches += !!memcmp(&expected[j], &result[j], sizeof(RaspiAPA102ColorQuad));
+                }
+                RASPI_APA102_TEST_CHECK(mismatches == 0);
+            }
+        }
+    }
+
+    free(expected);
+    free(result);
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,207 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Packing.h>
+#include <RaspiAPA102/SIMD.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The brightness passed to the packers.
+ */
+#define RASPI_APA102_TEST_PACKING_BRIGHTNESS 21
+
+/**
+ * @brief   The maximum number of pixels.
+ */
+#define RASPI_APA102_TEST_PACKING_MAX_COUNT 1001
+
+/**
+ * @brief   The pixel counts covered by the suite (none is a multiple of the vector widths).
+ */
+static const size_t RASPI_APA102_TEST_PACKING_COUNTS[] = { 1, 3, 7, 15, 17, 31, 33, 63, 1001 };
+
+/**
+ * @brief   The source byte offsets of the red, green and blue components and the pixel size of 
+ *          every `RaspiAPA102PixelFormat`.
+ */
+static const uint8_t RASPI_APA102_TEST_PACKING_FORMATS[][4] =
+{
+    { 0, 1, 2, 3 }, // RGB
+    { 2, 1, 0, 3 }, // BGR
+    { 1, 0, 2, 3 }, // GRB
+    { 0, 1, 2, 4 }, // RGBA
+    { 2, 1, 0, 4 }, // BGRA
+    { 1, 2, 3, 4 }  // ARGB
+};
+
+/**
+ * @brief   The component (`0` = red, `1` = green, `2` = blue) of the three color bytes on the 
+ *          wire for every `RaspiAPA102ChannelOrder`.
+ */
+static const uint8_t RASPI_APA102_TEST_PACKING_ORDERS[][3] =
+{
+    { 2, 1, 0 }, // BGR
+    { 2, 0, 1 }, // BRG
+    { 1, 2, 0 }, // GBR
+    { 1, 0, 2 }, // GRB
+    { 0, 2, 1 }, // RBG
+    { 0, 1, 2 }  // RGB
+};
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Packs the given pixels and checks the quads.
+ *
+ * @param   packer      A pointer to the `RaspiAPA102Packer` struct.
+ * @param   pixels      A pointer to the source pixels.
+ * @param   count       The number of pixels.
+ * @param   expected    The expected quads.
+ * @param   quads       A buffer for `count + 1` quads.
+ *
+ * The quad behind the last pixel has to stay untouched.
+ */
+static void RaspiAPA102TestPackingCheck(const RaspiAPA102Packer* packer, const uint8_t* pixels, 
+    size_t count, const uint8_t* expected, RaspiAPA102ColorQuad* quads)
+{
+    memset(quads, 0xCC, (count + 1) * sizeof(RaspiAPA102ColorQuad));
+    RASPI_APA102_TEST_CHECK(RaspiAPA102PackerPack(packer, quads, pixels, count) == 0);
+
+    const uint8_t* const data = (const uint8_t*)quads;
+    RASPI_APA102_TEST_CHECK(!memcmp(data, expected, count * sizeof(RaspiAPA102ColorQuad)));
+    size_t overwritten = 0;
+    for (size_t i = 0; i < sizeof(RaspiAPA102ColorQuad); ++i)
+    {
+        overwritten += (data[count * sizeof(RaspiAPA102ColorQuad) + i] != 0xCC);
+    }
+    RASPI_APA102_TEST_CHECK(overwritten == 0);
+}
+
+/**
+ * @brief   Checks all supported implementations for the given format and channel order.
+ *
+ * @param   format  The source pixel format.
+ * @param   order   The channel order on the wire.
+ * @param   pixels  The source pixels (`RASPI_APA102_TEST_PACKING_MAX_COUNT` pixels of 4 bytes, 
+ *                  starting at an odd address).
+ * @param   buffer  A buffer for the expected quads and the packed quads.
+ */
+static void RaspiAPA102TestPackingRun(RaspiAPA102PixelFormat format, RaspiAPA102ChannelOrder order, 
+    const uint8_t* pixels, uint8_t* buffer)
+{
+    const uint8_t* const layout = RASPI_APA102_TEST_PACKING_FORMATS[format];
+    const uint8_t* const wire = RASPI_APA102_TEST_PACKING_ORDERS[order];
+    const size_t quad_size = sizeof(RaspiAPA102ColorQuad);
+    uint8_t* const expected = buffer;
+    RaspiAPA102ColorQuad* const quads = 
+        (RaspiAPA102ColorQuad*)(buffer + RASPI_APA102_TEST_PACKING_MAX_COUNT * quad_size);
+
+    // Reference conversion, independent of the implementations of the library
+    for (size_t i = 0; i < RASPI_APA102_TEST_PACKING_MAX_COUNT; ++i)
+    {
+        const uint8_t* const pixel = pixels + i * layout[3];
+        expected[i * quad_size] = 0xE0 | RASPI_APA102_TEST_PACKING_BRIGHTNESS;
+        for (size_t j = 0; j < 3; ++j)
+        {
+            expected[i * quad_size + 1 + j] = pixel[layout[wire[j]]];
+        }
+    }
+
+    RaspiAPA102Packer packer;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102PackerInit(&packer, format, order, 
+        RASPI_APA102_TEST_PACKING_BRIGHTNESS) == 0);
+
+    const size_t count = 
+        sizeof(RASPI_APA102_TEST_PACKING_COUNTS) / sizeof(RASPI_APA102_TEST_PACKING_COUNTS[0]);
+    for (int path = RASPI_APA102_SIMD_SCALAR; path <= RASPI_APA102_SIMD_MAX_VALUE; ++path)
+    {
+        if (!RaspiAPA102SIMDIsSupported((RaspiAPA102SIMDPath)path))
+        {
+            continue;
+        }
+        RASPI_APA102_TEST_CHECK(RaspiAPA102PackerSetPath(&packer, (RaspiAPA102SIMDPath)path) == 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            RaspiAPA102TestPackingCheck(&packer, pixels, RASPI_APA102_TEST_PACKING_COUNTS[i], 
+                expected, quads);
+        }
+    }
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102TestPacking(void)
+{
+    const size_t quad_size = sizeof(RaspiAPA102ColorQuad);
+    uint8_t* const source = malloc(RASPI_APA102_TEST_PACKING_MAX_COUNT * 4 + 1);
+    uint8_t* const buffer = malloc((2 * RASPI_APA102_TEST_PACKING_MAX_COUNT + 1) * quad_size);
+    if (!RASPI_APA102_TEST_CHECK(source && buffer))
+    {
+        free(source);
+        free(buffer);
+        return;
+    }
+    for (size_t i = 0; i < RASPI_APA102_TEST_PACKING_MAX_COUNT * 4 + 1; ++i)
+    {
+        source[i] = (uint8_t)(i * 37 + (i >> 8) * 11);
+    }
+
+    for (int path = RASPI_APA102_SIMD_SCALAR + 1; path <= RASPI_APA102_SIMD_MAX_VALUE; ++path)
+    {
+        if (RaspiAPA102SIMDIsSupported((RaspiAPA102SIMDPath)path))
+        {
+            printf("packing: checking the %s implementation\n", 
+                RaspiAPA102SIMDGetName((RaspiAPA102SIMDPath)path));
+        }
+    }
+
+    // The pixels start at an odd address, so that unaligned loads are covered
+    for (int format = 0; format <= RASPI_APA102_PIXEL_FORMAT_MAX_VALUE; ++format)
+    {
+        for (int order = 0; order <= RASPI_APA102_CHANNEL_ORDER_MAX_VALUE; ++order)
+        {
+            RaspiAPA102TestPackingRun((RaspiAPA102PixelFormat)format, 
+                (RaspiAPA102ChannelOrder)order, source + 1, buffer);
+        }
+    }
+
+    free(source);
+    free(buffer);
+}
+
+/* ============================================================================================== */
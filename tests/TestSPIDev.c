@@ -0,0 +1,378 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Transport.h>
+#include <TransportInternal.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The transfer alignment the `spidev` driver applies inside its bounce buffer.
+ */
+#define RASPI_APA102_TEST_SPIDEV_ALIGNMENT 128
+
+/**
+ * @brief   The maximum number of transfers in a single message.
+ */
+#define RASPI_APA102_TEST_SPIDEV_MAX_TRANSFERS 16
+
+/**
+ * @brief   The `SPI` clock frequency passed to the transport.
+ */
+#define RASPI_APA102_TEST_SPIDEV_SPEED 8000000
+
+/**
+ * @brief   The number of segments written directly to the transport.
+ */
+#define RASPI_APA102_TEST_SPIDEV_SEGMENTS 40
+
+/**
+ * @brief   The upper bound of the segment sizes.
+ */
+#define RASPI_APA102_TEST_SPIDEV_SEGMENT_SIZE 600
+
+/**
+ * @brief   The message size limits covered by the suite (the third one is not aligned).
+ */
+static const size_t RASPI_APA102_TEST_SPIDEV_BUFSIZES[] = { 128, 4096, 1000, 65536 };
+
+/**
+ * @brief   The string lengths covered by the suite.
+ */
+static const size_t RASPI_APA102_TEST_SPIDEV_SIZES[] = { 1, 47, 1000, 10000, 50000, 100000 };
+
+/* ============================================================================================== */
+/* Internal types                                                                                 */
+/* ============================================================================================== */
+
+/**
+ * @brief   Defines the `RaspiAPA102TestSPIDevRecorder` struct.
+ *
+ * Records the messages the `spidev` transport submits in place of the `SPI_IOC_MESSAGE` request.
+ */
+typedef struct RaspiAPA102TestSPIDevRecorder_
+{
+    /**
+     * @brief   The aligned message size limit.
+     */
+    size_t bufsiz;
+    /**
+     * @brief   The joined data of all recorded transfers.
+     */
+    uint8_t* data;
+    /**
+     * @brief   The number of recorded bytes.
+     */
+    size_t size;
+    /**
+     * @brief   The capacity of the `data` buffer.
+     */
+    size_t capacity;
+    /**
+     * @brief   The number of recorded messages.
+     */
+    size_t message_count;
+    /**
+     * @brief   The largest number of transfers in a single message.
+     */
+    size_t max_transfers;
+    /**
+     * @brief   The number of messages or transfers that the `spidev` driver would reject.
+     */
+    size_t violations;
+    /**
+     * @brief   Signals, if the next message fails.
+     */
+    bool fail;
+} RaspiAPA102TestSPIDevRecorder;
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Records a single message.
+ *
+ * @param   user        A pointer to the `RaspiAPA102TestSPIDevRecorder` struct.
+ * @param   transfers   A pointer to the chained `spi_ioc_transfer` structs.
+ * @param   count       The number of structs in the passed array.
+ *
+ * @return  A status code.
+ */
+static int RaspiAPA102TestSPIDevSubmit(void* user, const struct spi_ioc_transfer* transfers, 
+    size_t count)
+{
+    RaspiAPA102TestSPIDevRecorder* const recorder = user;
+
+    if (recorder->fail)
+    {
+        return -1;
+    }
+
+    ++recorder->message_count;
+    if (count > recorder->max_transfers)
+    {
+        recorder->max_transfers = count;
+    }
+
+    // The driver rejects messages with more than `bufsiz` bytes after aligning every transfer
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t length = transfers[i].len;
+        total += (length + RASPI_APA102_TEST_SPIDEV_ALIGNMENT - 1) & 
+            ~(size_t)(RASPI_APA102_TEST_SPIDEV_ALIGNMENT - 1);
+        recorder->violations += !length || transfers[i].rx_buf || 
+            (transfers[i].speed_hz != RASPI_APA102_TEST_SPIDEV_SPEED) || 
+            (transfers[i].bits_per_word != 8);
+
+        if (recorder->size + length > recorder->capacity)
+        {
+            const size_t capacity = 2 * (recorder->size + length);
+            uint8_t* const data = realloc(recorder->data, capacity);
+            if (!data)
+            {
+                return -1;
+            }
+            recorder->data = data;
+            recorder->capacity = capacity;
+        }
+        memcpy(recorder->data + recorder->size, (const void*)(uintptr_t)transfers[i].tx_buf, 
+            length);
+        recorder->size += length;
+    }
+    recorder->violations += (count > RASPI_APA102_TEST_SPIDEV_MAX_TRANSFERS) || 
+        (total > recorder->bufsiz);
+
+    return 0;
+}
+
+/**
+ * @brief   Creates a `spidev` transport that submits to the given recorder.
+ *
+ * @param   transport   Receives the transport.
+ * @param   recorder    A pointer to the `RaspiAPA102TestSPIDevRecorder` struct.
+ * @param   bufsiz      The message size limit.
+ *
+ * @return  `true`, if the transport was created.
+ */
+static bool RaspiAPA102TestSPIDevCreate(RaspiAPA102Transport* transport, 
+    RaspiAPA102TestSPIDevRecorder* recorder, size_t bufsiz)
+{
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->bufsiz = bufsiz & ~(size_t)(RASPI_APA102_TEST_SPIDEV_ALIGNMENT - 1);
+
+    return RASPI_APA102_TEST_CHECK(RaspiAPA102SPIDevTransportCreateEx(transport, "/dev/null", 
+        RASPI_APA102_TEST_SPIDEV_SPEED, bufsiz, &RaspiAPA102TestSPIDevSubmit, recorder) == 0);
+}
+
+/**
+ * @brief   Checks that the recorded messages reproduce the captured frame.
+ *
+ * @param   recorder    A pointer to the `RaspiAPA102TestSPIDevRecorder` struct.
+ * @param   capture     A pointer to the `RaspiAPA102Capture` struct holding the expected frame.
+ */
+static void RaspiAPA102TestSPIDevCheckFrame(RaspiAPA102TestSPIDevRecorder* recorder, 
+    const RaspiAPA102Capture* capture)
+{
+    RASPI_APA102_TEST_CHECK(recorder->violations == 0);
+    RASPI_APA102_TEST_CHECK(recorder->max_transfers <= RASPI_APA102_TEST_SPIDEV_MAX_TRANSFERS);
+    if (RASPI_APA102_TEST_CHECK(recorder->size == capture->size))
+    {
+        RASPI_APA102_TEST_CHECK(!memcmp(recorder->data, capture->data, capture->size));
+    }
+    recorder->size = 0;
+}
+
+/**
+ * @brief   Writes more segments than the transport queues per message and checks the joined 
+ *          stream.
+ *
+ * @param   bufsiz  The message size limit.
+ */
+static void RaspiAPA102TestSPIDevRunSegments(size_t bufsiz)
+{
+    RaspiAPA102TestSPIDevRecorder recorder;
+    RaspiAPA102Transport transport;
+    if (!RaspiAPA102TestSPIDevCreate(&transport, &recorder, bufsiz))
+    {
+        return;
+    }
+
+    // Odd segment sizes around the alignment and the message limit, including empty segments
+    uint8_t source[RASPI_APA102_TEST_SPIDEV_SEGMENTS * RASPI_APA102_TEST_SPIDEV_SEGMENT_SIZE];
+    for (size_t i = 0; i < sizeof(source); ++i)
+    {
+        source[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < RASPI_APA102_TEST_SPIDEV_SEGMENTS; ++i)
+    {
+        const size_t size = (i * 97 + (i & 1) * bufsiz) % RASPI_APA102_TEST_SPIDEV_SEGMENT_SIZE;
+        RASPI_APA102_TEST_CHECK(transport.write(transport.context, source + offset, size) == 0);
+        offset += size;
+    }
+    RASPI_APA102_TEST_CHECK(transport.flush(transport.context) == 0);
+
+    // The queue of pending segments overflows, so the frame spans several messages
+    RASPI_APA102_TEST_CHECK(recorder.violations == 0);
+    RASPI_APA102_TEST_CHECK(recorder.message_count > 1);
+    RASPI_APA102_TEST_CHECK(recorder.max_transfers <= RASPI_APA102_TEST_SPIDEV_MAX_TRANSFERS);
+    if (bufsiz >= RASPI_APA102_TEST_SPIDEV_MAX_TRANSFERS * RASPI_APA102_TEST_SPIDEV_SEGMENT_SIZE)
+    {
+        RASPI_APA102_TEST_CHECK(recorder.max_transfers == RASPI_APA102_TEST_SPIDEV_MAX_TRANSFERS);
+    }
+    if (RASPI_APA102_TEST_CHECK(recorder.size == offset))
+    {
+        RASPI_APA102_TEST_CHECK(!memcmp(recorder.data, source, offset));
+    }
+
+    // A failed message drops the pending segments
+    recorder.fail = true;
+    RASPI_APA102_TEST_CHECK(transport.write(transport.context, source, 300) == 0);
+    RASPI_APA102_TEST_CHECK(transport.flush(transport.context) < 0);
+    recorder.fail = false;
+    recorder.message_count = 0;
+    RASPI_APA102_TEST_CHECK(transport.flush(transport.context) == 0);
+    RASPI_APA102_TEST_CHECK(recorder.message_count == 0);
+
+    transport.close(transport.context);
+    free(recorder.data);
+}
+
+/**
+ * @brief   Checks full, prefix and `RaspiAPA102DeviceUpdate` frames of the given length against 
+ *          the capture transport.
+ *
+ * @param   count   The number of LEDs in the string.
+ * @param   mode    The chain mode.
+ * @param   bufsiz  The message size limit.
+ */
+static void RaspiAPA102TestSPIDevRunDevice(size_t count, RaspiAPA102ChainMode mode, 
+    size_t bufsiz)
+{
+    RaspiAPA102ColorQuad* const colors = malloc(count * sizeof(RaspiAPA102ColorQuad));
+    if (!RASPI_APA102_TEST_CHECK(colors))
+    {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        RaspiAPA102ColorQuadInit(&colors[i], (uint8_t)i, (uint8_t)(i >> 8), (uint8_t)(i >> 16), 
+            (uint8_t)(i * 3));
+    }
+
+    RaspiAPA102TestSPIDevRecorder recorder;
+    RaspiAPA102Capture capture;
+    RaspiAPA102Transport transport;
+    RaspiAPA102Device devices[2];
+    if (!RaspiAPA102TestSPIDevCreate(&transport, &recorder, bufsiz))
+    {
+        free(colors);
+        return;
+    }
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceInitTransport(&devices[0], &transport) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102CaptureInit(&capture, false) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102CaptureGetTransport(&capture, &transport) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceInitTransport(&devices[1], &transport) == 0);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceAllocateBuffer(&devices[i], count) == 0);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceSetChainMode(&devices[i], mode) == 0);
+    }
+
+    // Full commit of the transmit buffer
+    for (size_t i = 0; i < 2; ++i)
+    {
+        for (size_t j = 0; j < count; ++j)
+        {
+            RaspiAPA102DeviceSetColor(&devices[i], j, colors[j]);
+        }
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceCommit(&devices[i]) == 0);
+    }
+    RaspiAPA102TestSPIDevCheckFrame(&recorder, &capture);
+
+    // Dirty prefix up to the middle of the string
+    const size_t prefix = count / 2 + 1;
+    RaspiAPA102ColorQuadInit(&colors[prefix - 1], 0x12, 0x34, 0x56, 0x1F);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceSetRefreshInterval(&devices[i], 1000) == 0);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceCommit(&devices[i]) == 0);
+    }
+    RaspiAPA102TestSPIDevCheckFrame(&recorder, &capture);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        RaspiAPA102DeviceSetColor(&devices[i], prefix - 1, colors[prefix - 1]);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceCommit(&devices[i]) == 0);
+    }
+    RaspiAPA102TestSPIDevCheckFrame(&recorder, &capture);
+
+    // Update from a separate array
+    for (size_t i = 0; i < 2; ++i)
+    {
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceUpdate(&devices[i], colors, count) == 0);
+    }
+    RaspiAPA102TestSPIDevCheckFrame(&recorder, &capture);
+
+    RaspiAPA102DeviceDestroy(&devices[0]);
+    RaspiAPA102DeviceDestroy(&devices[1]);
+    RaspiAPA102CaptureDestroy(&capture);
+    free(recorder.data);
+    free(colors);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102TestSPIDev(void)
+{
+    const size_t bufsiz_count = 
+        sizeof(RASPI_APA102_TEST_SPIDEV_BUFSIZES) / sizeof(RASPI_APA102_TEST_SPIDEV_BUFSIZES[0]);
+    const size_t size_count = 
+        sizeof(RASPI_APA102_TEST_SPIDEV_SIZES) / sizeof(RASPI_APA102_TEST_SPIDEV_SIZES[0]);
+    for (size_t i = 0; i < bufsiz_count; ++i)
+    {
+        const size_t bufsiz = RASPI_APA102_TEST_SPIDEV_BUFSIZES[i];
+        RaspiAPA102TestSPIDevRunSegments(bufsiz);
+        for (size_t j = 0; j < size_count; ++j)
+        {
+            RaspiAPA102TestSPIDevRunDevice(RASPI_APA102_TEST_SPIDEV_SIZES[j], 
+                RASPI_APA102_CHAIN_MODE_DEFAULT, bufsiz);
+            RaspiAPA102TestSPIDevRunDevice(RASPI_APA102_TEST_SPIDEV_SIZES[j], 
+                RASPI_APA102_CHAIN_MODE_LARGE, bufsiz);
+        }
+    }
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,306 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/SoftSPI.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The number of lanes.
+ */
+#define RASPI_APA102_TEST_SOFTSPI_LANES 4
+
+/**
+ * @brief   The shared `SCLK` pin.
+ */
+#define RASPI_APA102_TEST_SOFTSPI_SCLK 11
+
+/**
+ * @brief   The index of the `GPCLR0` register.
+ */
+#define RASPI_APA102_TEST_SOFTSPI_GPCLR0 (0x28 / 4)
+
+/**
+ * @brief   The clock frequency in Hz.
+ */
+#define RASPI_APA102_TEST_SOFTSPI_CLOCK 8000000
+
+/**
+ * @brief   The `MOSI` pins of the lanes.
+ */
+static const int RASPI_APA102_TEST_SOFTSPI_PINS[RASPI_APA102_TEST_SOFTSPI_LANES] = 
+{ 
+    10, 12, 23, 27 
+};
+
+/**
+ * @brief   The LED counts of the lanes (the lane with the most LEDs is not the first one).
+ */
+static const size_t RASPI_APA102_TEST_SOFTSPI_COUNTS[RASPI_APA102_TEST_SOFTSPI_LANES] = 
+{ 
+    7, 60, 1, 0 
+};
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Decodes the bytes of a single lane from the given `GPIO` masks.
+ *
+ * @param   masks   A pointer to the `GPIO` masks (one per clock period).
+ * @param   count   The number of masks (a multiple of `8`).
+ * @param   pin     The `MOSI` pin of the lane.
+ * @param   data    Receives `count / 8` bytes.
+ */
+static void RaspiAPA102TestSoftSPIDecode(const uint32_t* masks, size_t count, int pin, 
+    uint8_t* data)
+{
+    for (size_t i = 0; i < count / 8; ++i)
+    {
+        // Bits are sent MSB first
+        uint8_t value = 0;
+        for (size_t bit = 0; bit < 8; ++bit)
+        {
+            value = (uint8_t)((value << 1) | ((masks[i * 8 + bit] >> pin) & 1));
+        }
+        data[i] = value;
+    }
+}
+
+/**
+ * @brief   Checks that the given masks only drive the `MOSI` pins.
+ *
+ * @param   masks   A pointer to the `GPIO` masks.
+ * @param   count   The number of masks.
+ */
+static void RaspiAPA102TestSoftSPICheckPins(const uint32_t* masks, size_t count)
+{
+    uint32_t mask_mosi = 0;
+    for (size_t lane = 0; lane < RASPI_APA102_TEST_SOFTSPI_LANES; ++lane)
+    {
+        mask_mosi |= 1u << RASPI_APA102_TEST_SOFTSPI_PINS[lane];
+    }
+
+    size_t violations = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        violations += ((masks[i] & ~mask_mosi) != 0);
+    }
+    RASPI_APA102_TEST_CHECK(violations == 0);
+}
+
+/**
+ * @brief   Checks raw lane buffers of different sizes, which are padded with `0xFF`.
+ *
+ * @param   spi A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ */
+static void RaspiAPA102TestSoftSPIEncode(const RaspiAPA102MultiLaneSPI* spi)
+{
+    enum { SIZE = 37 };
+
+    uint8_t buffers[RASPI_APA102_TEST_SOFTSPI_LANES][SIZE];
+    const uint8_t* lanes[RASPI_APA102_TEST_SOFTSPI_LANES];
+    size_t sizes[RASPI_APA102_TEST_SOFTSPI_LANES];
+    for (size_t lane = 0; lane < RASPI_APA102_TEST_SOFTSPI_LANES; ++lane)
+    {
+        for (size_t i = 0; i < SIZE; ++i)
+        {
+            buffers[lane][i] = (uint8_t)(i * 13 + lane * 71);
+        }
+        lanes[lane] = buffers[lane];
+        sizes[lane] = SIZE - lane * 9;
+    }
+
+    uint32_t masks[SIZE * 8];
+    RASPI_APA102_TEST_CHECK(RaspiAPA102MultiLaneSPIEncode(spi, lanes, sizes, SIZE, masks) == 0);
+    RaspiAPA102TestSoftSPICheckPins(masks, SIZE * 8);
+
+    for (size_t lane = 0; lane < RASPI_APA102_TEST_SOFTSPI_LANES; ++lane)
+    {
+        uint8_t data[SIZE];
+        RaspiAPA102TestSoftSPIDecode(masks, SIZE * 8, RASPI_APA102_TEST_SOFTSPI_PINS[lane], data);
+        RASPI_APA102_TEST_CHECK(!memcmp(data, buffers[lane], sizes[lane]));
+        for (size_t i = sizes[lane]; i < SIZE; ++i)
+        {
+            RASPI_APA102_TEST_CHECK(data[i] == 0xFF);
+        }
+    }
+}
+
+/**
+ * @brief   Checks that every lane of an update decodes to its `APA102` stream.
+ *
+ * @param   spi A pointer to the `RaspiAPA102MultiLaneSPI` struct.
+ *
+ * Lanes with less LEDs have to be padded with LED frames that turn the LEDs off; only the end
+ * frame consists of ones.
+ */
+static void RaspiAPA102TestSoftSPIEncodeUpdate(const RaspiAPA102MultiLaneSPI* spi)
+{
+    size_t count = 0;
+    for (size_t lane = 0; lane < RASPI_APA102_TEST_SOFTSPI_LANES; ++lane)
+    {
+        if (RASPI_APA102_TEST_SOFTSPI_COUNTS[lane] > count)
+        {
+            count = RASPI_APA102_TEST_SOFTSPI_COUNTS[lane];
+        }
+    }
+
+    RaspiAPA102ColorQuad colors[RASPI_APA102_TEST_SOFTSPI_LANES][64];
+    const RaspiAPA102ColorQuad* pointers[RASPI_APA102_TEST_SOFTSPI_LANES];
+    for (size_t lane = 0; lane < RASPI_APA102_TEST_SOFTSPI_LANES; ++lane)
+    {
+        for (size_t i = 0; i < RASPI_APA102_TEST_SOFTSPI_COUNTS[lane]; ++i)
+        {
+            RaspiAPA102ColorQuadInit(&colors[lane][i], (uint8_t)(i + 1), (uint8_t)(lane + 1), 
+                (uint8_t)(i * 5), (uint8_t)(i + lane));
+        }
+        pointers[lane] = colors[lane];
+    }
+
+    size_t mask_count = 0;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102MultiLaneSPIEncodeUpdate(spi, pointers, 
+        RASPI_APA102_TEST_SOFTSPI_COUNTS, NULL, &mask_count) == 0);
+    if (!RASPI_APA102_TEST_CHECK(mask_count == RASPI_APA102_FRAME_SIZE(count) * 8))
+    {
+        return;
+    }
+
+    uint32_t* const masks = malloc(mask_count * sizeof(uint32_t));
+    uint8_t* const data = malloc(mask_count / 8);
+    uint8_t* const expected = malloc(mask_count / 8);
+    if (!RASPI_APA102_TEST_CHECK(masks && data && expected))
+    {
+        free(masks);
+        free(data);
+        free(expected);
+        return;
+    }
+
+    size_t capacity = mask_count - 1;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102MultiLaneSPIEncodeUpdate(spi, pointers, 
+        RASPI_APA102_TEST_SOFTSPI_COUNTS, masks, &capacity) < 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102MultiLaneSPIEncodeUpdate(spi, pointers, 
+        RASPI_APA102_TEST_SOFTSPI_COUNTS, masks, &mask_count) == 0);
+    RaspiAPA102TestSoftSPICheckPins(masks, mask_count);
+
+    for (size_t lane = 0; lane < RASPI_APA102_TEST_SOFTSPI_LANES; ++lane)
+    {
+        // <start frame> <LED frames> <off frames up to the longest lane> <end frame of ones>
+        const size_t lane_count = RASPI_APA102_TEST_SOFTSPI_COUNTS[lane];
+        uint8_t* position = expected;
+        memset(position, 0x00, RASPI_APA102_START_FRAME_SIZE);
+        position += RASPI_APA102_START_FRAME_SIZE;
+        memcpy(position, colors[lane], lane_count * sizeof(RaspiAPA102ColorQuad));
+        position += lane_count * sizeof(RaspiAPA102ColorQuad);
+        for (size_t i = lane_count; i < count; ++i)
+        {
+            static const uint8_t off[4] = { 0xE0, 0x00, 0x00, 0x00 };
+            memcpy(position, off, sizeof(off));
+            position += sizeof(off);
+        }
+        memset(position, 0xFF, RASPI_APA102_END_FRAME_SIZE(count));
+
+        RaspiAPA102TestSoftSPIDecode(masks, mask_count, RASPI_APA102_TEST_SOFTSPI_PINS[lane], 
+            data);
+        RASPI_APA102_TEST_CHECK(!memcmp(data, expected, mask_count / 8));
+    }
+
+    free(masks);
+    free(data);
+    free(expected);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102TestSoftSPI(void)
+{
+    // The `GPIO` registers are replaced by plain memory
+    static uint32_t registers[RASPI_APA102_GPIO_REGISTER_COUNT];
+
+    RaspiAPA102MultiLaneSPI spi;
+    if (!RASPI_APA102_TEST_CHECK(RaspiAPA102MultiLaneSPIInit(&spi, registers, 
+        RASPI_APA102_TEST_SOFTSPI_SCLK, RASPI_APA102_TEST_SOFTSPI_PINS, 
+        RASPI_APA102_TEST_SOFTSPI_LANES, RASPI_APA102_TEST_SOFTSPI_CLOCK) == 0))
+    {
+        return;
+    }
+
+    // All pins are switched to `OUTPUT` mode (function select `001`)
+    RASPI_APA102_TEST_CHECK(((registers[RASPI_APA102_TEST_SOFTSPI_SCLK / 10] >> 
+        ((RASPI_APA102_TEST_SOFTSPI_SCLK % 10) * 3)) & 7) == 1);
+    for (size_t lane = 0; lane < RASPI_APA102_TEST_SOFTSPI_LANES; ++lane)
+    {
+        const int pin = RASPI_APA102_TEST_SOFTSPI_PINS[lane];
+        RASPI_APA102_TEST_CHECK(((registers[pin / 10] >> ((pin % 10) * 3)) & 7) == 1);
+    }
+
+    RaspiAPA102TestSoftSPIEncode(&spi);
+    RaspiAPA102TestSoftSPIEncodeUpdate(&spi);
+
+    // The update runs against the stub and leaves the clock low
+    RaspiAPA102ColorQuad colors[RASPI_APA102_TEST_SOFTSPI_LANES][64] = { { { 0 } } };
+    const RaspiAPA102ColorQuad* pointers[RASPI_APA102_TEST_SOFTSPI_LANES];
+    for (size_t lane = 0; lane < RASPI_APA102_TEST_SOFTSPI_LANES; ++lane)
+    {
+        pointers[lane] = colors[lane];
+    }
+    RASPI_APA102_TEST_CHECK(RaspiAPA102MultiLaneSPIUpdate(&spi, pointers, 
+        RASPI_APA102_TEST_SOFTSPI_COUNTS) == 0);
+    RASPI_APA102_TEST_CHECK(
+        registers[RASPI_APA102_TEST_SOFTSPI_GPCLR0] == (1u << RASPI_APA102_TEST_SOFTSPI_SCLK));
+
+    RASPI_APA102_TEST_CHECK(RaspiAPA102MultiLaneSPIDestroy(&spi) == 0);
+
+    // Pins that are shared by two signals are rejected
+    const int duplicate[] = { 10, 12, 10 };
+    const int clock[] = { 10, RASPI_APA102_TEST_SOFTSPI_SCLK };
+    RASPI_APA102_TEST_CHECK(RaspiAPA102MultiLaneSPIInit(&spi, registers, 
+        RASPI_APA102_TEST_SOFTSPI_SCLK, duplicate, 3, RASPI_APA102_TEST_SOFTSPI_CLOCK) < 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102MultiLaneSPIInit(&spi, registers, 
+        RASPI_APA102_TEST_SOFTSPI_SCLK, clock, 2, RASPI_APA102_TEST_SOFTSPI_CLOCK) < 0);
+
+    RaspiAPA102SoftSPI single;
+    const int sclk = RASPI_APA102_TEST_SOFTSPI_SCLK;
+    const uint32_t clock_hz = RASPI_APA102_TEST_SOFTSPI_CLOCK;
+    RASPI_APA102_TEST_CHECK(
+        RaspiAPA102SoftSPIInit(&single, registers, sclk, sclk, -1, clock_hz) < 0);
+    RASPI_APA102_TEST_CHECK(
+        RaspiAPA102SoftSPIInit(&single, registers, sclk, 10, sclk, clock_hz) < 0);
+    RASPI_APA102_TEST_CHECK(
+        RaspiAPA102SoftSPIInit(&single, registers, sclk, 10, 10, clock_hz) < 0);
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,202 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/StripGroup.h>
+#include <RaspiAPA102/Transport.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The number of devices.
+ */
+#define RASPI_APA102_TEST_STRIP_GROUP_DEVICES 2
+
+/**
+ * @brief   The number of pixels on the canvas.
+ */
+#define RASPI_APA102_TEST_STRIP_GROUP_CANVAS 57
+
+/**
+ * @brief   The number of committed frames.
+ */
+#define RASPI_APA102_TEST_STRIP_GROUP_FRAMES 20
+
+/**
+ * @brief   The number of LEDs of every device.
+ */
+static const size_t RASPI_APA102_TEST_STRIP_GROUP_COUNTS[RASPI_APA102_TEST_STRIP_GROUP_DEVICES] = 
+{ 
+    40, 25 
+};
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Renders the canvas of the given frame.
+ *
+ * @param   canvas  A pointer to the canvas.
+ * @param   frame   The number of the frame.
+ */
+static void RaspiAPA102TestStripGroupRender(RaspiAPA102ColorQuad* canvas, size_t frame)
+{
+    for (size_t i = 0; i < RASPI_APA102_TEST_STRIP_GROUP_CANVAS; ++i)
+    {
+        RaspiAPA102ColorQuadInit(&canvas[i], (uint8_t)i, (uint8_t)frame, (uint8_t)(i * 7 + frame), 
+            (uint8_t)(i + frame));
+    }
+}
+
+/**
+ * @brief   Maps the canvas onto the expected LED frames of the devices.
+ *
+ * @param   expected    The expected LED frames of every device. LEDs that are not covered by a 
+ *                      segment keep their value.
+ * @param   canvas      A pointer to the canvas.
+ * @param   segments    A pointer to the segments.
+ * @param   count       The number of segments.
+ * @param   devices     A pointer to the devices.
+ */
+static void RaspiAPA102TestStripGroupMap(RaspiAPA102ColorQuad** expected, 
+    const RaspiAPA102ColorQuad* canvas, const RaspiAPA102StripSegment* segments, size_t count, 
+    const RaspiAPA102Device* devices)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const RaspiAPA102StripSegment* const segment = &segments[i];
+        RaspiAPA102ColorQuad* const destination = 
+            &expected[segment->device - devices][segment->device_offset];
+        for (size_t j = 0; j < segment->length; ++j)
+        {
+            const size_t k = segment->reversed ? segment->length - 1 - j : j;
+            destination[k] = canvas[segment->canvas_offset + j];
+        }
+    }
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102TestStripGroup(void)
+{
+    RaspiAPA102Capture captures[RASPI_APA102_TEST_STRIP_GROUP_DEVICES];
+    RaspiAPA102Device devices[RASPI_APA102_TEST_STRIP_GROUP_DEVICES];
+    RaspiAPA102ColorQuad* expected[RASPI_APA102_TEST_STRIP_GROUP_DEVICES];
+    for (size_t i = 0; i < RASPI_APA102_TEST_STRIP_GROUP_DEVICES; ++i)
+    {
+        const size_t count = RASPI_APA102_TEST_STRIP_GROUP_COUNTS[i];
+        RaspiAPA102Transport transport;
+        RASPI_APA102_TEST_CHECK(RaspiAPA102CaptureInit(&captures[i], true) == 0);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102CaptureGetTransport(&captures[i], &transport) == 0);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceInitTransport(&devices[i], &transport) == 0);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceAllocateBuffer(&devices[i], count) == 0);
+
+        // LEDs that are not covered by a segment keep the value of the transmit buffer
+        RaspiAPA102ColorQuad* colors;
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceGetBuffer(&devices[i], &colors, NULL) == 0);
+        for (size_t j = 0; j < count; ++j)
+        {
+            RaspiAPA102ColorQuadInit(&colors[j], 0xAA, (uint8_t)j, (uint8_t)i, 3);
+        }
+        expected[i] = malloc(count * sizeof(RaspiAPA102ColorQuad));
+        if (!RASPI_APA102_TEST_CHECK(expected[i]))
+        {
+            return;
+        }
+        memcpy(expected[i], colors, count * sizeof(RaspiAPA102ColorQuad));
+    }
+
+    // Forward and reversed segments on both devices, with a gap on the first device
+    const RaspiAPA102StripSegment segments[] =
+    {
+        { .device = &devices[0], .canvas_offset =  0, .device_offset =  0, .length = 12 },
+        { .device = &devices[0], .canvas_offset = 12, .device_offset = 17, .length = 23, 
+            .reversed = true },
+        { .device = &devices[1], .canvas_offset = 35, .device_offset =  0, .length = 15, 
+            .reversed = true },
+        { .device = &devices[1], .canvas_offset = 50, .device_offset = 18, .length =  7 }
+    };
+    const size_t segment_count = sizeof(segments) / sizeof(segments[0]);
+
+    RaspiAPA102StripGroup group;
+    if (!RASPI_APA102_TEST_CHECK(RaspiAPA102StripGroupInit(&group, 
+        RASPI_APA102_TEST_STRIP_GROUP_CANVAS, segments, segment_count) == 0))
+    {
+        return;
+    }
+    RaspiAPA102ColorQuad* canvas;
+    size_t canvas_size;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102StripGroupGetCanvas(&group, &canvas, &canvas_size) == 0);
+    RASPI_APA102_TEST_CHECK(canvas_size == RASPI_APA102_TEST_STRIP_GROUP_CANVAS);
+
+    for (size_t frame = 1; frame <= RASPI_APA102_TEST_STRIP_GROUP_FRAMES; ++frame)
+    {
+        RaspiAPA102TestStripGroupRender(canvas, frame);
+        RaspiAPA102TestStripGroupMap(expected, canvas, segments, segment_count, devices);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102StripGroupCommit(&group) == 0);
+
+        // Every other frame is committed back to back, so the next commit waits for the workers
+        if (frame & 1)
+        {
+            continue;
+        }
+        RASPI_APA102_TEST_CHECK(RaspiAPA102StripGroupWait(&group) == 0);
+
+        // Every device sent exactly one frame per commit (accumulated by the captures)
+        for (size_t i = 0; i < RASPI_APA102_TEST_STRIP_GROUP_DEVICES; ++i)
+        {
+            const size_t count = RASPI_APA102_TEST_STRIP_GROUP_COUNTS[i];
+            const size_t frame_size = RASPI_APA102_FRAME_SIZE(count);
+            RASPI_APA102_TEST_CHECK(captures[i].frame_count == frame);
+            if (!RASPI_APA102_TEST_CHECK(captures[i].size == frame * frame_size))
+            {
+                continue;
+            }
+            const uint8_t* const data = 
+                captures[i].data + (frame - 1) * frame_size + RASPI_APA102_START_FRAME_SIZE;
+            RASPI_APA102_TEST_CHECK(
+                !memcmp(data, expected[i], count * sizeof(RaspiAPA102ColorQuad)));
+        }
+    }
+
+    RASPI_APA102_TEST_CHECK(RaspiAPA102StripGroupDestroy(&group) == 0);
+    for (size_t i = 0; i < RASPI_APA102_TEST_STRIP_GROUP_DEVICES; ++i)
+    {
+        RaspiAPA102DeviceDestroy(&devices[i]);
+        RaspiAPA102CaptureDestroy(&captures[i]);
+        free(expected[i]);
+    }
+}
+
+/* ============================================================================================== */
@@ -0,0 +1,275 @@
+/***************************************************************************************************
+
+  Raspberry Pi APA102 Library
+
+  Original Author : Florian Bernd
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+
+***************************************************************************************************/
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <RaspiAPA102/APA102.h>
+#include <RaspiAPA102/Submitter.h>
+#include "Test.h"
+
+/* ============================================================================================== */
+/* Constants                                                                                      */
+/* ============================================================================================== */
+
+/**
+ * @brief   The number of targets.
+ */
+#define RASPI_APA102_TEST_SUBMITTER_TARGETS 2
+
+/**
+ * @brief   The number of frames sent to each target.
+ */
+#define RASPI_APA102_TEST_SUBMITTER_FRAMES 3
+
+/**
+ * @brief   The number of LEDs of each target.
+ */
+static const size_t RASPI_APA102_TEST_SUBMITTER_COUNTS[RASPI_APA102_TEST_SUBMITTER_TARGETS] = 
+{ 
+    100, 300 
+};
+
+/**
+ * @brief   The chunk size of each target (the second target splits every write).
+ */
+static const size_t RASPI_APA102_TEST_SUBMITTER_CHUNKS[RASPI_APA102_TEST_SUBMITTER_TARGETS] = 
+{ 
+    0, 64 
+};
+
+/* ============================================================================================== */
+/* Internal Functions                                                                             */
+/* ============================================================================================== */
+
+/**
+ * @brief   Reads all data that is available from the given pipe.
+ *
+ * @param   fd          The read end of the pipe (non-blocking).
+ * @param   buffer      Receives the data.
+ * @param   capacity    The size of the buffer in bytes.
+ *
+ * @return  The number of bytes read.
+ */
+static size_t RaspiAPA102TestSubmitterDrain(int fd, uint8_t* buffer, size_t capacity)
+{
+    size_t size = 0;
+    while (size < capacity)
+    {
+        const ssize_t result = read(fd, buffer + size, capacity - size);
+        if (result <= 0)
+        {
+            break;
+        }
+        size += (size_t)result;
+    }
+
+    return size;
+}
+
+/**
+ * @brief   Checks a single frame of the given colors in the default chain mode.
+ *
+ * @param   data    A pointer to the received data.
+ * @param   size    The number of received bytes.
+ * @param   colors  The expected LED frames.
+ * @param   count   The number of LED frames.
+ */
+static void RaspiAPA102TestSubmitterCheckFrame(const uint8_t* data, size_t size, 
+    const RaspiAPA102ColorQuad* colors, size_t count)
+{
+    if (!RASPI_APA102_TEST_CHECK(size == RASPI_APA102_FRAME_SIZE(count)))
+    {
+        return;
+    }
+
+    static const uint8_t start[RASPI_APA102_START_FRAME_SIZE] = { 0 };
+    RASPI_APA102_TEST_CHECK(!memcmp(data, start, sizeof(start)));
+    data += RASPI_APA102_START_FRAME_SIZE;
+    RASPI_APA102_TEST_CHECK(!memcmp(data, colors, count * sizeof(RaspiAPA102ColorQuad)));
+    data += count * sizeof(RaspiAPA102ColorQuad);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < RASPI_APA102_END_FRAME_SIZE(count); ++i)
+    {
+        mismatches += (data[i] != 0xFF);
+    }
+    RASPI_APA102_TEST_CHECK(mismatches == 0);
+}
+
+/**
+ * @brief   Sends frames to two pipe targets through the given backend and checks the received 
+ *          streams and the statistics.
+ *
+ * @param   backend The backend.
+ *
+ * The first target is driven by `RaspiAPA102DeviceCommit` (a single write per frame), the second 
+ * one by `RaspiAPA102DeviceUpdate` (several writes per frame, split into chunks). Finally, the
+ * reader of the first target is closed, so that the next frame is dropped.
+ */
+static void RaspiAPA102TestSubmitterRun(RaspiAPA102SubmitterBackend backend)
+{
+    RaspiAPA102Submitter submitter;
+    if (!RASPI_APA102_TEST_CHECK(RaspiAPA102SubmitterInit(&submitter, backend, 
+        RASPI_APA102_TEST_SUBMITTER_TARGETS, 8) == 0))
+    {
+        return;
+    }
+
+    RaspiAPA102SubmitterBackend used;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102SubmitterGetBackend(&submitter, &used) == 0);
+    RASPI_APA102_TEST_CHECK(used == backend);
+
+    int pipes[RASPI_APA102_TEST_SUBMITTER_TARGETS][2];
+    RaspiAPA102Device devices[RASPI_APA102_TEST_SUBMITTER_TARGETS];
+    RaspiAPA102ColorQuad* colors[RASPI_APA102_TEST_SUBMITTER_TARGETS];
+    for (size_t t = 0; t < RASPI_APA102_TEST_SUBMITTER_TARGETS; ++t)
+    {
+        const size_t count = RASPI_APA102_TEST_SUBMITTER_COUNTS[t];
+        RASPI_APA102_TEST_CHECK(pipe(pipes[t]) == 0);
+        fcntl(pipes[t][0], F_SETFL, fcntl(pipes[t][0], F_GETFL) | O_NONBLOCK);
+
+        size_t target;
+        RASPI_APA102_TEST_CHECK(RaspiAPA102SubmitterAddTarget(&submitter, pipes[t][1], 
+            RASPI_APA102_TEST_SUBMITTER_CHUNKS[t], &target) == 0);
+        RASPI_APA102_TEST_CHECK(target == t);
+
+        RaspiAPA102Transport transport;
+        RASPI_APA102_TEST_CHECK(
+            RaspiAPA102SubmitterGetTransport(&submitter, target, &transport) == 0);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceInitTransport(&devices[t], &transport) == 0);
+        colors[t] = malloc(count * sizeof(RaspiAPA102ColorQuad));
+        if (t == 0)
+        {
+            RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceAllocateBuffer(&devices[t], count) == 0);
+        }
+    }
+
+    uint8_t* const buffer = malloc(RASPI_APA102_FRAME_SIZE(RASPI_APA102_TEST_SUBMITTER_COUNTS[1]));
+    size_t frames_total = 0;
+    for (size_t frame = 0; frame < RASPI_APA102_TEST_SUBMITTER_FRAMES; ++frame)
+    {
+        for (size_t t = 0; t < RASPI_APA102_TEST_SUBMITTER_TARGETS; ++t)
+        {
+            for (size_t i = 0; i < RASPI_APA102_TEST_SUBMITTER_COUNTS[t]; ++i)
+            {
+                RaspiAPA102ColorQuadInit(&colors[t][i], (uint8_t)(i + frame), (uint8_t)t, 
+                    (uint8_t)(i >> 8), (uint8_t)frame);
+            }
+        }
+        for (size_t i = 0; i < RASPI_APA102_TEST_SUBMITTER_COUNTS[0]; ++i)
+        {
+            RaspiAPA102DeviceSetColor(&devices[0], i, colors[0][i]);
+        }
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceCommit(&devices[0]) == 0);
+        RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceUpdate(&devices[1], colors[1], 
+            RASPI_APA102_TEST_SUBMITTER_COUNTS[1]) == 0);
+
+        RASPI_APA102_TEST_CHECK(RaspiAPA102SubmitterSubmit(&submitter) == 0);
+        size_t frames = 0;
+        for (size_t i = 0; (frames < RASPI_APA102_TEST_SUBMITTER_TARGETS) && (i < 1000); ++i)
+        {
+            size_t completed;
+            if (!RASPI_APA102_TEST_CHECK(
+                RaspiAPA102SubmitterReap(&submitter, true, &completed) == 0))
+            {
+                break;
+            }
+            frames += completed;
+        }
+        RASPI_APA102_TEST_CHECK(frames == RASPI_APA102_TEST_SUBMITTER_TARGETS);
+        frames_total += frames;
+
+        for (size_t t = 0; t < RASPI_APA102_TEST_SUBMITTER_TARGETS; ++t)
+        {
+            const size_t count = RASPI_APA102_TEST_SUBMITTER_COUNTS[t];
+            const size_t size = RaspiAPA102TestSubmitterDrain(pipes[t][0], buffer, 
+                RASPI_APA102_FRAME_SIZE(RASPI_APA102_TEST_SUBMITTER_COUNTS[1]));
+            RaspiAPA102TestSubmitterCheckFrame(buffer, size, colors[t], count);
+        }
+    }
+    RASPI_APA102_TEST_CHECK(frames_total == 
+        RASPI_APA102_TEST_SUBMITTER_TARGETS * RASPI_APA102_TEST_SUBMITTER_FRAMES);
+
+    for (size_t t = 0; t < RASPI_APA102_TEST_SUBMITTER_TARGETS; ++t)
+    {
+        RaspiAPA102SubmitterStats stats;
+        RASPI_APA102_TEST_CHECK(RaspiAPA102SubmitterGetStats(&submitter, t, &stats) == 0);
+        RASPI_APA102_TEST_CHECK(stats.frames == RASPI_APA102_TEST_SUBMITTER_FRAMES);
+        RASPI_APA102_TEST_CHECK(stats.errors == 0);
+        RASPI_APA102_TEST_CHECK(stats.bytes == RASPI_APA102_TEST_SUBMITTER_FRAMES * 
+            RASPI_APA102_FRAME_SIZE(RASPI_APA102_TEST_SUBMITTER_COUNTS[t]));
+    }
+
+    // A failed write drops the frame and is counted as an error
+    close(pipes[0][0]);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102DeviceCommit(&devices[0]) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102SubmitterSubmit(&submitter) == 0);
+    RASPI_APA102_TEST_CHECK(RaspiAPA102SubmitterWait(&submitter) == 0);
+
+    RaspiAPA102SubmitterStats stats;
+    RASPI_APA102_TEST_CHECK(RaspiAPA102SubmitterGetStats(&submitter, 0, &stats) == 0);
+    RASPI_APA102_TEST_CHECK(stats.frames == RASPI_APA102_TEST_SUBMITTER_FRAMES);
+    RASPI_APA102_TEST_CHECK(stats.errors == 1);
+
+    for (size_t t = 0; t < RASPI_APA102_TEST_SUBMITTER_TARGETS; ++t)
+    {
+        RaspiAPA102DeviceDestroy(&devices[t]);
+        free(colors[t]);
+    }
+    RASPI_APA102_TEST_CHECK(RaspiAPA102SubmitterDestroy(&submitter) == 0);
+    close(pipes[0][1]);
+    close(pipes[1][0]);
+    close(pipes[1][1]);
+    free(buffer);
+}
+
+/* ============================================================================================== */
+/* Functions                                                                                      */
+/* ============================================================================================== */
+
+void RaspiAPA102TestSubmitter(void)
+{
+    // Writes to the closed pipe have to fail with `EPIPE` instead of terminating the process
+    signal(SIGPIPE, SIG_IGN);
+
+    RaspiAPA102TestSubmitterRun(RASPI_APA102_SUBMITTER_BACKEND_POLL);
+
+    // Kernels without `io_uring` (or sandboxes that block it) can only run the fallback
+    RaspiAPA102Submitter submitter;
+    if (RaspiAPA102SubmitterInit(&submitter, RASPI_APA102_SUBMITTER_BACKEND_IO_URING, 1, 1) < 0)
+    {
+        printf("submitter: io_uring is not available, skipped\n");
+        return;
+    }
+    RaspiAPA102SubmitterDestroy(&submitter);
+    RaspiAPA102TestSubmitterRun(RASPI_APA102_SUBMITTER_BACKEND_IO_URING);
+}
+
+/* ============================================================================================== */